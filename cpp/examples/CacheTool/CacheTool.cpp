@@ -0,0 +1,191 @@
+//-----------------------------------------------------------------------------
+//
+//	CacheTool.cpp
+//
+//	Converts the network cache between the XML and binary formats,
+//	measures how long each format takes to load, and compiles the
+//	config folder into the device database.
+//
+//	Usage:
+//		CacheTool to-binary ozwcache_0x<homeid>.xml ozwcache_0x<homeid>.bin
+//		CacheTool to-xml ozwcache_0x<homeid>.bin ozwcache_0x<homeid>.xml
+//		CacheTool bench ozwcache_0x<homeid>.xml [iterations]
+//		CacheTool device-db <config folder> [device_database.bin]
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "Defs.h"
+#include "BinaryCache.h"
+#include "DeviceDatabase.h"
+#include "platform/FileOps.h"
+#include "tinyxml.h"
+
+using namespace OpenZWave;
+
+//-----------------------------------------------------------------------------
+// <CountElements>
+// Walk a decoded tree, the same way Node::ReadXML visits every element
+//-----------------------------------------------------------------------------
+static uint32 CountElements(TiXmlElement const* _element)
+{
+	uint32 count = 1;
+	for (TiXmlElement const* child = _element->FirstChildElement(); child; child = child->NextSiblingElement())
+	{
+		count += CountElements(child);
+	}
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// <LoadXML>
+// Load the XML cache and visit every Node
+//-----------------------------------------------------------------------------
+static uint32 LoadXML(string const& _filename)
+{
+	TiXmlDocument doc;
+	doc.SetCondenseWhiteSpace(false);
+	if (!doc.LoadFile(_filename.c_str(), TIXML_ENCODING_UTF8) || !doc.RootElement())
+	{
+		return 0;
+	}
+	return CountElements(doc.RootElement());
+}
+
+//-----------------------------------------------------------------------------
+// <LoadBinary>
+// Map the binary cache and decode every Node one at a time, as Driver::ReadCache does
+//-----------------------------------------------------------------------------
+static uint32 LoadBinary(string const& _filename)
+{
+	Internal::BinaryCache cache;
+	if (!cache.Open(_filename))
+	{
+		return 0;
+	}
+	TiXmlDocument doc;
+	TiXmlElement* driverElement = cache.Decode(cache.GetRoot(), &doc, true);
+	if (!driverElement)
+	{
+		return 0;
+	}
+	uint32 count = 1;
+	uint32 root = cache.GetRoot();
+	for (uint16 i = 0; i < cache.GetChildCount(root); ++i)
+	{
+		TiXmlElement* node = cache.Decode(cache.GetChild(root, i), driverElement);
+		if (!node)
+		{
+			return 0;
+		}
+		count += CountElements(node);
+		driverElement->RemoveChild(node);
+	}
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// <Bench>
+// Time loading the same cache in both formats
+//-----------------------------------------------------------------------------
+static int Bench(string const& _xmlFile, int _iterations)
+{
+	string binaryFile = _xmlFile + ".bench.bin";
+	if (!Internal::BinaryCache::ConvertToBinary(_xmlFile, binaryFile))
+	{
+		fprintf(stderr, "Could not convert %s\n", _xmlFile.c_str());
+		return 1;
+	}
+
+	uint32 xmlElements = 0;
+	uint32 binaryElements = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < _iterations; ++i)
+	{
+		xmlElements = LoadXML(_xmlFile);
+	}
+	std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+	for (int i = 0; i < _iterations; ++i)
+	{
+		binaryElements = LoadBinary(binaryFile);
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	remove(binaryFile.c_str());
+
+	if (xmlElements != binaryElements)
+	{
+		fprintf(stderr, "Element count mismatch: XML %u, binary %u\n", xmlElements, binaryElements);
+		return 1;
+	}
+	double xmlMs = std::chrono::duration<double, std::milli>(middle - start).count() / _iterations;
+	double binaryMs = std::chrono::duration<double, std::milli>(end - middle).count() / _iterations;
+	printf("%u elements, %d iterations\n", xmlElements, _iterations);
+	printf("XML:    %.3f ms per load\n", xmlMs);
+	printf("Binary: %.3f ms per load (%.1fx)\n", binaryMs, binaryMs > 0 ? xmlMs / binaryMs : 0.0);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s to-binary <xml> <bin> | to-xml <bin> <xml> | bench <xml> [iterations] | device-db <config folder> [output]\n", argv[0]);
+		return 1;
+	}
+
+	Internal::Platform::FileOps::Create();
+	int ret = 1;
+	if (!strcmp(argv[1], "to-binary") && argc == 4)
+	{
+		ret = Internal::BinaryCache::ConvertToBinary(argv[2], argv[3]) ? 0 : 1;
+	}
+	else if (!strcmp(argv[1], "to-xml") && argc == 4)
+	{
+		ret = Internal::BinaryCache::ConvertToXML(argv[2], argv[3]) ? 0 : 1;
+	}
+	else if (!strcmp(argv[1], "device-db") && argc <= 4)
+	{
+		string configPath = argv[2];
+		if (configPath[configPath.size() - 1] != '/')
+		{
+			configPath += "/";
+		}
+		string output = (argc == 4) ? argv[3] : configPath + Internal::DeviceDatabase::c_filename;
+		ret = Internal::DeviceDatabase::Compile(configPath, output) ? 0 : 1;
+	}
+	else if (!strcmp(argv[1], "bench"))
+	{
+		int iterations = (argc > 3) ? atoi(argv[3]) : 20;
+		ret = Bench(argv[2], iterations > 0 ? iterations : 1);
+	}
+	else
+	{
+		fprintf(stderr, "Unknown command %s\n", argv[1]);
+	}
+	if (ret && strcmp(argv[1], "bench"))
+	{
+		fprintf(stderr, "Conversion failed\n");
+	}
+	Internal::Platform::FileOps::Destroy();
+	return ret;
+}
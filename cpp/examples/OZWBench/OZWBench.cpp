@@ -0,0 +1,1119 @@
+//-----------------------------------------------------------------------------
+//
+//	OZWBench.cpp
+//
+//	Microbenchmarks for the Driver thread's hot paths.
+//
+//	wait: a second thread signals one of the Driver's 11 wait objects and
+//	waits for the Driver side to pick it up, as a received frame or a queued
+//	message would.  The wakeup latency and the CPU time used by the waiting
+//	thread are reported for Wait::Multiple and for a WaitSet.
+//
+//	stream: a producer thread writes Z-Wave sized frames into a Stream, the
+//	way the serial reader thread does, while the consumer drains it.  The
+//	throughput of the Stream is compared with the mutex based ring buffer
+//	it replaced.
+//
+//	nodelock: reader threads make Manager style value queries against a node
+//	table while a writer thread updates it, as the Driver thread does for each
+//	received report.  The query rate and the writer's wait for the lock are
+//	reported with the table guarded by a Mutex and by a SharedMutex.
+//
+//	valuestore: lookups, iteration and insertion over the values of a node
+//	with a few hundred of them, a 16 way metering power strip, against the
+//	map the ValueStore used to be.
+//
+//	timers: sets and then deletes a large number of timers spread over the
+//	next minute, as dimmers doing transitions do, in a TimerWheel and in the
+//	list of TimeStamps the TimerThread used to keep.  Also reported is the
+//	cost of a TimerThread wakeup with all those timers pending.
+//
+//	msgs: queues a backlog of Get messages, as an interview of many nodes does,
+//	then frees them as they would be sent.  The Msg, with its frame inline and
+//	taken from a pool, is compared with the layout it replaced, which carried
+//	two 256 byte buffers and a copy of its log text.
+//
+//	interview: replays the interview of a network through the InterviewScheduler,
+//	on a simulated clock, and reports how long it takes until all nodes are
+//	queried, and until the important ones are, for several pipeline depths.
+//	The network is read from a file, a line per node of "nodeId latency
+//	queries [important]" with the latency in milliseconds, or else made up
+//	the same way each run.
+//
+//	Usage:
+//		OZWBench wait [iterations]
+//		OZWBench stream [megabytes]
+//		OZWBench nodelock [readers]
+//		OZWBench valuestore [values]
+//		OZWBench timers [timers]
+//		OZWBench msgs [messages]
+//		OZWBench interview [nodes | file]
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <map>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "Defs.h"
+#include "InterviewScheduler.h"
+#include "platform/Event.h"
+#include "platform/Mutex.h"
+#include "platform/SharedMutex.h"
+#include "platform/Stream.h"
+#include "platform/TimeStamp.h"
+#include "platform/Wait.h"
+#include "platform/WaitSet.h"
+#include "Manager.h"
+#include "Msg.h"
+#include "Options.h"
+#include "OZWException.h"
+#include "TimerWheel.h"
+#include "Utils.h"
+#include "value_classes/Value.h"
+#include "value_classes/ValueStore.h"
+
+using namespace OpenZWave;
+using Internal::Platform::Event;
+using Internal::Platform::Mutex;
+using Internal::Platform::SharedMutex;
+using Internal::Platform::Stream;
+using Internal::Platform::TimeStamp;
+using Internal::Platform::Wait;
+using Internal::Platform::WaitSet;
+using Internal::VC::Value;
+using Internal::VC::ValueStore;
+using Internal::TimerWheel;
+using Internal::Msg;
+using Internal::InterviewScheduler;
+
+#define WAITOBJECTCOUNT 11
+
+typedef std::chrono::steady_clock Clock;
+
+//-----------------------------------------------------------------------------
+// <ThreadCpuNs>
+// CPU time used so far by the calling thread
+//-----------------------------------------------------------------------------
+static double ThreadCpuNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+struct WaitResult
+{
+	double m_cpuNs;							// waiting thread CPU per wakeup
+	std::vector<double> m_latencyUs;		// signal to return from the wait
+};
+
+//-----------------------------------------------------------------------------
+// <RunWait>
+// Ping-pong between a signalling thread and a thread waiting on 11 events
+//-----------------------------------------------------------------------------
+static WaitResult RunWait(bool _useWaitSet, int _iterations)
+{
+	Event* events[WAITOBJECTCOUNT];
+	Wait* waitObjects[WAITOBJECTCOUNT];
+	for (int i = 0; i < WAITOBJECTCOUNT; ++i)
+	{
+		events[i] = new Event();
+		waitObjects[i] = events[i];
+	}
+	Event* ack = new Event();
+
+	WaitResult result;
+	result.m_latencyUs.resize(_iterations);
+	std::vector<Clock::time_point> sent(_iterations);
+
+	// Signal the queue and controller events in turn, never the exit event (index 0)
+	std::thread signaller([&]()
+	{
+		for (int i = 0; i < _iterations; ++i)
+		{
+			ack->Reset();
+			sent[i] = Clock::now();
+			events[1 + (i % (WAITOBJECTCOUNT - 1))]->Set();
+			Wait::Single(ack);
+		}
+	});
+
+	WaitSet* waitSet = _useWaitSet ? new WaitSet(waitObjects, WAITOBJECTCOUNT) : NULL;
+	double cpuStart = ThreadCpuNs();
+	for (int i = 0; i < _iterations; ++i)
+	{
+		int32 res = waitSet ? waitSet->Select(WAITOBJECTCOUNT) : Wait::Multiple(waitObjects, WAITOBJECTCOUNT);
+		result.m_latencyUs[i] = std::chrono::duration<double, std::micro>(Clock::now() - sent[i]).count();
+		events[res]->Reset();
+		ack->Set();
+	}
+	result.m_cpuNs = (ThreadCpuNs() - cpuStart) / _iterations;
+	signaller.join();
+	delete waitSet;
+
+	for (int i = 0; i < WAITOBJECTCOUNT; ++i)
+	{
+		events[i]->Release();
+	}
+	ack->Release();
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// <Report>
+// Print the latency percentiles and CPU cost of one run
+//-----------------------------------------------------------------------------
+static void Report(char const* _name, WaitResult& _result)
+{
+	std::vector<double>& l = _result.m_latencyUs;
+	std::sort(l.begin(), l.end());
+	printf("%-14s p50 %7.1f us  p99 %7.1f us  max %8.1f us  cpu %6.2f us/wakeup\n", _name, l[l.size() / 2], l[l.size() * 99 / 100], l.back(), _result.m_cpuNs / 1000.0);
+}
+
+//-----------------------------------------------------------------------------
+// <BenchWait>
+// Compare Wait::Multiple with WaitSet
+//-----------------------------------------------------------------------------
+static int BenchWait(int _iterations)
+{
+	printf("%d wakeups across %d wait objects\n", _iterations, WAITOBJECTCOUNT);
+	WaitResult multiple = RunWait(false, _iterations);
+	WaitResult waitSet = RunWait(true, _iterations);
+	Report("Wait::Multiple", multiple);
+	Report("WaitSet", waitSet);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// <LockedStream>
+// The mutex protected ring buffer that Stream used to be, kept for comparison
+//-----------------------------------------------------------------------------
+class LockedStream: public Wait
+{
+	public:
+		LockedStream(uint32 _bufferSize) :
+				m_bufferSize(_bufferSize), m_signalSize(1), m_dataSize(0), m_head(0), m_tail(0), m_mutex(new Mutex())
+		{
+			m_buffer = new uint8[m_bufferSize];
+		}
+
+		bool Get(uint8* _buffer, uint32 _size)
+		{
+			if (m_dataSize < _size)
+			{
+				return false;
+			}
+			m_mutex->Lock();
+			if ((m_tail + _size) > m_bufferSize)
+			{
+				uint32 block1 = m_bufferSize - m_tail;
+				uint32 block2 = _size - block1;
+				memcpy(_buffer, &m_buffer[m_tail], block1);
+				memcpy(&_buffer[block1], m_buffer, block2);
+				m_tail = block2;
+			}
+			else
+			{
+				memcpy(_buffer, &m_buffer[m_tail], _size);
+				m_tail += _size;
+			}
+			m_dataSize -= _size;
+			m_mutex->Unlock();
+			return true;
+		}
+
+		bool Put(uint8* _buffer, uint32 _size)
+		{
+			if ((m_bufferSize - m_dataSize) < _size)
+			{
+				return false;
+			}
+			m_mutex->Lock();
+			if ((m_head + _size) > m_bufferSize)
+			{
+				uint32 block1 = m_bufferSize - m_head;
+				uint32 block2 = _size - block1;
+				memcpy(&m_buffer[m_head], _buffer, block1);
+				memcpy(m_buffer, &_buffer[block1], block2);
+				m_head = block2;
+			}
+			else
+			{
+				memcpy(&m_buffer[m_head], _buffer, _size);
+				m_head += _size;
+			}
+			m_dataSize += _size;
+			if (IsSignalled())
+			{
+				Notify();
+			}
+			m_mutex->Unlock();
+			return true;
+		}
+
+		uint32 GetDataSize() const
+		{
+			return m_dataSize;
+		}
+
+	protected:
+		virtual bool IsSignalled()
+		{
+			return (m_dataSize >= m_signalSize);
+		}
+
+		~LockedStream()
+		{
+			m_mutex->Release();
+			delete[] m_buffer;
+		}
+
+	private:
+		uint8* m_buffer;
+		uint32 m_bufferSize;
+		uint32 m_signalSize;
+		uint32 m_dataSize;
+		uint32 m_head;
+		uint32 m_tail;
+		Mutex* m_mutex;
+};
+
+// Old and new consumers, each taking whatever is in the stream
+static uint32 Drain(LockedStream* _stream, uint8* _buffer, uint32 _size)
+{
+	uint32 size = _stream->GetDataSize();
+	if (size > _size)
+	{
+		size = _size;
+	}
+	return _stream->Get(_buffer, size) ? size : 0;
+}
+
+static uint32 Drain(Stream* _stream, uint8* _buffer, uint32 _size)
+{
+	return _stream->GetAvailable(_buffer, _size);
+}
+
+//-----------------------------------------------------------------------------
+// <RunStream>
+// Push _total bytes through a stream and return the throughput in MB/s
+//-----------------------------------------------------------------------------
+template<class T> static double RunStream(T* _stream, uint64 _total)
+{
+	std::thread producer([&]()
+	{
+		// A meter report is about 16 bytes on the wire
+		uint8 frame[16];
+		memset(frame, 0x5a, sizeof(frame));
+		for (uint64 sent = 0; sent < _total; sent += sizeof(frame))
+		{
+			while (!_stream->Put(frame, sizeof(frame)))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	uint8 buffer[2048];
+	uint64 received = 0;
+	Clock::time_point start = Clock::now();
+	while (received < _total)
+	{
+		uint32 size = Drain(_stream, buffer, sizeof(buffer));
+		if (!size)
+		{
+			Wait::Single(_stream, 1);
+		}
+		received += size;
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	producer.join();
+	_stream->Release();
+	return (_total / 1e6) / seconds;
+}
+
+//-----------------------------------------------------------------------------
+// <BenchStream>
+// Compare Stream with the mutex based ring buffer
+//-----------------------------------------------------------------------------
+static int BenchStream(int _megabytes)
+{
+	uint64 total = (uint64) _megabytes * 1000000;
+	printf("%d MB in 16 byte frames through a 2048 byte stream\n", _megabytes);
+	printf("%-14s %8.1f MB/s\n", "Mutex", RunStream(new LockedStream(2048), total));
+	printf("%-14s %8.1f MB/s\n", "Lock-free", RunStream(new Stream(2048), total));
+	return 0;
+}
+
+struct NodeLockResult
+{
+		double m_readsPerSec;
+		std::vector<double> m_latencyUs;		// writer's wait for the lock
+};
+
+//-----------------------------------------------------------------------------
+// <RunNodeLock>
+// Readers query a value table while one writer updates it every 100us.
+// Queries lock the table with TReadGuard, the writer with a LockGuard.
+//-----------------------------------------------------------------------------
+template<class TMutex, class TReadGuard> static NodeLockResult RunNodeLock(TMutex* _mutex, int _readers, double _seconds)
+{
+	// 64 nodes with 32 values each, keyed like a ValueStore
+	std::map<uint32, int32> values;
+	for (uint32 i = 0; i < 64 * 32; ++i)
+	{
+		values[i * 2654435761u] = (int32) i;
+	}
+
+	std::atomic<bool> stop(false);
+	std::atomic<uint64> reads(0);
+	std::atomic<int64> checksum(0);
+	std::vector<std::thread> readers;
+	for (int r = 0; r < _readers; ++r)
+	{
+		readers.push_back(std::thread([&, r]()
+		{
+			uint64 count = 0;
+			int64 sum = 0;
+			uint32 i = r;
+			while (!stop)
+			{
+				TReadGuard LG(_mutex);
+				std::map<uint32, int32>::const_iterator it = values.find((i++ % (64 * 32)) * 2654435761u);
+				sum += it->second;
+				++count;
+			}
+			reads += count;
+			checksum += sum;
+		}));
+	}
+
+	NodeLockResult result;
+	Clock::time_point start = Clock::now();
+	Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(_seconds));
+	uint32 i = 0;
+	while (Clock::now() < end)
+	{
+		Clock::time_point before = Clock::now();
+		{
+			Internal::LockGuard LG(_mutex);
+			result.m_latencyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+			values[(i++ % (64 * 32)) * 2654435761u]++;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	stop = true;
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	for (std::vector<std::thread>::iterator it = readers.begin(); it != readers.end(); ++it)
+	{
+		it->join();
+	}
+	_mutex->Release();
+
+	result.m_readsPerSec = reads / seconds;
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+// <ReportNodeLock>
+// Print the query rate and the writer's lock latency for one run
+//-----------------------------------------------------------------------------
+static void ReportNodeLock(char const* _name, NodeLockResult& _result)
+{
+	std::vector<double>& l = _result.m_latencyUs;
+	std::sort(l.begin(), l.end());
+	printf("%-14s %8.2f M reads/s  writer wait p50 %7.1f us  p99 %8.1f us  max %8.1f us\n", _name, _result.m_readsPerSec / 1e6, l[l.size() / 2], l[l.size() * 99 / 100], l.back());
+}
+
+//-----------------------------------------------------------------------------
+// <BenchNodeLock>
+// Compare a Mutex with a SharedMutex guarding the node table
+//-----------------------------------------------------------------------------
+static int BenchNodeLock(int _readers)
+{
+	printf("%d reader threads and one writer for 2 seconds\n", _readers);
+	NodeLockResult mutex = RunNodeLock<Mutex, Internal::LockGuard>(new Mutex(), _readers, 2.0);
+	NodeLockResult shared = RunNodeLock<SharedMutex, Internal::SharedLockGuard>(new SharedMutex(), _readers, 2.0);
+	ReportNodeLock("Mutex", mutex);
+	ReportNodeLock("SharedMutex", shared);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// <BenchValue>
+// A value that can be made without a Driver.  The normal constructors and
+// ValueStore::AddValue look the Driver up by Home ID and throw without one.
+//-----------------------------------------------------------------------------
+class BenchValue: public Value
+{
+	public:
+		BenchValue(uint8 const _commandClassId, uint8 const _instance, uint16 const _index)
+		{
+			m_id = ValueID(0xdeadbeef, 2, ValueID::ValueGenre_User, _commandClassId, _instance, _index, ValueID::ValueType_Byte);
+		}
+};
+
+// Keeps the compiler from dropping the loops being timed
+static volatile uint32 s_sink;
+
+// Old and new lookups, as used by Node::GetValue
+static Value* Lookup(std::map<uint32, Value*>* _values, uint32 _key)
+{
+	std::map<uint32, Value*>::const_iterator it = _values->find(_key);
+	if (it == _values->end())
+	{
+		return NULL;
+	}
+	it->second->AddRef();
+	return it->second;
+}
+
+static Value* Lookup(ValueStore* _store, uint32 _key)
+{
+	return _store->GetValue(_key);
+}
+
+template<class T> static double TimeLookup(T* _store, std::vector<uint32> const& _keys, int _rounds)
+{
+	Clock::time_point start = Clock::now();
+	for (int r = 0; r < _rounds; ++r)
+	{
+		for (std::vector<uint32>::const_iterator it = _keys.begin(); it != _keys.end(); ++it)
+		{
+			Lookup(_store, *it)->Release();
+		}
+	}
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ((double) _rounds * _keys.size());
+}
+
+static double TimeBorrow(ValueStore* _store, std::vector<uint32> const& _keys, int _rounds)
+{
+	uint32 sum = 0;
+	Clock::time_point start = Clock::now();
+	for (int r = 0; r < _rounds; ++r)
+	{
+		for (std::vector<uint32>::const_iterator it = _keys.begin(); it != _keys.end(); ++it)
+		{
+			sum += _store->BorrowValue(*it)->GetID().GetIndex();
+		}
+	}
+	s_sink = sum;
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ((double) _rounds * _keys.size());
+}
+
+// Walk every value, as WriteXML and the poll list rebuild do
+template<class TIterator> static uint32 Walk(TIterator _begin, TIterator _end)
+{
+	uint32 sum = 0;
+	for (TIterator it = _begin; it != _end; ++it)
+	{
+		sum += it->second->GetID().GetIndex();
+	}
+	return sum;
+}
+
+//-----------------------------------------------------------------------------
+// <BenchValueStore>
+// Compare the flat ValueStore with the map it replaced
+//-----------------------------------------------------------------------------
+static int BenchValueStore(int _count)
+{
+	Options::Create("../config/", "", "");
+	Options::Get()->AddOptionBool("Logging", false);
+	Options::Get()->AddOptionBool("ConsoleOutput", false);
+	Options::Get()->Lock();
+	Manager::Create();
+
+	// Per endpoint: switch, meter readings and sensors.  The rest are configuration parameters.
+	std::vector<Value*> values;
+	for (uint8 instance = 1; instance <= 16 && (int) values.size() < _count; ++instance)
+	{
+		values.push_back(new BenchValue(0x25, instance, 0));
+		for (uint16 index = 0; index < 10; ++index)
+		{
+			values.push_back(new BenchValue(0x32, instance, index));
+		}
+		for (uint16 index = 1; index <= 4; ++index)
+		{
+			values.push_back(new BenchValue(0x31, instance, index));
+		}
+	}
+	for (uint16 index = 1; (int) values.size() < _count; ++index)
+	{
+		values.push_back(new BenchValue(0x70, 1, index));
+	}
+
+	std::vector<uint32> keys;
+	std::map<uint32, Value*> map;
+	ValueStore* store = new ValueStore();
+	for (std::vector<Value*>::iterator it = values.begin(); it != values.end(); ++it)
+	{
+		uint32 key = (*it)->GetID().GetValueStoreKey();
+		keys.push_back(key);
+		map[key] = *it;
+		try
+		{
+			store->AddValue(*it);
+		} catch (OZWException const&)
+		{
+			// Thrown when the value added notification looks for the Driver, after the value is in the store
+		}
+	}
+
+	printf("%d values in one node\n", (int) values.size());
+
+	// Look the values up in a scattered order, as reports and polls arrive
+	std::vector<uint32> order(keys);
+	for (size_t i = order.size() - 1; i > 0; --i)
+	{
+		std::swap(order[i], order[rand() % (i + 1)]);
+	}
+	int rounds = 20000;
+	printf("%-22s %7.1f ns\n", "lookup map", TimeLookup(&map, order, rounds));
+	printf("%-22s %7.1f ns\n", "lookup ValueStore", TimeLookup(store, order, rounds));
+	printf("%-22s %7.1f ns\n", "borrow ValueStore", TimeBorrow(store, order, rounds));
+
+	uint32 sum = 0;
+	Clock::time_point start = Clock::now();
+	for (int r = 0; r < rounds; ++r)
+	{
+		sum += Walk(map.begin(), map.end());
+	}
+	double mapWalk = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ((double) rounds * keys.size());
+	start = Clock::now();
+	for (int r = 0; r < rounds; ++r)
+	{
+		sum += Walk(store->Begin(), store->End());
+	}
+	double storeWalk = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ((double) rounds * keys.size());
+	printf("%-22s %7.1f ns/value\n", "iterate map", mapWalk);
+	s_sink = sum;
+	printf("%-22s %7.1f ns/value\n", "iterate ValueStore", storeWalk);
+
+	// Insertion into the two layouts, in the order the command classes create values.  AddValue
+	// itself is dominated by the value added notification, which needs a Driver.
+	rounds = 2000;
+	start = Clock::now();
+	for (int r = 0; r < rounds; ++r)
+	{
+		std::map<uint32, Value*> m;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			m[keys[i]] = values[i];
+		}
+	}
+	double mapInsert = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ((double) rounds * keys.size());
+	start = Clock::now();
+	for (int r = 0; r < rounds; ++r)
+	{
+		std::vector<std::pair<uint32, Value*> > v;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			std::pair<uint32, Value*> entry(keys[i], values[i]);
+			v.insert(std::lower_bound(v.begin(), v.end(), entry), entry);
+		}
+	}
+	double vectorInsert = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ((double) rounds * keys.size());
+	// AddValue also updates the hash index, at worst rebuilding it.  Removing a command
+	// class the node does not have costs one pass over the values and that rebuild.
+	start = Clock::now();
+	for (int r = 0; r < rounds; ++r)
+	{
+		store->RemoveCommandClassValues(0xff);
+	}
+	double reindex = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / rounds;
+	printf("%-22s %7.1f ns/value\n", "insert map", mapInsert);
+	printf("%-22s %7.1f ns/value\n", "insert sorted vector", vectorInsert);
+	printf("%-22s %7.1f ns/insert\n", "rebuild index", reindex);
+
+	// The store is not destroyed, as removing values also looks for the Driver
+	return 0;
+}
+
+// A timer as the TimerThread used to keep them
+struct ListTimer
+{
+		TimeStamp m_timestamp;
+		uint32 m_id;
+};
+
+// A timer as the TimerThread keeps them now
+struct WheelTimer: public TimerWheel::Entry
+{
+		uint32 m_id;
+};
+
+//-----------------------------------------------------------------------------
+// <BenchTimers>
+// Compare the TimerWheel with the list of TimeStamps it replaced
+//-----------------------------------------------------------------------------
+static int BenchTimers(int _count)
+{
+	printf("%d timers due in the next minute\n", _count);
+	std::vector<int32> delays(_count);
+	for (int i = 0; i < _count; ++i)
+	{
+		delays[i] = 1 + rand() % 60000;
+	}
+	int wakeups = 100;
+
+	// The list, with an allocation per timer.  Timers are deleted in the order they
+	// were set, which is the best case for the find that deleting one needs.
+	std::list<ListTimer*> list;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < _count; ++i)
+	{
+		ListTimer* timer = new ListTimer();
+		timer->m_timestamp.SetTime(delays[i]);
+		timer->m_id = i;
+		list.push_back(timer);
+	}
+	double listSet = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / _count;
+	int32 sum = 0;
+	start = Clock::now();
+	for (int w = 0; w < wakeups; ++w)
+	{
+		for (std::list<ListTimer*>::iterator it = list.begin(); it != list.end(); ++it)
+		{
+			sum += (*it)->m_timestamp.TimeRemaining() <= 0;
+		}
+	}
+	double listWakeup = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / wakeups;
+	std::vector<ListTimer*> listTimers(list.begin(), list.end());
+	start = Clock::now();
+	for (int i = 0; i < _count; ++i)
+	{
+		std::list<ListTimer*>::iterator it = std::find(list.begin(), list.end(), listTimers[i]);
+		delete *it;
+		list.erase(it);
+	}
+	double listDel = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / _count;
+
+	// The wheel, taking its entries from a pool, on a millisecond clock.  Deleted in a
+	// scattered order, which costs the wheel no more.
+	std::vector<WheelTimer> pool(_count);
+	std::vector<WheelTimer*> freeTimers;
+	for (int i = _count - 1; i >= 0; --i)
+	{
+		freeTimers.push_back(&pool[i]);
+	}
+	Clock::time_point zero = Clock::now();
+	TimerWheel wheel;
+	std::vector<WheelTimer*> wheelTimers;
+	start = Clock::now();
+	for (int i = 0; i < _count; ++i)
+	{
+		WheelTimer* timer = freeTimers.back();
+		freeTimers.pop_back();
+		timer->m_expiry = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - zero).count() + delays[i];
+		timer->m_id = i;
+		wheel.Add(timer);
+		wheelTimers.push_back(timer);
+	}
+	double wheelSet = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / _count;
+	start = Clock::now();
+	for (int w = 0; w < wakeups; ++w)
+	{
+		uint64 now = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - zero).count();
+		while (wheel.Expire(now) != NULL)
+		{
+			++sum;
+		}
+		sum += (int32) (wheel.GetNextTick() - now);
+	}
+	double wheelWakeup = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / wakeups;
+	for (size_t i = wheelTimers.size() - 1; i > 0; --i)
+	{
+		std::swap(wheelTimers[i], wheelTimers[rand() % (i + 1)]);
+	}
+	start = Clock::now();
+	for (int i = 0; i < _count; ++i)
+	{
+		wheel.Remove(wheelTimers[i]);
+		freeTimers.push_back(wheelTimers[i]);
+	}
+	double wheelDel = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / _count;
+	s_sink = sum;
+
+	printf("%-14s set %7.1f ns  delete %9.1f ns  wakeup %9.1f us\n", "List", listSet, listDel, listWakeup);
+	printf("%-14s set %7.1f ns  delete %9.1f ns  wakeup %9.1f us\n", "TimerWheel", wheelSet, wheelDel, wheelWakeup);
+	return 0;
+}
+
+// A message laid out as Msg used to be
+struct OldMsg
+{
+		OldMsg(string const& _logText, uint8 _targetNodeId, uint8 const _msgType, uint8 const _function) :
+				m_logText(_logText), m_length(4), m_targetNodeId(_targetNodeId)
+		{
+			memset(m_buffer, 0x00, 256);
+			memset(e_buffer, 0x00, 256);
+			m_buffer[0] = SOF;
+			m_buffer[2] = _msgType;
+			m_buffer[3] = _function;
+		}
+
+		void Append(uint8 const _data)
+		{
+			m_buffer[m_length++] = _data;
+		}
+
+		void Finalize()
+		{
+			m_buffer[1] = m_length;
+			m_buffer[m_length++] = 10;
+			uint8 checksum = 0xff;
+			for (uint32 i = 1; i < m_length; ++i)
+			{
+				checksum ^= m_buffer[i];
+			}
+			m_buffer[m_length++] = checksum;
+		}
+
+		string m_logText;
+		uint8 m_length;
+		uint8 m_buffer[256];
+		uint8 e_buffer[256];
+		uint8 m_targetNodeId;
+};
+
+//-----------------------------------------------------------------------------
+// <FillGet>
+// Build a Get for a node, as a command class does
+//-----------------------------------------------------------------------------
+template<class T> static void FillGet(T* _msg, uint8 _nodeId)
+{
+	_msg->Append(_nodeId);
+	_msg->Append(2);
+	_msg->Append(0x25);
+	_msg->Append(0x02);
+	_msg->Append(TRANSMIT_OPTION_ACK | TRANSMIT_OPTION_AUTO_ROUTE | TRANSMIT_OPTION_EXPLORE);
+	_msg->Finalize();
+}
+
+//-----------------------------------------------------------------------------
+// <BenchMsgs>
+// Compare the pooled Msg with the layout it replaced
+//-----------------------------------------------------------------------------
+static int BenchMsgs(int _count)
+{
+	printf("Backlogs of %d messages\n", _count);
+	int rounds = 20;
+	std::vector<OldMsg*> oldMsgs(_count);
+	std::vector<Msg*> msgs(_count);
+	int32 sum = 0;
+
+	Clock::time_point start = Clock::now();
+	for (int r = 0; r < rounds; ++r)
+	{
+		for (int i = 0; i < _count; ++i)
+		{
+			oldMsgs[i] = new OldMsg("SwitchMultilevelCmd_Get", (uint8) (i % 232 + 1), REQUEST, FUNC_ID_ZW_SEND_DATA);
+			FillGet(oldMsgs[i], (uint8) (i % 232 + 1));
+		}
+		for (int i = 0; i < _count; ++i)
+		{
+			sum += oldMsgs[i]->m_length;
+			delete oldMsgs[i];
+		}
+	}
+	double oldTime = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (rounds * _count);
+
+	start = Clock::now();
+	for (int r = 0; r < rounds; ++r)
+	{
+		for (int i = 0; i < _count; ++i)
+		{
+			msgs[i] = new Msg("SwitchMultilevelCmd_Get", (uint8) (i % 232 + 1), REQUEST, FUNC_ID_ZW_SEND_DATA, true, true, FUNC_ID_APPLICATION_COMMAND_HANDLER, 0x25);
+			FillGet(msgs[i], (uint8) (i % 232 + 1));
+		}
+		for (int i = 0; i < _count; ++i)
+		{
+			sum += msgs[i]->GetLength();
+			delete msgs[i];
+		}
+	}
+	double newTime = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (rounds * _count);
+	s_sink = sum;
+
+	printf("%-14s %5d bytes  %7.1f ns per message queued and freed\n", "Old layout", (int) sizeof(OldMsg), oldTime);
+	printf("%-14s %5d bytes  %7.1f ns per message queued and freed\n", "Msg", (int) sizeof(Msg), newTime);
+	return 0;
+}
+
+// A node of the network being interviewed
+struct SimNode
+{
+		uint8 m_nodeId;
+		int32 m_latency;			// Milliseconds from a query being delivered to its report arriving
+		int32 m_queries;
+		bool m_important;
+};
+
+// Milliseconds the controller takes to deliver a query and have it acknowledged
+static int64 const c_deliveryTime = 25;
+
+//-----------------------------------------------------------------------------
+// <LoadNetwork>
+// Read a network to replay, a line per node
+//-----------------------------------------------------------------------------
+static bool LoadNetwork(char const* _path, std::vector<SimNode>* _nodes)
+{
+	FILE* file = fopen(_path, "r");
+	if (file == NULL)
+	{
+		return false;
+	}
+	char line[256];
+	while (fgets(line, sizeof(line), file))
+	{
+		int nodeId, latency, queries, important = 0;
+		if ((line[0] != '#') && (sscanf(line, "%d %d %d %d", &nodeId, &latency, &queries, &important) >= 3) && (nodeId > 0) && (nodeId < 256))
+		{
+			SimNode node = { (uint8) nodeId, latency, queries, important != 0 };
+			_nodes->push_back(node);
+		}
+	}
+	fclose(file);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// <MakeNetwork>
+// Make up a network, the same one each time.  Most nodes answer quickly, and
+// a few that are several hops away slowly.
+//-----------------------------------------------------------------------------
+static void MakeNetwork(int _count, std::vector<SimNode>* _nodes)
+{
+	uint32 seed = 1;
+	for (int i = 0; i < _count; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		uint32 hops = (seed >> 16) % 8;
+		seed = seed * 1103515245 + 12345;
+		SimNode node = { (uint8) (i + 2), (int32) (40 + ((hops > 4) ? hops * 120 : hops * 30)), (int32) (15 + (seed >> 16) % 30), (i % 30) == 29 };
+		_nodes->push_back(node);
+	}
+}
+
+// The state of a replayed interview
+class InterviewReplay
+{
+	public:
+		InterviewReplay(std::vector<SimNode> const& _nodes, uint32 _pipeline) :
+				m_scheduler(_pipeline), m_now(0), m_left(0), m_importantLeft(0), m_importantQueried(0)
+		{
+			memset(m_remaining, 0, sizeof(m_remaining));
+			memset(m_latency, 0, sizeof(m_latency));
+			for (std::vector<SimNode>::const_iterator it = _nodes.begin(); it != _nodes.end(); ++it)
+			{
+				if (it->m_queries > 0)
+				{
+					m_remaining[it->m_nodeId] = it->m_queries;
+					m_latency[it->m_nodeId] = it->m_latency;
+					m_scheduler.SetImportant(it->m_nodeId, it->m_important);
+					++m_left;
+					m_importantLeft += it->m_important;
+				}
+			}
+		}
+
+		// Query the nodes, as the Driver does, until they have all answered every query
+		void Run(int64* _allQueried, int64* _importantQueried)
+		{
+			uint8 last = 0;
+			while (m_left)
+			{
+				while (!m_reports.empty() && (m_reports.top().first <= m_now))
+				{
+					TakeReport();
+				}
+
+				int32 next = -1;
+				for (uint32 i = 1; i < 256; ++i)
+				{
+					if (m_remaining[i] && !m_scheduler.IsAwaiting((uint8) i) && ((next < 0) || m_scheduler.IsBefore((uint8) i, (uint8) next, last)))
+					{
+						next = (int32) i;
+					}
+				}
+				if (next < 0)
+				{
+					// Every node left is awaiting a report
+					m_now = m_reports.top().first;
+					continue;
+				}
+
+				uint8 nodeId = (uint8) next;
+				last = nodeId;
+				m_now += c_deliveryTime;
+				int64 due = m_now + m_latency[nodeId];
+				Msg* msg = new Msg("SwitchBinaryCmd_Get", nodeId, REQUEST, FUNC_ID_ZW_SEND_DATA, true, true, FUNC_ID_APPLICATION_COMMAND_HANDLER, 0x25);
+				FillGet(msg, nodeId);
+
+				// With the pipeline full, wait for the report, unless another report frees a place first
+				while (!m_scheduler.CanAwait() && !m_reports.empty() && (m_reports.top().first < due))
+				{
+					m_now = m_reports.top().first;
+					TakeReport();
+				}
+				if (m_scheduler.CanAwait())
+				{
+					m_scheduler.Await(msg, 0, InterviewScheduler::Clock::time_point(std::chrono::milliseconds(m_now + 10000)));
+					m_reports.push(Report(due, nodeId));
+				}
+				else
+				{
+					delete msg;
+					m_now = due;
+					Answered(nodeId);
+				}
+			}
+			*_allQueried = m_now;
+			*_importantQueried = m_importantQueried;
+		}
+
+	private:
+		typedef std::pair<int64, uint8> Report;
+
+		// The next report arrives
+		void TakeReport()
+		{
+			static uint8 const c_report[] = { 0x25, 0x03, 0x00 };
+			uint8 nodeId = m_reports.top().second;
+			m_reports.pop();
+			delete m_scheduler.ReportReceived(nodeId, c_report, sizeof(c_report));
+			Answered(nodeId);
+		}
+
+		// A node has answered a query, and how long it takes is now known
+		void Answered(uint8 _nodeId)
+		{
+			m_scheduler.SetLatency(_nodeId, m_latency[_nodeId]);
+			if (--m_remaining[_nodeId] == 0)
+			{
+				--m_left;
+				if (m_scheduler.IsImportant(_nodeId) && (--m_importantLeft == 0))
+				{
+					m_importantQueried = m_now;
+				}
+			}
+		}
+
+		InterviewScheduler m_scheduler;
+		std::priority_queue<Report, std::vector<Report>, std::greater<Report> > m_reports;
+		int32 m_remaining[256];
+		int32 m_latency[256];
+		int64 m_now;
+		uint32 m_left;
+		uint32 m_importantLeft;
+		int64 m_importantQueried;
+};
+
+//-----------------------------------------------------------------------------
+// <BenchInterview>
+// Time to all nodes queried, by pipeline depth
+//-----------------------------------------------------------------------------
+static int BenchInterview(char const* _network)
+{
+	std::vector<SimNode> nodes;
+	if (_network && (atoi(_network) <= 0))
+	{
+		if (!LoadNetwork(_network, &nodes))
+		{
+			fprintf(stderr, "Cannot read %s\n", _network);
+			return 1;
+		}
+	}
+	else
+	{
+		MakeNetwork(_network ? std::min(atoi(_network), 230) : 150, &nodes);
+	}
+
+	int32 queries = 0;
+	int32 important = 0;
+	for (std::vector<SimNode>::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+	{
+		queries += it->m_queries;
+		important += it->m_important;
+	}
+	printf("Interview of %d nodes, %d queries, %d of the nodes important\n", (int) nodes.size(), queries, important);
+
+	static uint32 const c_pipelines[] = { 1, 2, 4, 8 };
+	for (uint32 i = 0; i < sizeof(c_pipelines) / sizeof(c_pipelines[0]); ++i)
+	{
+		int64 all, importantQueried;
+		InterviewReplay replay(nodes, c_pipelines[i]);
+		replay.Run(&all, &importantQueried);
+		printf("Pipeline %d   all nodes queried after %7.1f s   important nodes after %7.1f s\n", c_pipelines[i], all / 1000.0, importantQueried / 1000.0);
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s wait [iterations] | stream [megabytes] | nodelock [readers] | valuestore [values] | timers [timers] | msgs [messages] | interview [nodes | file]\n", argv[0]);
+		return 1;
+	}
+
+	int iterations = (argc > 2) ? atoi(argv[2]) : 0;
+	if (!strcmp(argv[1], "wait"))
+	{
+		return BenchWait(iterations > 0 ? iterations : 100000);
+	}
+	if (!strcmp(argv[1], "stream"))
+	{
+		return BenchStream(iterations > 0 ? iterations : 100);
+	}
+	if (!strcmp(argv[1], "nodelock"))
+	{
+		return BenchNodeLock(iterations > 0 ? iterations : 4);
+	}
+	if (!strcmp(argv[1], "valuestore"))
+	{
+		return BenchValueStore(iterations > 0 ? iterations : 320);
+	}
+	if (!strcmp(argv[1], "timers"))
+	{
+		return BenchTimers(iterations > 0 ? iterations : 100000);
+	}
+	if (!strcmp(argv[1], "msgs"))
+	{
+		return BenchMsgs(iterations > 0 ? iterations : 10000);
+	}
+	if (!strcmp(argv[1], "interview"))
+	{
+		return BenchInterview((argc > 2) ? argv[2] : NULL);
+	}
+	fprintf(stderr, "Unknown benchmark %s\n", argv[1]);
+	return 1;
+}
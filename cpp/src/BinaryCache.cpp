@@ -0,0 +1,581 @@
+//-----------------------------------------------------------------------------
+//
+//	BinaryCache.cpp
+//
+//	Memory mapped binary form of the network cache
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+#include "BinaryCache.h"
+#include "platform/FileOps.h"
+#include "platform/Log.h"
+#include "tinyxml.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		// Bump whenever the layout changes. A file with a different version is ignored and the XML cache is used instead.
+		static uint32 const c_binaryCacheVersion = 1;
+		static uint32 const c_headerSize = 32;
+		static uint32 const c_elementSize = 12;
+		static uint32 const c_noText = 0xffffffff;
+		static uint32 const c_indexSlotSize = 16;
+		static uint64 const c_emptySlot = 0xffffffffffffffffULL;
+		// Guards the recursive decoder against a corrupt file that loops back on itself
+		static uint32 const c_maxDepth = 32;
+
+		namespace
+		{
+			uint32 IndexHash(uint64 _key)
+			{
+				_key ^= _key >> 29;
+				_key *= 0x9e3779b97f4a7c15ULL;
+				return (uint32) (_key >> 32);
+			}
+
+			class BinaryCacheWriter
+			{
+				public:
+					uint32 Intern(char const* _str)
+					{
+						map<string, uint32>::iterator it = m_index.find(_str);
+						if (it != m_index.end())
+						{
+							return it->second;
+						}
+						uint32 idx = (uint32) m_strings.size();
+						m_strings.push_back(_str);
+						m_index[_str] = idx;
+						return idx;
+					}
+
+					void Put32(uint32 const _value)
+					{
+						m_data.push_back((uint8) (_value & 0xff));
+						m_data.push_back((uint8) ((_value >> 8) & 0xff));
+						m_data.push_back((uint8) ((_value >> 16) & 0xff));
+						m_data.push_back((uint8) ((_value >> 24) & 0xff));
+					}
+
+					void Put16(uint16 const _value)
+					{
+						m_data.push_back((uint8) (_value & 0xff));
+						m_data.push_back((uint8) ((_value >> 8) & 0xff));
+					}
+
+					void Patch32(uint32 const _offset, uint32 const _value)
+					{
+						m_data[_offset] = (uint8) (_value & 0xff);
+						m_data[_offset + 1] = (uint8) ((_value >> 8) & 0xff);
+						m_data[_offset + 2] = (uint8) ((_value >> 16) & 0xff);
+						m_data[_offset + 3] = (uint8) ((_value >> 24) & 0xff);
+					}
+
+					// Children are written before their parent, so the parent can record their offsets
+					bool WriteElement(TiXmlElement const* _element, uint32* o_offset)
+					{
+						vector<uint32> children;
+						for (TiXmlElement const* child = _element->FirstChildElement(); child; child = child->NextSiblingElement())
+						{
+							uint32 offset;
+							if (!WriteElement(child, &offset))
+							{
+								return false;
+							}
+							children.push_back(offset);
+						}
+
+						uint32 attrCount = 0;
+						for (TiXmlAttribute const* attr = _element->FirstAttribute(); attr; attr = attr->Next())
+						{
+							++attrCount;
+						}
+						if (attrCount > 0xffff || children.size() > 0xffff)
+						{
+							Log::Write(LogLevel_Warning, "WARNING: BinaryCache - <%s> has too many attributes or children", _element->Value());
+							return false;
+						}
+
+						*o_offset = (uint32) m_data.size();
+						m_offsets[_element] = *o_offset;
+						Put32(Intern(_element->Value()));
+						Put32(_element->GetText() ? Intern(_element->GetText()) : c_noText);
+						Put16((uint16) attrCount);
+						Put16((uint16) children.size());
+						for (TiXmlAttribute const* attr = _element->FirstAttribute(); attr; attr = attr->Next())
+						{
+							Put32(Intern(attr->Name()));
+							Put32(Intern(attr->Value()));
+						}
+						for (vector<uint32>::iterator it = children.begin(); it != children.end(); ++it)
+						{
+							Put32(*it);
+						}
+						return true;
+					}
+
+					bool Write(TiXmlElement const* _root, string const& _filename, map<int64, TiXmlElement const*> const* _index)
+					{
+						m_data.assign(c_headerSize, 0);
+						uint32 root;
+						if (!WriteElement(_root, &root))
+						{
+							return false;
+						}
+
+						uint32 index = 0;
+						uint32 slots = 0;
+						if (_index && !_index->empty())
+						{
+							// Keep the table at most half full, so probe sequences stay short
+							slots = 1;
+							while (slots < 2 * _index->size())
+							{
+								slots <<= 1;
+							}
+							index = (uint32) m_data.size();
+							for (uint32 i = 0; i < slots; ++i)
+							{
+								Put32((uint32) c_emptySlot);
+								Put32((uint32) (c_emptySlot >> 32));
+								Put32(0);
+								Put32(0);
+							}
+							vector<bool> used(slots, false);
+							for (map<int64, TiXmlElement const*>::const_iterator it = _index->begin(); it != _index->end(); ++it)
+							{
+								map<TiXmlElement const*, uint32>::iterator oit = m_offsets.find(it->second);
+								if (oit == m_offsets.end())
+								{
+									Log::Write(LogLevel_Warning, "WARNING: BinaryCache - Index entry for an element outside the tree");
+									return false;
+								}
+								uint64 key = (uint64) it->first;
+								uint32 slot = IndexHash(key) & (slots - 1);
+								while (used[slot])
+								{
+									slot = (slot + 1) & (slots - 1);
+								}
+								used[slot] = true;
+								uint32 offset = index + slot * c_indexSlotSize;
+								Patch32(offset, (uint32) key);
+								Patch32(offset + 4, (uint32) (key >> 32));
+								Patch32(offset + 8, oit->second);
+							}
+						}
+
+						uint32 table = (uint32) m_data.size();
+						uint32 offset = table + 4 * (uint32) m_strings.size();
+						for (vector<string>::iterator it = m_strings.begin(); it != m_strings.end(); ++it)
+						{
+							Put32(offset);
+							offset += (uint32) it->size() + 1;
+						}
+						for (vector<string>::iterator it = m_strings.begin(); it != m_strings.end(); ++it)
+						{
+							m_data.insert(m_data.end(), it->begin(), it->end());
+							m_data.push_back(0);
+						}
+
+						memcpy(&m_data[0], "OZWB", 4);
+						Patch32(4, c_binaryCacheVersion);
+						Patch32(8, (uint32) m_data.size());
+						Patch32(12, table);
+						Patch32(16, (uint32) m_strings.size());
+						Patch32(20, root);
+						Patch32(24, index);
+						Patch32(28, slots);
+
+						// Write to a temporary file and rename it over the old cache, so a reader never maps a half written file
+						string tmpFile = _filename + ".tmp";
+						FILE* fp = fopen(tmpFile.c_str(), "wb");
+						if (!fp)
+						{
+							Log::Write(LogLevel_Warning, "WARNING: BinaryCache - Could not create %s", tmpFile.c_str());
+							return false;
+						}
+						bool ok = (fwrite(&m_data[0], 1, m_data.size(), fp) == m_data.size());
+						ok = (fflush(fp) == 0) && ok;
+						fclose(fp);
+						if (ok)
+						{
+#if defined _WINDOWS || defined WINRT
+							remove(_filename.c_str());
+#endif
+							ok = (rename(tmpFile.c_str(), _filename.c_str()) == 0);
+						}
+						if (!ok)
+						{
+							Log::Write(LogLevel_Warning, "WARNING: BinaryCache - Could not write %s", _filename.c_str());
+							remove(tmpFile.c_str());
+						}
+						return ok;
+					}
+
+				private:
+					vector<uint8> m_data;
+					vector<string> m_strings;
+					map<string, uint32> m_index;
+					map<TiXmlElement const*, uint32> m_offsets;
+			};
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::BinaryCache>
+// Constructor
+//-----------------------------------------------------------------------------
+		BinaryCache::BinaryCache() :
+				m_data(NULL), m_size(0), m_strings(0), m_stringCount(0), m_root(0), m_index(0), m_indexSlots(0)
+		{
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::~BinaryCache>
+// Destructor
+//-----------------------------------------------------------------------------
+		BinaryCache::~BinaryCache()
+		{
+			Close();
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::Open>
+// Map and validate a binary cache file
+//-----------------------------------------------------------------------------
+		bool BinaryCache::Open(string const& _filename)
+		{
+			Close();
+			m_data = Platform::FileOps::Create()->FileMap(_filename, &m_size);
+			if (!m_data)
+			{
+				return false;
+			}
+
+			char const* error = NULL;
+			if (m_size < c_headerSize || memcmp(m_data, "OZWB", 4))
+			{
+				error = "not a binary cache";
+			}
+			else if (Read32(4) != c_binaryCacheVersion)
+			{
+				error = "unsupported format version";
+			}
+			else if (Read32(8) != m_size || m_data[m_size - 1] != 0)
+			{
+				error = "truncated";
+			}
+			else
+			{
+				m_strings = Read32(12);
+				m_stringCount = Read32(16);
+				m_root = Read32(20);
+				m_index = Read32(24);
+				m_indexSlots = Read32(28);
+				if (m_strings < c_headerSize || m_strings > m_size || m_stringCount > (m_size - m_strings) / 4 || !IsElement(m_root))
+				{
+					error = "corrupt header";
+				}
+				else if (m_index && (m_index < c_headerSize || m_index > m_strings || (m_indexSlots & (m_indexSlots - 1)) || m_indexSlots > (m_strings - m_index) / c_indexSlotSize))
+				{
+					error = "corrupt index";
+				}
+			}
+			if (error)
+			{
+				Log::Write(LogLevel_Warning, "WARNING: BinaryCache - Ignoring %s: %s", _filename.c_str(), error);
+				Close();
+				return false;
+			}
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::Close>
+// Release the mapping
+//-----------------------------------------------------------------------------
+		void BinaryCache::Close()
+		{
+			if (m_data)
+			{
+				Platform::FileOps::FileUnmap(m_data, m_size);
+			}
+			m_data = NULL;
+			m_size = 0;
+			m_strings = 0;
+			m_stringCount = 0;
+			m_root = 0;
+			m_index = 0;
+			m_indexSlots = 0;
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::Read32>
+// Read a little endian value (the caller has checked the bounds)
+//-----------------------------------------------------------------------------
+		uint32 BinaryCache::Read32(uint32 const _offset) const
+		{
+			return (uint32) m_data[_offset] | ((uint32) m_data[_offset + 1] << 8) | ((uint32) m_data[_offset + 2] << 16) | ((uint32) m_data[_offset + 3] << 24);
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::Read16>
+// Read a little endian value (the caller has checked the bounds)
+//-----------------------------------------------------------------------------
+		uint16 BinaryCache::Read16(uint32 const _offset) const
+		{
+			return (uint16) (m_data[_offset] | (m_data[_offset + 1] << 8));
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::IsElement>
+// Check that an element record and its tables lie within the file
+//-----------------------------------------------------------------------------
+		bool BinaryCache::IsElement(uint32 const _element) const
+		{
+			if (_element < c_headerSize || _element >= m_strings || m_strings - _element < c_elementSize)
+			{
+				return false;
+			}
+			uint32 tables = 8 * (uint32) Read16(_element + 8) + 4 * (uint32) Read16(_element + 10);
+			return (m_strings - _element - c_elementSize >= tables);
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::GetString>
+// Look up an entry in the string table
+//-----------------------------------------------------------------------------
+		char const* BinaryCache::GetString(uint32 const _index) const
+		{
+			if (_index >= m_stringCount)
+			{
+				return NULL;
+			}
+			uint32 offset = Read32(m_strings + 4 * _index);
+			if (offset >= m_size)
+			{
+				return NULL;
+			}
+			// The file ends in a NUL, so every string is terminated
+			return (char const*) m_data + offset;
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::GetName>
+// Get an element's name
+//-----------------------------------------------------------------------------
+		char const* BinaryCache::GetName(uint32 const _element) const
+		{
+			if (!IsElement(_element))
+			{
+				return NULL;
+			}
+			return GetString(Read32(_element));
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::GetAttribute>
+// Get an element's attribute value without decoding it
+//-----------------------------------------------------------------------------
+		char const* BinaryCache::GetAttribute(uint32 const _element, char const* _name) const
+		{
+			if (!IsElement(_element))
+			{
+				return NULL;
+			}
+			uint16 count = Read16(_element + 8);
+			uint32 attr = _element + c_elementSize;
+			for (uint16 i = 0; i < count; ++i, attr += 8)
+			{
+				char const* name = GetString(Read32(attr));
+				if (name && !strcmp(name, _name))
+				{
+					return GetString(Read32(attr + 4));
+				}
+			}
+			return NULL;
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::GetChildCount>
+// Get the number of child elements
+//-----------------------------------------------------------------------------
+		uint16 BinaryCache::GetChildCount(uint32 const _element) const
+		{
+			if (!IsElement(_element))
+			{
+				return 0;
+			}
+			return Read16(_element + 10);
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::GetChild>
+// Get the offset of a child element
+//-----------------------------------------------------------------------------
+		uint32 BinaryCache::GetChild(uint32 const _element, uint16 const _index) const
+		{
+			if (_index >= GetChildCount(_element))
+			{
+				return 0;
+			}
+			uint32 child = Read32(_element + c_elementSize + 8 * (uint32) Read16(_element + 8) + 4 * (uint32) _index);
+			// Children are always written ahead of their parent. Anything else is corruption (and could loop).
+			return (child < _element) ? child : 0;
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::Find>
+// Look up a key in the index
+//-----------------------------------------------------------------------------
+		uint32 BinaryCache::Find(int64 const _key) const
+		{
+			if (!m_index || !m_indexSlots)
+			{
+				return 0;
+			}
+			uint64 key = (uint64) _key;
+			uint32 slot = IndexHash(key) & (m_indexSlots - 1);
+			for (uint32 probes = 0; probes < m_indexSlots; ++probes)
+			{
+				uint32 offset = m_index + slot * c_indexSlotSize;
+				uint64 slotKey = (uint64) Read32(offset) | ((uint64) Read32(offset + 4) << 32);
+				if (slotKey == key)
+				{
+					uint32 element = Read32(offset + 8);
+					return IsElement(element) ? element : 0;
+				}
+				if (slotKey == c_emptySlot)
+				{
+					break;
+				}
+				slot = (slot + 1) & (m_indexSlots - 1);
+			}
+			return 0;
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::Decode>
+// Decode an element into a TinyXML tree
+//-----------------------------------------------------------------------------
+		TiXmlElement* BinaryCache::Decode(uint32 const _element, TiXmlNode* _parent, bool const _attributesOnly) const
+		{
+			return Decode(_element, _parent, _attributesOnly, 0);
+		}
+
+		TiXmlElement* BinaryCache::Decode(uint32 const _element, TiXmlNode* _parent, bool const _attributesOnly, uint32 const _depth) const
+		{
+			char const* name = GetName(_element);
+			if (!name || _depth > c_maxDepth)
+			{
+				Log::Write(LogLevel_Warning, "WARNING: BinaryCache - Corrupt element at offset %d", _element);
+				return NULL;
+			}
+
+			TiXmlElement* element = new TiXmlElement(name);
+			_parent->LinkEndChild(element);
+
+			uint32 text = Read32(_element + 4);
+			if (text != c_noText)
+			{
+				char const* str = GetString(text);
+				if (str)
+				{
+					element->LinkEndChild(new TiXmlText(str));
+				}
+			}
+
+			uint16 count = Read16(_element + 8);
+			uint32 attr = _element + c_elementSize;
+			for (uint16 i = 0; i < count; ++i, attr += 8)
+			{
+				char const* attrName = GetString(Read32(attr));
+				char const* attrValue = GetString(Read32(attr + 4));
+				if (attrName && attrValue)
+				{
+					element->SetAttribute(attrName, attrValue);
+				}
+			}
+
+			if (!_attributesOnly)
+			{
+				uint16 children = Read16(_element + 10);
+				for (uint16 i = 0; i < children; ++i)
+				{
+					if (!Decode(GetChild(_element, i), element, false, _depth + 1))
+					{
+						return NULL;
+					}
+				}
+			}
+			return element;
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::Write>
+// Write an element tree to a binary cache file
+//-----------------------------------------------------------------------------
+		bool BinaryCache::Write(TiXmlElement const* _root, string const& _filename, map<int64, TiXmlElement const*> const* _index)
+		{
+			BinaryCacheWriter writer;
+			return writer.Write(_root, _filename, _index);
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::ConvertToBinary>
+// Convert an XML cache to a binary cache
+//-----------------------------------------------------------------------------
+		bool BinaryCache::ConvertToBinary(string const& _xmlFile, string const& _binaryFile)
+		{
+			TiXmlDocument doc;
+			if (!doc.LoadFile(_xmlFile.c_str(), TIXML_ENCODING_UTF8) || !doc.RootElement())
+			{
+				Log::Write(LogLevel_Warning, "WARNING: BinaryCache - Could not load %s", _xmlFile.c_str());
+				return false;
+			}
+			return Write(doc.RootElement(), _binaryFile);
+		}
+
+//-----------------------------------------------------------------------------
+// <BinaryCache::ConvertToXML>
+// Convert a binary cache back to an XML cache
+//-----------------------------------------------------------------------------
+		bool BinaryCache::ConvertToXML(string const& _binaryFile, string const& _xmlFile)
+		{
+			BinaryCache cache;
+			if (!cache.Open(_binaryFile))
+			{
+				return false;
+			}
+			TiXmlDocument doc;
+			doc.LinkEndChild(new TiXmlDeclaration("1.0", "utf-8", ""));
+			if (!cache.Decode(cache.GetRoot(), &doc))
+			{
+				return false;
+			}
+			return doc.SaveFile(_xmlFile.c_str());
+		}
+	} // namespace Internal
+} // namespace OpenZWave
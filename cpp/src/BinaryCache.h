@@ -0,0 +1,126 @@
+//-----------------------------------------------------------------------------
+//
+//	BinaryCache.h
+//
+//	Memory mapped binary form of the network cache
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _BinaryCache_H
+#define _BinaryCache_H
+
+#include <string>
+#include <map>
+
+#include "Defs.h"
+
+class TiXmlElement;
+class TiXmlNode;
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		/** \brief Reads and writes the network cache in a versioned binary format.
+		 *
+		 *  The file holds the same element tree as ozwcache_0xHOMEID.xml, but already
+		 *  tokenized: every element is a fixed size record with an attribute table and a
+		 *  table of child offsets, and all names and values live in a shared string table.
+		 *  The file is memory mapped and nothing is decoded up front. The Driver reads the
+		 *  root attributes in place and decodes one \<Node\> subtree at a time (every
+		 *  CommandClass and Value element also has its own offset table entry), then hands
+		 *  it to the usual Node::ReadXML.
+		 *
+		 *  Layout (all integers little endian):
+		 *  - Header: "OZWB", format version, file size, string table offset, string count, root element offset,
+		 *    index offset, index slot count
+		 *  - Elements: name index, text index, attribute count (16 bit), child count (16 bit),
+		 *    (name index, value index) per attribute, absolute offset per child
+		 *  - Index (optional): open addressed hash table of (64 bit key, element offset) slots
+		 *  - String table: absolute offset per string, then the NUL terminated strings
+		 */
+		class OPENZWAVE_EXPORT BinaryCache
+		{
+			public:
+				BinaryCache();
+				~BinaryCache();
+
+				/**
+				 * Map a binary cache file.
+				 * \return false if the file is missing, of a different format version, or fails validation.
+				 */
+				bool Open(string const& _filename);
+				void Close();
+
+				/** Offset of the root (\<Driver\>) element */
+				uint32 GetRoot() const
+				{
+					return m_root;
+				}
+				char const* GetName(uint32 const _element) const;
+				char const* GetAttribute(uint32 const _element, char const* _name) const;
+				uint16 GetChildCount(uint32 const _element) const;
+				uint32 GetChild(uint32 const _element, uint16 const _index) const;
+
+				/**
+				 * Look up an element in the index written by Write.
+				 * \return the element offset, or 0 if the key is not in the index
+				 */
+				uint32 Find(int64 const _key) const;
+
+				/**
+				 * Decode an element (and everything below it) into a TinyXML tree.
+				 * \param _element Offset of the element to decode
+				 * \param _parent The decoded element is linked to the end of this node
+				 * \param _attributesOnly Only decode the element's own attributes, not its children
+				 * \return the new element, or NULL if the file is corrupt
+				 */
+				TiXmlElement* Decode(uint32 const _element, TiXmlNode* _parent, bool const _attributesOnly = false) const;
+
+				/**
+				 * Write an element tree to a binary cache file.
+				 * \param _index Optional keys for elements in the tree, so they can be found with Find
+				 */
+				static bool Write(TiXmlElement const* _root, string const& _filename, map<int64, TiXmlElement const*> const* _index = NULL);
+
+				/** Convert an XML cache to a binary cache */
+				static bool ConvertToBinary(string const& _xmlFile, string const& _binaryFile);
+				/** Convert a binary cache back to an XML cache */
+				static bool ConvertToXML(string const& _binaryFile, string const& _xmlFile);
+
+			private:
+				uint32 Read32(uint32 const _offset) const;
+				uint16 Read16(uint32 const _offset) const;
+				bool IsElement(uint32 const _element) const;
+				char const* GetString(uint32 const _index) const;
+				TiXmlElement* Decode(uint32 const _element, TiXmlNode* _parent, bool const _attributesOnly, uint32 const _depth) const;
+
+				uint8 const* m_data;
+				size_t m_size;
+				uint32 m_strings;
+				uint32 m_stringCount;
+				uint32 m_root;
+				uint32 m_index;
+				uint32 m_indexSlots;
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _BinaryCache_H
@@ -0,0 +1,282 @@
+//-----------------------------------------------------------------------------
+//
+//	CacheJournal.cpp
+//
+//	Append-only change journal for the network cache
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+
+#include "CacheJournal.h"
+#include "Driver.h"
+#include "Options.h"
+#include "Utils.h"
+#include "platform/Log.h"
+#include "platform/Mutex.h"
+#include "tinyxml.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		// Delay between reaching the compaction threshold and writing the snapshot, so
+		// a burst of changes (eg: a re-interview) results in a single snapshot write
+		static int32 const c_compactDelay = 5000;
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::CacheJournal>
+// Constructor
+//-----------------------------------------------------------------------------
+		CacheJournal::CacheJournal(Driver* _driver, uint32 const _homeId, string const& _basePath) :
+				Timer(_driver), m_driver(_driver), m_mutex(new Internal::Platform::Mutex()), m_homeId(_homeId), m_journalFile(_basePath + ".journal"), m_oldJournalFile(_basePath + ".journal.old"), m_generation(0), m_records(0), m_compactThreshold(64), m_headerWritten(false), m_compactPending(false)
+		{
+			int32 threshold;
+			if (Options::Get()->GetOptionAsInt("CacheJournalCompact", &threshold) && threshold > 0)
+			{
+				m_compactThreshold = (uint32) threshold;
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::~CacheJournal>
+// Destructor
+//-----------------------------------------------------------------------------
+		CacheJournal::~CacheJournal()
+		{
+			TimerDelEvents();
+			m_mutex->Release();
+		}
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::Load>
+// Load the journal(s) that should be replayed on top of a snapshot
+//-----------------------------------------------------------------------------
+		void CacheJournal::Load(uint32 const _generation, list<TiXmlDocument*>& o_docs)
+		{
+			LockGuard LG(m_mutex);
+			string const* files[2] =
+			{ &m_oldJournalFile, &m_journalFile };
+
+			m_generation = _generation;
+			m_records = 0;
+			m_headerWritten = false;
+			for (int i = 0; i < 2; ++i)
+			{
+				TiXmlDocument* doc = new TiXmlDocument();
+				doc->SetCondenseWhiteSpace(false);
+				if (!doc->LoadFile(files[i]->c_str(), TIXML_ENCODING_UTF8))
+				{
+					if (doc->ErrorId() == TiXmlBase::TIXML_ERROR_OPENING_FILE || doc->ErrorId() == TiXmlBase::TIXML_ERROR_DOCUMENT_EMPTY)
+					{
+						delete doc;
+						continue;
+					}
+					// A crash while appending leaves a truncated last record behind. Everything before it is intact.
+					Log::Write(LogLevel_Warning, "WARNING: CacheJournal - %s is truncated at line %d. Dropping the last record", files[i]->c_str(), doc->ErrorRow());
+					if (doc->LastChild())
+					{
+						doc->RemoveChild(doc->LastChild());
+					}
+				}
+				doc->SetUserData((void *) files[i]->c_str());
+
+				int32 intVal;
+				TiXmlElement const* header = doc->FirstChildElement();
+				if (!header || strcmp(header->Value(), "Journal") || TIXML_SUCCESS != header->QueryIntAttribute("generation", &intVal))
+				{
+					Log::Write(LogLevel_Warning, "WARNING: CacheJournal - %s has no header. Ignoring it", files[i]->c_str());
+					delete doc;
+					continue;
+				}
+				if ((uint32) intVal < _generation)
+				{
+					// Already folded into the snapshot
+					Log::Write(LogLevel_Info, "CacheJournal - %s (generation %d) is older than the cache (generation %d). Ignoring it", files[i]->c_str(), intVal, _generation);
+					delete doc;
+					continue;
+				}
+				for (TiXmlElement const* record = header->NextSiblingElement(); record; record = record->NextSiblingElement())
+				{
+					++m_records;
+				}
+				Log::Write(LogLevel_Info, "CacheJournal - replaying %s (generation %d)", files[i]->c_str(), intVal);
+				if (i == 1)
+				{
+					// Keep appending to the current journal.
+					m_generation = (uint32) intVal;
+					m_headerWritten = true;
+				}
+				o_docs.push_back(doc);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::WriteHeader>
+// Start a new journal file for the current generation
+//-----------------------------------------------------------------------------
+		bool CacheJournal::WriteHeader()
+		{
+			FILE* fp = fopen(m_journalFile.c_str(), "wb");
+			if (!fp)
+			{
+				Log::Write(LogLevel_Warning, "WARNING: CacheJournal - Could not create %s", m_journalFile.c_str());
+				return false;
+			}
+			fprintf(fp, "<Journal generation=\"%u\" />\n", m_generation);
+			fclose(fp);
+			m_headerWritten = true;
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::Append>
+// Append a record to the journal
+//-----------------------------------------------------------------------------
+		bool CacheJournal::Append(TiXmlElement const* _record)
+		{
+			LockGuard LG(m_mutex);
+			if (!m_headerWritten && !WriteHeader())
+			{
+				return false;
+			}
+
+			TiXmlPrinter printer;
+			_record->Accept(&printer);
+
+			FILE* fp = fopen(m_journalFile.c_str(), "ab");
+			if (!fp)
+			{
+				Log::Write(LogLevel_Warning, "WARNING: CacheJournal - Could not open %s", m_journalFile.c_str());
+				return false;
+			}
+			bool ok = (fwrite(printer.CStr(), 1, printer.Size(), fp) == printer.Size());
+			ok = (fflush(fp) == 0) && ok;
+			fclose(fp);
+			if (!ok)
+			{
+				Log::Write(LogLevel_Warning, "WARNING: CacheJournal - Could not append to %s", m_journalFile.c_str());
+				return false;
+			}
+
+			if (++m_records >= m_compactThreshold && !m_compactPending)
+			{
+				Log::Write(LogLevel_Info, "CacheJournal - %d records pending. Scheduling compaction", m_records);
+				m_compactPending = true;
+				TimerSetEvent(c_compactDelay, bind(&CacheJournal::CompactTimer, this, std::placeholders::_1), 1);
+			}
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::Rotate>
+// Move the current journal aside and start a new generation
+//-----------------------------------------------------------------------------
+		uint32 CacheJournal::Rotate()
+		{
+			LockGuard LG(m_mutex);
+			if (m_headerWritten)
+			{
+				FILE* old = fopen(m_oldJournalFile.c_str(), "rb");
+				if (!old)
+				{
+					rename(m_journalFile.c_str(), m_oldJournalFile.c_str());
+				}
+				else
+				{
+					// A previous snapshot write never committed, so the old journal still holds records
+					// the snapshot on disk doesn't have. Carry the current records over rather than lose them.
+					fclose(old);
+					FILE* in = fopen(m_journalFile.c_str(), "rb");
+					FILE* out = fopen(m_oldJournalFile.c_str(), "ab");
+					if (in && out)
+					{
+						char buf[4096];
+						size_t len;
+						int c;
+						// Skip the <Journal> header line
+						while ((c = fgetc(in)) != EOF && c != '\n')
+						{
+						}
+						while ((len = fread(buf, 1, sizeof(buf), in)) > 0)
+						{
+							fwrite(buf, 1, len, out);
+						}
+					}
+					if (in)
+					{
+						fclose(in);
+					}
+					if (out)
+					{
+						fclose(out);
+					}
+				}
+			}
+			++m_generation;
+			m_records = 0;
+			m_headerWritten = false;
+			WriteHeader();
+			return m_generation;
+		}
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::Commit>
+// The snapshot is on disk, so the rotated journal is no longer needed
+//-----------------------------------------------------------------------------
+		void CacheJournal::Commit()
+		{
+			LockGuard LG(m_mutex);
+			remove(m_oldJournalFile.c_str());
+		}
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::Purge>
+// Remove all journal files
+//-----------------------------------------------------------------------------
+		void CacheJournal::Purge()
+		{
+			LockGuard LG(m_mutex);
+			remove(m_oldJournalFile.c_str());
+			remove(m_journalFile.c_str());
+			m_records = 0;
+			m_headerWritten = false;
+		}
+
+//-----------------------------------------------------------------------------
+// <CacheJournal::CompactTimer>
+// Fold the journal into a new snapshot
+//-----------------------------------------------------------------------------
+		void CacheJournal::CompactTimer(uint32 _id)
+		{
+			{
+				LockGuard LG(m_mutex);
+				m_compactPending = false;
+			}
+			if (!m_driver->CompactCache())
+			{
+				// The node list is busy. Try again shortly.
+				LockGuard LG(m_mutex);
+				m_compactPending = true;
+				TimerSetEvent(c_compactDelay, bind(&CacheJournal::CompactTimer, this, std::placeholders::_1), 1);
+			}
+		}
+	} // namespace Internal
+} // namespace OpenZWave
@@ -0,0 +1,127 @@
+//-----------------------------------------------------------------------------
+//
+//	CacheJournal.h
+//
+//	Append-only change journal for the network cache
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _CacheJournal_H
+#define _CacheJournal_H
+
+#include <string>
+#include <list>
+
+#include "Defs.h"
+#include "TimerThread.h"
+
+class TiXmlDocument;
+class TiXmlElement;
+
+namespace OpenZWave
+{
+	class Driver;
+	namespace Internal
+	{
+		namespace Platform
+		{
+			class Mutex;
+		}
+
+		/** \brief Append-only journal of changes made to the network cache since
+		 *  the last snapshot (ozwcache_0xHOMEID.xml) was written.
+		 *
+		 *  Each record is a complete XML element (a \<Node\> element as written by
+		 *  Node::WriteXML, or a \<NodeRemoved id="x"/\> marker) appended to
+		 *  ozwcache_0xHOMEID.journal.  The journal starts with a \<Journal generation="n"/\>
+		 *  header that ties it to the snapshot carrying the same journal_generation.
+		 *  When a snapshot is written, the journal is rotated to .journal.old first, and
+		 *  the old file is only deleted once the snapshot is safely on disk, so a crash
+		 *  at any point leaves a snapshot plus the journals that still apply to it.
+		 *
+		 *  Once the number of records reaches the "CacheJournalCompact" option, a
+		 *  compaction (a full snapshot write) is scheduled on the timer thread.
+		 */
+		class CacheJournal: public Timer
+		{
+			public:
+				CacheJournal(Driver* _driver, uint32 const _homeId, string const& _basePath);
+				~CacheJournal();
+
+				uint32 GetHomeId() const
+				{
+					return m_homeId;
+				}
+				uint32 GetGeneration() const
+				{
+					return m_generation;
+				}
+
+				/**
+				 * Load the journals that apply on top of a snapshot.
+				 * \param _generation The journal_generation stored in the snapshot.
+				 * \param o_docs Receives the journal documents to replay, oldest first.  The caller owns them.
+				 */
+				void Load(uint32 const _generation, list<TiXmlDocument*>& o_docs);
+
+				/**
+				 * Append a single record to the journal.
+				 * \param _record The element to append.  The element is not modified or freed.
+				 * \return false if the record could not be written (the caller should fall back to a full snapshot)
+				 */
+				bool Append(TiXmlElement const* _record);
+
+				/**
+				 * Start a new journal generation ahead of writing a snapshot.  Must be called
+				 * while the node list is locked, so no change can slip between the snapshot and the new journal.
+				 * \return the generation to store in the snapshot.
+				 */
+				uint32 Rotate();
+
+				/**
+				 * Called once the snapshot for the current generation has been written.
+				 * Removes the journal that was rotated out by Rotate().
+				 */
+				void Commit();
+
+				/**
+				 * Remove all journal files (used when journaling is disabled).
+				 */
+				void Purge();
+
+			private:
+				bool WriteHeader();
+				void CompactTimer(uint32 _id);
+
+				Driver* m_driver;
+				Internal::Platform::Mutex* m_mutex;
+				uint32 m_homeId;
+				string m_journalFile;
+				string m_oldJournalFile;
+				uint32 m_generation;
+				uint32 m_records;
+				uint32 m_compactThreshold;
+				bool m_headerWritten;
+				bool m_compactPending;
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _CacheJournal_H
@@ -25,6 +25,8 @@
 //
 //-----------------------------------------------------------------------------
 
+#include <algorithm>
+
 #include "command_classes/CommandClass.h"
 #include "CompatOptionManager.h"
 #include "platform/Log.h"
@@ -85,8 +87,32 @@ namespace OpenZWave
 
 		uint16_t availableDiscoveryFlagsCount = sizeof(availableDiscoveryFlags) / sizeof(availableDiscoveryFlags[0]);
 
+		bool CompatOptionFlagStorage::GetIndexed(uint32_t index, uint32_t* o_value) const
+		{
+			std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = std::lower_bound(valArray.begin(), valArray.end(), std::make_pair(index, (uint32_t) 0));
+			if ((it == valArray.end()) || (it->first != index))
+			{
+				return false;
+			}
+			*o_value = it->second;
+			return true;
+		}
+
+		void CompatOptionFlagStorage::SetIndexed(uint32_t index, uint32_t value)
+		{
+			std::vector<std::pair<uint32_t, uint32_t> >::iterator it = std::lower_bound(valArray.begin(), valArray.end(), std::make_pair(index, (uint32_t) 0));
+			if ((it != valArray.end()) && (it->first == index))
+			{
+				it->second = value;
+			}
+			else
+			{
+				valArray.insert(it, std::make_pair(index, value));
+			}
+		}
+
 		CompatOptionManager::CompatOptionManager(CompatOptionType type, Internal::CC::CommandClass *owner) :
-				m_owner(owner), m_comtype(type)
+				m_enabledFlags(0), m_owner(owner), m_comtype(type)
 		{
 			switch (m_comtype)
 			{
@@ -112,8 +138,16 @@ namespace OpenZWave
 				if (m_availableFlags[i].flag == flag)
 				{
 					m_enabledCompatFlags[m_availableFlags[i].name] = flag;
-					m_CompatVals[flag].type = m_availableFlags[i].type;
-					m_CompatVals[flag].changed = false;
+					if (!(m_enabledFlags & ((uint64_t) 1 << flag)))
+					{
+						m_enabledFlags |= ((uint64_t) 1 << flag);
+						m_slots[flag] = (uint8_t) m_CompatVals.size();
+						m_CompatVals.push_back(CompatOptionFlagStorage());
+						m_CompatVals.back().flag = flag;
+					}
+					CompatOptionFlagStorage& storage = m_CompatVals[m_slots[flag]];
+					storage.type = m_availableFlags[i].type;
+					storage.changed = false;
 					switch (m_availableFlags[i].type)
 					{
 						case COMPAT_FLAG_TYPE_BOOL:
@@ -123,7 +157,7 @@ namespace OpenZWave
 								Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "EnableFlag: Default Value for %s is not a Bool", m_availableFlags[i].name.c_str());
 								defaultval = 0;
 							}
-							m_CompatVals[flag].valBool = (defaultval == 0 ? false : true);
+							storage.valBool = (defaultval == 0 ? false : true);
 							break;
 						case COMPAT_FLAG_TYPE_BYTE:
 						case COMPAT_FLAG_TYPE_BYTE_ARRAY:
@@ -132,7 +166,7 @@ namespace OpenZWave
 								Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "EnableFlag: Default Value for %s is larger than a byte", m_availableFlags[i].name.c_str());
 								defaultval = 0;
 							}
-							m_CompatVals[flag].valByte = defaultval;
+							storage.valByte = defaultval;
 							break;
 						case COMPAT_FLAG_TYPE_SHORT:
 						case COMPAT_FLAG_TYPE_SHORT_ARRAY:
@@ -141,7 +175,7 @@ namespace OpenZWave
 								Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "EnableFlag: Default Value for %s is larger than a short", m_availableFlags[i].name.c_str());
 								defaultval = 0;
 							}
-							m_CompatVals[flag].valShort = defaultval;
+							storage.valShort = defaultval;
 							break;
 						case COMPAT_FLAG_TYPE_INT:
 						case COMPAT_FLAG_TYPE_INT_ARRAY:
@@ -150,7 +184,7 @@ namespace OpenZWave
 								Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "EnableFlag: Default Value for %s is larger than a int", m_availableFlags[i].name.c_str());
 								defaultval = 0;
 							}
-							m_CompatVals[flag].valInt = defaultval;
+							storage.valInt = defaultval;
 							break;
 					}
 				}
@@ -170,26 +204,27 @@ namespace OpenZWave
 					TiXmlElement const *valElement = compatElement->FirstChildElement(it->first.c_str());
 					if (valElement)
 					{
+						CompatOptionFlagStorage& storage = m_CompatVals[m_slots[it->second]];
 						value = valElement->GetText();
 						char* pStopChar;
 						uint32_t val = strtol(value.c_str(), &pStopChar, 10);
-						switch (m_CompatVals[it->second].type)
+						switch (storage.type)
 						{
 							case COMPAT_FLAG_TYPE_BOOL:
-								if (m_CompatVals[it->second].valBool != !strcmp(value.c_str(), "true"))
+								if (storage.valBool != !strcmp(value.c_str(), "true"))
 								{
-									m_CompatVals[it->second].valBool = !strcmp(value.c_str(), "true");
-									m_CompatVals[it->second].changed = true;
+									storage.valBool = !strcmp(value.c_str(), "true");
+									storage.changed = true;
 								}
 								break;
 							case COMPAT_FLAG_TYPE_BOOL_ARRAY:
 								{
-									if (m_CompatVals[it->second].valBool != !strcmp(value.c_str(), "true"))
+									if (storage.valBool != !strcmp(value.c_str(), "true"))
 									{
 										string indexVal = valElement->Attribute("index");
 										uint32 index = strtol(indexVal.c_str(), &pStopChar, 10);
-										m_CompatVals[it->second].valBoolArray.insert(std::pair<uint32, bool>(index, !strcmp(value.c_str(), "true")));
-										m_CompatVals[it->second].changed = true;
+										storage.SetIndexed(index, !strcmp(value.c_str(), "true"));
+										storage.changed = true;
 									}
 									break;
 								}
@@ -199,10 +234,10 @@ namespace OpenZWave
 									Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "ReadXML: (%s) - Value for %s is larger than a byte", m_owner->GetCommandClassName().c_str(), it->first.c_str());
 									val = 0;
 								}
-								if (m_CompatVals[it->second].valByte != val)
+								if (storage.valByte != val)
 								{
-									m_CompatVals[it->second].valByte = val;
-									m_CompatVals[it->second].changed = true;
+									storage.valByte = val;
+									storage.changed = true;
 								}
 								break;
 							case COMPAT_FLAG_TYPE_BYTE_ARRAY:
@@ -211,12 +246,12 @@ namespace OpenZWave
 									Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "ReadXML: (%s) - Value for %s is larger than a byte", m_owner->GetCommandClassName().c_str(), it->first.c_str());
 									val = 0;
 								}
-								if (m_CompatVals[it->second].valByte != val)
+								if (storage.valByte != val)
 								{
 									string indexVal = valElement->Attribute("index");
 									uint32 index = strtol(indexVal.c_str(), &pStopChar, 10);
-									m_CompatVals[it->second].valByteArray.insert(std::pair<uint32_t, uint8_t>(index, val));
-									m_CompatVals[it->second].changed = true;
+									storage.SetIndexed(index, val);
+									storage.changed = true;
 								}
 								break;
 
@@ -226,10 +261,10 @@ namespace OpenZWave
 									Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "ReadXML: (%s) - Value for %s is larger than a short", m_owner->GetCommandClassName().c_str(), it->first.c_str());
 									val = 0;
 								}
-								if (m_CompatVals[it->second].valShort != val)
+								if (storage.valShort != val)
 								{
-									m_CompatVals[it->second].valShort = val;
-									m_CompatVals[it->second].changed = true;
+									storage.valShort = val;
+									storage.changed = true;
 								}
 								break;
 							case COMPAT_FLAG_TYPE_SHORT_ARRAY:
@@ -238,12 +273,12 @@ namespace OpenZWave
 									Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "ReadXML: (%s) - Value for %s is larger than a short", m_owner->GetCommandClassName().c_str(), it->first.c_str());
 									val = 0;
 								}
-								if (m_CompatVals[it->second].valShort != val)
+								if (storage.valShort != val)
 								{
 									string indexVal = valElement->Attribute("index");
 									uint32 index = strtol(indexVal.c_str(), &pStopChar, 10);
-									m_CompatVals[it->second].valShortArray.insert(std::pair<uint32_t, uint16_t>(index, val));
-									m_CompatVals[it->second].changed = true;
+									storage.SetIndexed(index, val);
+									storage.changed = true;
 								}
 								break;
 							case COMPAT_FLAG_TYPE_INT:
@@ -252,10 +287,10 @@ namespace OpenZWave
 									Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "ReadXML: (%s) - Value for %s is larger than a int", m_owner->GetCommandClassName().c_str(), it->first.c_str());
 									val = 0;
 								}
-								if (m_CompatVals[it->second].valInt != val)
+								if (storage.valInt != val)
 								{
-									m_CompatVals[it->second].valInt = val;
-									m_CompatVals[it->second].changed = true;
+									storage.valInt = val;
+									storage.changed = true;
 								}
 								break;
 							case COMPAT_FLAG_TYPE_INT_ARRAY:
@@ -264,12 +299,12 @@ namespace OpenZWave
 									Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "ReadXML: (%s) - Value for %s is larger than a int", m_owner->GetCommandClassName().c_str(), it->first.c_str());
 									val = 0;
 								}
-								if (m_CompatVals[it->second].valInt != val)
+								if (storage.valInt != val)
 								{
 									string indexVal = valElement->Attribute("index");
 									uint32 index = strtol(indexVal.c_str(), &pStopChar, 10);
-									m_CompatVals[it->second].valIntArray.insert(std::pair<uint32_t, uint32_t>(index, val));
-									m_CompatVals[it->second].changed = true;
+									storage.SetIndexed(index, val);
+									storage.changed = true;
 								}
 								break;
 
@@ -282,40 +317,41 @@ namespace OpenZWave
 				Log::Write(LogLevel_Info, m_owner->GetNodeId(), "(%d - %s) - %s Flags:", m_owner->GetCommandClassId(), m_owner->GetCommandClassName().c_str(), GetXMLTagName().c_str());
 				for (it = m_enabledCompatFlags.begin(); it != m_enabledCompatFlags.end(); it++)
 				{
-					if (m_CompatVals[it->second].changed)
+					CompatOptionFlagStorage const& storage = m_CompatVals[m_slots[it->second]];
+					if (storage.changed)
 					{
-						switch (m_CompatVals[it->second].type)
+						switch (storage.type)
 						{
 							case COMPAT_FLAG_TYPE_BOOL:
-								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s: %s", it->first.c_str(), m_CompatVals[it->second].valBool ? "true" : "false");
+								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s: %s", it->first.c_str(), storage.valBool ? "true" : "false");
 								break;
 							case COMPAT_FLAG_TYPE_BOOL_ARRAY:
-								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s (Default): %s", it->first.c_str(), m_CompatVals[it->second].valBool ? "true" : "false");
-								for (std::map<uint32_t, bool>::iterator it2 = m_CompatVals[it->second].valBoolArray.begin(); it2 != m_CompatVals[it->second].valBoolArray.end(); it2++)
+								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s (Default): %s", it->first.c_str(), storage.valBool ? "true" : "false");
+								for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it2 = storage.valArray.begin(); it2 != storage.valArray.end(); it2++)
 									Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t\t %s - %d: %s", it->first.c_str(), it2->first, it2->second ? "true" : "false");
 								break;
 							case COMPAT_FLAG_TYPE_BYTE:
-								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s: %d", it->first.c_str(), m_CompatVals[it->second].valByte);
+								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s: %d", it->first.c_str(), storage.valByte);
 								break;
 							case COMPAT_FLAG_TYPE_BYTE_ARRAY:
-								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s (Default): %d", it->first.c_str(), m_CompatVals[it->second].valByte);
-								for (std::map<uint32_t, uint8_t>::iterator it2 = m_CompatVals[it->second].valByteArray.begin(); it2 != m_CompatVals[it->second].valByteArray.end(); it2++)
+								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s (Default): %d", it->first.c_str(), storage.valByte);
+								for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it2 = storage.valArray.begin(); it2 != storage.valArray.end(); it2++)
 									Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t\t %s - %d: %d", it->first.c_str(), it2->first, it2->second );
 								break;
 							case COMPAT_FLAG_TYPE_SHORT:
-								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s: %d", it->first.c_str(), m_CompatVals[it->second].valShort);
+								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s: %d", it->first.c_str(), storage.valShort);
 								break;
 							case COMPAT_FLAG_TYPE_SHORT_ARRAY:
-								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s (Default): %d", it->first.c_str(), m_CompatVals[it->second].valShort);
-								for (std::map<uint32_t, uint16_t>::iterator it2 = m_CompatVals[it->second].valShortArray.begin(); it2 != m_CompatVals[it->second].valShortArray.end(); it2++)
+								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s (Default): %d", it->first.c_str(), storage.valShort);
+								for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it2 = storage.valArray.begin(); it2 != storage.valArray.end(); it2++)
 									Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t\t %s - %d: %d", it->first.c_str(), it2->first, it2->second );
 								break;
 							case COMPAT_FLAG_TYPE_INT:
-								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s: %d", it->first.c_str(), m_CompatVals[it->second].valInt);
+								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s: %d", it->first.c_str(), storage.valInt);
 								break;
 							case COMPAT_FLAG_TYPE_INT_ARRAY:
-								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s (Default): %d", it->first.c_str(), m_CompatVals[it->second].valShort);
-								for (std::map<uint32_t, uint32_t>::iterator it2 = m_CompatVals[it->second].valIntArray.begin(); it2 != m_CompatVals[it->second].valIntArray.end(); it2++)
+								Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t %s (Default): %d", it->first.c_str(), storage.valInt);
+								for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it2 = storage.valArray.begin(); it2 != storage.valArray.end(); it2++)
 									Log::Write(LogLevel_Info, m_owner->GetNodeId(), "\t\t %s - %d: %d", it->first.c_str(), it2->first, it2->second );
 								break;
 
@@ -334,26 +370,27 @@ namespace OpenZWave
 			string value;
 			for (it = m_enabledCompatFlags.begin(); it != m_enabledCompatFlags.end(); it++)
 			{
-				if (m_CompatVals[it->second].changed == false)
+				CompatOptionFlagStorage const& storage = m_CompatVals[m_slots[it->second]];
+				if (storage.changed == false)
 				{
 					/* skip writing out default values */
 					continue;
 				}
 				char str[32];
-				switch (m_CompatVals[it->second].type)
+				switch (storage.type)
 				{
 					case COMPAT_FLAG_TYPE_BOOL:
 					{
 						TiXmlElement* valElement = new TiXmlElement(it->first.c_str());
-						TiXmlText *text = new TiXmlText(m_CompatVals[it->second].valBool == true ? "true" : "false");
+						TiXmlText *text = new TiXmlText(storage.valBool == true ? "true" : "false");
 						valElement->LinkEndChild(text);
 						compatElement->LinkEndChild(valElement);
 						break;
 					}
 					case COMPAT_FLAG_TYPE_BOOL_ARRAY:
 					{
-						for (std::map<uint32_t, bool>::iterator it2 = m_CompatVals[it->second].valBoolArray.begin(); it2 != m_CompatVals[it->second].valBoolArray.end(); it2++) {
-							if (it2->second != m_CompatVals[it->second].valBool) {
+						for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it2 = storage.valArray.begin(); it2 != storage.valArray.end(); it2++) {
+							if (it2->second != storage.valBool) {
 								TiXmlElement* valElement = new TiXmlElement(it->first.c_str());
 								valElement->SetAttribute("index", it2->first);
 								TiXmlText *text = new TiXmlText(it2->second == true ? "true" : "false");
@@ -365,7 +402,7 @@ namespace OpenZWave
 					}
 					case COMPAT_FLAG_TYPE_BYTE:
 					{
-						snprintf(str, sizeof(str), "%d", m_CompatVals[it->second].valByte);
+						snprintf(str, sizeof(str), "%d", storage.valByte);
 						TiXmlElement* valElement = new TiXmlElement(it->first.c_str());
 						TiXmlText *text = new TiXmlText(str);
 						valElement->LinkEndChild(text);
@@ -374,8 +411,8 @@ namespace OpenZWave
 					}
 					case COMPAT_FLAG_TYPE_BYTE_ARRAY:
 					{
-						for (std::map<uint32_t, uint8_t>::iterator it2 = m_CompatVals[it->second].valByteArray.begin(); it2 != m_CompatVals[it->second].valByteArray.end(); it2++) {
-							if (it2->second != m_CompatVals[it->second].valByte) {
+						for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it2 = storage.valArray.begin(); it2 != storage.valArray.end(); it2++) {
+							if (it2->second != storage.valByte) {
 								snprintf(str, sizeof(str), "%d", it2->second);
 								TiXmlElement* valElement = new TiXmlElement(it->first.c_str());
 								valElement->SetAttribute("index", it2->first);
@@ -388,7 +425,7 @@ namespace OpenZWave
 					}
 					case COMPAT_FLAG_TYPE_SHORT:
 					{
-						snprintf(str, sizeof(str), "%d", m_CompatVals[it->second].valShort);
+						snprintf(str, sizeof(str), "%d", storage.valShort);
 						TiXmlElement* valElement = new TiXmlElement(it->first.c_str());
 						TiXmlText *text = new TiXmlText(str);
 						valElement->LinkEndChild(text);
@@ -397,8 +434,8 @@ namespace OpenZWave
 					}
 					case COMPAT_FLAG_TYPE_SHORT_ARRAY:
 					{
-						for (std::map<uint32_t, uint16_t>::iterator it2 = m_CompatVals[it->second].valShortArray.begin(); it2 != m_CompatVals[it->second].valShortArray.end(); it2++) {
-							if (it2->second != m_CompatVals[it->second].valShort) {
+						for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it2 = storage.valArray.begin(); it2 != storage.valArray.end(); it2++) {
+							if (it2->second != storage.valShort) {
 								snprintf(str, sizeof(str), "%d", it2->second);
 								TiXmlElement* valElement = new TiXmlElement(it->first.c_str());
 								valElement->SetAttribute("index", it2->first);
@@ -411,7 +448,7 @@ namespace OpenZWave
 					}
 					case COMPAT_FLAG_TYPE_INT:
 					{
-						snprintf(str, sizeof(str), "%d", m_CompatVals[it->second].valInt);
+						snprintf(str, sizeof(str), "%d", storage.valInt);
 						TiXmlElement* valElement = new TiXmlElement(it->first.c_str());
 						TiXmlText *text = new TiXmlText(str);
 						valElement->LinkEndChild(text);
@@ -420,8 +457,8 @@ namespace OpenZWave
 					}
 					case COMPAT_FLAG_TYPE_INT_ARRAY:
 					{
-						for (std::map<uint32_t, uint32_t>::iterator it2 = m_CompatVals[it->second].valIntArray.begin(); it2 != m_CompatVals[it->second].valIntArray.end(); it2++) {
-							if (it2->second != m_CompatVals[it->second].valInt) {
+						for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it2 = storage.valArray.begin(); it2 != storage.valArray.end(); it2++) {
+							if (it2->second != storage.valInt) {
 								snprintf(str, sizeof(str), "%d", it2->second);
 								TiXmlElement* valElement = new TiXmlElement(it->first.c_str());
 								valElement->SetAttribute("index", it2->first);
@@ -437,144 +474,141 @@ namespace OpenZWave
 			_ccElement->LinkEndChild(compatElement);
 		}
 
-		bool CompatOptionManager::GetFlagBool(CompatOptionFlags const flag, uint32_t index) const
+		bool CompatOptionManager::GetFlagBool(CompatOptionFlags flag, uint32_t index) const
 		{
-			if (m_CompatVals.count(flag) == 0)
+			CompatOptionFlagStorage const* storage = Find(flag);
+			if (storage == NULL)
 			{
 				Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagBool: (%s) - Flag %s Not Enabled!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 				return false;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_BOOL)
+			if (storage->type == COMPAT_FLAG_TYPE_BOOL)
 			{
-				return m_CompatVals.at(flag).valBool;
+				return storage->valBool;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_BOOL_ARRAY)
+			if (storage->type == COMPAT_FLAG_TYPE_BOOL_ARRAY)
 			{
 				if (index == (uint32_t)-1) {
 					Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagBool: (%s) - Flag %s had Invalid Index", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
-					return m_CompatVals.at(flag).valBool;
+					return storage->valBool;
 				}
-				if (m_CompatVals.at(flag).valBoolArray.count(index))
-					return m_CompatVals.at(flag).valBoolArray.at(index);
+				uint32_t value;
+				if (storage->GetIndexed(index, &value))
+					return value != 0;
 				/* Return our Default */
-				return m_CompatVals.at(flag).valBool;
+				return storage->valBool;
 			}
 			Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagBool: (%s) - Flag %s Not a Boolean Value!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 			return false;
-
 		}
 
 		uint8_t CompatOptionManager::GetFlagByte(CompatOptionFlags flag, uint32_t index) const
 		{
-			if (m_CompatVals.count(flag) == 0)
+			CompatOptionFlagStorage const* storage = Find(flag);
+			if (storage == NULL)
 			{
 				Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagByte: (%s) - Flag %s Not Enabled!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 				return 0;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_BYTE)
+			if (storage->type == COMPAT_FLAG_TYPE_BYTE)
 			{
-				return m_CompatVals.at(flag).valByte;
+				return storage->valByte;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_BYTE_ARRAY)
+			if (storage->type == COMPAT_FLAG_TYPE_BYTE_ARRAY)
 			{
 				if (index == (uint32_t)-1) {
 					Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagByte: (%s) - Flag %s had Invalid Index", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
-					return m_CompatVals.at(flag).valByte;
+					return storage->valByte;
 				}
-				if (m_CompatVals.at(flag).valByteArray.count(index))
-					return m_CompatVals.at(flag).valByteArray.at(index);
+				uint32_t value;
+				if (storage->GetIndexed(index, &value))
+					return (uint8_t) value;
 				/* Return our Default */
-				return m_CompatVals.at(flag).valByte;
-
+				return storage->valByte;
 			}
 			Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagByte: (%s) - Flag %s Not a Byte Value!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 			return 0;
-
 		}
 
 		uint16_t CompatOptionManager::GetFlagShort(CompatOptionFlags flag, uint32_t index) const
 		{
-			if (m_CompatVals.count(flag) == 0)
+			CompatOptionFlagStorage const* storage = Find(flag);
+			if (storage == NULL)
 			{
 				Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagShort: (%s) - Flag %s Not Enabled!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 				return 0;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_SHORT)
+			if (storage->type == COMPAT_FLAG_TYPE_SHORT)
 			{
-				return m_CompatVals.at(flag).valShort;
+				return storage->valShort;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_SHORT_ARRAY)
+			if (storage->type == COMPAT_FLAG_TYPE_SHORT_ARRAY)
 			{
 				if (index == (uint32_t)-1) {
 					Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagShort: (%s) - Flag %s had Invalid Index", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
-					return m_CompatVals.at(flag).valShort;
+					return storage->valShort;
 				}
-				if (m_CompatVals.at(flag).valShortArray.count(index))
-					return m_CompatVals.at(flag).valShortArray.at(index);
+				uint32_t value;
+				if (storage->GetIndexed(index, &value))
+					return (uint16_t) value;
 				/* Return our Default */
-				return m_CompatVals.at(flag).valShort;
+				return storage->valShort;
 			}
-
 			Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagShort: (%s) - Flag %s Not a Short Value!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 			return 0;
-
 		}
 
 		uint32_t CompatOptionManager::GetFlagInt(CompatOptionFlags flag, uint32_t index) const
 		{
-			if (m_CompatVals.count(flag) == 0)
+			CompatOptionFlagStorage const* storage = Find(flag);
+			if (storage == NULL)
 			{
 				Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagInt: (%s) - Flag %s Not Enabled!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 				return 0;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_INT)
+			if (storage->type == COMPAT_FLAG_TYPE_INT)
 			{
-				return m_CompatVals.at(flag).valInt;
+				return storage->valInt;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_INT_ARRAY)
+			if (storage->type == COMPAT_FLAG_TYPE_INT_ARRAY)
 			{
 				if (index == (uint32_t)-1) {
 					Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagInt: (%s) - Flag %s had Invalid Index", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
-					return m_CompatVals.at(flag).valInt;
+					return storage->valInt;
 				}
-				if (m_CompatVals.at(flag).valIntArray.count(index))
-					return m_CompatVals.at(flag).valIntArray.at(index);
+				uint32_t value;
+				if (storage->GetIndexed(index, &value))
+					return (uint32_t) value;
 				/* Return our Default */
-				return m_CompatVals.at(flag).valInt;
+				return storage->valInt;
 			}
-
 			Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "GetFlagInt: (%s) - Flag %s Not a Int Value!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 			return 0;
-
 		}
 
 		bool CompatOptionManager::SetFlagBool(CompatOptionFlags flag, bool value, uint32_t index)
 		{
-			if (m_CompatVals.count(flag) == 0)
+			CompatOptionFlagStorage* storage = Find(flag);
+			if (storage == NULL)
 			{
 				Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagBool: (%s) - Flag %s Not Enabled!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 				return false;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_BOOL)
+			if (storage->type == COMPAT_FLAG_TYPE_BOOL)
 			{
-				m_CompatVals.at(flag).valBool = value;
-				m_CompatVals.at(flag).changed = true;
+				storage->valBool = value;
+				storage->changed = true;
 				return true;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_BOOL_ARRAY)
+			if (storage->type == COMPAT_FLAG_TYPE_BOOL_ARRAY)
 			{
 				if (index == (uint32_t)-1) {
 					Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagBool: (%s) - Flag %s had Invalid Index", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 					return false;
 				}
-				m_CompatVals.at(flag).changed = true;
-				if (m_CompatVals.at(flag).valBoolArray.count(index)) {
-					m_CompatVals.at(flag).valBoolArray.at(index) = value;
-					return true;
-				} else {
-					m_CompatVals.at(flag).valBoolArray.insert(std::pair<uint32_t, bool>(index, value));
-					return true;
-				}
+				storage->changed = true;
+				storage->SetIndexed(index, value);
+				return true;
 			}
 			Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagBool: (%s) - Flag %s Not a Bool Value!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 			return false;
@@ -582,31 +616,27 @@ namespace OpenZWave
 
 		bool CompatOptionManager::SetFlagByte(CompatOptionFlags flag, uint8_t value, uint32_t index)
 		{
-			if (m_CompatVals.count(flag) == 0)
+			CompatOptionFlagStorage* storage = Find(flag);
+			if (storage == NULL)
 			{
 				Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagByte: (%s) - Flag %s Not Enabled!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 				return false;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_BYTE)
+			if (storage->type == COMPAT_FLAG_TYPE_BYTE)
 			{
-				m_CompatVals.at(flag).valByte = value;
-				m_CompatVals.at(flag).changed = true;
+				storage->valByte = value;
+				storage->changed = true;
 				return true;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_BYTE_ARRAY)
+			if (storage->type == COMPAT_FLAG_TYPE_BYTE_ARRAY)
 			{
 				if (index == (uint32_t)-1) {
 					Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagByte: (%s) - Flag %s had Invalid Index", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 					return false;
 				}
-				m_CompatVals.at(flag).changed = true;
-				if (m_CompatVals.at(flag).valByteArray.count(index)) {
-					m_CompatVals.at(flag).valByteArray.at(index) = value;
-					return true;
-				} else {
-					m_CompatVals.at(flag).valByteArray.insert(std::pair<uint32_t, uint8_t>(index, value));
-					return true;
-				}
+				storage->changed = true;
+				storage->SetIndexed(index, value);
+				return true;
 			}
 			Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagByte: (%s) - Flag %s Not a Byte Value!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 			return false;
@@ -614,31 +644,27 @@ namespace OpenZWave
 
 		bool CompatOptionManager::SetFlagShort(CompatOptionFlags flag, uint16_t value, uint32_t index)
 		{
-			if (m_CompatVals.count(flag) == 0)
+			CompatOptionFlagStorage* storage = Find(flag);
+			if (storage == NULL)
 			{
 				Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagShort: (%s) - Flag %s Not Enabled!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 				return false;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_SHORT)
+			if (storage->type == COMPAT_FLAG_TYPE_SHORT)
 			{
-				m_CompatVals.at(flag).valShort = value;
-				m_CompatVals.at(flag).changed = true;
+				storage->valShort = value;
+				storage->changed = true;
 				return true;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_SHORT_ARRAY)
+			if (storage->type == COMPAT_FLAG_TYPE_SHORT_ARRAY)
 			{
 				if (index == (uint32_t)-1) {
 					Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagShort: (%s) - Flag %s had Invalid Index", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 					return false;
 				}
-				m_CompatVals.at(flag).changed = true;
-				if (m_CompatVals.at(flag).valShortArray.count(index)) {
-					m_CompatVals.at(flag).valShortArray.at(index) = value;
-					return true;
-				} else {
-					m_CompatVals.at(flag).valShortArray.insert(std::pair<uint32_t, uint16_t>(index, value));
-					return true;
-				}
+				storage->changed = true;
+				storage->SetIndexed(index, value);
+				return true;
 			}
 			Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagShort: (%s) - Flag %s Not a Short Value!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 			return false;
@@ -646,31 +672,27 @@ namespace OpenZWave
 
 		bool CompatOptionManager::SetFlagInt(CompatOptionFlags flag, uint32_t value, uint32_t index)
 		{
-			if (m_CompatVals.count(flag) == 0)
+			CompatOptionFlagStorage* storage = Find(flag);
+			if (storage == NULL)
 			{
 				Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagInt: (%s) - Flag %s Not Enabled!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 				return false;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_INT)
+			if (storage->type == COMPAT_FLAG_TYPE_INT)
 			{
-				m_CompatVals.at(flag).valInt = value;
-				m_CompatVals.at(flag).changed = true;
+				storage->valInt = value;
+				storage->changed = true;
 				return true;
 			}
-			if (m_CompatVals.at(flag).type == COMPAT_FLAG_TYPE_INT_ARRAY)
+			if (storage->type == COMPAT_FLAG_TYPE_INT_ARRAY)
 			{
 				if (index == (uint32_t)-1) {
 					Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagInt: (%s) - Flag %s had Invalid Index", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 					return false;
 				}
-				m_CompatVals.at(flag).changed = true;
-				if (m_CompatVals.at(flag).valIntArray.count(index)) {
-					m_CompatVals.at(flag).valIntArray.at(index) = value;
-					return true;
-				} else {
-					m_CompatVals.at(flag).valIntArray.insert(std::pair<uint32_t, uint32_t>(index, value));
-					return true;
-				}
+				storage->changed = true;
+				storage->SetIndexed(index, value);
+				return true;
 			}
 			Log::Write(LogLevel_Warning, m_owner->GetNodeId(), "SetFlagInt: (%s) - Flag %s Not a Int Value!", m_owner->GetCommandClassName().c_str(), GetFlagName(flag).c_str());
 			return false;
@@ -32,6 +32,7 @@
 #include "tinyxml.h"
 
 #include <map>
+#include <vector>
 
 namespace OpenZWave
 {
@@ -85,6 +86,7 @@ namespace OpenZWave
 			STATE_FLAG_DOORLOCK_TIMEOUTSECS,
 			STATE_FLAG_DOORLOCKLOG_MAXRECORDS,
 			STATE_FLAG_USERCODE_COUNT,
+			COMPAT_FLAG_COUNT		// The number of flags.  Keep this last.
 		};
 
 		enum CompatOptionFlagType
@@ -120,15 +122,15 @@ namespace OpenZWave
 						uint16_t valShort;
 						uint32_t valInt;
 				};
-				/* Only when FLAG_TYPE_*_ARRAY is this union used, and holds
-				 * individual values for each key. Default Value is taken from
-				 * the above Union
+				/* Only when FLAG_TYPE_*_ARRAY is this used, and holds the
+				 * individual values for each index, sorted by index.  Whatever the
+				 * type, each value is widened to 32 bits.  Default Value is taken
+				 * from the above Union
 				 */
-				/* oh - And we can't use a Union here with a non-POD type */
-				std::map<uint32_t, bool> valBoolArray;
-				std::map<uint32_t, uint8_t> valByteArray;
-				std::map<uint32_t, uint16_t> valShortArray;
-				std::map<uint32_t, uint32_t> valIntArray;
+				std::vector<std::pair<uint32_t, uint32_t> > valArray;
+
+				bool GetIndexed(uint32_t index, uint32_t* o_value) const;
+				void SetIndexed(uint32_t index, uint32_t value);
 		};
 
 		struct CompatOptionFlagDefintions
@@ -138,6 +140,8 @@ namespace OpenZWave
 				CompatOptionFlagType type;
 		};
 
+		static_assert(COMPAT_FLAG_COUNT <= 64, "CompatOptionManager keeps the enabled flags in a 64 bit mask");
+
 		class CompatOptionManager
 		{
 			public:
@@ -158,9 +162,26 @@ namespace OpenZWave
 				bool SetFlagShort(CompatOptionFlags flag, uint16_t value, uint32_t index = -1);
 				bool SetFlagInt(CompatOptionFlags flag, uint32_t value, uint32_t index = -1);
 			private:
+				/* The storage for a flag, or NULL if it is not enabled.  This is on the receive
+				 * path of every command class, so it is a bit test and an indexed load.
+				 */
+				CompatOptionFlagStorage const* Find(CompatOptionFlags flag) const
+				{
+					if (((uint32_t) flag >= COMPAT_FLAG_COUNT) || !(m_enabledFlags & ((uint64_t) 1 << flag)))
+					{
+						return NULL;
+					}
+					return &m_CompatVals[m_slots[flag]];
+				}
+				CompatOptionFlagStorage* Find(CompatOptionFlags flag)
+				{
+					return const_cast<CompatOptionFlagStorage*>(static_cast<CompatOptionManager const*>(this)->Find(flag));
+				}
 				string GetFlagName(CompatOptionFlags flag) const;
 				string GetXMLTagName();
-				map<CompatOptionFlags, CompatOptionFlagStorage> m_CompatVals;
+				uint64_t m_enabledFlags;						// A bit for each enabled CompatOptionFlags
+				uint8_t m_slots[COMPAT_FLAG_COUNT];				// Where each enabled flag is in m_CompatVals
+				vector<CompatOptionFlagStorage> m_CompatVals;
 				map<string, CompatOptionFlags> m_enabledCompatFlags;
 				Internal::CC::CommandClass *m_owner;
 				CompatOptionType m_comtype;
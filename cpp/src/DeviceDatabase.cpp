@@ -0,0 +1,386 @@
+//-----------------------------------------------------------------------------
+//
+//	DeviceDatabase.cpp
+//
+//	Precompiled form of the device configuration files
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DeviceDatabase.h"
+#include "ManufacturerSpecificDB.h"
+#include "platform/FileOps.h"
+#include "platform/Log.h"
+#include "tinyxml.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		string const DeviceDatabase::c_filename = "device_database.bin";
+
+		// Device files are indexed next to the products, with this bit set above the 48 bit product keys
+		static int64 const c_configFileKey = ((int64) 1) << 48;
+
+		namespace
+		{
+			// Used to notice XML files that were changed after the database was built: the size and
+			// an FNV-1a hash of the contents, so an edit that keeps the length, such as a new revision
+			// number, is noticed too.  Modification times are not used, as installing copies the files.
+			string GetFileStamp(string const& _filename)
+			{
+				FILE* fp = fopen(_filename.c_str(), "rb");
+				if (!fp)
+				{
+					return "";
+				}
+				uint64 hash = 0xcbf29ce484222325ULL;
+				uint32 size = 0;
+				uint8 buffer[4096];
+				size_t count;
+				while ((count = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						hash ^= buffer[i];
+						hash *= 0x100000001b3ULL;
+					}
+					size += (uint32) count;
+				}
+				fclose(fp);
+
+				char str[32];
+				snprintf(str, sizeof(str), "%u-%016llx", size, (unsigned long long) hash);
+				return str;
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::DeviceDatabase>
+// Constructor
+//-----------------------------------------------------------------------------
+		DeviceDatabase::DeviceDatabase() :
+				m_revision(0), m_open(false)
+		{
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::~DeviceDatabase>
+// Destructor
+//-----------------------------------------------------------------------------
+		DeviceDatabase::~DeviceDatabase()
+		{
+			Close();
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::Open>
+// Map the database and check it matches manufacturer_specific.xml
+//-----------------------------------------------------------------------------
+		bool DeviceDatabase::Open(string const& _configPath)
+		{
+			Close();
+			m_filename = _configPath + c_filename;
+			if (!Platform::FileOps::Create()->FileExists(m_filename) || !m_cache.Open(m_filename))
+			{
+				return false;
+			}
+
+			uint32 root = m_cache.GetRoot();
+			char const* name = m_cache.GetName(root);
+			char const* stamp = m_cache.GetAttribute(root, "source_stamp");
+			if (!name || strcmp(name, "DeviceDatabase") || !stamp)
+			{
+				Log::Write(LogLevel_Warning, "WARNING: %s is not a device database, or was built by an older version. Ignoring it", m_filename.c_str());
+				m_cache.Close();
+				return false;
+			}
+			if (GetFileStamp(_configPath + "manufacturer_specific.xml") != stamp)
+			{
+				Log::Write(LogLevel_Warning, "WARNING: manufacturer_specific.xml has changed since %s was built. Loading the XML config files instead", m_filename.c_str());
+				m_cache.Close();
+				return false;
+			}
+
+			char const* revision = m_cache.GetAttribute(root, "revision");
+			m_revision = revision ? (uint32) atol(revision) : 0;
+			m_open = true;
+			Log::Write(LogLevel_Info, "Loaded Device Database %s (Revision %d)", m_filename.c_str(), m_revision);
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::Close>
+// Release the mapping
+//-----------------------------------------------------------------------------
+		void DeviceDatabase::Close()
+		{
+			m_cache.Close();
+			m_revision = 0;
+			m_open = false;
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::Discard>
+// Close and delete the database
+//-----------------------------------------------------------------------------
+		void DeviceDatabase::Discard()
+		{
+			if (!m_open)
+			{
+				return;
+			}
+			Close();
+			Log::Write(LogLevel_Info, "Config files were updated. Removing %s until it is rebuilt", m_filename.c_str());
+			remove(m_filename.c_str());
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::ReadProducts>
+// Fill the manufacturer and product maps from the database
+//-----------------------------------------------------------------------------
+		bool DeviceDatabase::ReadProducts(map<uint16, string>& o_manufacturers, map<int64, std::shared_ptr<ProductDescriptor> >& o_products)
+		{
+			if (!m_open)
+			{
+				return false;
+			}
+
+			char* pStopChar;
+			uint32 root = m_cache.GetRoot();
+			for (uint16 i = 0; i < m_cache.GetChildCount(root); ++i)
+			{
+				uint32 manufacturer = m_cache.GetChild(root, i);
+				char const* str = m_cache.GetName(manufacturer);
+				if (!str || strcmp(str, "Manufacturer"))
+				{
+					continue;
+				}
+				char const* idStr = m_cache.GetAttribute(manufacturer, "id");
+				char const* nameStr = m_cache.GetAttribute(manufacturer, "name");
+				if (!idStr || !nameStr)
+				{
+					return false;
+				}
+				uint16 manufacturerId = (uint16) strtol(idStr, &pStopChar, 16);
+				o_manufacturers[manufacturerId] = nameStr;
+
+				for (uint16 j = 0; j < m_cache.GetChildCount(manufacturer); ++j)
+				{
+					uint32 product = m_cache.GetChild(manufacturer, j);
+					char const* typeStr = m_cache.GetAttribute(product, "type");
+					idStr = m_cache.GetAttribute(product, "id");
+					nameStr = m_cache.GetAttribute(product, "name");
+					if (!typeStr || !idStr || !nameStr)
+					{
+						return false;
+					}
+					uint16 productType = (uint16) strtol(typeStr, &pStopChar, 16);
+					uint16 productId = (uint16) strtol(idStr, &pStopChar, 16);
+					char const* configStr = m_cache.GetAttribute(product, "config");
+
+					int64 key = ProductDescriptor::GetKey(manufacturerId, productType, productId);
+					if (o_products.find(key) != o_products.end())
+					{
+						std::shared_ptr<ProductDescriptor> c = o_products[key];
+						Log::Write(LogLevel_Info, "Product name collision: %s type %x id %x manufacturerid %x, collides with %s, type %x id %x manufacturerid %x", nameStr, productType, productId, manufacturerId, c->GetProductName().c_str(), c->GetProductType(), c->GetProductId(), c->GetManufacturerId());
+						continue;
+					}
+
+					ProductDescriptor* descriptor = new ProductDescriptor(manufacturerId, productType, productId, nameStr, o_manufacturers[manufacturerId], configStr ? configStr : "");
+					if (uint32 configFile = GetConfigFile(key))
+					{
+						char const* revision = m_cache.GetAttribute(configFile, "revision");
+						if (revision)
+						{
+							descriptor->SetConfigRevision(atol(revision));
+						}
+					}
+					o_products[key] = std::shared_ptr<ProductDescriptor>(descriptor);
+				}
+			}
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::GetConfigFile>
+// Find the device file of a product
+//-----------------------------------------------------------------------------
+		uint32 DeviceDatabase::GetConfigFile(int64 const _key) const
+		{
+			uint32 product = m_cache.Find(_key);
+			char const* configId = product ? m_cache.GetAttribute(product, "config_id") : NULL;
+			if (!configId)
+			{
+				return 0;
+			}
+			return m_cache.Find(c_configFileKey | atol(configId));
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::LoadConfigFile>
+// Decode the device file of a product
+//-----------------------------------------------------------------------------
+		bool DeviceDatabase::LoadConfigFile(int64 const _key, string const& _filename, TiXmlDocument* _doc)
+		{
+			uint32 configFile = m_open ? GetConfigFile(_key) : 0;
+			if (!configFile)
+			{
+				return false;
+			}
+			char const* stamp = m_cache.GetAttribute(configFile, "stamp");
+			if (!stamp || GetFileStamp(_filename) != stamp)
+			{
+				Log::Write(LogLevel_Info, "%s has changed since the Device Database was built. Loading it from XML", _filename.c_str());
+				return false;
+			}
+			return (m_cache.GetChildCount(configFile) == 1) && (m_cache.Decode(m_cache.GetChild(configFile, 0), _doc) != NULL);
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::GetProductPic>
+// Get the ProductPic metadata of a product's device file
+//-----------------------------------------------------------------------------
+		bool DeviceDatabase::GetProductPic(int64 const _key, string* o_pic)
+		{
+			uint32 configFile = m_open ? GetConfigFile(_key) : 0;
+			if (!configFile)
+			{
+				return false;
+			}
+			char const* pic = m_cache.GetAttribute(configFile, "product_pic");
+			*o_pic = pic ? pic : "";
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <DeviceDatabase::Compile>
+// Compile manufacturer_specific.xml and the device files into a database
+//-----------------------------------------------------------------------------
+		bool DeviceDatabase::Compile(string const& _configPath, string const& _filename)
+		{
+			string mfsFile = _configPath + "manufacturer_specific.xml";
+			TiXmlDocument mfs;
+			if (!mfs.LoadFile(mfsFile.c_str(), TIXML_ENCODING_UTF8) || !mfs.RootElement())
+			{
+				Log::Write(LogLevel_Warning, "WARNING: Unable to load %s", mfsFile.c_str());
+				return false;
+			}
+
+			TiXmlElement root("DeviceDatabase");
+			char const* str = mfs.RootElement()->Attribute("Revision");
+			root.SetAttribute("revision", str ? str : "0");
+			root.SetAttribute("source_stamp", GetFileStamp(mfsFile).c_str());
+
+			map<int64, TiXmlElement const*> index;
+			map<string, int32> configIds;
+			for (TiXmlElement const* manufacturerElement = mfs.RootElement()->FirstChildElement("Manufacturer"); manufacturerElement; manufacturerElement = manufacturerElement->NextSiblingElement("Manufacturer"))
+			{
+				char const* idStr = manufacturerElement->Attribute("id");
+				char const* nameStr = manufacturerElement->Attribute("name");
+				if (!idStr || !nameStr)
+				{
+					Log::Write(LogLevel_Warning, "WARNING: Error in %s at line %d - missing manufacturer id or name attribute", mfsFile.c_str(), manufacturerElement->Row());
+					return false;
+				}
+				uint16 manufacturerId = (uint16) strtol(idStr, NULL, 16);
+				TiXmlElement* manufacturer = new TiXmlElement("Manufacturer");
+				manufacturer->SetAttribute("id", idStr);
+				manufacturer->SetAttribute("name", nameStr);
+				root.LinkEndChild(manufacturer);
+
+				for (TiXmlElement const* productElement = manufacturerElement->FirstChildElement("Product"); productElement; productElement = productElement->NextSiblingElement("Product"))
+				{
+					char const* typeStr = productElement->Attribute("type");
+					idStr = productElement->Attribute("id");
+					nameStr = productElement->Attribute("name");
+					if (!typeStr || !idStr || !nameStr)
+					{
+						Log::Write(LogLevel_Warning, "WARNING: Error in %s at line %d - missing product type, id or name attribute", mfsFile.c_str(), productElement->Row());
+						return false;
+					}
+					TiXmlElement* product = new TiXmlElement("Product");
+					product->SetAttribute("type", typeStr);
+					product->SetAttribute("id", idStr);
+					product->SetAttribute("name", nameStr);
+					if (char const* configStr = productElement->Attribute("config"))
+					{
+						map<string, int32>::iterator it = configIds.find(configStr);
+						if (it == configIds.end())
+						{
+							it = configIds.insert(std::make_pair(string(configStr), (int32) configIds.size())).first;
+						}
+						product->SetAttribute("config", configStr);
+						product->SetAttribute("config_id", it->second);
+					}
+					manufacturer->LinkEndChild(product);
+
+					// The first product with a key wins, as in ManufacturerSpecificDB::LoadProductXML
+					int64 key = ProductDescriptor::GetKey(manufacturerId, (uint16) strtol(typeStr, NULL, 16), (uint16) strtol(idStr, NULL, 16));
+					if (index.find(key) == index.end())
+					{
+						index[key] = product;
+					}
+				}
+			}
+
+			size_t products = index.size();
+			for (map<string, int32>::iterator it = configIds.begin(); it != configIds.end(); ++it)
+			{
+				string path = _configPath + it->first;
+				TiXmlDocument doc;
+				if (!doc.LoadFile(path.c_str(), TIXML_ENCODING_UTF8) || !doc.RootElement())
+				{
+					// The XML loader will report it when a node needs it
+					Log::Write(LogLevel_Warning, "WARNING: Unable to load %s. Leaving it out of the Device Database", path.c_str());
+					continue;
+				}
+				TiXmlElement const* productElement = doc.RootElement();
+				TiXmlElement* configFile = new TiXmlElement("ConfigFile");
+				configFile->SetAttribute("path", it->first.c_str());
+				configFile->SetAttribute("stamp", GetFileStamp(path).c_str());
+				if ((str = productElement->Attribute("Revision")) != NULL)
+				{
+					configFile->SetAttribute("revision", str);
+				}
+				if (TiXmlElement const* metaDataElement = productElement->FirstChildElement("MetaData"))
+				{
+					for (TiXmlElement const* metaDataItem = metaDataElement->FirstChildElement("MetaDataItem"); metaDataItem; metaDataItem = metaDataItem->NextSiblingElement("MetaDataItem"))
+					{
+						str = metaDataItem->Attribute("name");
+						if (str && !strcmp(str, "ProductPic") && metaDataItem->GetText())
+						{
+							configFile->SetAttribute("product_pic", metaDataItem->GetText());
+						}
+					}
+				}
+				configFile->LinkEndChild(productElement->Clone());
+				root.LinkEndChild(configFile);
+				index[c_configFileKey | it->second] = configFile;
+			}
+
+			Log::Write(LogLevel_Info, "Compiled %d products and %d device files into %s", (int) products, (int) (index.size() - products), _filename.c_str());
+			return BinaryCache::Write(&root, _filename, &index);
+		}
+	} // namespace Internal
+} // namespace OpenZWave
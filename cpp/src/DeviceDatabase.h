@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+//
+//	DeviceDatabase.h
+//
+//	Precompiled form of the device configuration files
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _DeviceDatabase_H
+#define _DeviceDatabase_H
+
+#include <string>
+#include <map>
+#include <memory>
+
+#include "Defs.h"
+#include "BinaryCache.h"
+
+class TiXmlDocument;
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		class ProductDescriptor;
+
+		/** \brief manufacturer_specific.xml and every device file it references, compiled
+		 *  into a single indexed file (device_database.bin in the config folder).
+		 *
+		 *  The file uses the BinaryCache format. It holds one \<Product\> entry per
+		 *  manufacturer_specific.xml product, indexed by ProductDescriptor::GetKey, and one
+		 *  \<ConfigFile\> per device file, holding the already tokenized \<Product\> tree
+		 *  along with its revision and ProductPic. Looking up a product or its device
+		 *  file is a single hash probe in the mapped file and never parses XML.
+		 *
+		 *  The database is built by "CacheTool device-db" as part of the build. It is only
+		 *  used while it matches the XML it was built from: a changed manufacturer_specific.xml
+		 *  disables it, a changed device file falls back to that XML file, and a config
+		 *  update downloaded at runtime removes it.
+		 */
+		class OPENZWAVE_EXPORT DeviceDatabase
+		{
+			public:
+				DeviceDatabase();
+				~DeviceDatabase();
+
+				/**
+				 * Map the database in a config folder.
+				 * \return false if there is no usable database, in which case the XML files should be used
+				 */
+				bool Open(string const& _configPath);
+				void Close();
+				bool IsOpen() const
+				{
+					return m_open;
+				}
+
+				/**
+				 * Close the database and delete the file, as it no longer matches the config folder.
+				 */
+				void Discard();
+
+				/** The Revision of the manufacturer_specific.xml the database was built from */
+				uint32 GetRevision() const
+				{
+					return m_revision;
+				}
+
+				/**
+				 * Fill the manufacturer and product maps, as ManufacturerSpecificDB::LoadProductXML does from the XML.
+				 */
+				bool ReadProducts(map<uint16, string>& o_manufacturers, map<int64, std::shared_ptr<ProductDescriptor> >& o_products);
+
+				/**
+				 * Decode the device file for a product into a document.
+				 * \param _key The ProductDescriptor key
+				 * \param _filename Full path of the XML device file, used to detect that it was changed since the database was built
+				 * \return false if the database has no (current) copy of the device file
+				 */
+				bool LoadConfigFile(int64 const _key, string const& _filename, TiXmlDocument* _doc);
+
+				/**
+				 * Get the ProductPic metadata of a product's device file.
+				 * \return false if the database has no copy of the device file
+				 */
+				bool GetProductPic(int64 const _key, string* o_pic);
+
+				/**
+				 * Compile a config folder into a database.
+				 */
+				static bool Compile(string const& _configPath, string const& _filename);
+
+				static string const c_filename;
+
+			private:
+				uint32 GetConfigFile(int64 const _key) const;
+
+				BinaryCache m_cache;
+				string m_filename;
+				uint32 m_revision;
+				bool m_open;
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _DeviceDatabase_H
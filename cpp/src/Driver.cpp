@@ -35,11 +35,21 @@
 #include "ZWSecurity.h"
 #include "DNSThread.h"
 #include "TimerThread.h"
+#include "MsgScheduler.h"
+#include "InterviewScheduler.h"
+#include "PollScheduler.h"
+#include "IdleSignal.h"
+#include "NotificationDispatcher.h"
+#include "MetricsExporter.h"
 #include "Http.h"
 #include "ManufacturerSpecificDB.h"
+#include "CacheJournal.h"
+#include "BinaryCache.h"
 
 #include "platform/Event.h"
+#include "platform/FileOps.h"
 #include "platform/Mutex.h"
+#include "platform/SharedMutex.h"
 #include "platform/SerialController.h"
 #ifdef USE_HID
 #ifdef WINRT
@@ -51,6 +61,7 @@
 #include "platform/Thread.h"
 #include "platform/Log.h"
 #include "platform/TimeStamp.h"
+#include "platform/WaitSet.h"
 
 #include "command_classes/CommandClasses.h"
 #include "command_classes/ApplicationStatus.h"
@@ -59,6 +70,7 @@
 #include "command_classes/WakeUp.h"
 #include "command_classes/SwitchAll.h"
 #include "command_classes/ManufacturerSpecific.h"
+#include "command_classes/MultiCmd.h"
 #include "command_classes/NoOperation.h"
 
 #include "value_classes/ValueID.h"
@@ -110,15 +122,39 @@ static char const* c_controllerCommandNames[] =
 static char const* c_sendQueueNames[] =
 { "Command", "NoOp", "Controller", "WakeUp", "Send", "Query", "Poll" };
 
+int32 const Driver::c_pollLagBounds[Driver::PollLagBuckets - 1] =
+{ 10, 50, 100, 500, 1000, 5000, 10000 };
+
+// Largest MultiCmd encapsulation built from queued commands.  It leaves room for a frame
+// routed through four repeaters, sent as an explorer frame.
+static uint32 const c_multiCmdMaxPayload = 36;
+
+// For the air time estimate: bytes in the preamble, header and checksum of a frame and
+// of its acknowledgement, and microseconds to send a byte at 40kbit/s
+static uint32 const c_frameOverheadBytes = 42;
+static uint32 const c_byteAirTime = 200;
+
+//-----------------------------------------------------------------------------
+// <LogLatency>
+// Write a line of the latency table in LogDriverStatistics
+//-----------------------------------------------------------------------------
+static void LogLatency(char const* _name, LatencyHistogramData const& _data)
+{
+	if (_data.m_count)
+	{
+		Log::Write(LogLevel_Always, "%-16s %7d %8.1f %8.1f %8.1f %8.1f %8.1f", _name, _data.m_count, _data.GetMean() / 1000.0, _data.GetPercentile(50) / 1000.0, _data.GetPercentile(90) / 1000.0, _data.GetPercentile(99) / 1000.0, _data.m_max / 1000.0);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::Driver>
 // Constructor
 //-----------------------------------------------------------------------------
 Driver::Driver(string const& _controllerPath, ControllerInterface const& _interface) :
-		m_driverThread(new Internal::Platform::Thread("driver")), m_dns(new Internal::DNSThread(this)), m_dnsThread(new Internal::Platform::Thread("dns")), m_initMutex(new Internal::Platform::Mutex()), m_exit(false), m_init(false), m_awakeNodesQueried(false), m_allNodesQueried(false), m_notifytransactions(false), m_timer(new Internal::TimerThread(this)), m_timerThread(new Internal::Platform::Thread("timer")), m_controllerInterfaceType(_interface), m_controllerPath(_controllerPath), m_controller(
-				NULL), m_homeId(0), m_libraryVersion(""), m_libraryTypeName(""), m_libraryType(0), m_manufacturerId(0), m_productType(0), m_productId(0), m_initVersion(0), m_initCaps(0), m_controllerCaps(0), m_Controller_nodeId(0), m_nodeMutex(new Internal::Platform::Mutex()), m_controllerReplication( NULL), m_transmitOptions( TRANSMIT_OPTION_ACK | TRANSMIT_OPTION_AUTO_ROUTE | TRANSMIT_OPTION_EXPLORE), m_waitingForAck(false), m_expectedCallbackId(0), m_expectedReply(0), m_expectedCommandClassId(
-				0), m_expectedNodeId(0), m_pollThread(new Internal::Platform::Thread("poll")), m_pollMutex(new Internal::Platform::Mutex()), m_pollInterval(0), m_bIntervalBetweenPolls(false),				// if set to true (via SetPollInterval), the pollInterval will be interspersed between each poll (so a much smaller m_pollInterval like 100, 500, or 1,000 may be appropriate)
-		m_currentControllerCommand( NULL), m_SUCNodeId(0), m_controllerResetEvent( NULL), m_sendMutex(new Internal::Platform::Mutex()), m_currentMsg( NULL), m_virtualNeighborsReceived(false), m_notificationsEvent(new Internal::Platform::Event()), m_SOFCnt(0), m_ACKWaiting(0), m_readAborts(0), m_badChecksum(0), m_readCnt(0), m_writeCnt(0), m_CANCnt(0), m_NAKCnt(0), m_ACKCnt(0), m_OOFCnt(0), m_dropped(0), m_retries(0), m_callbacks(0), m_badroutes(0), m_noack(0), m_netbusy(0), m_notidle(0), m_txverified(
+		m_driverThread(new Internal::Platform::Thread("driver")), m_dns(new Internal::DNSThread(this)), m_dnsThread(new Internal::Platform::Thread("dns")), m_initMutex(new Internal::Platform::Mutex()), m_exit(false), m_init(false), m_awakeNodesQueried(false), m_allNodesQueried(false), m_notifytransactions(false), m_cacheJournal(NULL), m_cacheRefreshStage(Node::QueryStage_Dynamic), m_timer(new Internal::TimerThread(this)), m_timerThread(new Internal::Platform::Thread("timer")), m_controllerInterfaceType(_interface), m_controllerPath(_controllerPath), m_controller(
+				NULL), m_homeId(0), m_libraryVersion(""), m_libraryTypeName(""), m_libraryType(0), m_manufacturerId(0), m_productType(0), m_productId(0), m_initVersion(0), m_initCaps(0), m_controllerCaps(0), m_Controller_nodeId(0), m_nodeMutex(new Internal::Platform::SharedMutex()), m_controllerReplication( NULL), m_transmitOptions( TRANSMIT_OPTION_ACK | TRANSMIT_OPTION_AUTO_ROUTE | TRANSMIT_OPTION_EXPLORE), m_waitingForAck(false), m_expectedCallbackId(0), m_expectedReply(0), m_expectedCommandClassId(
+				0), m_expectedNodeId(0), m_currentMsgDelivered(false), m_pollThread(new Internal::Platform::Thread("poll")), m_pollScheduler(NULL), m_pollMutex(new Internal::Platform::Mutex()), m_pollInterval(0), m_bIntervalBetweenPolls(false),				// if set to true (via SetPollInterval), the pollInterval will be interspersed between each poll (so a much smaller m_pollInterval like 100, 500, or 1,000 may be appropriate)
+		m_currentControllerCommand( NULL), m_SUCNodeId(0), m_controllerResetEvent( NULL), m_sendMutex(new Internal::Platform::Mutex()), m_currentMsg( NULL), m_idleSignal(NULL), m_msgScheduler(NULL), m_interviewScheduler(NULL), m_retryTimeout(RETRY_TIMEOUT), m_multiCmdBatching(false), m_virtualNeighborsReceived(false), m_notificationsEvent(new Internal::Platform::Event()), m_notificationDispatcher(NULL), m_notificationThread(NULL), m_notificationCoalesceWindow(0), m_notificationTimer(NULL), m_notificationTimerSet(false), m_notificationsMerged(0), m_SOFCnt(0), m_ACKWaiting(0), m_readAborts(0), m_badChecksum(0), m_readCnt(0), m_writeCnt(0), m_CANCnt(0), m_NAKCnt(0), m_ACKCnt(0), m_OOFCnt(0), m_dropped(0), m_retries(0), m_callbacks(0), m_badroutes(0), m_noack(0), m_netbusy(0), m_notidle(0), m_txverified(
 				0), m_nondelivery(0), m_routedbusy(0), m_broadcastReadCnt(0), m_broadcastWriteCnt(0), AuthKey(0), EncryptKey(0), m_nonceReportSent(0), m_nonceReportSentAttempt(0), m_queueMsgEvent(new Internal::Platform::Event()), m_eventMutex(new Internal::Platform::Mutex())
 {
 	// set a timestamp to indicate when this driver started
@@ -129,6 +165,22 @@ Driver::Driver(string const& _controllerPath, ControllerInterface const& _interf
 	{
 		m_queueEvent[i] = new Internal::Platform::Event();
 	}
+	memset(m_lastQueueNode, 0, sizeof(m_lastQueueNode));
+	memset(m_queueOverdue, 0, sizeof(m_queueOverdue));
+	m_multiCmdFramesSaved = 0;
+	m_multiCmdAirTimeSaved = 0;
+	m_pollCnt = 0;
+	memset(m_pollLag, 0, sizeof(m_pollLag));
+	m_pollWakeups = 0;
+	m_allNodesQueriedTime = 0;
+	for (int32 i = 0; i < 256; ++i)
+	{
+		m_commandClassReportLatency[i] = NULL;
+	}
+	m_metricsExporter = NULL;
+	m_metricsThread = NULL;
+	m_metricsInterval = 0;
+	m_idleSignal = new Internal::IdleSignal(m_sendMutex);
 
 	// Clear the nodes array
 	memset(m_nodes, 0, sizeof(Node*) * 256);
@@ -155,6 +207,105 @@ Driver::Driver(string const& _controllerPath, ControllerInterface const& _interf
 	Options::Get()->GetOptionAsBool("NotifyTransactions", &m_notifytransactions);
 	Options::Get()->GetOptionAsInt("PollInterval", &m_pollInterval);
 	Options::Get()->GetOptionAsBool("IntervalBetweenPolls", &m_bIntervalBetweenPolls);
+	int32 pollBackoff = 1;
+	Options::Get()->GetOptionAsInt("PollBackoff", &pollBackoff);
+	m_pollScheduler = new Internal::PollScheduler(pollBackoff > 1 ? (uint32) pollBackoff : 1);
+
+	string scheduler;
+	Options::Get()->GetOptionAsString("MessageScheduler", &scheduler);
+	if (Internal::ToUpper(scheduler) == "FAIR")
+	{
+		int32 sendDeadline = 500;
+		Options::Get()->GetOptionAsInt("SendDeadline", &sendDeadline);
+		int32 pollShare = 20;
+		Options::Get()->GetOptionAsInt("PollShare", &pollShare);
+		m_msgScheduler = new Internal::FairMsgScheduler(sendDeadline, pollShare);
+	}
+	else
+	{
+		if (Internal::ToUpper(scheduler) != "PRIORITY")
+		{
+			Log::Write(LogLevel_Warning, "Unknown MessageScheduler \"%s\", using PRIORITY", scheduler.c_str());
+		}
+		m_msgScheduler = new Internal::MsgScheduler();
+	}
+	Options::Get()->GetOptionAsBool("MultiCmdBatching", &m_multiCmdBatching);
+	Options::Get()->GetOptionAsInt("RetryTimeout", &m_retryTimeout);
+	int32 pipeline = 1;
+	Options::Get()->GetOptionAsInt("InterviewPipeline", &pipeline);
+	m_interviewScheduler = new Internal::InterviewScheduler(pipeline > 1 ? (uint32) pipeline : 1);
+
+	string cacheRefresh;
+	Options::Get()->GetOptionAsString("CacheRefresh", &cacheRefresh);
+	if (Internal::ToUpper(cacheRefresh) == "ALL")
+	{
+		m_cacheRefreshStage = Node::QueryStage_Associations;
+	}
+	else if (Internal::ToUpper(cacheRefresh) == "NONE")
+	{
+		m_cacheRefreshStage = Node::QueryStage_Configuration;
+	}
+	else
+	{
+		if (Internal::ToUpper(cacheRefresh) != "DYNAMIC")
+		{
+			Log::Write(LogLevel_Warning, "Unknown CacheRefresh \"%s\", using DYNAMIC", cacheRefresh.c_str());
+		}
+		m_cacheRefreshStage = Node::QueryStage_Dynamic;
+	}
+
+	Options::Get()->GetOptionAsInt("NotificationCoalesceWindow", &m_notificationCoalesceWindow);
+	if (m_notificationCoalesceWindow > 0)
+	{
+		m_notificationTimer = new Internal::Timer(this);
+	}
+
+	bool asyncNotifications = false;
+	Options::Get()->GetOptionAsBool("AsyncNotifications", &asyncNotifications);
+	if (asyncNotifications)
+	{
+		int32 queueSize = 1024;
+		Options::Get()->GetOptionAsInt("NotificationQueueSize", &queueSize);
+		string backpressure;
+		Options::Get()->GetOptionAsString("NotificationBackpressure", &backpressure);
+		Internal::NotificationDispatcher::Backpressure mode = Internal::NotificationDispatcher::Backpressure_Block;
+		if (Internal::ToUpper(backpressure) == "DROP")
+		{
+			mode = Internal::NotificationDispatcher::Backpressure_Drop;
+		}
+		else if (Internal::ToUpper(backpressure) == "COALESCE")
+		{
+			mode = Internal::NotificationDispatcher::Backpressure_Coalesce;
+		}
+		else if (Internal::ToUpper(backpressure) != "BLOCK")
+		{
+			Log::Write(LogLevel_Warning, "Unknown NotificationBackpressure \"%s\", using BLOCK", backpressure.c_str());
+		}
+		m_notificationDispatcher = new Internal::NotificationDispatcher(queueSize > 0 ? queueSize : 1, mode, m_notificationsEvent);
+		m_notificationThread = new Internal::Platform::Thread("notify");
+	}
+
+	string metricsExport;
+	Options::Get()->GetOptionAsString("MetricsExport", &metricsExport);
+	if (!metricsExport.empty())
+	{
+		m_metricsExporter = new Internal::MetricsExporter(metricsExport);
+		if (m_metricsExporter->IsValid())
+		{
+			m_metricsInterval = 15000;
+			Options::Get()->GetOptionAsInt("MetricsExportInterval", &m_metricsInterval);
+			if (m_metricsInterval < 1000)
+			{
+				m_metricsInterval = 1000;
+			}
+			m_metricsThread = new Internal::Platform::Thread("metrics");
+		}
+		else
+		{
+			delete m_metricsExporter;
+			m_metricsExporter = NULL;
+		}
+	}
 
 	m_httpClient = new Internal::HttpClient(this);
 
@@ -171,11 +322,18 @@ Driver::Driver(string const& _controllerPath, ControllerInterface const& _interf
 Driver::~Driver()
 {
 
+	// Stop holding back value notifications, so nothing waits behind them
+	m_notificationCoalesceWindow = 0;
+
 	/* Signal that we are going away... so at least Apps know... */
 	Notification* notification = new Notification(Notification::Type_DriverRemoved);
 	notification->SetHomeAndNodeIds(m_homeId, 0);
 	QueueNotification(notification);
 	NotifyWatchers();
+	if (m_notificationDispatcher)
+	{
+		m_notificationDispatcher->Flush();
+	}
 
 	// append final driver stats output to the log file
 	LogDriverStatistics();
@@ -200,6 +358,13 @@ Driver::~Driver()
 	m_pollThread->Stop();
 	m_pollThread->Release();
 
+	if (m_metricsThread)
+	{
+		m_metricsThread->Stop();
+		m_metricsThread->Release();
+		m_metricsThread = NULL;
+	}
+
 	m_dnsThread->Stop();
 	m_dnsThread->Release();
 
@@ -208,7 +373,28 @@ Driver::~Driver()
 
 	m_timerThread->Stop();
 	m_timerThread->Release();
+	delete m_notificationTimer;
+	m_notificationTimer = NULL;
+	delete m_metricsExporter;
+	m_metricsExporter = NULL;
+	for (int32 i = 0; i < 256; ++i)
+	{
+		delete m_commandClassReportLatency[i].load();
+	}
+
+	if (m_notificationDispatcher)
+	{
+		// Anything queued after DriverRemoved is not delivered, unless NotifyOnDriverUnload
+		// is set, in which case it is delivered below on this thread, as it always was.
+		m_notificationThread->Stop();
+		m_notificationThread->Release();
+		delete m_notificationDispatcher;
+		m_notificationDispatcher = NULL;
+	}
 
+	// The current message is removed below, with nothing left to wait for the queues
+	delete m_idleSignal;
+	m_idleSignal = NULL;
 	m_sendMutex->Release();
 
 	m_controller->Close();
@@ -238,6 +424,7 @@ Driver::~Driver()
 	}
 	// Don't release until all nodes have removed their poll values
 	m_pollMutex->Release();
+	delete m_pollScheduler;
 
 	// Clear the send Queue
 	for (int32 i = 0; i < MsgQueue_Count; ++i)
@@ -258,6 +445,8 @@ Driver::~Driver()
 
 		m_queueEvent[i]->Release();
 	}
+	delete m_interviewScheduler;
+	delete m_msgScheduler;
 	/* Doing our Notification Call back here in the destructor is just asking for trouble
 	 * as there is a good chance that the application will do some sort of GetDriver() supported
 	 * method on the Manager Class, which by this time, most of the OZW Classes associated with the
@@ -283,6 +472,7 @@ Driver::~Driver()
 		delete notification;
 		nit = m_notifications.begin();
 	}
+	m_pendingValueNotifications.clear();
 
 	if (m_controllerReplication)
 		delete m_controllerReplication;
@@ -294,6 +484,7 @@ Driver::~Driver()
 	delete this->AuthKey;
 	delete this->EncryptKey;
 	delete this->m_httpClient;
+	delete this->m_cacheJournal;
 	delete this->m_timer;
 	delete this->m_dns;
 
@@ -310,6 +501,10 @@ void Driver::Start()
 	m_driverThread->Start(Driver::DriverThreadEntryPoint, this);
 	m_dnsThread->Start(Internal::DNSThread::DNSThreadEntryPoint, m_dns);
 	m_timerThread->Start(Internal::TimerThread::TimerThreadEntryPoint, m_timer);
+	if (m_notificationDispatcher)
+	{
+		m_notificationThread->Start(Internal::NotificationDispatcher::DispatcherThreadEntryPoint, m_notificationDispatcher);
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -354,13 +549,16 @@ void Driver::DriverThreadProc(Internal::Platform::Event* _exitEvent)
 			waitObjects[9] = m_queueEvent[MsgQueue_Query];		// Node queries are pending.
 			waitObjects[10] = m_queueEvent[MsgQueue_Poll];		// Poll request is waiting.
 
+			// Register with the wait objects once, rather than on every pass of the loop
+			Internal::Platform::WaitSet waitSet(waitObjects, WAITOBJECTCOUNT);
+
 			Internal::Platform::TimeStamp retryTimeStamp;
-			int retryTimeout = RETRY_TIMEOUT;
-			Options::Get()->GetOptionAsInt("RetryTimeout", &retryTimeout);
+			int retryTimeout = Options::Get()->GetSnapshot().m_retryTimeout;
 			//retryTimeout = RETRY_TIMEOUT * 10;
 			while (true)
 			{
 				Log::Write(LogLevel_StreamDetail, "      Top of DriverThreadProc loop.");
+				ExpireAwaitedReports();
 				uint32 count = WAITOBJECTCOUNT;
 				int32 timeout = Internal::Platform::Wait::Timeout_Infinite;
 
@@ -384,19 +582,26 @@ void Driver::DriverThreadProc(Internal::Platform::Event* _exitEvent)
 				else if (m_currentControllerCommand != NULL)
 				{
 					count = 7;
+					timeout = GetAwaitTimeout();
 				}
 				else
 				{
 					Log::QueueClear();							// clear the log queue when starting a new message
+					timeout = GetAwaitTimeout();
 				}
 
 				// Wait for something to do
-				int32 res = Internal::Platform::Wait::Multiple(waitObjects, count, timeout);
+				int32 res = waitSet.Select(count, timeout);
 
 				switch (res)
 				{
 					case -1:
 					{
+						if (!m_waitingForAck && !m_expectedCallbackId && !m_expectedReply)
+						{
+							// A query waiting for its report has timed out.  It is queued again at the top of the loop.
+							break;
+						}
 						// Wait has timed out - time to resend
 						if (m_currentMsg != NULL && !m_currentMsg->isResendDuetoCANorNAK())
 						{
@@ -446,7 +651,8 @@ void Driver::DriverThreadProc(Internal::Platform::Event* _exitEvent)
 					default:
 					{
 						// All the other events are sending message queue items
-						if (WriteNextMsg((MsgQueue) (res - 4)))
+						MsgQueue queue = SelectMsgQueue((MsgQueue) (res - 4), count - 4);
+						if ((queue != MsgQueue_Count) && WriteNextMsg(queue))
 						{
 							retryTimeStamp.SetTime(retryTimeout);
 						}
@@ -458,8 +664,7 @@ void Driver::DriverThreadProc(Internal::Platform::Event* _exitEvent)
 
 		++attempts;
 
-		uint32 maxAttempts = 0;
-		Options::Get()->GetOptionAsInt("DriverMaxAttempts", (int32 *) &maxAttempts);
+		uint32 maxAttempts = (uint32) Options::Get()->GetSnapshot().m_driverMaxAttempts;
 		if (maxAttempts && (attempts >= maxAttempts))
 		{
 			Manager::Get()->Manager::SetDriverReady(this, false);
@@ -513,6 +718,7 @@ bool Driver::Init(uint32 _attempts)
 
 	// Open the controller
 	Log::Write(LogLevel_Info, "  Opening controller %s", m_controllerPath.c_str());
+	m_openedTime.SetTime();
 
 	if (!m_controller->Open(m_controllerPath))
 	{
@@ -557,6 +763,7 @@ void Driver::RemoveQueues(uint8 const _nodeId)
 	{
 		RemoveCurrentMsg();
 	}
+	delete m_interviewScheduler->Remove(_nodeId);
 
 	// Clear the send Queue
 	for (int32 i = 0; i < MsgQueue_Count; ++i)
@@ -598,6 +805,7 @@ void Driver::RemoveQueues(uint8 const _nodeId)
 			m_queueEvent[i]->Reset();
 		}
 	}
+	UpdateIdleSignal();
 }
 
 //-----------------------------------------------------------------------------
@@ -619,15 +827,39 @@ bool Driver::ReadCache()
 
 	snprintf(str, sizeof(str), "ozwcache_0x%08x.xml", m_homeId);
 	string filename = userPath + string(str);
+	snprintf(str, sizeof(str), "ozwcache_0x%08x.bin", m_homeId);
+	string binaryFilename = userPath + string(str);
+
+	// Prefer the cache in the configured format, but accept the other one so switching formats keeps the cache.
+	// Only one is kept: writing the cache removes the one in the other format.
+	string format = "xml";
+	Options::Get()->GetOptionAsString("CacheFormat", &format);
+	Internal::BinaryCache binary;
+	bool useBinary = (format == "binary") ? Internal::Platform::FileOps::Create()->FileExists(binaryFilename) : !Internal::Platform::FileOps::Create()->FileExists(filename);
+	if (useBinary && !binary.Open(binaryFilename))
+	{
+		// Corrupt or from another format version. Try the XML cache instead.
+		useBinary = false;
+	}
 
 	TiXmlDocument doc;
 	doc.SetCondenseWhiteSpace(false);
-	if (!doc.LoadFile(filename.c_str(), TIXML_ENCODING_UTF8))
+	if (useBinary)
+	{
+		// Only the <Driver> attributes are decoded here. The nodes are decoded one at a time below.
+		filename = binaryFilename;
+		binary.Decode(binary.GetRoot(), &doc, true);
+	}
+	else if (!doc.LoadFile(filename.c_str(), TIXML_ENCODING_UTF8))
 	{
 		return false;
 	}
 	doc.SetUserData((void *) filename.c_str());
-	TiXmlElement const* driverElement = doc.RootElement();
+	TiXmlElement* driverElement = doc.RootElement();
+	if (!driverElement)
+	{
+		return false;
+	}
 
 	char const *xmlns = driverElement->Attribute("xmlns");
 	if (strcmp(xmlns, "https://github.com/OpenZWave/open-zwave"))
@@ -707,8 +939,30 @@ bool Driver::ReadCache()
 		m_bIntervalBetweenPolls = !strcmp(cstr, "true");
 	}
 
-	// Read the nodes
-	Internal::LockGuard LG(m_nodeMutex);
+	// Journal generation this snapshot was written with
+	uint32 generation = 0;
+	if (TIXML_SUCCESS == driverElement->QueryIntAttribute("journal_generation", &intVal))
+	{
+		generation = (uint32) intVal;
+	}
+
+	// Collect the most recent record for each node: first from the snapshot, then from the journal
+	map<uint8, TiXmlElement const*> nodeElements;
+	map<uint8, uint32> binaryNodes;
+	if (useBinary)
+	{
+		uint32 root = binary.GetRoot();
+		for (uint16 i = 0; i < binary.GetChildCount(root); ++i)
+		{
+			uint32 child = binary.GetChild(root, i);
+			char const* name = binary.GetName(child);
+			char const* id = binary.GetAttribute(child, "id");
+			if (name && id && !strcmp(name, "Node"))
+			{
+				binaryNodes[(uint8) atoi(id)] = child;
+			}
+		}
+	}
 	TiXmlElement const* nodeElement = driverElement->FirstChildElement();
 	while (nodeElement)
 	{
@@ -718,24 +972,86 @@ bool Driver::ReadCache()
 			// Get the node Id from the XML
 			if (TIXML_SUCCESS == nodeElement->QueryIntAttribute("id", &intVal))
 			{
-				uint8 nodeId = (uint8) intVal;
-				Node* node = new Node(m_homeId, nodeId);
-				m_nodes[nodeId] = node;
+				nodeElements[(uint8) intVal] = nodeElement;
+			}
+		}
 
-				Notification* notification = new Notification(Notification::Type_NodeAdded);
-				notification->SetHomeAndNodeIds(m_homeId, nodeId);
-				QueueNotification(notification);
+		nodeElement = nodeElement->NextSiblingElement();
+	}
 
-				// Read the rest of the node configuration from the XML
-				node->ReadXML(nodeElement);
+	Internal::LockGuard LG(m_nodeMutex);
+	list<TiXmlDocument*> journals;
+	if (Internal::CacheJournal* journal = GetCacheJournal())
+	{
+		journal->Load(generation, journals);
+	}
+	for (list<TiXmlDocument*>::iterator it = journals.begin(); it != journals.end(); ++it)
+	{
+		uint32 records = 0;
+		for (nodeElement = (*it)->FirstChildElement()->NextSiblingElement(); nodeElement; nodeElement = nodeElement->NextSiblingElement())
+		{
+			char const* str = nodeElement->Value();
+			if (!str || TIXML_SUCCESS != nodeElement->QueryIntAttribute("id", &intVal))
+			{
+				continue;
 			}
+			if (!strcmp(str, "Node"))
+			{
+				nodeElements[(uint8) intVal] = nodeElement;
+				binaryNodes.erase((uint8) intVal);
+			}
+			else if (!strcmp(str, "NodeRemoved"))
+			{
+				nodeElements.erase((uint8) intVal);
+				binaryNodes.erase((uint8) intVal);
+			}
+			++records;
 		}
+		Log::Write(LogLevel_Info, "Replayed %d Cache Journal records from %s", records, (char const*) (*it)->GetUserData());
+	}
 
-		nodeElement = nodeElement->NextSiblingElement();
+	// Read the nodes
+	for (int i = 0; i < 256; ++i)
+	{
+		uint8 nodeId = (uint8) i;
+		map<uint8, TiXmlElement const*>::iterator it = nodeElements.find(nodeId);
+		map<uint8, uint32>::iterator bit = binaryNodes.find(nodeId);
+		TiXmlElement* decoded = NULL;
+		if (it != nodeElements.end())
+		{
+			nodeElement = it->second;
+		}
+		else if (bit != binaryNodes.end() && (decoded = binary.Decode(bit->second, driverElement)) != NULL)
+		{
+			nodeElement = decoded;
+		}
+		else
+		{
+			continue;
+		}
+
+		Node* node = new Node(m_homeId, nodeId);
+		m_nodes[nodeId] = node;
+
+		Notification* notification = new Notification(Notification::Type_NodeAdded);
+		notification->SetHomeAndNodeIds(m_homeId, nodeId);
+		QueueNotification(notification);
+
+		// Read the rest of the node configuration from the XML
+		node->ReadXML(nodeElement);
+		if (decoded)
+		{
+			driverElement->RemoveChild(decoded);
+		}
 	}
 
 	LG.Unlock();
 
+	for (list<TiXmlDocument*>::iterator it = journals.begin(); it != journals.end(); ++it)
+	{
+		delete *it;
+	}
+
 	// restore the previous state (for now, polling) for the nodes/values just retrieved
 	for (int i = 0; i < 256; i++)
 	{
@@ -759,17 +1075,71 @@ bool Driver::ReadCache()
 // Write ourselves to an XML document
 //-----------------------------------------------------------------------------
 void Driver::WriteCache()
+{
+	CompactCache(true);
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::WriteCache>
+// Record the current state of a single node in the cache journal
+//-----------------------------------------------------------------------------
+void Driver::WriteCache(uint8 const _nodeId)
+{
+	if (!m_homeId || m_exit)
+	{
+		return;
+	}
+
+	{
+		Internal::LockGuard LG(m_nodeMutex);
+		if (Internal::CacheJournal* journal = GetCacheJournal())
+		{
+			// Node::WriteXML adds the node as a child of the element passed in
+			TiXmlElement records("Records");
+			Node* node = m_nodes[_nodeId];
+			if (node && node->GetCurrentQueryStage() >= Node::QueryStage_CacheLoad)
+			{
+				node->WriteXML(&records);
+			}
+			else
+			{
+				// A full save would skip this node as well
+				TiXmlElement* removed = new TiXmlElement("NodeRemoved");
+				removed->SetAttribute("id", _nodeId);
+				records.LinkEndChild(removed);
+			}
+			if (journal->Append(records.FirstChildElement()))
+			{
+				Log::Write(LogLevel_Info, _nodeId, "Cache Journal updated for Node %d", _nodeId);
+				return;
+			}
+		}
+	}
+
+	// Journaling is disabled or failed, so save everything
+	WriteCache();
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::CompactCache>
+// Write a complete snapshot of the network and start a new journal
+//-----------------------------------------------------------------------------
+bool Driver::CompactCache(bool const _wait)
 {
 	char str[32];
 
 	if (!m_homeId)
 	{
 		Log::Write(LogLevel_Warning, "WARNING: Tried to write driver config with no home ID set");
-		return;
+		return true;
 	}
 	if (m_exit) {
 		Log::Write(LogLevel_Info, "Skipping Cache Save as we are shutting down");
-		return;
+		return true;
+	}
+	if (!m_nodeMutex->Lock(_wait))
+	{
+		return false;
 	}
 
 	Log::Write(LogLevel_Info, "Saving Cache");
@@ -806,32 +1176,111 @@ void Driver::WriteCache()
 	snprintf(str, sizeof(str), "%s", m_bIntervalBetweenPolls ? "true" : "false");
 	driverElement->SetAttribute("poll_interval_between", str);
 
+	// Start a new journal while the nodes are locked, so every change after this
+	// point lands in a journal that will be replayed on top of this snapshot
+	Internal::CacheJournal* journal = GetCacheJournal();
+	if (journal)
 	{
-		Internal::LockGuard LG(m_nodeMutex);
+		snprintf(str, sizeof(str), "%u", journal->Rotate());
+		driverElement->SetAttribute("journal_generation", str);
+	}
 
-		for (int i = 0; i < 256; ++i)
+	for (int i = 0; i < 256; ++i)
+	{
+		if (m_nodes[i])
 		{
-			if (m_nodes[i])
+			if (m_nodes[i]->GetCurrentQueryStage() >= Node::QueryStage_CacheLoad)
 			{
-				if (m_nodes[i]->GetCurrentQueryStage() >= Node::QueryStage_CacheLoad)
-				{
-					m_nodes[i]->WriteXML(driverElement);
-					Log::Write(LogLevel_Info, i, "Cache Save for Node %d as its QueryStage_CacheLoad", i);
-				}
-				else
-				{
-					Log::Write(LogLevel_Info, i, "Skipping Cache Save for Node %d as its not past QueryStage_CacheLoad", i);
-				}
+				m_nodes[i]->WriteXML(driverElement);
+				Log::Write(LogLevel_Info, i, "Cache Save for Node %d as its QueryStage_CacheLoad", i);
+			}
+			else
+			{
+				Log::Write(LogLevel_Info, i, "Skipping Cache Save for Node %d as its not past QueryStage_CacheLoad", i);
 			}
 		}
 	}
+	m_nodeMutex->Unlock();
+
 	string userPath;
 	Options::Get()->GetOptionAsString("UserPath", &userPath);
 
-	snprintf(str, sizeof(str), "ozwcache_0x%08x.xml", m_homeId);
-	string filename = userPath + string(str);
+	string format = "xml";
+	Options::Get()->GetOptionAsString("CacheFormat", &format);
+	bool saved;
+	string filename;
+	string otherFilename;
+	if (format == "binary")
+	{
+		snprintf(str, sizeof(str), "ozwcache_0x%08x.bin", m_homeId);
+		filename = userPath + string(str);
+		snprintf(str, sizeof(str), "ozwcache_0x%08x.xml", m_homeId);
+		otherFilename = userPath + string(str);
+		saved = Internal::BinaryCache::Write(driverElement, filename);
+	}
+	else
+	{
+		snprintf(str, sizeof(str), "ozwcache_0x%08x.xml", m_homeId);
+		filename = userPath + string(str);
+		snprintf(str, sizeof(str), "ozwcache_0x%08x.bin", m_homeId);
+		otherFilename = userPath + string(str);
+		saved = doc.SaveFile(filename.c_str());
+	}
+	if (!saved)
+	{
+		Log::Write(LogLevel_Warning, "WARNING: Failed to save cache to %s", filename.c_str());
+	}
+	else
+	{
+		// A snapshot left in the other format is now out of date, and would be loaded if the format was switched back
+		if (Internal::Platform::FileOps::Create()->FileExists(otherFilename))
+		{
+			Log::Write(LogLevel_Info, "Removing the out of date cache %s", otherFilename.c_str());
+			remove(otherFilename.c_str());
+		}
+		if (journal)
+		{
+			journal->Commit();
+		}
+	}
+	return true;
+}
 
-	doc.SaveFile(filename.c_str());
+//-----------------------------------------------------------------------------
+// <Driver::GetCacheJournal>
+// Return the cache journal for the current Home ID
+//-----------------------------------------------------------------------------
+Internal::CacheJournal* Driver::GetCacheJournal()
+{
+	char str[32];
+
+	if (!m_homeId)
+	{
+		return NULL;
+	}
+	if (m_cacheJournal && m_cacheJournal->GetHomeId() != m_homeId)
+	{
+		// The controller was reset
+		delete m_cacheJournal;
+		m_cacheJournal = NULL;
+	}
+	if (!m_cacheJournal)
+	{
+		string userPath;
+		Options::Get()->GetOptionAsString("UserPath", &userPath);
+		snprintf(str, sizeof(str), "ozwcache_0x%08x", m_homeId);
+		m_cacheJournal = new Internal::CacheJournal(this, m_homeId, userPath + string(str));
+	}
+
+	bool enabled = true;
+	Options::Get()->GetOptionAsBool("CacheJournal", &enabled);
+	if (!enabled)
+	{
+		// Make sure a stale journal is never replayed over a newer snapshot
+		m_cacheJournal->Purge();
+		return NULL;
+	}
+	return m_cacheJournal;
 }
 
 //-----------------------------------------------------------------------------
@@ -908,8 +1357,7 @@ void Driver::SendQueryStageComplete(uint8 const _nodeId, Node::QueryStage const
 		// Non-sleeping node
 		Log::Write(LogLevel_Detail, node->GetNodeId(), "Queuing (%s) Query Stage Complete (%s)", c_sendQueueNames[MsgQueue_Query], node->GetQueryStageName(_stage).c_str());
 		m_sendMutex->Lock();
-		m_msgQueue[MsgQueue_Query].push_back(item);
-		m_queueEvent[MsgQueue_Query]->Set();
+		PushMsgQueueItem(item, MsgQueue_Query);
 		m_sendMutex->Unlock();
 
 	}
@@ -952,6 +1400,7 @@ void Driver::SendMsg(Internal::Msg* _msg, MsgQueue const _queue)
 	/* make sure the HomeId is Set on this message */
 	_msg->SetHomeId(m_homeId);
 	_msg->Finalize();
+	bool batch = false;
 	{
 		Internal::LockGuard LG(m_nodeMutex);
 		if (Node* node = GetNode(_msg->GetTargetNodeId()))
@@ -967,6 +1416,13 @@ void Driver::SendMsg(Internal::Msg* _msg, MsgQueue const _queue)
 				}
 			}
 
+			// Wake-up and query traffic can share frames, if the node said it takes MultiCmd encapsulations
+			if (m_multiCmdBatching && ((_queue == MsgQueue_WakeUp) || (_queue == MsgQueue_Query)))
+			{
+				Internal::CC::CommandClass* cc = node->GetCommandClass(Internal::CC::MultiCmd::StaticGetCommandClassId());
+				batch = (cc != NULL) && cc->IsInNIF() && !cc->IsAfterMark() && !cc->IsSecured();
+			}
+
 			// If the message is for a sleeping node, we queue it in the node itself.
 			if (!node->IsListeningDevice())
 			{
@@ -987,7 +1443,10 @@ void Driver::SendMsg(Internal::Msg* _msg, MsgQueue const _queue)
 						}
 						else
 						{
-							Log::Write(LogLevel_Detail, GetNodeNumber(_msg), "Queuing (%s) %s", c_sendQueueNames[MsgQueue_WakeUp], _msg->GetAsString().c_str());
+							if (Log::IsEnabled(LogLevel_Detail))
+							{
+								Log::Write(LogLevel_Detail, GetNodeNumber(_msg), "Queuing (%s) %s", c_sendQueueNames[MsgQueue_WakeUp], _msg->GetAsString().c_str());
+							}
 						}
 						wakeUp->QueueMsg(item);
 						return;
@@ -996,10 +1455,15 @@ void Driver::SendMsg(Internal::Msg* _msg, MsgQueue const _queue)
 			}
 		}
 	}
-	Log::Write(LogLevel_Detail, GetNodeNumber(_msg), "Queuing (%s) %s", c_sendQueueNames[_queue], _msg->GetAsString().c_str());
+	if (Log::IsEnabled(LogLevel_Detail))
+	{
+		Log::Write(LogLevel_Detail, GetNodeNumber(_msg), "Queuing (%s) %s", c_sendQueueNames[_queue], _msg->GetAsString().c_str());
+	}
 	m_sendMutex->Lock();
-	m_msgQueue[_queue].push_back(item);
-	m_queueEvent[_queue]->Set();
+	if (!batch || !BatchMsgQueueItem(item, _queue))
+	{
+		PushMsgQueueItem(item, _queue);
+	}
 	m_sendMutex->Unlock();
 }
 
@@ -1020,6 +1484,7 @@ bool Driver::WriteNextMsg(MsgQueue const _queue)
 		m_currentMsg = item.m_msg;
 		m_currentMsgQueueSource = _queue;
 		m_msgQueue[_queue].pop_front();
+		MsgQueueItemTaken(item, _queue);
 		if (m_msgQueue[_queue].empty())
 		{
 			m_queueEvent[_queue]->Reset();
@@ -1031,9 +1496,13 @@ bool Driver::WriteNextMsg(MsgQueue const _queue)
 			item_new.m_nodeId = item.m_msg->GetTargetNodeId();
 			item_new.m_retry = item.m_retry;
 			item_new.m_msg = new Internal::Msg(*item.m_msg);
+			item_new.m_pinned = true;
+			item_new.m_queued = item.m_queued;
+			item_new.m_deadline = item.m_deadline;
 			m_msgQueue[_queue].push_front(item_new);
 			m_queueEvent[_queue]->Set();
 		}
+		UpdateIdleSignal();
 		m_sendMutex->Unlock();
 		return WriteMsg("WriteNextMsg");
 	}
@@ -1043,10 +1512,12 @@ bool Driver::WriteNextMsg(MsgQueue const _queue)
 		m_currentMsg = NULL;
 		Node::QueryStage stage = item.m_queryStage;
 		m_msgQueue[_queue].pop_front();
+		MsgQueueItemTaken(item, _queue);
 		if (m_msgQueue[_queue].empty())
 		{
 			m_queueEvent[_queue]->Reset();
 		}
+		UpdateIdleSignal();
 		m_sendMutex->Unlock();
 
 		Node* node = GetNodeUnsafe(item.m_nodeId);
@@ -1064,6 +1535,10 @@ bool Driver::WriteNextMsg(MsgQueue const _queue)
 	else if (MsgQueueCmd_Controller == item.m_command)
 	{
 		// Run a multi-step controller command
+		if (m_currentControllerCommand != item.m_cci)
+		{
+			MsgQueueItemTaken(item, _queue);
+		}
 		m_currentControllerCommand = item.m_cci;
 		m_sendMutex->Unlock();
 		// Figure out if done with command
@@ -1109,10 +1584,12 @@ bool Driver::WriteNextMsg(MsgQueue const _queue)
 	else if (MsgQueueCmd_ReloadNode == item.m_command)
 	{
 		m_msgQueue[_queue].pop_front();
+		MsgQueueItemTaken(item, _queue);
 		if (m_msgQueue[_queue].empty())
 		{
 			m_queueEvent[_queue]->Reset();
 		}
+		UpdateIdleSignal();
 		m_sendMutex->Unlock();
 
 		Log::Write(LogLevel_Info, item.m_nodeId, "Reloading Sleeping Node");
@@ -1124,6 +1601,173 @@ bool Driver::WriteNextMsg(MsgQueue const _queue)
 	return false;
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::SelectMsgQueue>
+// Choose the queue to send from next
+//-----------------------------------------------------------------------------
+Driver::MsgQueue Driver::SelectMsgQueue(MsgQueue const _first, uint32 const _count)
+{
+	Internal::LockGuard LG(m_sendMutex);
+	Internal::MsgScheduler::QueueHead heads[MsgQueue_Count];
+	uint32 count = std::min(_count, (uint32) MsgQueue_Count);
+	bool ready = false;
+	for (uint32 i = 0; i < count; ++i)
+	{
+		// A controller command waiting on the controller leaves its item queued, with the event reset
+		heads[i].m_ready = !m_msgQueue[i].empty() && (Internal::Platform::Wait::Single(m_queueEvent[i], 0) == 0);
+		if (heads[i].m_ready && (i == MsgQueue_Query) && m_interviewScheduler->GetAwaitingCount() && !m_msgQueue[i].front().m_pinned)
+		{
+			// Nothing more is sent to a node whose report is awaited
+			list<MsgQueueItem>::iterator it = m_msgQueue[i].begin();
+			while ((it != m_msgQueue[i].end()) && m_interviewScheduler->IsAwaiting(it->GetNodeId()))
+			{
+				++it;
+			}
+			if (it == m_msgQueue[i].end())
+			{
+				// Set again once a report arrives
+				m_queueEvent[i]->Reset();
+				heads[i].m_ready = false;
+			}
+		}
+		if (heads[i].m_ready)
+		{
+			heads[i].m_deadline = m_msgQueue[i].front().m_deadline;
+			ready = true;
+		}
+	}
+	if (!ready)
+	{
+		return MsgQueue_Count;
+	}
+
+	MsgQueue queue = (MsgQueue) m_msgScheduler->Select(heads, count, std::chrono::steady_clock::now());
+	list<MsgQueueItem>& items = m_msgQueue[queue];
+	if (m_msgScheduler->IsFairQueue(queue) && !items.front().m_pinned)
+	{
+		// Serve the next node after the one served last, taking its oldest item.  The
+		// interview scheduler puts the important and the slow nodes first.
+		uint8 last = m_lastQueueNode[queue];
+		list<MsgQueueItem>::iterator next = items.end();
+		for (list<MsgQueueItem>::iterator it = items.begin(); it != items.end(); ++it)
+		{
+			uint8 nodeId = it->GetNodeId();
+			if (queue == MsgQueue_Query)
+			{
+				if (!m_interviewScheduler->IsAwaiting(nodeId) && ((next == items.end()) || m_interviewScheduler->IsBefore(nodeId, next->GetNodeId(), last)))
+				{
+					next = it;
+				}
+			}
+			else if ((next == items.end()) || (Internal::InterviewScheduler::GetTurn(nodeId, last) < Internal::InterviewScheduler::GetTurn(next->GetNodeId(), last)))
+			{
+				next = it;
+			}
+		}
+		items.splice(items.begin(), items, next);
+		m_lastQueueNode[queue] = items.front().GetNodeId();
+	}
+	return queue;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::PushMsgQueueItem>
+// Add an item to the back of a queue, stamped with the time and its deadline
+//-----------------------------------------------------------------------------
+void Driver::PushMsgQueueItem(MsgQueueItem& _item, MsgQueue const _queue)
+{
+	_item.m_queued = std::chrono::steady_clock::now();
+	_item.m_deadline = _item.m_queued + std::chrono::milliseconds(m_msgScheduler->GetDeadline(_queue));
+	m_msgQueue[_queue].push_back(_item);
+	m_queueEvent[_queue]->Set();
+	UpdateIdleSignal();
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::UpdateIdleSignal>
+// Set the idle signal, which the poll thread waits on, from the queues
+//-----------------------------------------------------------------------------
+void Driver::UpdateIdleSignal()
+{
+	// Not once the destructor has started taking the Driver apart
+	if (m_idleSignal == NULL)
+	{
+		return;
+	}
+	Internal::LockGuard LG(m_sendMutex);
+	m_idleSignal->Update(m_msgQueue[MsgQueue_Command].empty() && m_msgQueue[MsgQueue_Send].empty() && m_msgQueue[MsgQueue_Query].empty() && m_msgQueue[MsgQueue_Poll].empty() && (m_currentMsg == NULL));
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::MsgQueueItemTaken>
+// Count an item taken off a queue in the latency histogram for the queue
+//-----------------------------------------------------------------------------
+void Driver::MsgQueueItemTaken(MsgQueueItem const& _item, MsgQueue const _queue)
+{
+	if (_item.m_pinned)
+	{
+		// Requeued while a nonce report went first, and already counted
+		return;
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	m_queueWait[_queue].Record(now - _item.m_queued);
+	if (m_msgScheduler->GetDeadline(_queue) && (now > _item.m_deadline))
+	{
+		++m_queueOverdue[_queue];
+	}
+
+	if ((MsgQueueCmd_SendMsg == _item.m_command) && (_item.m_msg->GetBatchCount() > 1))
+	{
+		// Each frame saved is the framing and acknowledgement of one command, less the
+		// byte the command's length takes in the encapsulation.  Estimated at 40kbit/s.
+		uint32 saved = _item.m_msg->GetBatchCount() - 1;
+		int64 bytes = (int64) saved * c_frameOverheadBytes - 3 - _item.m_msg->GetBatchCount();
+		m_multiCmdFramesSaved += saved;
+		if (bytes > 0)
+		{
+			m_multiCmdAirTimeSaved += (uint64) bytes * c_byteAirTime;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::BatchMsgQueueItem>
+// Add a message to the last one queued for its node, if they can share a frame
+//-----------------------------------------------------------------------------
+bool Driver::BatchMsgQueueItem(MsgQueueItem& _item, MsgQueue const _queue)
+{
+	if ((MsgQueueCmd_SendMsg != _item.m_command) || !_item.m_msg->CanBatch())
+	{
+		return false;
+	}
+
+	// Only the node's last item will do.  Adding to an earlier one would reorder its commands,
+	// and a query stage ends with an item of its own, so batches never span stages.
+	uint8 nodeId = _item.m_msg->GetTargetNodeId();
+	list<MsgQueueItem>& items = m_msgQueue[_queue];
+	for (list<MsgQueueItem>::reverse_iterator it = items.rbegin(); it != items.rend(); ++it)
+	{
+		if (it->GetNodeId() != nodeId)
+		{
+			continue;
+		}
+		if ((MsgQueueCmd_SendMsg != it->m_command) || it->m_pinned || !it->m_msg->Batch(*_item.m_msg, c_multiCmdMaxPayload))
+		{
+			return false;
+		}
+
+		if (Log::IsEnabled(LogLevel_Detail))
+		{
+			Log::Write(LogLevel_Detail, nodeId, "Batched (%s) %s", c_sendQueueNames[_queue], it->m_msg->GetAsString().c_str());
+		}
+		delete _item.m_msg;
+		_item.m_msg = NULL;
+		return true;
+	}
+	return false;
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::WriteMsg>
 // Transmit the current message to the Z-Wave controller
@@ -1210,6 +1854,7 @@ bool Driver::WriteMsg(string const &msg)
 		m_expectedNodeId = m_currentMsg->GetTargetNodeId();
 		m_expectedReply = m_currentMsg->GetExpectedReply();
 		m_waitingForAck = true;
+		m_currentMsgDelivered = false;
 	}
 	string attemptsstr = "";
 	if (attempts > 1)
@@ -1235,7 +1880,10 @@ bool Driver::WriteMsg(string const &msg)
 	{
 		if (m_currentMsg->isNonceRecieved())
 		{
-			Log::Write(LogLevel_Info, nodeId, "Processing (%s) Encrypted message (%sCallback ID=0x%.2x, Expected Reply=0x%.2x) - %s", c_sendQueueNames[m_currentMsgQueueSource], attemptsstr.c_str(), m_expectedCallbackId, m_expectedReply, m_currentMsg->GetAsString().c_str());
+			if (Log::IsEnabled(LogLevel_Info))
+			{
+				Log::Write(LogLevel_Info, nodeId, "Processing (%s) Encrypted message (%sCallback ID=0x%.2x, Expected Reply=0x%.2x) - %s", c_sendQueueNames[m_currentMsgQueueSource], attemptsstr.c_str(), m_expectedCallbackId, m_expectedReply, m_currentMsg->GetAsString().c_str());
+			}
 			SendEncryptedMessage();
 		}
 		else
@@ -1246,7 +1894,10 @@ bool Driver::WriteMsg(string const &msg)
 	}
 	else
 	{
-		Log::Write(LogLevel_Info, nodeId, "Sending (%s) message (%sCallback ID=0x%.2x, Expected Reply=0x%.2x) - %s", c_sendQueueNames[m_currentMsgQueueSource], attemptsstr.c_str(), m_expectedCallbackId, m_expectedReply, m_currentMsg->GetAsString().c_str());
+		if (Log::IsEnabled(LogLevel_Info))
+		{
+			Log::Write(LogLevel_Info, nodeId, "Sending (%s) message (%sCallback ID=0x%.2x, Expected Reply=0x%.2x) - %s", c_sendQueueNames[m_currentMsgQueueSource], attemptsstr.c_str(), m_expectedCallbackId, m_expectedReply, m_currentMsg->GetAsString().c_str());
+		}
 		uint32 bytesWritten = m_controller->Write(m_currentMsg->GetBuffer(), m_currentMsg->GetLength());
 
 		if (bytesWritten == 0)
@@ -1264,6 +1915,7 @@ bool Driver::WriteMsg(string const &msg)
 		}
 	}
 	m_writeCnt++;
+	m_writeTime = std::chrono::steady_clock::now();
 
 	if (nodeId == 0xff)
 	{
@@ -1275,6 +1927,7 @@ bool Driver::WriteMsg(string const &msg)
 		{
 			node->m_sentCnt++;
 			node->m_sentTS.SetTime();
+			node->m_sentTime = m_writeTime;
 			if (m_expectedReply == FUNC_ID_APPLICATION_COMMAND_HANDLER)
 			{
 				Internal::CC::CommandClass *cc = node->GetCommandClass(m_expectedCommandClassId);
@@ -1299,6 +1952,7 @@ void Driver::RemoveCurrentMsg()
 	{
 		delete m_currentMsg;
 		m_currentMsg = NULL;
+		UpdateIdleSignal();
 	}
 
 	m_expectedCallbackId = 0;
@@ -1306,6 +1960,7 @@ void Driver::RemoveCurrentMsg()
 	m_expectedNodeId = 0;
 	m_expectedReply = 0;
 	m_waitingForAck = false;
+	m_currentMsgDelivered = false;
 	m_nonceReportSent = 0;
 	m_nonceReportSentAttempt = 0;
 }
@@ -1439,6 +2094,7 @@ bool Driver::MoveMessagesToWakeUpQueue(uint8 const _targetNodeId, bool const _mo
 							m_queueEvent[i]->Reset();
 						}
 					}
+					UpdateIdleSignal();
 
 					if (m_currentControllerCommand)
 					{
@@ -1448,13 +2104,12 @@ bool Driver::MoveMessagesToWakeUpQueue(uint8 const _targetNodeId, bool const _mo
 						item.m_command = MsgQueueCmd_Controller;
 						item.m_cci = new ControllerCommandItem(*m_currentControllerCommand);
 						m_currentControllerCommand = item.m_cci;
-						m_msgQueue[MsgQueue_Controller].push_back(item);
-						m_queueEvent[MsgQueue_Controller]->Set();
+						PushMsgQueueItem(item, MsgQueue_Controller);
 					}
 
 					m_sendMutex->Unlock();
 
-					CheckCompletedNodeQueries();
+					CheckCompletedNodeQueries(_targetNodeId);
 
 					// Move completed successfully
 					return true;
@@ -1525,7 +2180,7 @@ bool Driver::HandleErrorResponse(uint8 const _error, uint8 const _nodeId, char c
 // <Driver::CheckCompletedNodeQueries>
 // Identify controller (as opposed to node) commands...especially blocking ones
 //-----------------------------------------------------------------------------
-void Driver::CheckCompletedNodeQueries()
+void Driver::CheckCompletedNodeQueries(uint8 const _nodeId)
 {
 	Log::Write(LogLevel_Warning, "CheckCompletedNodeQueries m_allNodesQueried=%d m_awakeNodesQueried=%d", m_allNodesQueried, m_awakeNodesQueried);
 	if (!m_allNodesQueried)
@@ -1552,6 +2207,11 @@ void Driver::CheckCompletedNodeQueries()
 						{
 							sleepingOnly = false;
 						}
+						if (!sleepingOnly || m_awakeNodesQueried)
+						{
+							// Nothing more to learn from the rest, as no notification is due yet
+							break;
+						}
 					}
 				}
 			}
@@ -1578,6 +2238,8 @@ void Driver::CheckCompletedNodeQueries()
 			}
 			m_awakeNodesQueried = true;
 			m_allNodesQueried = true;
+			m_allNodesQueriedTime = (uint32) -m_openedTime.TimeRemaining();
+			Log::Write(LogLevel_Info, "         Nodes queried in %d seconds.", m_allNodesQueriedTime / 1000);
 		}
 		else if (sleepingOnly)
 		{
@@ -1592,7 +2254,146 @@ void Driver::CheckCompletedNodeQueries()
 			}
 		}
 	}
-	WriteCache();
+	WriteCache(_nodeId);
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::AwaitReport>
+// Hand the current query over to the interview scheduler to wait for its report
+//-----------------------------------------------------------------------------
+bool Driver::AwaitReport()
+{
+	// Only plain queries to nodes that are always listening, once the node has acknowledged them
+	if ((m_currentMsg == NULL) || !m_currentMsgDelivered || m_waitingForAck || m_expectedCallbackId)
+	{
+		return false;
+	}
+	if ((m_currentMsgQueueSource != MsgQueue_Query) || !m_msgScheduler->IsFairQueue(MsgQueue_Query) || (m_currentControllerCommand != NULL))
+	{
+		return false;
+	}
+	if ((m_expectedReply != FUNC_ID_APPLICATION_COMMAND_HANDLER) || !m_expectedCommandClassId || m_currentMsg->isEncrypted() || m_nonceReportSent)
+	{
+		return false;
+	}
+	uint8 nodeId = m_currentMsg->GetTargetNodeId();
+	Node* node = GetNodeUnsafe(nodeId);
+	if ((node == NULL) || !node->IsListeningDevice())
+	{
+		return false;
+	}
+
+	Internal::LockGuard LG(m_sendMutex);
+	if (!m_interviewScheduler->CanAwait())
+	{
+		return false;
+	}
+	Log::Write(LogLevel_Detail, nodeId, "  Awaiting the report while other nodes are queried");
+	m_interviewScheduler->Await(m_currentMsg, MsgQueue_Query, std::chrono::steady_clock::now() + std::chrono::milliseconds(m_retryTimeout));
+	m_currentMsg = NULL;
+	m_expectedCallbackId = 0;
+	m_expectedCommandClassId = 0;
+	m_expectedNodeId = 0;
+	m_expectedReply = 0;
+	m_waitingForAck = false;
+	m_currentMsgDelivered = false;
+	UpdateIdleSignal();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::AwaitedReportReceived>
+// Release the query a report answers, if its report was being awaited
+//-----------------------------------------------------------------------------
+bool Driver::AwaitedReportReceived(uint8 const _nodeId, uint8 const* _data, uint32 const _length)
+{
+	Internal::LockGuard LG(m_sendMutex);
+	Internal::Msg* msg = m_interviewScheduler->ReportReceived(_nodeId, _data, _length);
+	if (msg == NULL)
+	{
+		return false;
+	}
+
+	Log::Write(LogLevel_Detail, _nodeId, "  Awaited report was received");
+	if (m_notifytransactions)
+	{
+		Notification* notification = new Notification(Notification::Type_Notification);
+		notification->SetHomeAndNodeIds(m_homeId, _nodeId);
+		notification->SetNotification(Notification::Code_MsgComplete);
+		QueueNotification(notification);
+	}
+	delete msg;
+
+	// The node's next queries can go now.  So can the next node's, if the current query
+	// was only held up because the pipeline was full.
+	if (!m_msgQueue[MsgQueue_Query].empty())
+	{
+		m_queueEvent[MsgQueue_Query]->Set();
+	}
+	AwaitReport();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::ExpireAwaitedReports>
+// Queue again the queries whose reports have not arrived in time
+//-----------------------------------------------------------------------------
+void Driver::ExpireAwaitedReports()
+{
+	Internal::LockGuard LG(m_sendMutex);
+	if (!m_interviewScheduler->GetAwaitingCount())
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	uint32 queue;
+	while (Internal::Msg* msg = m_interviewScheduler->TakeExpired(now, &queue))
+	{
+		Log::Write(LogLevel_Info, msg->GetTargetNodeId(), "Timed out awaiting the report to %s", msg->GetAsString().c_str());
+		Notification* notification = new Notification(Notification::Type_Notification);
+		notification->SetHomeAndNodeIds(m_homeId, msg->GetTargetNodeId());
+		notification->SetNotification(Notification::Code_Timeout);
+		QueueNotification(notification);
+
+		// Sent again ahead of the node's other queries, or dropped by WriteMsg once it has had all its attempts
+		MsgQueueItem item;
+		item.m_command = MsgQueueCmd_SendMsg;
+		item.m_nodeId = msg->GetTargetNodeId();
+		item.m_msg = msg;
+		item.m_pinned = true;
+		item.m_queued = now;
+		item.m_deadline = now;
+		m_msgQueue[queue].push_front(item);
+		m_queueEvent[queue]->Set();
+	}
+	UpdateIdleSignal();
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetAwaitTimeout>
+// Milliseconds until the next awaited report times out
+//-----------------------------------------------------------------------------
+int32 Driver::GetAwaitTimeout()
+{
+	Internal::LockGuard LG(m_sendMutex);
+	std::chrono::steady_clock::time_point deadline;
+	if (!m_interviewScheduler->GetNextDeadline(&deadline))
+	{
+		return Internal::Platform::Wait::Timeout_Infinite;
+	}
+	int64 timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+	return (timeout > 0) ? (int32) timeout + 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::UpdateNodeLatency>
+// Tell the interview scheduler how long a node takes to answer
+//-----------------------------------------------------------------------------
+void Driver::UpdateNodeLatency(Node const* _node)
+{
+	Internal::LockGuard LG(m_sendMutex);
+	m_interviewScheduler->SetLatency(_node->GetNodeId(), _node->m_averageResponseRTT ? _node->m_averageResponseRTT : _node->m_averageRequestRTT);
 }
 
 //-----------------------------------------------------------------------------
@@ -1626,175 +2427,213 @@ bool Driver::IsExpectedReply(const uint8 _nodeId)
 
 //-----------------------------------------------------------------------------
 // <Driver::ReadMsg>
-// Read data from the serial port
+// Read and process every frame waiting in the controller's buffer
 //-----------------------------------------------------------------------------
 bool Driver::ReadMsg()
 {
-	uint8 buffer[1024];
-
-	memset(buffer, 0, sizeof(uint8) * 1024);
-
-	if (!m_controller->Read(buffer, 1))
+	// Take everything the controller has buffered in one go.  During report storms
+	// this is usually several frames, which are all handled before returning.
+	uint32 length = m_controller->GetAvailable(m_readBuffer, sizeof(m_readBuffer));
+	if (!length)
 	{
 		// Nothing to read
 		return false;
 	}
 
-	switch (buffer[0])
+	uint32 pos = 0;
+	while (pos < length)
 	{
-		case SOF:
+		switch (m_readBuffer[pos])
 		{
-			m_SOFCnt++;
-			if (m_waitingForAck)
+			case SOF:
 			{
-				// This can happen on any normal network when a transmission overlaps an unexpected
-				// reception and the data in the buffer doesn't contain the ACK. The controller will
-				// notice and send us a CAN to retransmit.
-				Log::Write(LogLevel_Detail, "Unsolicited message received while waiting for ACK.");
-				m_ACKWaiting++;
-			}
+				m_SOFCnt++;
+				if (m_waitingForAck)
+				{
+					// This can happen on any normal network when a transmission overlaps an unexpected
+					// reception and the data in the buffer doesn't contain the ACK. The controller will
+					// notice and send us a CAN to retransmit.
+					Log::Write(LogLevel_Detail, "Unsolicited message received while waiting for ACK.");
+					m_ACKWaiting++;
+				}
 
-			// Read the length byte.  Keep trying until we get it.
-			m_controller->SetSignalThreshold(1);
-			int32 response = Internal::Platform::Wait::Single(m_controller, 50);
-			if (response < 0)
-			{
-				Log::Write(LogLevel_Warning, "WARNING: 50ms passed without finding the length byte...aborting frame read");
-				m_readAborts++;
-				break;
-			}
-			/* this is the size of the packet */
-			m_controller->Read(&buffer[1], 1);
-			m_controller->SetSignalThreshold(buffer[1]);
-			if (Internal::Platform::Wait::Single(m_controller, 500) < 0)
-			{
-				Log::Write(LogLevel_Warning, "WARNING: 500ms passed without reading the rest of the frame...aborting frame read");
-				m_readAborts++;
-				m_controller->SetSignalThreshold(1);
-				break;
-			}
+				if (!ReadFrame(pos, length))
+				{
+					// The frame was cut short, so drop what we have of it
+					return true;
+				}
 
-			m_controller->Read(&buffer[2], buffer[1]);
-			m_controller->SetSignalThreshold(1);
+				uint8* buffer = &m_readBuffer[pos];
+				uint32 frameLength = buffer[1] + 2;
 
-			uint32 length = buffer[1] + 2;
+				// Log the data
+				uint8 nodeId = NodeFromMessage(buffer);
+				if (nodeId == 0)
+				{
+					nodeId = GetNodeNumber(m_currentMsg);
+				}
+				if (Log::IsEnabled(LogLevel_Detail))
+				{
+					Log::Write(LogLevel_Detail, nodeId, "  Received: %s", Internal::PktToString(buffer, frameLength).c_str());
+				}
 
-			// Log the data
-			string str = "";
-			for (uint32 i = 0; i < length; ++i)
-			{
-				if (i)
+				// Verify checksum
+				uint8 checksum = 0xff;
+				for (uint32 i = 1; i < (frameLength - 1); ++i)
 				{
-					str += ", ";
+					checksum ^= buffer[i];
 				}
 
-				char byteStr[8];
-				snprintf(byteStr, sizeof(byteStr), "0x%.2x", buffer[i]);
-				str += byteStr;
+				if (buffer[frameLength - 1] != checksum)
+				{
+					Log::Write(LogLevel_Warning, nodeId, "WARNING: Checksum incorrect - sending NAK");
+					m_badChecksum++;
+					uint8 nak = NAK;
+					m_controller->Write(&nak, 1);
+					m_controller->Purge();
+					return true;
+				}
+
+				// Checksum correct - send ACK
+				uint8 ack = ACK;
+				m_controller->Write(&ack, 1);
+				m_readCnt++;
+
+				// Process the received message
+				pos += frameLength;
+				ProcessMsg(&buffer[2], frameLength - 2);
+				break;
 			}
-			uint8 nodeId = NodeFromMessage(buffer);
-			if (nodeId == 0)
+
+			case CAN:
 			{
-				nodeId = GetNodeNumber(m_currentMsg);
+				// This is the other side of an unsolicited ACK. As mentioned there if we receive a message
+				// just after we transmitted one, the controller will notice and tell us to retransmit here.
+				// Don't increment the transmission counter as it is possible the message will never get out
+				// on very busy networks with lots of unsolicited messages being received. Increase the amount
+				// of retries but only up to a limit so we don't stay here forever.
+				Log::Write(LogLevel_Detail, GetNodeNumber(m_currentMsg), "CAN received...triggering resend");
+				m_CANCnt++;
+				if (m_currentMsg != NULL)
+				{
+					m_currentMsg->SetMaxSendAttempts(m_currentMsg->GetMaxSendAttempts() + 1);
+					m_currentMsg->setResendDuetoCANorNAK();
+				}
+				else
+				{
+					Log::Write(LogLevel_Warning, "m_currentMsg was NULL when trying to set MaxSendAttempts");
+					Log::QueueDump();
+				}
+				// Don't do WriteMsg("CAN"); here, the controller has data waiting to be handled by OZW.
+				// Instead, let the main loop handle incoming message first to flush the buffer(s)
+				pos++;
+				break;
 			}
-			Log::Write(LogLevel_Detail, nodeId, "  Received: %s", str.c_str());
 
-			// Verify checksum
-			uint8 checksum = 0xff;
-			for (uint32 i = 1; i < (length - 1); ++i)
+			case NAK:
 			{
-				checksum ^= buffer[i];
+				Log::Write(LogLevel_Warning, GetNodeNumber(m_currentMsg), "WARNING: NAK received...triggering resend");
+				m_currentMsg->SetMaxSendAttempts(m_currentMsg->GetMaxSendAttempts() + 1);
+				m_currentMsg->setResendDuetoCANorNAK();
+				m_NAKCnt++;
+				//WriteMsg("NAK");
+				pos++;
+				break;
 			}
 
-			if (buffer[length - 1] == checksum)
+			case ACK:
 			{
-				// Checksum correct - send ACK
-				uint8 ack = ACK;
-				m_controller->Write(&ack, 1);
-				m_readCnt++;
-
-				// Process the received message
-				ProcessMsg(&buffer[2], length - 2);
+				m_ACKCnt++;
+				m_waitingForAck = false;
+				if (m_currentMsg == NULL)
+				{
+					Log::Write(LogLevel_StreamDetail, 255, "  ACK received");
+				}
+				else
+				{
+					m_sendToAck.RecordSince(m_writeTime);
+					Log::Write(LogLevel_StreamDetail, GetNodeNumber(m_currentMsg), "  ACK received CallbackId 0x%.2x Reply 0x%.2x", m_expectedCallbackId, m_expectedReply);
+					if ((0 == m_expectedCallbackId) && (0 == m_expectedReply))
+					{
+						// Remove the message from the queue, now that it has been acknowledged.
+						RemoveCurrentMsg();
+					}
+				}
+				pos++;
+				break;
 			}
-			else
+
+			default:
 			{
-				Log::Write(LogLevel_Warning, nodeId, "WARNING: Checksum incorrect - sending NAK");
-				m_badChecksum++;
+				Log::Write(LogLevel_Warning, "WARNING: Out of frame flow! (0x%.2x).  Sending NAK.", m_readBuffer[pos]);
+				m_OOFCnt++;
 				uint8 nak = NAK;
 				m_controller->Write(&nak, 1);
 				m_controller->Purge();
+				return true;
 			}
-			break;
 		}
+	}
 
-		case CAN:
-		{
-			// This is the other side of an unsolicited ACK. As mentioned there if we receive a message
-			// just after we transmitted one, the controller will notice and tell us to retransmit here.
-			// Don't increment the transmission counter as it is possible the message will never get out
-			// on very busy networks with lots of unsolicited messages being received. Increase the amount
-			// of retries but only up to a limit so we don't stay here forever.
-			Log::Write(LogLevel_Detail, GetNodeNumber(m_currentMsg), "CAN received...triggering resend");
-			m_CANCnt++;
-			if (m_currentMsg != NULL)
-			{
-				m_currentMsg->SetMaxSendAttempts(m_currentMsg->GetMaxSendAttempts() + 1);
-				m_currentMsg->setResendDuetoCANorNAK();
-			}
-			else
-			{
-				Log::Write(LogLevel_Warning, "m_currentMsg was NULL when trying to set MaxSendAttempts");
-				Log::QueueDump();
-			}
-			// Don't do WriteMsg("CAN"); here, the controller has data waiting to be handled by OZW.
-			// Instead, let the main loop handle incoming message first to flush the buffer(s)
-			break;
-		}
+	return true;
+}
 
-		case NAK:
-		{
-			Log::Write(LogLevel_Warning, GetNodeNumber(m_currentMsg), "WARNING: NAK received...triggering resend");
-			m_currentMsg->SetMaxSendAttempts(m_currentMsg->GetMaxSendAttempts() + 1);
-			m_currentMsg->setResendDuetoCANorNAK();
-			m_NAKCnt++;
-			//WriteMsg("NAK");
-			break;
-		}
+//-----------------------------------------------------------------------------
+// <Driver::ReadFrame>
+// Make sure the whole of the frame starting at _pos is in the read buffer
+//-----------------------------------------------------------------------------
+bool Driver::ReadFrame(uint32& _pos, uint32& _length)
+{
+	uint32 available = _length - _pos;
+	if ((available >= 2) && (available >= (uint32) (m_readBuffer[_pos + 1] + 2)))
+	{
+		return true;
+	}
 
-		case ACK:
-		{
-			m_ACKCnt++;
-			m_waitingForAck = false;
-			if (m_currentMsg == NULL)
-			{
-				Log::Write(LogLevel_StreamDetail, 255, "  ACK received");
-			}
-			else
-			{
-				Log::Write(LogLevel_StreamDetail, GetNodeNumber(m_currentMsg), "  ACK received CallbackId 0x%.2x Reply 0x%.2x", m_expectedCallbackId, m_expectedReply);
-				if ((0 == m_expectedCallbackId) && (0 == m_expectedReply))
-				{
-					// Remove the message from the queue, now that it has been acknowledged.
-					RemoveCurrentMsg();
-				}
-			}
-			break;
-		}
+	// Move the partial frame to the start of the buffer, to make room for the rest of it
+	memmove(m_readBuffer, &m_readBuffer[_pos], available);
+	_pos = 0;
+	_length = available;
 
-		default:
-		{
-			Log::Write(LogLevel_Warning, "WARNING: Out of frame flow! (0x%.2x).  Sending NAK.", buffer[0]);
-			m_OOFCnt++;
-			uint8 nak = NAK;
-			m_controller->Write(&nak, 1);
-			m_controller->Purge();
-			break;
-		}
+	// Read the length byte.  Keep trying until we get it.
+	if (!ReadMsgBytes(_length, 2, 50))
+	{
+		Log::Write(LogLevel_Warning, "WARNING: 50ms passed without finding the length byte...aborting frame read");
+		m_readAborts++;
+		return false;
 	}
 
+	/* this is the size of the packet */
+	if (!ReadMsgBytes(_length, m_readBuffer[1] + 2, 500))
+	{
+		Log::Write(LogLevel_Warning, "WARNING: 500ms passed without reading the rest of the frame...aborting frame read");
+		m_readAborts++;
+		return false;
+	}
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::ReadMsgBytes>
+// Wait until the read buffer holds at least _size bytes
+//-----------------------------------------------------------------------------
+bool Driver::ReadMsgBytes(uint32& _length, uint32 _size, int32 _timeout)
+{
+	if (_length >= _size)
+	{
+		return true;
+	}
+
+	m_controller->SetSignalThreshold(_size - _length);
+	bool res = (Internal::Platform::Wait::Single(m_controller, _timeout) >= 0);
+	m_controller->SetSignalThreshold(1);
+	if (res)
+	{
+		_length += m_controller->GetAvailable(&m_readBuffer[_length], sizeof(m_readBuffer) - _length);
+	}
+	return res;
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::ProcessMsg>
 // Process data received from the Z-Wave PC interface
@@ -2376,6 +3215,12 @@ void Driver::ProcessMsg(uint8* _data, uint8 _length)
 				{
 					Log::Write(LogLevel_Detail, GetNodeNumber(m_currentMsg), "  Expected callbackId was received");
 					m_expectedCallbackId = 0;
+					m_currentMsgDelivered = (_data[1] == FUNC_ID_ZW_SEND_DATA) && (_data[3] == TRANSMIT_COMPLETE_OK);
+					if (AwaitReport())
+					{
+						// The node has the query, and its report is awaited while the next message is sent
+						return;
+					}
 				}
 				else if (_data[2] == 0x02 || _data[2] == 0x01)
 				{
@@ -2389,7 +3234,20 @@ void Driver::ProcessMsg(uint8* _data, uint8 _length)
 				{
 					if (m_expectedCommandClassId && (m_expectedReply == FUNC_ID_APPLICATION_COMMAND_HANDLER))
 					{
-						if (m_expectedCallbackId == 0 && m_expectedCommandClassId == _data[5] && m_expectedNodeId == _data[3])
+						bool received = false;
+						if (m_expectedCallbackId == 0 && m_expectedNodeId == _data[3])
+						{
+							if (m_currentMsg && m_currentMsg->GetBatchCount())
+							{
+								// A MultiCmd encapsulation waits for the reports to each of its commands
+								received = m_currentMsg->BatchReportReceived(&_data[5], _data[4]);
+							}
+							else
+							{
+								received = (m_expectedCommandClassId == _data[5]);
+							}
+						}
+						if (received)
 						{
 							Log::Write(LogLevel_Detail, _data[3], "  Expected reply and command class was received");
 							m_waitingForAck = false;
@@ -2741,6 +3599,11 @@ void Driver::HandleSerialAPIGetInitDataResponse(uint8* _data)
 		// all the code handling notifications will go awry).
 		Manager::Get()->SetDriverReady(this, true);
 
+		if (m_metricsThread)
+		{
+			m_metricsThread->Start(Driver::MetricsThreadEntryPoint, this);
+		}
+
 		// Read the config file first, to get the last known state
 		ReadCache();
 	}
@@ -3098,6 +3961,7 @@ void Driver::HandleSendDataRequest(uint8* _data, uint8 _length, bool _replicatio
 			}
 			else
 			{
+				m_sendToCallback.RecordSince(m_writeTime);
 				node->m_lastRequestRTT = -node->m_sentTS.TimeRemaining();
 
 				if (node->m_averageRequestRTT)
@@ -3111,6 +3975,7 @@ void Driver::HandleSendDataRequest(uint8* _data, uint8 _length, bool _replicatio
 					node->m_averageRequestRTT = node->m_lastRequestRTT;
 				}
 				Log::Write(LogLevel_Info, nodeId, "Request RTT %d Average Request RTT %d", node->m_lastRequestRTT, node->m_averageRequestRTT);
+				UpdateNodeLatency(node);
 			}
 			/* if the frame has txStatus message, then extract it */
 			// petergebruers, changed test (_length > 7) to >= 23 to avoid extracting non-existent data, highest is _data[22]
@@ -3340,7 +4205,7 @@ void Driver::HandleRemoveNodeFromNetworkRequest(uint8* _data)
 			{
 				m_currentControllerCommand->m_controllerCommandNode = _data[4];
 			}
-			WriteCache();
+			WriteCache(m_currentControllerCommand->m_controllerCommandNode);
 			Log::Write(LogLevel_Info, "Removing controller ID %d", m_currentControllerCommand->m_controllerCommandNode);
 			break;
 		}
@@ -3369,7 +4234,7 @@ void Driver::HandleRemoveNodeFromNetworkRequest(uint8* _data)
 						delete m_nodes[m_currentControllerCommand->m_controllerCommandNode];
 						m_nodes[m_currentControllerCommand->m_controllerCommandNode] = NULL;
 					}
-					WriteCache();
+					WriteCache(m_currentControllerCommand->m_controllerCommandNode);
 					Notification* notification = new Notification(Notification::Type_NodeRemoved);
 					notification->SetHomeAndNodeIds(m_homeId, m_currentControllerCommand->m_controllerCommandNode);
 					QueueNotification(notification);
@@ -3506,7 +4371,7 @@ void Driver::HandleRemoveFailedNodeRequest(uint8* _data)
 				delete m_nodes[m_currentControllerCommand->m_controllerCommandNode];
 				m_nodes[m_currentControllerCommand->m_controllerCommandNode] = NULL;
 			}
-			WriteCache();
+			WriteCache(m_currentControllerCommand->m_controllerCommandNode);
 			Notification* notification = new Notification(Notification::Type_NodeRemoved);
 			notification->SetHomeAndNodeIds(m_homeId, m_currentControllerCommand->m_controllerCommandNode);
 			QueueNotification(notification);
@@ -3555,8 +4420,8 @@ void Driver::HandleReplaceFailedNodeRequest(uint8* _data)
 			if (m_currentControllerCommand != NULL)
 			{
 				InitNode(m_currentControllerCommand->m_controllerCommandNode, true);
+				WriteCache(m_currentControllerCommand->m_controllerCommandNode);
 			}
-			WriteCache();
 			break;
 		}
 		case FAILED_NODE_REPLACE_FAILED:
@@ -3605,7 +4470,9 @@ void Driver::HandleApplicationCommandHandlerRequest(uint8* _data, bool encrypted
 			memcpy(node->m_lastReceivedMessage, _data, sizeof(node->m_lastReceivedMessage));
 		}
 		node->m_receivedTS.SetTime();
-		if (m_expectedReply == FUNC_ID_APPLICATION_COMMAND_HANDLER && m_expectedNodeId == nodeId)
+		bool expected = (m_expectedReply == FUNC_ID_APPLICATION_COMMAND_HANDLER && m_expectedNodeId == nodeId);
+		bool awaited = AwaitedReportReceived(nodeId, &_data[5], _data[4]);
+		if (expected || awaited)
 		{
 			// Need to confirm this is the correct response to the last sent request.
 			// At least ignore any received messages prior to the send data request.
@@ -3622,6 +4489,8 @@ void Driver::HandleApplicationCommandHandlerRequest(uint8* _data, bool encrypted
 				node->m_averageResponseRTT = node->m_lastResponseRTT;
 			}
 			Log::Write(LogLevel_Info, nodeId, "Response RTT %d Average Response RTT %d", node->m_lastResponseRTT, node->m_averageResponseRTT);
+			UpdateNodeLatency(node);
+			ReportReceived(node, _data[5]);
 		}
 		else
 		{
@@ -4050,65 +4919,53 @@ void Driver::CommonAddNodeStatusRequestHandler(uint8 _funcId, uint8* _data)
 //-----------------------------------------------------------------------------
 bool Driver::EnablePoll(ValueID const &_valueId, uint8 const _intensity)
 {
-	// make sure the polling thread doesn't lock the node while we're in this function
-	m_pollMutex->Lock();
-
-	// confirm that this node exists
+	// The poll mutex is never held while the node mutex is taken, so look the value up first
 	uint8 nodeId = _valueId.GetNodeId();
-	Internal::LockGuard LG(m_nodeMutex);
-	Node* node = GetNode(nodeId);
-	if (node != NULL)
+	int32 interval;
 	{
-		// confirm that this value is in the node's value store
-		if (Internal::VC::Value* value = node->GetValue(_valueId))
+		Internal::LockGuard LG(m_nodeMutex);
+		Node* node = GetNode(nodeId);
+		if (node == NULL)
 		{
-			// update the value's pollIntensity
-			value->SetPollIntensity(_intensity);
+			Log::Write(LogLevel_Info, "EnablePoll failed - node %d not found", nodeId);
+			return false;
+		}
 
-			// Add the valueid to the polling list
-			// See if the node is already in the poll list.
-			for (list<PollEntry>::iterator it = m_pollList.begin(); it != m_pollList.end(); ++it)
-			{
-				if ((*it).m_id == _valueId)
-				{
-					// It is already in the poll list, so we have nothing to do.
-					Log::Write(LogLevel_Detail, "EnablePoll not required to do anything (value is already in the poll list)");
-					value->Release();
-					m_pollMutex->Unlock();
-					return true;
-				}
-			}
+		// confirm that this value is in the node's value store
+		Internal::VC::Value* value = node->GetValue(_valueId);
+		if (value == NULL)
+		{
+			Log::Write(LogLevel_Info, nodeId, "EnablePoll failed - value not found for node %d", nodeId);
+			return false;
+		}
 
-			// Not in the list, so we add it
-			PollEntry pe;
-			pe.m_id = _valueId;
-			pe.m_pollCounter = value->GetPollIntensity();
-			m_pollList.push_back(pe);
-			value->Release();
-			m_pollMutex->Unlock();
+		// update the value's pollIntensity
+		value->SetPollIntensity(_intensity);
+		interval = value->GetPollInterval();
+		value->Release();
+	}
 
-			// send notification to indicate polling is enabled
-			Notification* notification = new Notification(Notification::Type_PollingEnabled);
-			notification->SetHomeAndNodeIds(m_homeId, _valueId.GetNodeId());
-			notification->SetValueId(_valueId);
-			QueueNotification(notification);
-			Log::Write(LogLevel_Info, nodeId, "EnablePoll for HomeID 0x%.8x, value(cc=0x%02x,in=0x%02x,id=0x%02x)--poll list has %d items", _valueId.GetHomeId(), _valueId.GetCommandClassId(), _valueId.GetIndex(), _valueId.GetInstance(), m_pollList.size());
-			WriteCache();
+	// Add the valueid to the poll scheduler, unless it is already there
+	uint32 count;
+	{
+		Internal::LockGuard LG(m_pollMutex);
+		if (!m_pollScheduler->Add(_valueId, _intensity, interval, Internal::PollScheduler::Clock::now()))
+		{
+			m_pollScheduler->SetIntensity(_valueId, _intensity);
+			Log::Write(LogLevel_Detail, "EnablePoll not required to do anything (value is already in the poll list)");
 			return true;
 		}
-
-		// allow the poll thread to continue
-		m_pollMutex->Unlock();
-
-		Log::Write(LogLevel_Info, nodeId, "EnablePoll failed - value not found for node %d", nodeId);
-		return false;
+		count = m_pollScheduler->GetCount();
 	}
 
-	// allow the poll thread to continue
-	m_pollMutex->Unlock();
-
-	Log::Write(LogLevel_Info, "EnablePoll failed - node %d not found", nodeId);
-	return false;
+	// send notification to indicate polling is enabled
+	Notification* notification = new Notification(Notification::Type_PollingEnabled);
+	notification->SetHomeAndNodeIds(m_homeId, _valueId.GetNodeId());
+	notification->SetValueId(_valueId);
+	QueueNotification(notification);
+	Log::Write(LogLevel_Info, nodeId, "EnablePoll for HomeID 0x%.8x, value(cc=0x%02x,in=0x%02x,id=0x%02x)--poll list has %d items", _valueId.GetHomeId(), _valueId.GetCommandClassId(), _valueId.GetIndex(), _valueId.GetInstance(), count);
+	WriteCache(_valueId.GetNodeId());
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -4117,54 +4974,42 @@ bool Driver::EnablePoll(ValueID const &_valueId, uint8 const _intensity)
 //-----------------------------------------------------------------------------
 bool Driver::DisablePoll(ValueID const &_valueId)
 {
-	// make sure the polling thread doesn't lock the node while we're in this function
-	m_pollMutex->Lock();
-
-	// confirm that this node exists
 	uint8 nodeId = _valueId.GetNodeId();
 	Internal::LockGuard LG(m_nodeMutex);
 	Node* node = GetNode(nodeId);
-	if (node != NULL)
+	if (node == NULL)
 	{
-		// See if the value is already in the poll list.
-		for (list<PollEntry>::iterator it = m_pollList.begin(); it != m_pollList.end(); ++it)
-		{
-			if ((*it).m_id == _valueId)
-			{
-				// Found it
-				// remove it from the poll list
-				m_pollList.erase(it);
+		Log::Write(LogLevel_Info, "DisablePoll failed - node %d not found", nodeId);
+		return false;
+	}
 
-				// get the value object and reset pollIntensity to zero (indicating no polling)
-				Internal::VC::Value* value = GetValue(_valueId);
-				if (!value)
-					continue;
-				value->SetPollIntensity(0);
-				value->Release();
-				m_pollMutex->Unlock();
-
-				// send notification to indicate polling is disabled
-				Notification* notification = new Notification(Notification::Type_PollingDisabled);
-				notification->SetHomeAndNodeIds(m_homeId, _valueId.GetNodeId());
-				notification->SetValueId(_valueId);
-				QueueNotification(notification);
-				Log::Write(LogLevel_Info, nodeId, "DisablePoll for HomeID 0x%.8x, value(cc=0x%02x,in=0x%02x,id=0x%02x)--poll list has %d items", _valueId.GetHomeId(), _valueId.GetCommandClassId(), _valueId.GetIndex(), _valueId.GetInstance(), m_pollList.size());
-				WriteCache();
-				return true;
-			}
+	// remove it from the poll scheduler
+	uint32 count;
+	{
+		Internal::LockGuard PLG(m_pollMutex);
+		if (!m_pollScheduler->Remove(_valueId))
+		{
+			Log::Write(LogLevel_Info, nodeId, "DisablePoll failed - value not on list");
+			return false;
 		}
-
-		// Not in the list
-		m_pollMutex->Unlock();
-		Log::Write(LogLevel_Info, nodeId, "DisablePoll failed - value not on list");
-		return false;
+		count = m_pollScheduler->GetCount();
 	}
 
-	// allow the poll thread to continue
-	m_pollMutex->Unlock();
+	// get the value object and reset pollIntensity to zero (indicating no polling)
+	if (Internal::VC::Value* value = GetValue(_valueId))
+	{
+		value->SetPollIntensity(0);
+		value->Release();
+	}
 
-	Log::Write(LogLevel_Info, "DisablePoll failed - node %d not found", nodeId);
-	return false;
+	// send notification to indicate polling is disabled
+	Notification* notification = new Notification(Notification::Type_PollingDisabled);
+	notification->SetHomeAndNodeIds(m_homeId, _valueId.GetNodeId());
+	notification->SetValueId(_valueId);
+	QueueNotification(notification);
+	Log::Write(LogLevel_Info, nodeId, "DisablePoll for HomeID 0x%.8x, value(cc=0x%02x,in=0x%02x,id=0x%02x)--poll list has %d items", _valueId.GetHomeId(), _valueId.GetCommandClassId(), _valueId.GetIndex(), _valueId.GetInstance(), count);
+	WriteCache(_valueId.GetNodeId());
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -4175,70 +5020,38 @@ bool Driver::isPolled(ValueID const &_valueId)
 {
 	bool bPolled;
 
-	// make sure the polling thread doesn't lock the node while we're in this function
-	m_pollMutex->Lock();
-
-	Internal::VC::Value* value = GetValue(_valueId);
-	if (value && value->GetPollIntensity() != 0)
-	{
-		bPolled = true;
-	}
-	else
+	// confirm that this node exists
+	uint8 nodeId = _valueId.GetNodeId();
 	{
-		bPolled = false;
-	}
+		Internal::LockGuard LG(m_nodeMutex);
+		if (GetNode(nodeId) == NULL)
+		{
+			Log::Write(LogLevel_Info, "isPolled failed - node %d not found", nodeId);
+			return false;
+		}
 
-	if (value)
-		value->Release();
+		Internal::VC::Value* value = GetValue(_valueId);
+		bPolled = (value && value->GetPollIntensity() != 0);
+		if (value)
+			value->Release();
+	}
 
 	/*
 	 * This code is retained for the moment as a belt-and-suspenders test to confirm that
-	 * the pollIntensity member of each value and the pollList contents do not get out
+	 * the pollIntensity member of each value and the poll scheduler contents do not get out
 	 * of sync.
 	 */
-	// confirm that this node exists
-	uint8 nodeId = _valueId.GetNodeId();
-	Internal::LockGuard LG(m_nodeMutex);
-	Node* node = GetNode(nodeId);
-	if (node != NULL)
+	bool bScheduled;
 	{
-
-		// See if the value is already in the poll list.
-		for (list<PollEntry>::iterator it = m_pollList.begin(); it != m_pollList.end(); ++it)
-		{
-			if ((*it).m_id == _valueId)
-			{
-				// Found it
-				if (bPolled)
-				{
-					m_pollMutex->Unlock();
-					return true;
-				}
-				else
-				{
-					Log::Write(LogLevel_Error, nodeId, "IsPolled setting for valueId 0x%016x is not consistent with the poll list", _valueId.GetId());
-				}
-			}
-		}
-
-		// Not in the list
-
-		if (!bPolled)
-		{
-			m_pollMutex->Unlock();
-			return false;
-		}
-		else
-		{
-			Log::Write(LogLevel_Error, nodeId, "IsPolled setting for valueId 0x%016x is not consistent with the poll list", _valueId.GetId());
-		}
+		Internal::LockGuard LG(m_pollMutex);
+		bScheduled = m_pollScheduler->Contains(_valueId);
 	}
-
-	// allow the poll thread to continue
-	m_pollMutex->Unlock();
-
-	Log::Write(LogLevel_Info, "isPolled failed - node %d not found (the value reported that it is%s polled)", nodeId, bPolled ? "" : " not");
-	return false;
+	if (bScheduled != bPolled)
+	{
+		Log::Write(LogLevel_Error, nodeId, "IsPolled setting for valueId 0x%016x is not consistent with the poll list", _valueId.GetId());
+		return false;
+	}
+	return bPolled;
 }
 
 //-----------------------------------------------------------------------------
@@ -4247,17 +5060,50 @@ bool Driver::isPolled(ValueID const &_valueId)
 //-----------------------------------------------------------------------------
 void Driver::SetPollIntensity(ValueID const &_valueId, uint8 const _intensity)
 {
-	// make sure the polling thread doesn't lock the value while we're in this function
-	m_pollMutex->Lock();
+	{
+		Internal::LockGuard LG(m_nodeMutex);
+		Internal::VC::Value* value = GetValue(_valueId);
+		if (!value)
+			return;
+		value->SetPollIntensity(_intensity);
+		value->Release();
+	}
+	{
+		Internal::LockGuard LG(m_pollMutex);
+		m_pollScheduler->SetIntensity(_valueId, _intensity);
+	}
+	WriteCache(_valueId.GetNodeId());
+}
 
-	Internal::VC::Value* value = GetValue(_valueId);
-	if (!value)
-		return;
-	value->SetPollIntensity(_intensity);
+//-----------------------------------------------------------------------------
+// <Driver::SetPollInterval>
+// Set the interval at which this value is polled
+//-----------------------------------------------------------------------------
+void Driver::SetPollInterval(ValueID const &_valueId, int32 const _milliseconds)
+{
+	{
+		Internal::LockGuard LG(m_nodeMutex);
+		Internal::VC::Value* value = GetValue(_valueId);
+		if (!value)
+			return;
+		value->SetPollInterval(_milliseconds);
+		value->Release();
+	}
+	{
+		Internal::LockGuard LG(m_pollMutex);
+		m_pollScheduler->SetInterval(_valueId, _milliseconds);
+	}
+	WriteCache(_valueId.GetNodeId());
+}
 
-	value->Release();
-	m_pollMutex->Unlock();
-	WriteCache();
+//-----------------------------------------------------------------------------
+// <Driver::PollValueReported>
+// A polled value has been reported, so reschedule its next poll
+//-----------------------------------------------------------------------------
+void Driver::PollValueReported(ValueID const& _valueId, bool _changed)
+{
+	Internal::LockGuard LG(m_pollMutex);
+	m_pollScheduler->Reported(_valueId, _changed, Internal::PollScheduler::Clock::now());
 }
 
 //-----------------------------------------------------------------------------
@@ -4279,132 +5125,153 @@ void Driver::PollThreadEntryPoint(Internal::Platform::Event* _exitEvent, void* _
 //-----------------------------------------------------------------------------
 void Driver::PollThreadProc(Internal::Platform::Event* _exitEvent)
 {
+	typedef Internal::PollScheduler::Clock Clock;
+
+	// No poll is sent before this time, to spread the polls out
+	Clock::time_point nextPoll = Clock::now();
 	while (1)
 	{
-		int32 pollInterval = m_pollInterval;
+		// Unless a value is due sooner, check again in half a second for newly polled values
+		int32 wait = 500;
 
-		if (m_awakeNodesQueried && !m_pollList.empty())
+		if (m_awakeNodesQueried)
 		{
-			// We only bother getting the lock if the pollList is not empty
-			m_pollMutex->Lock();
+			int32 pollInterval = m_pollInterval;
+			int32 gap = 0;
+			ValueID valueId;
+			int32 lag = 0;
+			bool poll = false;
+			{
+				Internal::LockGuard LG(m_pollMutex);
+				int32 count = (int32) m_pollScheduler->GetCount();
+				if (count > 0)
+				{
+					// If the polling interval is for the whole poll list, each value is polled once
+					// in it, and the polls are spread over it.  Otherwise each poll is followed by
+					// the interval, and a value is polled once in that many intervals.
+					if (!m_bIntervalBetweenPolls)
+					{
+						if (pollInterval < 100)
+						{
+							pollInterval *= 1000;
+						}
+						m_pollScheduler->SetDefaultInterval(pollInterval);
+						gap = pollInterval / count;
+					}
+					else
+					{
+						m_pollScheduler->SetDefaultInterval(pollInterval * count);
+						gap = pollInterval;
+					}
 
-			// Get the next value to be polled
-			PollEntry pe = m_pollList.front();
-			m_pollList.pop_front();
-			ValueID valueId = pe.m_id;
+					Clock::time_point now = Clock::now();
+					if (now >= nextPoll)
+					{
+						poll = m_pollScheduler->Next(now, &valueId, &lag);
+					}
 
-			// only execute this poll if pe.m_pollCounter == 1; otherwise decrement the counter and process the next polled value
-			if (pe.m_pollCounter != 1)
-			{
-				pe.m_pollCounter--;
-				m_pollList.push_back(pe);
-				m_pollMutex->Unlock();
-				continue;
+					Clock::time_point due;
+					if (!poll && m_pollScheduler->GetNextDue(&due))
+					{
+						if (due < nextPoll)
+						{
+							due = nextPoll;
+						}
+						int64 ms = std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count() + 1;
+						if (ms < wait)
+						{
+							wait = (ms > 0) ? (int32) ms : 1;
+						}
+					}
+				}
 			}
 
-			// reset the poll counter to the full pollIntensity value and push it at the end of the list
-			// release the value object referenced; call GetNode to ensure the node objects are locked during this period
-			{
-				Internal::LockGuard LG(m_nodeMutex);
-				(void) GetNode(valueId.GetNodeId());
-				Internal::VC::Value* value = GetValue(valueId);
-				if (!value)
-					continue;
-				pe.m_pollCounter = value->GetPollIntensity();
-				m_pollList.push_back(pe);
-				value->Release();
-			}
-			// If the polling interval is for the whole poll list, calculate the time before the next poll,
-			// so that all polls can take place within the user-specified interval.
-			if (!m_bIntervalBetweenPolls)
+			if (poll)
 			{
-				if (pollInterval < 100)
+				if (pollInterval != m_pollInterval)
 				{
-					Log::Write(LogLevel_Info, "The pollInterval setting is only %d, which appears to be a legacy setting.  Multiplying by 1000 to convert to ms.", pollInterval);
-					pollInterval *= 1000;
+					Log::Write(LogLevel_Info, "The pollInterval setting is only %d, which appears to be a legacy setting.  Multiplying by 1000 to convert to ms.", m_pollInterval);
 				}
-				pollInterval /= (int32) m_pollList.size();
-			}
 
-			{
-				Internal::LockGuard LG(m_nodeMutex);
-				// Request the state of the value from the node to which it belongs
-				if (Node* node = GetNode(valueId.GetNodeId()))
+				// Keep count of how late the poll is against the value's interval
+				++m_pollCnt;
+				int32 bucket = 0;
+				while ((bucket < (PollLagBuckets - 1)) && (lag >= c_pollLagBounds[bucket]))
 				{
-					bool requestState = true;
-					if (!node->IsListeningDevice())
+					++bucket;
+				}
+				++m_pollLag[bucket];
+
+				{
+					Internal::LockGuard LG(m_nodeMutex);
+					// Request the state of the value from the node to which it belongs
+					if (Node* node = GetNode(valueId.GetNodeId()))
 					{
-						// The device is not awake all the time.  If it is not awake, we mark it
-						// as requiring a poll.  The poll will be done next time the node wakes up.
-						if (Internal::CC::WakeUp* wakeUp = static_cast<Internal::CC::WakeUp*>(node->GetCommandClass(Internal::CC::WakeUp::StaticGetCommandClassId())))
+						bool requestState = true;
+						if (!node->IsListeningDevice())
 						{
-							if (!wakeUp->IsAwake())
+							// The device is not awake all the time.  If it is not awake, we mark it
+							// as requiring a poll.  The poll will be done next time the node wakes up.
+							if (Internal::CC::WakeUp* wakeUp = static_cast<Internal::CC::WakeUp*>(node->GetCommandClass(Internal::CC::WakeUp::StaticGetCommandClassId())))
 							{
-								wakeUp->SetPollRequired();
-								requestState = false;
+								if (!wakeUp->IsAwake())
+								{
+									wakeUp->SetPollRequired();
+									requestState = false;
+								}
 							}
 						}
-					}
 
-					if (requestState)
-					{
-						// Request an update of the value
-						Internal::CC::CommandClass* cc = node->GetCommandClass(valueId.GetCommandClassId());
-						if (cc)
+						if (requestState)
 						{
-							uint16_t index = valueId.GetIndex();
-							uint8_t instance = valueId.GetInstance();
-							Log::Write(LogLevel_Detail, node->m_nodeId, "Polling: %s index = %d instance = %d (poll queue has %d messages)", cc->GetCommandClassName().c_str(), index, instance, m_msgQueue[MsgQueue_Poll].size());
-							cc->RequestValue(0, index, instance, MsgQueue_Poll);
+							// Request an update of the value
+							Internal::CC::CommandClass* cc = node->GetCommandClass(valueId.GetCommandClassId());
+							if (cc)
+							{
+								uint16_t index = valueId.GetIndex();
+								uint8_t instance = valueId.GetInstance();
+								Log::Write(LogLevel_Detail, node->m_nodeId, "Polling: %s index = %d instance = %d (poll queue has %d messages, %dms late)", cc->GetCommandClassName().c_str(), index, instance, m_msgQueue[MsgQueue_Poll].size(), lag);
+								cc->RequestValue(0, index, instance, MsgQueue_Poll);
+							}
 						}
-					}
 
+					}
 				}
-			}
-
-			m_pollMutex->Unlock();
 
-			// Polling messages are only sent when there are no other messages waiting to be sent
-			// While this makes the polls much more variable and uncertain if some other activity dominates
-			// a send queue, that may be appropriate
-			// TODO we can have a debate about whether to test all four queues or just the Poll queue
-			// Wait until the library isn't actively sending messages (or in the midst of a transaction)
-			int i32;
-			int loopCount = 0;
-			while (!m_msgQueue[MsgQueue_Poll].empty() || !m_msgQueue[MsgQueue_Send].empty() || !m_msgQueue[MsgQueue_Command].empty() || !m_msgQueue[MsgQueue_Query].empty() || m_currentMsg != NULL)
-			{
-				i32 = Internal::Platform::Wait::Single(_exitEvent, 10);		// test conditions every 10ms
-				if (i32 == 0)
-				{
-					// Exit has been called
-					return;
-				}
-				loopCount++;
-				if (loopCount == 3000 * 10)		// 300 seconds worth of delay?  Something unusual is going on
+				// Polling messages are only sent when there are no other messages waiting to be sent
+				// While this makes the polls much more variable and uncertain if some other activity dominates
+				// a send queue, that may be appropriate
+				// Sleep until the library isn't actively sending messages (or in the midst of a transaction)
+				while (true)
 				{
+					int32 i32 = m_idleSignal->WaitUntilIdle(_exitEvent, 300 * 1000);
+					if (i32 == 0)
+					{
+						// Exit has been called
+						return;
+					}
+					if (i32 > 0)
+					{
+						break;
+					}
+					// 300 seconds worth of delay?  Something unusual is going on
 					Log::Write(LogLevel_Warning, "Poll queue hasn't been able to execute for 300 secs or more");
 					Log::QueueDump();
-					//					assert( 0 );
 				}
-			}
 
-			// ready for next poll...insert the pollInterval delay
-			i32 = Internal::Platform::Wait::Single(_exitEvent, pollInterval);
-			if (i32 == 0)
-			{
-				// Exit has been called
-				return;
+				// ready for the next poll once the gap has gone by
+				nextPoll = Clock::now() + std::chrono::milliseconds(gap);
+				continue;
 			}
 		}
-		else		// poll list is empty or awake nodes haven't been fully queried yet
+
+		// Nothing to poll yet.  Wait until the next value is due, or exit.
+		int32 i32 = Internal::Platform::Wait::Single(_exitEvent, wait);
+		++m_pollWakeups;
+		if (i32 == 0)
 		{
-			// don't poll just yet, wait for the pollInterval or exit before re-checking to see if the pollList has elements
-			int32 i32 = Internal::Platform::Wait::Single(_exitEvent, 500);
-			if (i32 == 0)
-			{
-				// Exit has been called
-				return;
-			}
+			// Exit has been called
+			return;
 		}
 	}
 }
@@ -4449,7 +5316,7 @@ void Driver::InitNode(uint8 const _nodeId, bool newNode, bool secure, uint8 cons
 			// Remove the original node
 			delete m_nodes[_nodeId];
 			m_nodes[_nodeId] = NULL;
-			WriteCache();
+			WriteCache(_nodeId);
 			Notification* notification = new Notification(Notification::Type_NodeRemoved);
 			notification->SetHomeAndNodeIds(m_homeId, _nodeId);
 			QueueNotification(notification);
@@ -4488,7 +5355,7 @@ void Driver::InitNode(uint8 const _nodeId, bool newNode, bool secure, uint8 cons
 bool Driver::IsNodeListeningDevice(uint8 const _nodeId)
 {
 	bool res = false;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		res = node->IsListeningDevice();
@@ -4504,7 +5371,7 @@ bool Driver::IsNodeListeningDevice(uint8 const _nodeId)
 bool Driver::IsNodeFrequentListeningDevice(uint8 const _nodeId)
 {
 	bool res = false;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		res = node->IsFrequentListeningDevice();
@@ -4520,7 +5387,7 @@ bool Driver::IsNodeFrequentListeningDevice(uint8 const _nodeId)
 bool Driver::IsNodeBeamingDevice(uint8 const _nodeId)
 {
 	bool res = false;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		res = node->IsBeamingDevice();
@@ -4536,7 +5403,7 @@ bool Driver::IsNodeBeamingDevice(uint8 const _nodeId)
 bool Driver::IsNodeRoutingDevice(uint8 const _nodeId)
 {
 	bool res = false;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		res = node->IsRoutingDevice();
@@ -4552,7 +5419,7 @@ bool Driver::IsNodeRoutingDevice(uint8 const _nodeId)
 bool Driver::IsNodeSecurityDevice(uint8 const _nodeId)
 {
 	bool security = false;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		security = node->IsSecurityDevice();
@@ -4568,7 +5435,7 @@ bool Driver::IsNodeSecurityDevice(uint8 const _nodeId)
 uint32 Driver::GetNodeMaxBaudRate(uint8 const _nodeId)
 {
 	uint32 baud = 0;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		baud = node->GetMaxBaudRate();
@@ -4584,7 +5451,7 @@ uint32 Driver::GetNodeMaxBaudRate(uint8 const _nodeId)
 uint8 Driver::GetNodeVersion(uint8 const _nodeId)
 {
 	uint8 version = 0;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		version = node->GetVersion();
@@ -4600,7 +5467,7 @@ uint8 Driver::GetNodeVersion(uint8 const _nodeId)
 uint8 Driver::GetNodeSecurity(uint8 const _nodeId)
 {
 	uint8 security = 0;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		security = node->GetSecurity();
@@ -4616,7 +5483,7 @@ uint8 Driver::GetNodeSecurity(uint8 const _nodeId)
 uint8 Driver::GetNodeBasic(uint8 const _nodeId)
 {
 	uint8 basic = 0;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		basic = node->GetBasic();
@@ -4650,7 +5517,7 @@ string Driver::GetNodeBasicString(uint8 const _nodeId)
 uint8 Driver::GetNodeGeneric(uint8 const _nodeId, uint8 const _instance)
 {
 	uint8 genericType = 0;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		genericType = node->GetGeneric(_instance);
@@ -4682,7 +5549,7 @@ string Driver::GetNodeGenericString(uint8 const _nodeId, uint8 const _instance)
 uint8 Driver::GetNodeSpecific(uint8 const _nodeId, uint8 const _instance)
 {
 	uint8 specific = 0;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		specific = node->GetSpecific(_instance);
@@ -4724,7 +5591,7 @@ string Driver::GetNodeType(uint8 const _nodeId)
 
 bool Driver::IsNodeZWavePlus(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->IsNodeZWavePlus();
@@ -4739,7 +5606,7 @@ bool Driver::IsNodeZWavePlus(uint8 const _nodeId)
 uint32 Driver::GetNodeNeighbors(uint8 const _nodeId, uint8** o_neighbors)
 {
 	uint32 numNeighbors = 0;
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		numNeighbors = node->GetNeighbors(o_neighbors);
@@ -4755,7 +5622,7 @@ uint32 Driver::GetNodeNeighbors(uint8 const _nodeId, uint8** o_neighbors)
 //-----------------------------------------------------------------------------
 string Driver::GetNodeManufacturerName(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetManufacturerName();
@@ -4771,7 +5638,7 @@ string Driver::GetNodeManufacturerName(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 string Driver::GetNodeProductName(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetProductName();
@@ -4787,7 +5654,7 @@ string Driver::GetNodeProductName(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 string Driver::GetNodeName(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetNodeName();
@@ -4803,7 +5670,7 @@ string Driver::GetNodeName(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 string Driver::GetNodeLocation(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetLocation();
@@ -4819,7 +5686,7 @@ string Driver::GetNodeLocation(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 uint16 Driver::GetNodeManufacturerId(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetManufacturerId();
@@ -4835,7 +5702,7 @@ uint16 Driver::GetNodeManufacturerId(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 uint16 Driver::GetNodeProductType(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetProductType();
@@ -4851,7 +5718,7 @@ uint16 Driver::GetNodeProductType(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 uint16 Driver::GetNodeProductId(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetProductId();
@@ -4866,7 +5733,7 @@ uint16 Driver::GetNodeProductId(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 uint16 Driver::GetNodeDeviceType(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetDeviceType();
@@ -4898,7 +5765,7 @@ string Driver::GetNodeDeviceTypeString(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 uint8 Driver::GetNodeRole(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetRoleType();
@@ -4928,7 +5795,7 @@ string Driver::GetNodeRoleString(uint8 const _nodeId)
 //-----------------------------------------------------------------------------
 uint8 Driver::GetNodePlusType(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
+	Internal::SharedLockGuard LG(m_nodeMutex);
 	if (Node* node = GetNode(_nodeId))
 	{
 		return node->GetNodeType();
@@ -4961,7 +5828,7 @@ void Driver::SetNodeManufacturerName(uint8 const _nodeId, string const& _manufac
 	{
 		node->SetManufacturerName(_manufacturerName);
 	}
-	WriteCache();
+	WriteCache(_nodeId);
 }
 
 //-----------------------------------------------------------------------------
@@ -4975,7 +5842,7 @@ void Driver::SetNodeProductName(uint8 const _nodeId, string const& _productName)
 	{
 		node->SetProductName(_productName);
 	}
-	WriteCache();
+	WriteCache(_nodeId);
 }
 
 //-----------------------------------------------------------------------------
@@ -4989,7 +5856,7 @@ void Driver::SetNodeName(uint8 const _nodeId, string const& _nodeName)
 	{
 		node->SetNodeName(_nodeName);
 	}
-	WriteCache();
+	WriteCache(_nodeId);
 }
 
 //-----------------------------------------------------------------------------
@@ -5003,7 +5870,7 @@ void Driver::SetNodeLocation(uint8 const _nodeId, string const& _location)
 	{
 		node->SetLocation(_location);
 	}
-	WriteCache();
+	WriteCache(_nodeId);
 }
 
 //-----------------------------------------------------------------------------
@@ -5045,6 +5912,26 @@ void Driver::SetNodeOff(uint8 const _nodeId)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::SetNodeImportant>
+// Mark a node to be queried ahead of the others
+//-----------------------------------------------------------------------------
+void Driver::SetNodeImportant(uint8 const _nodeId, bool const _important)
+{
+	Internal::LockGuard LG(m_sendMutex);
+	m_interviewScheduler->SetImportant(_nodeId, _important);
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::IsNodeImportant>
+// Whether a node is queried ahead of the others
+//-----------------------------------------------------------------------------
+bool Driver::IsNodeImportant(uint8 const _nodeId)
+{
+	Internal::LockGuard LG(m_sendMutex);
+	return m_interviewScheduler->IsImportant(_nodeId);
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::GetValue>
 // Get a pointer to a Value object for the specified ValueID
@@ -5061,6 +5948,21 @@ Internal::VC::Value* Driver::GetValue(ValueID const& _id)
 	return NULL;
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::BorrowValue>
+// Get a pointer to a Value object for the specified ValueID, without adding a
+// reference.  The value stays valid for as long as the node lock is held.
+//-----------------------------------------------------------------------------
+Internal::VC::Value* Driver::BorrowValue(ValueID const& _id)
+{
+	if (Node* node = m_nodes[_id.GetNodeId()])
+	{
+		return node->BorrowValue(_id);
+	}
+
+	return NULL;
+}
+
 //-----------------------------------------------------------------------------
 // Controller commands
 //-----------------------------------------------------------------------------
@@ -5140,8 +6042,7 @@ bool Driver::BeginControllerCommand(ControllerCommand _command, pfnControllerCal
 	item.m_cci = cci;
 
 	m_sendMutex->Lock();
-	m_msgQueue[MsgQueue_Controller].push_back(item);
-	m_queueEvent[MsgQueue_Controller]->Set();
+	PushMsgQueueItem(item, MsgQueue_Controller);
 	m_sendMutex->Unlock();
 
 	return true;
@@ -5886,20 +6787,121 @@ void Driver::RemoveAssociation(uint8 const _nodeId, uint8 const _groupIdx, uint8
 //-----------------------------------------------------------------------------
 void Driver::QueueNotification(Notification* _notification)
 {
+	if (m_notificationCoalesceWindow > 0)
+	{
+		Notification::NotificationType type = _notification->GetType();
+		if ((type == Notification::Type_ValueChanged) || (type == Notification::Type_ValueRefreshed))
+		{
+			if (CoalesceValueNotification(type, _notification->GetValueID()))
+			{
+				delete _notification;
+				return;
+			}
+			PendingValueNotification& pending = m_pendingValueNotifications[_notification->GetValueID().GetId()];
+			pending.m_notification = _notification;
+			pending.m_queued = std::chrono::steady_clock::now();
+		}
+	}
 	m_notifications.push_back(_notification);
 	m_notificationsEvent->Set();
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::QueueValueNotification>
+// Queue a ValueChanged or ValueRefreshed notification, without creating it
+// if it can be merged into one already queued
+//-----------------------------------------------------------------------------
+void Driver::QueueValueNotification(Notification::NotificationType const _type, ValueID const& _id)
+{
+	if ((m_notificationCoalesceWindow > 0) && CoalesceValueNotification(_type, _id))
+	{
+		return;
+	}
+	Notification* notification = new Notification(_type);
+	notification->SetValueId(_id);
+	QueueNotification(notification);
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::CoalesceValueNotification>
+// Merge a value notification into one for the same value that was queued less
+// than NotificationCoalesceWindow ms ago.  Notifications do not carry the value,
+// so the watchers lose nothing but the repeats.
+//-----------------------------------------------------------------------------
+bool Driver::CoalesceValueNotification(Notification::NotificationType const _type, ValueID const& _id)
+{
+	map<uint64, PendingValueNotification>::iterator it = m_pendingValueNotifications.find(_id.GetId());
+	if (it == m_pendingValueNotifications.end())
+	{
+		return false;
+	}
+	if ((std::chrono::steady_clock::now() - it->second.m_queued) >= std::chrono::milliseconds(m_notificationCoalesceWindow))
+	{
+		return false;
+	}
+
+	// A change outranks a refresh
+	if (_type == Notification::Type_ValueChanged)
+	{
+		it->second.m_notification->m_type = Notification::Type_ValueChanged;
+	}
+	++m_notificationsMerged;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::OnNotificationWindowExpired>
+// Wake the driver thread to deliver the value notifications it held back
+//-----------------------------------------------------------------------------
+void Driver::OnNotificationWindowExpired(uint32 _id)
+{
+	m_notificationTimerSet = false;
+	m_notificationsEvent->Set();
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::NotifyWatchers>
 // Notify any watching objects of a value change
 //-----------------------------------------------------------------------------
 void Driver::NotifyWatchers()
 {
+	// Anything queued from here on sets it again
+	m_notificationsEvent->Reset();
+
+	if (m_notificationDispatcher)
+	{
+		// Make room for anything held back since the last time
+		m_notificationDispatcher->Pump();
+	}
+
 	list<Notification*>::iterator nit = m_notifications.begin();
 	while (nit != m_notifications.end())
 	{
 		Notification* notification = m_notifications.front();
+
+		if (m_notificationCoalesceWindow > 0)
+		{
+			Notification::NotificationType type = notification->GetType();
+			if ((type == Notification::Type_ValueChanged) || (type == Notification::Type_ValueRefreshed))
+			{
+				map<uint64, PendingValueNotification>::iterator it = m_pendingValueNotifications.find(notification->GetValueID().GetId());
+				if ((it != m_pendingValueNotifications.end()) && (it->second.m_notification == notification))
+				{
+					// Hold it, and everything queued after it, until its window closes
+					int32 age = (int32) std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - it->second.m_queued).count();
+					if (age < m_notificationCoalesceWindow)
+					{
+						if (!m_notificationTimerSet)
+						{
+							m_notificationTimerSet = true;
+							m_notificationTimer->TimerSetEvent(m_notificationCoalesceWindow - age, bind(&Driver::OnNotificationWindowExpired, this, std::placeholders::_1), 1);
+						}
+						break;
+					}
+					m_pendingValueNotifications.erase(it);
+				}
+			}
+		}
 		m_notifications.pop_front();
 
 		/* check the any ValueID's sent as part of the Notification are still valid */
@@ -5909,28 +6911,44 @@ void Driver::NotifyWatchers()
 			case Notification::Type_ValueChanged:
 			case Notification::Type_ValueRefreshed:
 			{
-				Internal::VC::Value *val = GetValue(notification->GetValueID());
-				if (!val)
+				bool exists;
+				{
+					Internal::SharedLockGuard LG(m_nodeMutex);
+					exists = (BorrowValue(notification->GetValueID()) != NULL);
+				}
+				if (!exists)
 				{
 					Log::Write(LogLevel_Info, notification->GetNodeId(), "Dropping Notification as ValueID does not exist");
 					nit = m_notifications.begin();
 					delete notification;
 					continue;
 				}
-				val->Release();
 				break;
 			}
 			default:
 				break;
 		}
-		Log::Write(LogLevel_Detail, notification->GetNodeId(), "Notification: %s", notification->GetAsString().c_str());
 
+		if (m_notificationDispatcher)
+		{
+			// The dispatcher thread logs and delivers it
+			m_notificationDispatcher->Enqueue(notification);
+			nit = m_notifications.begin();
+			continue;
+		}
+
+		if (Log::IsEnabled(LogLevel_Detail))
+		{
+			Log::Write(LogLevel_Detail, notification->GetNodeId(), "Notification: %s", notification->GetAsString().c_str());
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 		Manager::Get()->NotifyWatchers(notification);
+		m_notifyWatchers.RecordSince(start);
 
 		delete notification;
 		nit = m_notifications.begin();
 	}
-	m_notificationsEvent->Reset();
 }
 
 //-----------------------------------------------------------------------------
@@ -6073,7 +7091,7 @@ void Driver::SendVirtualNodeInfo(uint8 const _FromNodeId, uint8 const _ToNodeId)
 	char str[80];
 
 	snprintf(str, sizeof(str), "Send Virtual Node Info from %d to %d", _FromNodeId, _ToNodeId);
-	Internal::Msg* msg = new Internal::Msg(str, 0xff, REQUEST, FUNC_ID_ZW_SEND_SLAVE_NODE_INFO, true);
+	Internal::Msg* msg = new Internal::Msg(string(str), 0xff, REQUEST, FUNC_ID_ZW_SEND_SLAVE_NODE_INFO, true);
 	msg->Append(_FromNodeId);		// from the virtual node
 	msg->Append(_ToNodeId);		// to the handheld controller
 	msg->Append( TRANSMIT_OPTION_ACK);
@@ -6554,6 +7572,28 @@ void Driver::GetDriverStatistics(DriverData* _data)
 	_data->m_routedbusy = m_routedbusy;
 	_data->m_broadcastReadCnt = m_broadcastReadCnt;
 	_data->m_broadcastWriteCnt = m_broadcastWriteCnt;
+	_data->m_notificationQueueDepth = m_notificationDispatcher ? m_notificationDispatcher->GetDepth() : 0;
+	_data->m_notificationQueueMax = m_notificationDispatcher ? m_notificationDispatcher->GetMaxDepth() : 0;
+	_data->m_notificationsDropped = m_notificationDispatcher ? m_notificationDispatcher->GetDropped() : 0;
+	_data->m_notificationsCoalesced = m_notificationDispatcher ? m_notificationDispatcher->GetCoalesced() : 0;
+	_data->m_notificationsMerged = m_notificationsMerged;
+	memcpy(_data->m_queueOverdue, m_queueOverdue, sizeof(_data->m_queueOverdue));
+	_data->m_multiCmdFramesSaved = m_multiCmdFramesSaved;
+	_data->m_multiCmdAirTimeSaved = (uint32) (m_multiCmdAirTimeSaved / 1000);
+	_data->m_pollCnt = m_pollCnt;
+	memcpy(_data->m_pollLag, m_pollLag, sizeof(_data->m_pollLag));
+	{
+		Internal::LockGuard LG(m_pollMutex);
+		_data->m_pollsDeferred = m_pollScheduler->GetDeferred();
+		_data->m_pollsBackedOff = m_pollScheduler->GetBackedOff();
+	}
+	_data->m_pollWakeups = m_pollWakeups + (m_idleSignal ? m_idleSignal->GetWakeups() : 0);
+	{
+		Internal::LockGuard LG(m_sendMutex);
+		_data->m_reportsAwaited = m_interviewScheduler->GetAnswered() + m_interviewScheduler->GetExpired() + m_interviewScheduler->GetAwaitingCount();
+		_data->m_reportsTimedOut = m_interviewScheduler->GetExpired();
+	}
+	_data->m_allNodesQueriedTime = m_allNodesQueriedTime;
 }
 
 //-----------------------------------------------------------------------------
@@ -6570,6 +7610,182 @@ void Driver::GetNodeStatistics(uint8 const _nodeId, Node::NodeData* _data)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// <Driver::GetLatencyData>
+// Copy the latency histograms
+//-----------------------------------------------------------------------------
+void Driver::GetLatencyData(LatencyData* _data)
+{
+	for (int32 i = 0; i < MsgQueue_Count; ++i)
+	{
+		m_queueWait[i].GetData(&_data->m_queueWait[i]);
+	}
+	m_sendToAck.GetData(&_data->m_sendToAck);
+	m_sendToCallback.GetData(&_data->m_sendToCallback);
+	m_notifyWatchers.GetData(&_data->m_notifyWatchers);
+	if (m_notificationDispatcher)
+	{
+		LatencyHistogramData delivered;
+		m_notificationDispatcher->GetDeliveryTime(&delivered);
+		_data->m_notifyWatchers.Add(delivered);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetNodeReportLatency>
+// Copy the histogram of the time a node takes to answer a request
+//-----------------------------------------------------------------------------
+bool Driver::GetNodeReportLatency(uint8 const _nodeId, LatencyHistogramData* _data)
+{
+	Internal::SharedLockGuard LG(m_nodeMutex);
+	if (Node* node = GetNode(_nodeId))
+	{
+		node->m_reportLatency.GetData(_data);
+		return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::GetCommandClassReportLatency>
+// Copy the histogram of the time the nodes take to answer a command class's requests
+//-----------------------------------------------------------------------------
+bool Driver::GetCommandClassReportLatency(uint8 const _commandClassId, LatencyHistogramData* _data)
+{
+	if (Internal::LatencyHistogram* histogram = m_commandClassReportLatency[_commandClassId].load(std::memory_order_acquire))
+	{
+		histogram->GetData(_data);
+		return true;
+	}
+	_data->Clear();
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::ReportReceived>
+// Record the time a node took to answer a request, for the node and the command class
+//-----------------------------------------------------------------------------
+void Driver::ReportReceived(Node* _node, uint8 const _commandClassId)
+{
+	std::chrono::steady_clock::duration latency = std::chrono::steady_clock::now() - _node->m_sentTime;
+	_node->m_reportLatency.Record(latency);
+
+	// Only the driver thread creates them, so there is no race to publish one
+	Internal::LatencyHistogram* histogram = m_commandClassReportLatency[_commandClassId].load(std::memory_order_relaxed);
+	if (histogram == NULL)
+	{
+		histogram = new Internal::LatencyHistogram();
+		m_commandClassReportLatency[_commandClassId].store(histogram, std::memory_order_release);
+	}
+	histogram->Record(latency);
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::MetricsThreadEntryPoint>
+// Entry point of the thread that writes the metrics out
+//-----------------------------------------------------------------------------
+void Driver::MetricsThreadEntryPoint(Internal::Platform::Event* _exitEvent, void* _context)
+{
+	Driver* driver = (Driver*) _context;
+	if (driver)
+	{
+		driver->MetricsThreadProc(_exitEvent);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::MetricsThreadProc>
+// Write the metrics out at each interval.  On a thread of its own, so a slow
+// reader at the other end holds up nothing else.
+//-----------------------------------------------------------------------------
+void Driver::MetricsThreadProc(Internal::Platform::Event* _exitEvent)
+{
+	while (Internal::Platform::Wait::Single(_exitEvent, m_metricsInterval) != 0)
+	{
+		ExportMetrics();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <Driver::ExportMetrics>
+// Write the statistics and latency histograms out for Prometheus
+//-----------------------------------------------------------------------------
+void Driver::ExportMetrics()
+{
+	DriverData data;
+	GetDriverStatistics(&data);
+	LatencyData* latency = new LatencyData();
+	GetLatencyData(latency);
+
+	char buf[64];
+	snprintf(buf, sizeof(buf), "home_id=\"0x%.8x\"", m_homeId);
+	string home = buf;
+	Internal::MetricsExporter& exporter = *m_metricsExporter;
+
+	exporter.Describe("ozw_messages_sent_total", "counter", "Messages written to the controller");
+	exporter.AddSample("ozw_messages_sent_total", home, data.m_writeCnt);
+	exporter.Describe("ozw_messages_received_total", "counter", "Messages read from the controller");
+	exporter.AddSample("ozw_messages_received_total", home, data.m_readCnt);
+	exporter.Describe("ozw_messages_retried_total", "counter", "Messages sent again");
+	exporter.AddSample("ozw_messages_retried_total", home, data.m_retries);
+	exporter.Describe("ozw_messages_dropped_total", "counter", "Messages dropped and not delivered");
+	exporter.AddSample("ozw_messages_dropped_total", home, data.m_dropped);
+	exporter.Describe("ozw_polls_total", "counter", "Polls sent");
+	exporter.AddSample("ozw_polls_total", home, data.m_pollCnt);
+	exporter.Describe("ozw_notification_queue_depth", "gauge", "Notifications waiting for the dispatcher thread");
+	exporter.AddSample("ozw_notification_queue_depth", home, data.m_notificationQueueDepth);
+
+	exporter.Describe("ozw_queue_wait_seconds", "histogram", "Time a message waited in its queue before it was sent");
+	for (int32 i = 0; i < MsgQueue_Count; ++i)
+	{
+		exporter.AddHistogram("ozw_queue_wait_seconds", home + ",queue=\"" + c_sendQueueNames[i] + "\"", latency->m_queueWait[i]);
+	}
+	exporter.Describe("ozw_send_ack_seconds", "histogram", "Time from writing a message to the controller to its ACK");
+	exporter.AddHistogram("ozw_send_ack_seconds", home, latency->m_sendToAck);
+	exporter.Describe("ozw_send_callback_seconds", "histogram", "Time from writing a message to the callback saying it was delivered");
+	exporter.AddHistogram("ozw_send_callback_seconds", home, latency->m_sendToCallback);
+	exporter.Describe("ozw_notify_watchers_seconds", "histogram", "Time the watchers took over each notification");
+	exporter.AddHistogram("ozw_notify_watchers_seconds", home, latency->m_notifyWatchers);
+
+	// Copy the nodes' histograms under the lock, and format them after
+	vector<uint8> nodeIds;
+	vector<LatencyHistogramData> nodeLatency;
+	{
+		Internal::SharedLockGuard LG(m_nodeMutex);
+		for (int32 i = 0; i < 256; ++i)
+		{
+			Node* node = m_nodes[i];
+			if ((node != NULL) && node->m_reportLatency.GetCount())
+			{
+				nodeIds.push_back((uint8) i);
+				nodeLatency.push_back(LatencyHistogramData());
+				node->m_reportLatency.GetData(&nodeLatency.back());
+			}
+		}
+	}
+	exporter.Describe("ozw_node_report_seconds", "histogram", "Time from sending a request to a node to the report that answers it");
+	for (size_t i = 0; i < nodeIds.size(); ++i)
+	{
+		snprintf(buf, sizeof(buf), ",node=\"%d\"", nodeIds[i]);
+		exporter.AddHistogram("ozw_node_report_seconds", home + buf, nodeLatency[i]);
+	}
+
+	delete latency;
+
+	exporter.Describe("ozw_command_class_report_seconds", "histogram", "Time from sending a request to the report that answers it, by command class");
+	LatencyHistogramData reportLatency;
+	for (int32 i = 0; i < 256; ++i)
+	{
+		if (GetCommandClassReportLatency((uint8) i, &reportLatency))
+		{
+			snprintf(buf, sizeof(buf), ",command_class=\"0x%.2x\"", i);
+			exporter.AddHistogram("ozw_command_class_report_seconds", home + buf + ",name=\"" + Internal::CC::CommandClasses::GetName((uint8) i) + "\"", reportLatency);
+		}
+	}
+
+	exporter.Write();
+}
+
 //-----------------------------------------------------------------------------
 // <Driver::LogDriverStatistics>
 // Report driver statistics to the driver's log
@@ -6611,6 +7827,78 @@ void Driver::LogDriverStatistics()
 	Log::Write(LogLevel_Always, "Out of frame data flow errors:  . . . . . . . . . . . . . %ld", data.m_OOFCnt);
 	Log::Write(LogLevel_Always, "Messages retransmitted: . . . . . . . . . . . . . . . . . %ld", data.m_retries);
 	Log::Write(LogLevel_Always, "Messages dropped and not delivered: . . . . . . . . . . . %ld", data.m_dropped);
+	if (m_notificationDispatcher)
+	{
+		Log::Write(LogLevel_Always, "*** Notifications");
+		Log::Write(LogLevel_Always, "Largest notification queue depth: . . . . . . . . . . . . %ld", data.m_notificationQueueMax);
+		Log::Write(LogLevel_Always, "Notifications dropped as the queue was full:  . . . . . . %ld", data.m_notificationsDropped);
+		Log::Write(LogLevel_Always, "Repeated notifications coalesced as the queue was full: . %ld", data.m_notificationsCoalesced);
+	}
+	if (m_notificationCoalesceWindow > 0)
+	{
+		Log::Write(LogLevel_Always, "Value notifications merged into a pending one:  . . . . . %ld", data.m_notificationsMerged);
+	}
+	// How long the items waited is in the queue latency histograms below
+	bool deadlines = false;
+	for (int32 i = 0; i < MsgQueue_Count; ++i)
+	{
+		if (m_msgScheduler->GetDeadline(i))
+		{
+			if (!deadlines)
+			{
+				Log::Write(LogLevel_Always, "*** Message queue deadlines");
+				deadlines = true;
+			}
+			Log::Write(LogLevel_Always, "%-10s items taken after their deadline: . . . . . . %ld", c_sendQueueNames[i], data.m_queueOverdue[i]);
+		}
+	}
+	if (m_multiCmdBatching)
+	{
+		Log::Write(LogLevel_Always, "*** MultiCmd batching");
+		Log::Write(LogLevel_Always, "Frames saved by batching commands:  . . . . . . . . . . . %ld", data.m_multiCmdFramesSaved);
+		Log::Write(LogLevel_Always, "Air time saved, estimated at 40kbit/s (ms): . . . . . . . %ld", data.m_multiCmdAirTimeSaved);
+	}
+	if (data.m_pollCnt)
+	{
+		uint32* lag = data.m_pollLag;
+		Log::Write(LogLevel_Always, "*** Polling");
+		Log::Write(LogLevel_Always, "Polls sent: . . . . . . . . . . . . . . . . . . . . . . . %ld", data.m_pollCnt);
+		Log::Write(LogLevel_Always, "Polls put off as the node had just reported the value: . %ld", data.m_pollsDeferred);
+		Log::Write(LogLevel_Always, "Intervals stretched as a value had not changed: . . . . . %ld", data.m_pollsBackedOff);
+		Log::Write(LogLevel_Always, "Poll thread wake-ups: . . . . . . . . . . . . . . . . . . %ld", data.m_pollWakeups);
+		Log::Write(LogLevel_Always, "Late by      <10ms  <50ms <100ms <500ms    <1s    <5s   <10s   more");
+		Log::Write(LogLevel_Always, "Polls      %6d %6d %6d %6d %6d %6d %6d %6d", lag[0], lag[1], lag[2], lag[3], lag[4], lag[5], lag[6], lag[7]);
+	}
+	Log::Write(LogLevel_Always, "*** Node queries");
+	Log::Write(LogLevel_Always, "Time to query all nodes (s):  . . . . . . . . . . . . . . %ld", data.m_allNodesQueriedTime / 1000);
+	if (m_interviewScheduler->GetPipeline() > 1)
+	{
+		Log::Write(LogLevel_Always, "Reports awaited while other nodes were queried: . . . . . %ld", data.m_reportsAwaited);
+		Log::Write(LogLevel_Always, "Awaited reports that timed out: . . . . . . . . . . . . . %ld", data.m_reportsTimedOut);
+	}
+
+	LatencyData* latency = new LatencyData();
+	GetLatencyData(latency);
+	Log::Write(LogLevel_Always, "*** Latency (ms)");
+	Log::Write(LogLevel_Always, "                   count     mean      p50      p90      p99      max");
+	for (int32 i = 0; i < MsgQueue_Count; ++i)
+	{
+		LogLatency((string("Queue ") + c_sendQueueNames[i]).c_str(), latency->m_queueWait[i]);
+	}
+	LogLatency("Send to ACK", latency->m_sendToAck);
+	LogLatency("Send to callback", latency->m_sendToCallback);
+	LogLatency("Notify watchers", latency->m_notifyWatchers);
+	delete latency;
+	LatencyHistogramData reportLatency;
+	for (int32 i = 0; i < 256; ++i)
+	{
+		if (GetCommandClassReportLatency((uint8) i, &reportLatency))
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "Report CC 0x%.2x", i);
+			LogLatency(name, reportLatency);
+		}
+	}
 	Log::Write(LogLevel_Always, "***************************************************************************");
 }
 
@@ -6669,7 +7957,10 @@ bool Driver::SendEncryptedMessage()
 	uint8 *buffer = m_currentMsg->GetBuffer();
 	uint8 length = m_currentMsg->GetLength();
 	m_expectedCallbackId = m_currentMsg->GetCallbackId();
-	Log::Write(LogLevel_Info, m_currentMsg->GetTargetNodeId(), "Sending (%s) message (Callback ID=0x%.2x, Expected Reply=0x%.2x) - %s", c_sendQueueNames[m_currentMsgQueueSource], m_expectedCallbackId, m_expectedReply, m_currentMsg->GetAsString().c_str());
+	if (Log::IsEnabled(LogLevel_Info))
+	{
+		Log::Write(LogLevel_Info, m_currentMsg->GetTargetNodeId(), "Sending (%s) message (Callback ID=0x%.2x, Expected Reply=0x%.2x) - %s", c_sendQueueNames[m_currentMsgQueueSource], m_expectedCallbackId, m_expectedReply, m_currentMsg->GetAsString().c_str());
+	}
 
 	m_controller->Write(buffer, length);
 	m_currentMsg->clearNonce();
@@ -7077,50 +8368,8 @@ bool Driver::refreshNodeConfig(uint8 _nodeId)
 //-----------------------------------------------------------------------------
 void Driver::ReloadNode(uint8 const _nodeId)
 {
-	Internal::LockGuard LG(m_nodeMutex);
 	Log::Write(LogLevel_Detail, _nodeId, "Reloading Node");
-	/* delete any cached information about this node so we start from fresh */
-	char str[32];
-	int32 intVal;
-
-	string userPath;
-	Options::Get()->GetOptionAsString("UserPath", &userPath);
-
-	snprintf(str, sizeof(str), "ozwcache_0x%08x.xml", m_homeId);
-	string filename = userPath + string(str);
-
-	TiXmlDocument doc;
-	doc.SetCondenseWhiteSpace(false);
-	if (doc.LoadFile(filename.c_str(), TIXML_ENCODING_UTF8))
-	{
-		doc.SetUserData((void *) filename.c_str());
-		TiXmlElement * driverElement = doc.RootElement();
-
-		TiXmlNode * nodeElement = driverElement->FirstChild();
-		while (nodeElement)
-		{
-			if (nodeElement->ToElement())
-			{
-				char const* str2 = nodeElement->ToElement()->Value();
-				if (str2 && !strcmp(str2, "Node"))
-				{
-					// Get the node Id from the XML
-					if (TIXML_SUCCESS == nodeElement->ToElement()->QueryIntAttribute("id", &intVal))
-					{
-						if (intVal == _nodeId)
-						{
-							driverElement->RemoveChild(nodeElement);
-							break;
-						}
-					}
-				}
-			}
-			nodeElement = nodeElement->NextSibling();
-		}
-	}
-	doc.SaveFile(filename.c_str());
-	LG.Unlock();
-
+	/* InitNode deletes the node and records its removal in the cache, so we start from fresh */
 	InitNode(_nodeId);
 }
 
@@ -31,13 +31,18 @@
 #include <string>
 #include <map>
 #include <list>
+#include <chrono>
+#include <atomic>
 
 #include "Defs.h"
 #include "Group.h"
 #include "value_classes/ValueID.h"
 #include "Node.h"
+#include "Notification.h"
+#include "LatencyHistogram.h"
 #include "platform/Event.h"
 #include "platform/Mutex.h"
+#include "platform/SharedMutex.h"
 #include "platform/Thread.h"
 #include "platform/TimeStamp.h"
 #include "aes/aescpp.h"
@@ -69,6 +74,7 @@ namespace OpenZWave
 		{
 			class Controller;
 		}
+		class CacheJournal;
 		class DNSThread;
 		struct DNSLookup;
 		class i_HttpClient;
@@ -76,6 +82,13 @@ namespace OpenZWave
 		class ManufacturerSpecificDB;
 		class Msg;
 		class TimerThread;
+		class Timer;
+		class NotificationDispatcher;
+		class MsgScheduler;
+		class PollScheduler;
+		class IdleSignal;
+		class InterviewScheduler;
+		class MetricsExporter;
 	}
 
 	/** \brief The Driver class handles communication between OpenZWave
@@ -102,6 +115,7 @@ namespace OpenZWave
 			friend class Internal::CC::Security;
 			friend class Internal::Msg;
 			friend class Internal::ManufacturerSpecificDB;
+			friend class Internal::CacheJournal;
 			friend class TimerThread;
 
 			//-----------------------------------------------------------------------------
@@ -193,8 +207,20 @@ namespace OpenZWave
 			//-----------------------------------------------------------------------------
 		private:
 			void RequestConfig();							// Get the network configuration from the Z-Wave network
-			bool ReadCache();								// Read the configuration from a file
-			void WriteCache();								// Save the configuration to a file
+			bool ReadCache();								// Read the configuration from a file (the snapshot plus any journaled changes)
+			void WriteCache();								// Save the whole configuration to a file, folding in the journal
+			void WriteCache(uint8 const _nodeId);			// Journal the state of a single node (or its removal)
+			bool CompactCache(bool const _wait = false);	// Write a new snapshot. Returns false if _wait is false and the node list is busy
+			Internal::CacheJournal* GetCacheJournal();		// Returns the journal for the current Home ID, or NULL if journaling is disabled. Call with m_nodeMutex held.
+
+			/** The stage a node loaded from the cache goes on to when its fingerprint matches (CacheRefresh option) */
+			Node::QueryStage GetCacheRefreshStage() const
+			{
+				return m_cacheRefreshStage;
+			}
+
+			Internal::CacheJournal* m_cacheJournal;
+			Node::QueryStage m_cacheRefreshStage;
 
 			//-----------------------------------------------------------------------------
 			//	Timer
@@ -344,7 +370,7 @@ namespace OpenZWave
 			bool m_hasExtendedTxStatus;						// True if the controller accepted SERIAL_API_SETUP_CMD_TX_STATUS_REPORT
 			uint8 m_Controller_nodeId;						// Z-Wave Controller's own node ID.
 			Node* m_nodes[256];								// Array containing all the node objects.
-			Internal::Platform::Mutex* m_nodeMutex;								// Serializes access to node data
+			Internal::Platform::SharedMutex* m_nodeMutex;								// Serializes access to node data.  Held shared by code that only reads it.
 
 			Internal::CC::ControllerReplication* m_controllerReplication;					// Controller replication is handled separately from the other command classes, due to older hand-held controllers using invalid node IDs.
 
@@ -355,8 +381,12 @@ namespace OpenZWave
 			//-----------------------------------------------------------------------------
 		private:
 			bool ReadMsg();
+			bool ReadFrame(uint32& _pos, uint32& _length);
+			bool ReadMsgBytes(uint32& _length, uint32 _size, int32 _timeout);
 			void ProcessMsg(uint8* _data, uint8 _length);
 
+			uint8 m_readBuffer[2048];							// Data taken from m_controller by ReadMsg, parsed in place.
+
 			void HandleGetVersionResponse(uint8* _data);
 			void HandleGetRandomResponse(uint8* _data);
 			void HandleSerialAPISetupResponse(uint8* _data);
@@ -425,6 +455,7 @@ namespace OpenZWave
 			uint8 m_expectedReply;							// If non-zero, we wait for a message with this function Id
 			uint8 m_expectedCommandClassId;					// If the expected reply is FUNC_ID_APPLICATION_COMMAND_HANDLER, this value stores the command class we're waiting to hear from
 			uint8 m_expectedNodeId;							// If we are waiting for a FUNC_ID_APPLICATION_COMMAND_HANDLER, make sure we only accept it from this node.
+			bool m_currentMsgDelivered;						// True once the node has acknowledged the current message, and only its report is awaited
 
 			//-----------------------------------------------------------------------------
 			//	Polling Z-Wave devices
@@ -443,20 +474,23 @@ namespace OpenZWave
 			bool DisablePoll(const ValueID &_valueId);
 			bool isPolled(const ValueID &_valueId);
 			void SetPollIntensity(const ValueID &_valueId, uint8 _intensity);
+			void SetPollInterval(const ValueID &_valueId, int32 _milliseconds);
 			static void PollThreadEntryPoint(Internal::Platform::Event* _exitEvent, void* _context);
 			void PollThreadProc(Internal::Platform::Event* _exitEvent);
 
 			Internal::Platform::Thread* m_pollThread;								// Thread for polling devices on the Z-Wave network
-			struct PollEntry
-			{
-					ValueID m_id;
-					uint8 m_pollCounter;
-			};
-			list<PollEntry> m_pollList;									// List of nodes that need to be polled
-			Internal::Platform::Mutex* m_pollMutex;								// Serialize access to the polling list
+			Internal::PollScheduler* m_pollScheduler;						// The polled values, in order of when they are next due
+			Internal::Platform::Mutex* m_pollMutex;								// Serialize access to the poll scheduler.  Nothing else is locked while it is held.
 			int32 m_pollInterval;								// Time interval during which all nodes must be polled
 			bool m_bIntervalBetweenPolls;					// if true, the library intersperses m_pollInterval between polls; if false, the library attempts to complete all polls within m_pollInterval
 
+		public:
+			/**
+			 * A polled value has been reported by its node, whether polled for or not.  The
+			 * value is then polled less often while it is not changing.
+			 */
+			void PollValueReported(ValueID const& _valueId, bool _changed);
+
 			//-----------------------------------------------------------------------------
 			//	Retrieving Node information
 			//-----------------------------------------------------------------------------
@@ -521,8 +555,11 @@ namespace OpenZWave
 			void SetNodeLevel(uint8 const _nodeId, uint8 const _level);
 			void SetNodeOn(uint8 const _nodeId);
 			void SetNodeOff(uint8 const _nodeId);
+			void SetNodeImportant(uint8 const _nodeId, bool const _important);
+			bool IsNodeImportant(uint8 const _nodeId);
 
 			Internal::VC::Value* GetValue(ValueID const& _id);
+			Internal::VC::Value* BorrowValue(ValueID const& _id);		// GetValue without adding a reference.  Call with m_nodeMutex held.
 
 			bool IsAPICallSupported(uint8 const _apinum) const
 			{
@@ -697,6 +734,7 @@ namespace OpenZWave
 			 *  RemoveNodeQuery, Node::AllQueriesCompleted
 			 */
 			bool WriteNextMsg(MsgQueue const _queue);							// Extracts the first message from the queue, and makes it the current one.
+			MsgQueue SelectMsgQueue(MsgQueue const _first, uint32 const _count);	// Asks the scheduler which of the first _count queues to serve, and puts the item to serve at its front.  _first is the highest priority one that is ready.  Returns MsgQueue_Count if none has an item that can be sent now.
 			bool WriteMsg(string const &str);									// Sends the current message to the Z-Wave network
 			void RemoveCurrentMsg();											// Deletes the current message and cleans up the callback etc states
 			bool MoveMessagesToWakeUpQueue(uint8 const _targetNodeId, bool const _move);		// If a node does not respond, and is of a type that can sleep, this method is used to move all its pending messages to another queue ready for when it wakes up next.
@@ -704,7 +742,12 @@ namespace OpenZWave
 			bool IsExpectedReply(uint8 const _nodeId);						// Determine if reply message is the one we are expecting
 			void SendQueryStageComplete(uint8 const _nodeId, Node::QueryStage const _stage);
 			void RetryQueryStageComplete(uint8 const _nodeId, Node::QueryStage const _stage);
-			void CheckCompletedNodeQueries();									// Send notifications if all awake and/or sleeping nodes have completed their queries
+			void CheckCompletedNodeQueries(uint8 const _nodeId);				// Send notifications if all awake and/or sleeping nodes have completed their queries
+			bool AwaitReport();												// Hands the current query to m_interviewScheduler to wait for its report, so that another node can be queried meanwhile
+			bool AwaitedReportReceived(uint8 const _nodeId, uint8 const* _data, uint32 const _length);	// Releases the query a report answers, if it was handed to m_interviewScheduler
+			void ExpireAwaitedReports();									// Queues again the queries whose reports have not arrived in time
+			int32 GetAwaitTimeout();										// Milliseconds until the next query handed to m_interviewScheduler times out
+			void UpdateNodeLatency(Node const* _node);						// Tells m_interviewScheduler how long a node takes to answer
 
 			// Requests to be sent to nodes are assigned to one of five queues.
 			// From highest to lowest priority, these are
@@ -740,6 +783,9 @@ namespace OpenZWave
 			//		at regular intervals.  These are of the lowest priority, and are only
 			//		sent when nothing else is going on
 			//
+			// That is the order the MsgScheduler starts from.  The FairMsgScheduler lets
+			// a message that is overdue jump it, and shares turns between Query and Poll.
+			//
 			enum MsgQueueCmd
 			{
 				MsgQueueCmd_SendMsg = 0,
@@ -752,8 +798,13 @@ namespace OpenZWave
 			{
 				public:
 					MsgQueueItem() :
-							m_msg(NULL), m_nodeId(0), m_queryStage(Node::QueryStage_None), m_retry(false), m_cci(NULL)
+							m_msg(NULL), m_nodeId(0), m_queryStage(Node::QueryStage_None), m_retry(false), m_cci(NULL), m_pinned(false)
+					{
+					}
+
+					uint8 GetNodeId() const
 					{
+						return (m_command == MsgQueueCmd_SendMsg) ? m_msg->GetTargetNodeId() : m_nodeId;
 					}
 
 					bool operator ==(MsgQueueItem const& _other) const
@@ -782,19 +833,56 @@ namespace OpenZWave
 						return false;
 					}
 
+					/** A hash of what operator == compares, for indexing queued items */
+					uint64 GetHash() const
+					{
+						uint64 hash = ((uint64) m_command) << 56;
+						if (m_command == MsgQueueCmd_SendMsg)
+						{
+							hash ^= m_msg->GetHash();
+						}
+						else if (m_command == MsgQueueCmd_QueryStageComplete)
+						{
+							hash |= (((uint64) m_nodeId) << 8) | (uint64) m_queryStage;
+						}
+						else if (m_command == MsgQueueCmd_Controller)
+						{
+							hash ^= (((uint64) m_cci->m_controllerCommand) << 48) ^ ((uint64) (uintptr_t) m_cci->m_controllerCallback);
+						}
+						else if (m_command == MsgQueueCmd_ReloadNode)
+						{
+							hash |= m_nodeId;
+						}
+						return hash;
+					}
+
 					MsgQueueCmd m_command;
 					Internal::Msg* m_msg;
 					uint8 m_nodeId;
 					Node::QueryStage m_queryStage;
 					bool m_retry;
 					ControllerCommandItem* m_cci;
+					bool m_pinned;										// Must be the next item taken from its queue
+					std::chrono::steady_clock::time_point m_queued;
+					std::chrono::steady_clock::time_point m_deadline;	// When the item is overdue, if the queue has deadlines
 			};
 
+			void PushMsgQueueItem(MsgQueueItem& _item, MsgQueue const _queue);	// Adds an item to the back of a queue.  The caller holds m_sendMutex.
+			void MsgQueueItemTaken(MsgQueueItem const& _item, MsgQueue const _queue);	// Records how long an item waited
+			bool BatchMsgQueueItem(MsgQueueItem& _item, MsgQueue const _queue);	// Adds a message to one queued for the same node, in a MultiCmd encapsulation.  The caller holds m_sendMutex.
+			void UpdateIdleSignal();											// Sets m_idleSignal from the queues and the current message
+
 			list<MsgQueueItem> m_msgQueue[MsgQueue_Count];
 			Internal::Platform::Event* m_queueEvent[MsgQueue_Count];		// Events for each queue, which are signaled when the queue is not empty
 			Internal::Platform::Mutex* m_sendMutex;						// Serialize access to the queues
 			Internal::Msg* m_currentMsg;
 			MsgQueue m_currentMsgQueueSource;			// identifies which queue held m_currentMsg
+			Internal::IdleSignal* m_idleSignal;			// Idle while the Command, Send, Query and Poll queues are empty and no message is being sent
+			Internal::MsgScheduler* m_msgScheduler;
+			Internal::InterviewScheduler* m_interviewScheduler;	// Orders the queries between the nodes, and holds those waiting for reports
+			int32 m_retryTimeout;						// Milliseconds to wait for a reply before sending a message again
+			uint8 m_lastQueueNode[MsgQueue_Count];		// The node last served from each queue, for the fair queues
+			bool m_multiCmdBatching;					// Batch queued commands for nodes that support MultiCmd
 			Internal::Platform::TimeStamp m_resendTimeStamp;
 
 			//-----------------------------------------------------------------------------
@@ -861,14 +949,39 @@ namespace OpenZWave
 			//-----------------------------------------------------------------------------
 		private:
 			void QueueNotification(Notification* _notification);				// Adds a notification to the list.  Notifications are queued until a point in the thread where we know we do not have any nodes locked.
+			void QueueValueNotification(Notification::NotificationType const _type, ValueID const& _id);	// Queues a ValueChanged or ValueRefreshed notification, unless it can be merged into one that is already queued
+			bool CoalesceValueNotification(Notification::NotificationType const _type, ValueID const& _id);	// Merges a value notification into a pending one for the same value, if there is one
+			void OnNotificationWindowExpired(uint32 _id);						// Timer callback that wakes the driver thread to deliver the notifications that were held back
 			void NotifyWatchers();												// Passes the notifications to all the registered watcher callbacks in turn.
 			list<Notification*> m_notifications;
 			Internal::Platform::Event* m_notificationsEvent;
+			Internal::NotificationDispatcher* m_notificationDispatcher;	// Delivers the notifications when the AsyncNotifications option is set, otherwise NULL
+			Internal::Platform::Thread* m_notificationThread;
+
+			// ValueChanged/ValueRefreshed notifications are held in m_notifications for up to
+			// m_notificationCoalesceWindow ms, and repeats for the same value merged into them
+			struct PendingValueNotification
+			{
+					Notification* m_notification;
+					std::chrono::steady_clock::time_point m_queued;
+			};
+			map<uint64, PendingValueNotification> m_pendingValueNotifications;	// Keyed by ValueID::GetId()
+			int32 m_notificationCoalesceWindow;
+			Internal::Timer* m_notificationTimer;
+			std::atomic<bool> m_notificationTimerSet;
+			uint32 m_notificationsMerged;
 
 			//-----------------------------------------------------------------------------
 			//	Statistics
 			//-----------------------------------------------------------------------------
 		public:
+			enum
+			{
+				PollLagBuckets = 8
+			};
+			/** Upper bounds, in milliseconds, of all but the last DriverData::m_pollLag bucket */
+			static int32 const c_pollLagBounds[PollLagBuckets - 1];
+
 			struct DriverData
 			{
 					uint32 m_SOFCnt;			// Number of SOF bytes received
@@ -893,12 +1006,44 @@ namespace OpenZWave
 					uint32 m_routedbusy;		// Number of messages received with routed busy status
 					uint32 m_broadcastReadCnt;	// Number of broadcasts read
 					uint32 m_broadcastWriteCnt;	// Number of broadcasts sent
+					uint32 m_notificationQueueDepth;	// Number of notifications waiting for the dispatcher thread (AsyncNotifications)
+					uint32 m_notificationQueueMax;	// Largest number of notifications that have waited for the dispatcher thread
+					uint32 m_notificationsDropped;	// Number of notifications dropped because the queue was full
+					uint32 m_notificationsCoalesced;	// Number of repeated value notifications dropped because the queue was full
+					uint32 m_notificationsMerged;	// Number of value notifications merged into a pending one (NotificationCoalesceWindow)
+					uint32 m_queueOverdue[MsgQueue_Count];	// Number of items taken from each queue after their deadline
+					uint32 m_multiCmdFramesSaved;	// Number of frames saved by batching commands into MultiCmd encapsulations
+					uint32 m_multiCmdAirTimeSaved;	// Estimated milliseconds of air time those frames would have taken
+					uint32 m_pollCnt;				// Number of polls sent
+					uint32 m_pollLag[PollLagBuckets];	// Number of polls, by how late they were sent.  See c_pollLagBounds.
+					uint32 m_pollsDeferred;			// Number of polls put off because the node had just reported the value
+					uint32 m_pollsBackedOff;		// Number of times a value was polled less often because it had not changed
+					uint32 m_pollWakeups;			// Number of times the poll thread has woken up
+					uint32 m_reportsAwaited;		// Number of queries whose reports were waited for while other nodes were queried (InterviewPipeline)
+					uint32 m_reportsTimedOut;		// Number of those queries that timed out and were sent again
+					uint32 m_allNodesQueriedTime;	// Milliseconds from opening the controller to all nodes being queried, or 0 until then
+			};
+
+			/** Latency histograms, in microseconds.  See Manager::GetDriverLatency. */
+			struct LatencyData
+			{
+					LatencyHistogramData m_queueWait[MsgQueue_Count];	// From queuing an item to taking it off its queue
+					LatencyHistogramData m_sendToAck;		// From writing a message to the controller to its ACK
+					LatencyHistogramData m_sendToCallback;	// From writing a message to the callback saying it was delivered
+					LatencyHistogramData m_notifyWatchers;	// Time the watchers took over each notification
 			};
 			void LogDriverStatistics();
 
 		private:
 			void GetDriverStatistics(DriverData* _data);
 			void GetNodeStatistics(uint8 const _nodeId, Node::NodeData* _data);
+			void GetLatencyData(LatencyData* _data);
+			bool GetNodeReportLatency(uint8 const _nodeId, LatencyHistogramData* _data);
+			bool GetCommandClassReportLatency(uint8 const _commandClassId, LatencyHistogramData* _data);
+			void ReportReceived(Node* _node, uint8 const _commandClassId);		// Records the time a node took to answer a request
+			static void MetricsThreadEntryPoint(Internal::Platform::Event* _exitEvent, void* _context);
+			void MetricsThreadProc(Internal::Platform::Event* _exitEvent);	// Writes the metrics out every MetricsExportInterval ms (MetricsExport)
+			void ExportMetrics();
 
 			uint32 m_SOFCnt;			// Number of SOF bytes received
 			uint32 m_ACKWaiting;		// Number of unsolicited messages while waiting for an ACK
@@ -922,6 +1067,23 @@ namespace OpenZWave
 			uint32 m_routedbusy;		// Number of messages received with routed busy status
 			uint32 m_broadcastReadCnt;	// Number of broadcasts read
 			uint32 m_broadcastWriteCnt;	// Number of broadcasts sent
+			uint32 m_queueOverdue[MsgQueue_Count];	// Number of items taken from each queue after their deadline
+			uint32 m_multiCmdFramesSaved;	// Number of frames saved by MultiCmd batching
+			uint64 m_multiCmdAirTimeSaved;	// Estimated microseconds of air time saved by MultiCmd batching
+			uint32 m_pollCnt;				// Number of polls sent
+			uint32 m_pollLag[PollLagBuckets];	// Number of polls, by how late they were sent
+			uint32 m_pollWakeups;			// Number of times the poll thread has woken up, apart from waiting for the queues
+			Internal::Platform::TimeStamp m_openedTime;	// When the controller was opened
+			uint32 m_allNodesQueriedTime;	// Milliseconds from opening the controller to all nodes being queried
+			Internal::LatencyHistogram m_queueWait[MsgQueue_Count];
+			Internal::LatencyHistogram m_sendToAck;
+			Internal::LatencyHistogram m_sendToCallback;
+			Internal::LatencyHistogram m_notifyWatchers;	// Watchers called on the driver thread.  The dispatcher has its own.
+			std::atomic<Internal::LatencyHistogram*> m_commandClassReportLatency[256];	// Created as each command class first answers a request
+			std::chrono::steady_clock::time_point m_writeTime;	// When the last message was written to the controller
+			Internal::MetricsExporter* m_metricsExporter;	// NULL unless the MetricsExport option is set.  Only used on m_metricsThread.
+			Internal::Platform::Thread* m_metricsThread;
+			int32 m_metricsInterval;
 			//time_t m_commandStart;	// Start time of last command
 			//time_t m_timeoutLost;		// Cumulative time lost to timeouts
 
@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+//
+//	IdleSignal.cpp
+//
+//	Lets a thread wait until another has nothing left to do
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include "IdleSignal.h"
+#include "Utils.h"
+#include "platform/Event.h"
+#include "platform/Mutex.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+//-----------------------------------------------------------------------------
+// <IdleSignal::IdleSignal>
+// Constructor
+//-----------------------------------------------------------------------------
+		IdleSignal::IdleSignal(Platform::Mutex* _mutex) :
+				m_mutex(_mutex), m_event(new Platform::Event()), m_idle(true), m_wakeups(0)
+		{
+			m_event->Set();
+		}
+
+//-----------------------------------------------------------------------------
+// <IdleSignal::~IdleSignal>
+// Destructor
+//-----------------------------------------------------------------------------
+		IdleSignal::~IdleSignal()
+		{
+			m_event->Release();
+		}
+
+//-----------------------------------------------------------------------------
+// <IdleSignal::Update>
+// Set whether the work is idle
+//-----------------------------------------------------------------------------
+		void IdleSignal::Update(bool _idle)
+		{
+			if (_idle == m_idle)
+			{
+				return;
+			}
+			m_idle = _idle;
+			if (_idle)
+			{
+				m_event->Set();
+			}
+			else
+			{
+				m_event->Reset();
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <IdleSignal::IsIdle>
+// Whether the work is idle
+//-----------------------------------------------------------------------------
+		bool IdleSignal::IsIdle() const
+		{
+			LockGuard LG(m_mutex);
+			return m_idle;
+		}
+
+//-----------------------------------------------------------------------------
+// <IdleSignal::WaitUntilIdle>
+// Sleep until the work is idle
+//-----------------------------------------------------------------------------
+		int32 IdleSignal::WaitUntilIdle(Platform::Event* _exitEvent, int32 _timeout)
+		{
+			// The event is only changed with the mutex held, so if the work goes idle after
+			// the check, the event is already set when the wait starts.  Waking up only means
+			// it was idle for a moment, so check again.
+			Platform::Wait* objects[2] =
+			{ _exitEvent, m_event };
+			while (!IsIdle())
+			{
+				int32 result = Platform::Wait::Multiple(objects, 2, _timeout);
+				++m_wakeups;
+				if (result <= 0)
+				{
+					return result;
+				}
+			}
+			return 1;
+		}
+	} // namespace Internal
+} // namespace OpenZWave
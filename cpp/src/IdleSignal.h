@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+//
+//	IdleSignal.h
+//
+//	Lets a thread wait until another has nothing left to do
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _IdleSignal_H
+#define _IdleSignal_H
+
+#include <atomic>
+
+#include "Defs.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+			class Event;
+			class Mutex;
+		}
+
+		/** \brief Whether some work is idle, with an event that is set while it is.
+		 *
+		 *  The owner of the work calls Update, holding its mutex, whenever the work may have
+		 *  become idle or busy.  Another thread calls WaitUntilIdle to sleep until then,
+		 *  rather than checking the owner's state over and over.  The idle state is read
+		 *  under the same mutex, so it is never seen part way through a change.
+		 */
+		class IdleSignal
+		{
+			public:
+				/**
+				 * Constructor.  Starts idle.
+				 * \param _mutex the mutex that guards the work.  It is not owned.
+				 */
+				IdleSignal(Platform::Mutex* _mutex);
+				~IdleSignal();
+
+				/**
+				 * Set whether the work is idle.  Call with the mutex held.
+				 */
+				void Update(bool _idle);
+
+				/**
+				 * Whether the work is idle.
+				 */
+				bool IsIdle() const;
+
+				/**
+				 * Wait until the work is idle.
+				 * \param _exitEvent an event that stops the wait.
+				 * \param _timeout the longest to wait in milliseconds, or -1 to wait forever.
+				 * \return 1 if the work is idle, 0 if _exitEvent was set, -1 if the wait timed out.
+				 */
+				int32 WaitUntilIdle(Platform::Event* _exitEvent, int32 _timeout);
+
+				/** The number of times a thread has woken up in WaitUntilIdle */
+				uint32 GetWakeups() const
+				{
+					return m_wakeups;
+				}
+
+			private:
+				IdleSignal(IdleSignal const&);					// prevent copy
+				IdleSignal& operator =(IdleSignal const&);		// prevent assignment
+
+				Platform::Mutex* m_mutex;
+				Platform::Event* m_event;						// Set while m_idle is true
+				bool m_idle;
+				std::atomic<uint32> m_wakeups;
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _IdleSignal_H
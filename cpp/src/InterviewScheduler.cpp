@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+//
+//	InterviewScheduler.cpp
+//
+//	Interleaves the queries of the nodes being interviewed
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "InterviewScheduler.h"
+#include "Msg.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::InterviewScheduler>
+// Constructor
+//-----------------------------------------------------------------------------
+		InterviewScheduler::InterviewScheduler(uint32 _pipeline) :
+				m_pipeline(_pipeline ? _pipeline : 1), m_answered(0), m_expired(0)
+		{
+			for (uint32 i = 0; i < 256; ++i)
+			{
+				m_nodes[i].m_important = false;
+				m_nodes[i].m_latency = 0;
+				m_nodes[i].m_msg = NULL;
+				m_nodes[i].m_queue = 0;
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::~InterviewScheduler>
+// Destructor
+//-----------------------------------------------------------------------------
+		InterviewScheduler::~InterviewScheduler()
+		{
+			while (!m_awaiting.empty())
+			{
+				delete Release(m_awaiting.back());
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::IsBefore>
+// Important nodes first, then the slowest to answer, then each in turn
+//-----------------------------------------------------------------------------
+		bool InterviewScheduler::IsBefore(uint8 _a, uint8 _b, uint8 _last) const
+		{
+			NodeState const& a = m_nodes[_a];
+			NodeState const& b = m_nodes[_b];
+			if (a.m_important != b.m_important)
+			{
+				return a.m_important;
+			}
+			if ((m_pipeline > 1) && (a.m_latency != b.m_latency))
+			{
+				return a.m_latency > b.m_latency;
+			}
+			return GetTurn(_a, _last) < GetTurn(_b, _last);
+		}
+
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::Await>
+// Hold a query until its report arrives
+//-----------------------------------------------------------------------------
+		void InterviewScheduler::Await(Msg* _msg, uint32 _queue, Clock::time_point _deadline)
+		{
+			uint8 nodeId = _msg->GetTargetNodeId();
+			NodeState& node = m_nodes[nodeId];
+			if (node.m_msg != NULL)
+			{
+				// Never happens, since a node with a query held is not sent another
+				delete Release(nodeId);
+			}
+			node.m_msg = _msg;
+			node.m_queue = _queue;
+			node.m_deadline = _deadline;
+			m_awaiting.push_back(nodeId);
+		}
+
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::ReportReceived>
+// Release the query a report answers
+//-----------------------------------------------------------------------------
+		Msg* InterviewScheduler::ReportReceived(uint8 _nodeId, uint8 const* _data, uint32 _length)
+		{
+			Msg* msg = m_nodes[_nodeId].m_msg;
+			if ((msg == NULL) || (_length == 0))
+			{
+				return NULL;
+			}
+
+			bool received;
+			if (msg->GetBatchCount())
+			{
+				// A MultiCmd encapsulation waits for the reports to each of its commands
+				received = msg->BatchReportReceived(_data, _length);
+			}
+			else
+			{
+				received = (msg->GetExpectedCommandClassId() == _data[0]);
+			}
+			if (!received)
+			{
+				return NULL;
+			}
+
+			++m_answered;
+			return Release(_nodeId);
+		}
+
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::TakeExpired>
+// Take a query that has waited too long for its report
+//-----------------------------------------------------------------------------
+		Msg* InterviewScheduler::TakeExpired(Clock::time_point _now, uint32* _queue)
+		{
+			for (std::vector<uint8>::iterator it = m_awaiting.begin(); it != m_awaiting.end(); ++it)
+			{
+				NodeState const& node = m_nodes[*it];
+				if (node.m_deadline <= _now)
+				{
+					*_queue = node.m_queue;
+					++m_expired;
+					return Release(*it);
+				}
+			}
+			return NULL;
+		}
+
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::Remove>
+// Take back the query held for a node
+//-----------------------------------------------------------------------------
+		Msg* InterviewScheduler::Remove(uint8 _nodeId)
+		{
+			return Release(_nodeId);
+		}
+
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::GetNextDeadline>
+// When the next held query times out
+//-----------------------------------------------------------------------------
+		bool InterviewScheduler::GetNextDeadline(Clock::time_point* _deadline) const
+		{
+			if (m_awaiting.empty())
+			{
+				return false;
+			}
+			*_deadline = m_nodes[m_awaiting.front()].m_deadline;
+			for (std::vector<uint8>::const_iterator it = m_awaiting.begin(); it != m_awaiting.end(); ++it)
+			{
+				*_deadline = std::min(*_deadline, m_nodes[*it].m_deadline);
+			}
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <InterviewScheduler::Release>
+// Stop holding a node's query and hand it back
+//-----------------------------------------------------------------------------
+		Msg* InterviewScheduler::Release(uint8 _nodeId)
+		{
+			Msg* msg = m_nodes[_nodeId].m_msg;
+			if (msg != NULL)
+			{
+				m_nodes[_nodeId].m_msg = NULL;
+				m_awaiting.erase(std::find(m_awaiting.begin(), m_awaiting.end(), _nodeId));
+			}
+			return msg;
+		}
+	} // namespace Internal
+} // namespace OpenZWave
@@ -0,0 +1,195 @@
+//-----------------------------------------------------------------------------
+//
+//	InterviewScheduler.h
+//
+//	Interleaves the queries of the nodes being interviewed
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _InterviewScheduler_H
+#define _InterviewScheduler_H
+
+#include <chrono>
+#include <vector>
+
+#include "Defs.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		class Msg;
+
+		/** \brief Decides which node's query is sent next, and holds the queries whose
+		 *  reports are still to come.
+		 *
+		 *  The controller sends one message at a time, but most of the time a query takes is
+		 *  spent waiting for the node to send its report back.  Once the node has acknowledged
+		 *  a query, the Driver may hand the query over to this class and go on to query another
+		 *  node, up to the pipeline depth of nodes in all.  The query stays here until its
+		 *  report arrives, or it times out and is sent again.
+		 *
+		 *  Nodes are queried in this order:
+		 *  - The nodes the application has marked as important.
+		 *  - With a pipeline, the nodes that take longest to answer, so that their waits
+		 *    overlap the most with the queries of the others.
+		 *  - Otherwise, each node in turn.
+		 *  A node with a query held here is not sent another until its report arrives.
+		 *
+		 *  It does no locking of its own.
+		 */
+		class InterviewScheduler
+		{
+			public:
+				typedef std::chrono::steady_clock Clock;
+
+				/**
+				 * Constructor.
+				 * \param _pipeline the number of nodes that may have a query outstanding at once,
+				 * including the one the Driver is sending to.  1 turns the pipeline off.
+				 */
+				InterviewScheduler(uint32 _pipeline = 1);
+				~InterviewScheduler();
+
+				/** The number of nodes that may have a query outstanding at once */
+				uint32 GetPipeline() const
+				{
+					return m_pipeline;
+				}
+
+				/** Mark a node as one to query ahead of the others */
+				void SetImportant(uint8 _nodeId, bool _important)
+				{
+					m_nodes[_nodeId].m_important = _important;
+				}
+
+				/** Whether a node is queried ahead of the others */
+				bool IsImportant(uint8 _nodeId) const
+				{
+					return m_nodes[_nodeId].m_important;
+				}
+
+				/** Set the time a node takes to answer a query, in milliseconds */
+				void SetLatency(uint8 _nodeId, int32 _latency)
+				{
+					m_nodes[_nodeId].m_latency = _latency;
+				}
+
+				/**
+				 * Whether node _a is queried before node _b.
+				 * \param _last the node queried last, which is the last to get another turn.
+				 */
+				bool IsBefore(uint8 _a, uint8 _b, uint8 _last) const;
+
+				/** Where a node comes in the turn that starts after node _last */
+				static uint8 GetTurn(uint8 _nodeId, uint8 _last)
+				{
+					return (uint8) (_nodeId - _last - 1);
+				}
+
+				/** Whether another query can be held while the Driver sends the next */
+				bool CanAwait() const
+				{
+					return (m_awaiting.size() + 1) < m_pipeline;
+				}
+
+				/**
+				 * Hold a query that its node has acknowledged until the report arrives.
+				 * \param _msg the query, which is now owned by this class.
+				 * \param _queue the Driver queue to send it from again if it times out.
+				 * \param _deadline when it times out.
+				 */
+				void Await(Msg* _msg, uint32 _queue, Clock::time_point _deadline);
+
+				/** Whether a node has a query held until its report arrives */
+				bool IsAwaiting(uint8 _nodeId) const
+				{
+					return m_nodes[_nodeId].m_msg != NULL;
+				}
+
+				/** The number of queries held */
+				uint32 GetAwaitingCount() const
+				{
+					return (uint32) m_awaiting.size();
+				}
+
+				/**
+				 * A node has sent a report.
+				 * \param _data the command class, command and parameters of the report.
+				 * \return the query it answers, now owned by the caller, or NULL.
+				 */
+				Msg* ReportReceived(uint8 _nodeId, uint8 const* _data, uint32 _length);
+
+				/**
+				 * Take a query whose report has not arrived by _now.
+				 * \param _queue set to the Driver queue it came from.
+				 * \return the query, now owned by the caller, or NULL if none has timed out.
+				 */
+				Msg* TakeExpired(Clock::time_point _now, uint32* _queue);
+
+				/**
+				 * Take back the query held for a node.
+				 * \return the query, now owned by the caller, or NULL.
+				 */
+				Msg* Remove(uint8 _nodeId);
+
+				/**
+				 * When the next held query times out.
+				 * \return false if none is held.
+				 */
+				bool GetNextDeadline(Clock::time_point* _deadline) const;
+
+				/** The number of queries that were held until their report arrived */
+				uint32 GetAnswered() const
+				{
+					return m_answered;
+				}
+
+				/** The number of held queries that timed out */
+				uint32 GetExpired() const
+				{
+					return m_expired;
+				}
+
+			private:
+				InterviewScheduler(InterviewScheduler const&);					// prevent copy
+				InterviewScheduler& operator =(InterviewScheduler const&);		// prevent assignment
+
+				struct NodeState
+				{
+						bool m_important;
+						int32 m_latency;					// Milliseconds, or 0 if not known yet
+						Msg* m_msg;							// The query held until its report arrives
+						uint32 m_queue;
+						Clock::time_point m_deadline;
+				};
+
+				Msg* Release(uint8 _nodeId);
+
+				NodeState m_nodes[256];
+				std::vector<uint8> m_awaiting;				// The nodes with a query held
+				uint32 m_pipeline;
+				uint32 m_answered;
+				uint32 m_expired;
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _InterviewScheduler_H
@@ -0,0 +1,215 @@
+//-----------------------------------------------------------------------------
+//
+//	LatencyHistogram.cpp
+//
+//	Lock-free histogram of latencies, with fine buckets at every scale
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <string.h>
+
+#include "LatencyHistogram.h"
+
+namespace OpenZWave
+{
+//-----------------------------------------------------------------------------
+// <LatencyHistogramData::LatencyHistogramData>
+// Constructor
+//-----------------------------------------------------------------------------
+	LatencyHistogramData::LatencyHistogramData()
+	{
+		Clear();
+	}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogramData::Clear>
+// Empty the histogram
+//-----------------------------------------------------------------------------
+	void LatencyHistogramData::Clear()
+	{
+		memset(m_buckets, 0, sizeof(m_buckets));
+		m_count = 0;
+		m_max = 0;
+		m_sum = 0;
+	}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogramData::Add>
+// Add in the latencies of another histogram
+//-----------------------------------------------------------------------------
+	void LatencyHistogramData::Add(LatencyHistogramData const& _other)
+	{
+		for (uint32 i = 0; i < BucketCount; ++i)
+		{
+			m_buckets[i] += _other.m_buckets[i];
+		}
+		m_count += _other.m_count;
+		m_sum += _other.m_sum;
+		if (_other.m_max > m_max)
+		{
+			m_max = _other.m_max;
+		}
+	}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogramData::GetPercentile>
+// The latency that a given share of those recorded did not exceed
+//-----------------------------------------------------------------------------
+	uint32 LatencyHistogramData::GetPercentile(double _percentile) const
+	{
+		if (m_count == 0)
+		{
+			return 0;
+		}
+
+		uint64 rank = (uint64) (_percentile * m_count / 100.0 + 0.5);
+		if (rank < 1)
+		{
+			rank = 1;
+		}
+		uint64 seen = 0;
+		for (uint32 i = 0; i < BucketCount; ++i)
+		{
+			seen += m_buckets[i];
+			if (seen >= rank)
+			{
+				uint32 upper = GetBucketUpperBound(i);
+				return (upper < m_max) ? upper : m_max;
+			}
+		}
+		return m_max;
+	}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogramData::GetCountAtOrBelow>
+// The number of latencies in the buckets that hold nothing above a bound
+//-----------------------------------------------------------------------------
+	uint32 LatencyHistogramData::GetCountAtOrBelow(uint32 _micros) const
+	{
+		uint32 count = 0;
+		for (uint32 i = 0; (i < BucketCount) && (GetBucketUpperBound(i) <= _micros); ++i)
+		{
+			count += m_buckets[i];
+		}
+		return count;
+	}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogramData::GetBucket>
+// The bucket a latency is counted in
+//-----------------------------------------------------------------------------
+	uint32 LatencyHistogramData::GetBucket(uint32 _micros)
+	{
+		if (_micros < SubBuckets)
+		{
+			return _micros;
+		}
+
+		// Position of the highest bit set
+		uint32 msb = 0;
+		for (uint32 step = 16; step > 0; step >>= 1)
+		{
+			if (_micros >> (msb + step))
+			{
+				msb += step;
+			}
+		}
+		// The three bits below it pick one of the 8 buckets for that power of two
+		uint32 shift = msb - 3;
+		return (msb - 2) * SubBuckets + ((_micros >> shift) & (SubBuckets - 1));
+	}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogramData::GetBucketLowerBound>
+// The smallest latency counted in a bucket
+//-----------------------------------------------------------------------------
+	uint32 LatencyHistogramData::GetBucketLowerBound(uint32 _bucket)
+	{
+		if (_bucket < SubBuckets)
+		{
+			return _bucket;
+		}
+		uint32 shift = _bucket / SubBuckets - 1;
+		return (SubBuckets + (_bucket % SubBuckets)) << shift;
+	}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogramData::GetBucketUpperBound>
+// The largest latency counted in a bucket
+//-----------------------------------------------------------------------------
+	uint32 LatencyHistogramData::GetBucketUpperBound(uint32 _bucket)
+	{
+		if (_bucket < SubBuckets)
+		{
+			return _bucket;
+		}
+		uint32 shift = _bucket / SubBuckets - 1;
+		return (uint32) (((uint64) GetBucketLowerBound(_bucket) + (1ULL << shift)) - 1);
+	}
+
+	namespace Internal
+	{
+//-----------------------------------------------------------------------------
+// <LatencyHistogram::LatencyHistogram>
+// Constructor
+//-----------------------------------------------------------------------------
+		LatencyHistogram::LatencyHistogram() :
+				m_count(0), m_max(0), m_sum(0)
+		{
+			for (uint32 i = 0; i < LatencyHistogramData::BucketCount; ++i)
+			{
+				m_buckets[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogram::Record>
+// Record a latency in microseconds
+//-----------------------------------------------------------------------------
+		void LatencyHistogram::Record(uint32 _micros)
+		{
+			m_buckets[LatencyHistogramData::GetBucket(_micros)].fetch_add(1, std::memory_order_relaxed);
+			m_count.fetch_add(1, std::memory_order_relaxed);
+			m_sum.fetch_add(_micros, std::memory_order_relaxed);
+
+			uint32 max = m_max.load(std::memory_order_relaxed);
+			while ((_micros > max) && !m_max.compare_exchange_weak(max, _micros, std::memory_order_relaxed))
+			{
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <LatencyHistogram::GetData>
+// Copy the histogram
+//-----------------------------------------------------------------------------
+		void LatencyHistogram::GetData(LatencyHistogramData* _data) const
+		{
+			// Count from the buckets, so the percentiles add up even while latencies are recorded
+			_data->m_count = 0;
+			for (uint32 i = 0; i < LatencyHistogramData::BucketCount; ++i)
+			{
+				_data->m_buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+				_data->m_count += _data->m_buckets[i];
+			}
+			_data->m_max = m_max.load(std::memory_order_relaxed);
+			_data->m_sum = m_sum.load(std::memory_order_relaxed);
+		}
+	} // namespace Internal
+} // namespace OpenZWave
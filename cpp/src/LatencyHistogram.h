@@ -0,0 +1,140 @@
+//-----------------------------------------------------------------------------
+//
+//	LatencyHistogram.h
+//
+//	Lock-free histogram of latencies, with fine buckets at every scale
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _LatencyHistogram_H
+#define _LatencyHistogram_H
+
+#include <atomic>
+#include <chrono>
+
+#include "Defs.h"
+
+namespace OpenZWave
+{
+	/** \brief A copy of a latency histogram, taken with Manager::GetDriverLatency and the like.
+	 *
+	 *  Latencies are in microseconds.  Below 8us each bucket holds a single value.  Above that,
+	 *  each power of two is split into 8 buckets, so a bucket is never wider than an eighth of
+	 *  the values it holds, and a percentile read from the buckets is within 12.5% of the truth.
+	 */
+	struct OPENZWAVE_EXPORT LatencyHistogramData
+	{
+			enum
+			{
+				SubBuckets = 8,
+				BucketCount = 240
+			};
+
+			uint32 m_buckets[BucketCount];		// Number of latencies in each bucket.  See GetBucketLowerBound.
+			uint32 m_count;						// Number of latencies recorded
+			uint32 m_max;						// Largest latency recorded
+			uint64 m_sum;						// Sum of the latencies recorded
+
+			LatencyHistogramData();
+
+			/** Empty the histogram */
+			void Clear();
+
+			/** Add in the latencies of another histogram */
+			void Add(LatencyHistogramData const& _other);
+
+			/** The mean latency, or 0 if none has been recorded */
+			uint32 GetMean() const
+			{
+				return m_count ? (uint32) (m_sum / m_count) : 0;
+			}
+
+			/**
+			 * The latency that a given share of those recorded did not exceed.
+			 * \param _percentile from 0 to 100.
+			 * \return the upper bound of the bucket the percentile falls in, but no more than the
+			 * largest latency recorded, or 0 if none has been recorded.
+			 */
+			uint32 GetPercentile(double _percentile) const;
+
+			/** The number of latencies recorded in buckets that hold nothing above _micros */
+			uint32 GetCountAtOrBelow(uint32 _micros) const;
+
+			/** The bucket a latency is counted in */
+			static uint32 GetBucket(uint32 _micros);
+
+			/** The smallest latency counted in a bucket */
+			static uint32 GetBucketLowerBound(uint32 _bucket);
+
+			/** The largest latency counted in a bucket */
+			static uint32 GetBucketUpperBound(uint32 _bucket);
+	};
+
+	namespace Internal
+	{
+		/** \brief Records latencies into the buckets of a LatencyHistogramData.
+		 *
+		 *  Record may be called from any thread, and GetData from any other, without locking.
+		 *  The counters are updated independently, so a copy taken while latencies are being
+		 *  recorded may have one in its bucket that is not yet in m_sum or m_max.
+		 */
+		class LatencyHistogram
+		{
+			public:
+				LatencyHistogram();
+
+				/** Record a latency in microseconds */
+				void Record(uint32 _micros);
+
+				/** Record a latency.  A negative one, from a clock set back, counts as 0. */
+				void Record(std::chrono::steady_clock::duration _latency)
+				{
+					int64 micros = std::chrono::duration_cast<std::chrono::microseconds>(_latency).count();
+					Record(micros < 0 ? 0 : (micros > 0xffffffff ? 0xffffffff : (uint32) micros));
+				}
+
+				/** Record the time from _start until now */
+				void RecordSince(std::chrono::steady_clock::time_point _start)
+				{
+					Record(std::chrono::steady_clock::now() - _start);
+				}
+
+				/** Copy the histogram into _data */
+				void GetData(LatencyHistogramData* _data) const;
+
+				/** The number of latencies recorded */
+				uint32 GetCount() const
+				{
+					return m_count.load(std::memory_order_relaxed);
+				}
+
+			private:
+				LatencyHistogram(LatencyHistogram const&);					// prevent copy
+				LatencyHistogram& operator =(LatencyHistogram const&);		// prevent assignment
+
+				std::atomic<uint32> m_buckets[LatencyHistogramData::BucketCount];
+				std::atomic<uint32> m_count;
+				std::atomic<uint32> m_max;
+				std::atomic<uint64> m_sum;
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _LatencyHistogram_H
@@ -48,6 +48,8 @@ namespace OpenZWave
 		std::map<uint8, std::shared_ptr<LabelLocalizationEntry> > Localization::m_commandClassLocalizationMap;
 		std::map<std::string, std::shared_ptr<LabelLocalizationEntry> > Localization::m_globalLabelLocalizationMap;
 		std::string Localization::m_selectedLang = "";
+		std::set<std::string> Localization::m_strings;
+		std::mutex Localization::m_stringsMutex;
 		uint32 Localization::m_revision = 0;
 
 		LabelLocalizationEntry::LabelLocalizationEntry(uint16 _index, uint32 _pos) :
@@ -87,8 +89,9 @@ namespace OpenZWave
 		}
 
 		ValueLocalizationEntry::ValueLocalizationEntry(uint8 _commandClass, uint16 _index, uint32 _pos) :
-				m_commandClass(_commandClass), m_index(_index), m_pos(_pos)
+				m_commandClass(_commandClass), m_index(_index), m_pos(_pos), m_boundLang(Localization::Get()->GetSelectedLang())
 		{
+			m_boundLabel = m_boundHelp = Localization::Intern("");
 		}
 
 		uint64 ValueLocalizationEntry::GetIdx()
@@ -120,7 +123,8 @@ namespace OpenZWave
 				m_DefaultHelpText = HelpText;
 			else
 				m_HelpText[lang] = HelpText;
-
+			if (lang.empty() || (lang == m_boundLang))
+				m_boundHelp = Localization::Intern(GetHelp(m_boundLang));
 		}
 		std::string ValueLocalizationEntry::GetLabel(string lang)
 		{
@@ -144,6 +148,8 @@ namespace OpenZWave
 				m_DefaultLabelText = Label;
 			else
 				m_LabelText[lang] = Label;
+			if (lang.empty() || (lang == m_boundLang))
+				m_boundLabel = Localization::Intern(GetLabel(m_boundLang));
 		}
 
 		void ValueLocalizationEntry::AddItemLabel(string label, int32 itemindex, string lang)
@@ -156,7 +162,8 @@ namespace OpenZWave
 			{
 				m_ItemLabelText[lang][itemindex] = label;
 			}
-
+			if (lang.empty() || (lang == m_boundLang))
+				BindItemLabel(itemindex);
 		}
 		std::string ValueLocalizationEntry::GetItemLabel(string lang, int32 itemindex)
 		{
@@ -193,7 +200,8 @@ namespace OpenZWave
 			{
 				m_ItemHelpText[lang][itemindex] = label;
 			}
-
+			if (lang.empty() || (lang == m_boundLang))
+				BindItemHelp(itemindex);
 		}
 		std::string ValueLocalizationEntry::GetItemHelp(string lang, int32 itemindex)
 		{
@@ -235,6 +243,49 @@ namespace OpenZWave
 			return false;
 		}
 
+		void ValueLocalizationEntry::Bind(string const& lang)
+		{
+			m_boundLang = lang;
+			m_boundLabel = Localization::Intern(GetLabel(lang));
+			m_boundHelp = Localization::Intern(GetHelp(lang));
+
+			m_boundItemLabel.clear();
+			for (map<int32, string>::iterator it = m_DefaultItemLabelText.begin(); it != m_DefaultItemLabelText.end(); ++it)
+				BindItemLabel(it->first);
+			if (m_ItemLabelText.find(lang) != m_ItemLabelText.end())
+				for (map<int32, string>::iterator it = m_ItemLabelText[lang].begin(); it != m_ItemLabelText[lang].end(); ++it)
+					BindItemLabel(it->first);
+
+			m_boundItemHelp.clear();
+			for (map<int32, string>::iterator it = m_DefaultItemHelpText.begin(); it != m_DefaultItemHelpText.end(); ++it)
+				BindItemHelp(it->first);
+			if (m_ItemHelpText.find(lang) != m_ItemHelpText.end())
+				for (map<int32, string>::iterator it = m_ItemHelpText[lang].begin(); it != m_ItemHelpText[lang].end(); ++it)
+					BindItemHelp(it->first);
+		}
+
+		void ValueLocalizationEntry::BindItemLabel(int32 itemIndex)
+		{
+			m_boundItemLabel[itemIndex] = Localization::Intern(GetItemLabel(m_boundLang, itemIndex));
+		}
+
+		void ValueLocalizationEntry::BindItemHelp(int32 itemIndex)
+		{
+			m_boundItemHelp[itemIndex] = Localization::Intern(GetItemHelp(m_boundLang, itemIndex));
+		}
+
+		std::string const* ValueLocalizationEntry::FindBoundItemLabel(int32 itemIndex) const
+		{
+			map<int32, string const*>::const_iterator it = m_boundItemLabel.find(itemIndex);
+			return (it != m_boundItemLabel.end()) ? it->second : NULL;
+		}
+
+		std::string const* ValueLocalizationEntry::FindBoundItemHelp(int32 itemIndex) const
+		{
+			map<int32, string const*>::const_iterator it = m_boundItemHelp.find(itemIndex);
+			return (it != m_boundItemHelp.end()) ? it->second : NULL;
+		}
+
 		Localization::Localization()
 		{
 		}
@@ -561,6 +612,47 @@ namespace OpenZWave
 			return ((uint64) _commandClass << 48) | ((uint64) _index << 32) | ((uint64) _pos);
 		}
 
+		bool Localization::IsUniqueItemKey(uint8 _commandClass, uint16 _index)
+		{
+			if ((_commandClass == Internal::CC::SoundSwitch::StaticGetCommandClassId()) && (_index == 1 || _index == 3))
+			{
+				return true;
+			}
+			if ((_commandClass == Internal::CC::CentralScene::StaticGetCommandClassId()) && (_index < 256))
+			{
+				return true;
+			}
+			return false;
+		}
+
+		ValueLocalizationEntry* Localization::GetValueEntry(uint8 node, uint8 ccID, uint16 indexId, int32 pos) const
+		{
+			map<uint64, std::shared_ptr<ValueLocalizationEntry> >::const_iterator it = m_valueLocalizationMap.find(GetValueKey(node, ccID, indexId, pos));
+			return (it != m_valueLocalizationMap.end()) ? it->second.get() : NULL;
+		}
+
+		ValueLocalizationEntry* Localization::GetValueItemEntry(uint8 node, uint8 ccID, uint16 indexId, int32 pos) const
+		{
+			map<uint64, std::shared_ptr<ValueLocalizationEntry> >::const_iterator it = m_valueLocalizationMap.find(GetValueKey(node, ccID, indexId, pos, IsUniqueItemKey(ccID, indexId)));
+			return (it != m_valueLocalizationMap.end()) ? it->second.get() : NULL;
+		}
+
+		std::string const* Localization::Intern(string const& text)
+		{
+			std::lock_guard<std::mutex> lock(m_stringsMutex);
+			return &*m_strings.insert(text).first;
+		}
+
+		void Localization::SetSelectedLang(string const& lang)
+		{
+			m_selectedLang = lang;
+			for (map<uint64, std::shared_ptr<ValueLocalizationEntry> >::iterator it = m_valueLocalizationMap.begin(); it != m_valueLocalizationMap.end(); ++it)
+			{
+				it->second->Bind(lang);
+			}
+			Log::Write(LogLevel_Info, "Localization: Switched to Language %s", lang.empty() ? "(default)" : lang.c_str());
+		}
+
 		void Localization::SetupCommandClass(Internal::CC::CommandClass *cc)
 		{
 			uint8 ccID = cc->GetCommandClassId();
@@ -622,59 +714,44 @@ namespace OpenZWave
 
 		std::string const Localization::GetValueHelp(uint8 node, uint8 ccID, uint16 indexId, uint32 pos)
 		{
-			uint64 key = GetValueKey(node, ccID, indexId, pos);
-			if (m_valueLocalizationMap.find(key) == m_valueLocalizationMap.end())
+			ValueLocalizationEntry* entry = GetValueEntry(node, ccID, indexId, pos);
+			if (entry == NULL)
 			{
 				Log::Write(LogLevel_Warning, "Localization::GetValueHelp: No Help for CommandClass %xd, ValueID: %d (%d)", ccID, indexId, pos);
 				return "";
 			}
-			return m_valueLocalizationMap[key]->GetHelp(m_selectedLang);
+			return entry->GetBoundHelp();
 		}
 
 		std::string const Localization::GetValueLabel(uint8 node, uint8 ccID, uint16 indexId, int32 pos) const
 		{
-			uint64 key = GetValueKey(node, ccID, indexId, pos);
-			if (m_valueLocalizationMap.find(key) == m_valueLocalizationMap.end())
+			ValueLocalizationEntry* entry = GetValueEntry(node, ccID, indexId, pos);
+			if (entry == NULL)
 			{
 				Log::Write(LogLevel_Warning, "Localization::GetValueLabel: No Label for CommandClass %xd, ValueID: %d (%d)", ccID, indexId, pos);
 				return "";
 			}
-			return m_valueLocalizationMap[key]->GetLabel(m_selectedLang);
+			return entry->GetBoundLabel();
 		}
 
 		std::string const Localization::GetValueItemLabel(uint8 node, uint8 ccID, uint16 indexId, int32 pos, int32 itemIndex) const
 		{
-			bool unique = false;
-			if ((ccID == Internal::CC::SoundSwitch::StaticGetCommandClassId()) && (indexId == 1 || indexId == 3))
-			{
-				unique = true;
-			}
-			if ((ccID == Internal::CC::CentralScene::StaticGetCommandClassId()) && (indexId < 256))
-			{
-				unique = true;
-			}
-			uint64 key = GetValueKey(node, ccID, indexId, pos, unique);
-			if (m_valueLocalizationMap.find(key) == m_valueLocalizationMap.end())
+			ValueLocalizationEntry* entry = GetValueItemEntry(node, ccID, indexId, pos);
+			if (entry == NULL)
 			{
 				Log::Write(LogLevel_Warning, "Localization::GetValueItemLabel: No ValueLocalizationMap for CommandClass %xd, ValueID: %d (%d) ItemIndex %d", ccID, indexId, pos, itemIndex);
 				return "";
 			}
-			return m_valueLocalizationMap[key]->GetItemLabel(m_selectedLang, itemIndex);
+			if (string const* label = entry->FindBoundItemLabel(itemIndex))
+			{
+				return *label;
+			}
+			return entry->GetItemLabel(m_selectedLang, itemIndex);
 		}
 
 		bool Localization::SetValueItemLabel(uint8 node, uint8 ccID, uint16 indexId, int32 pos, int32 itemIndex, string label, string lang)
 		{
-			bool unique = false;
-			if ((ccID == Internal::CC::SoundSwitch::StaticGetCommandClassId()) && (indexId == 1 || indexId == 3))
-			{
-				unique = true;
-			}
-			if ((ccID == Internal::CC::CentralScene::StaticGetCommandClassId()) && (indexId < 256))
-			{
-				unique = true;
-			}
-
-			uint64 key = GetValueKey(node, ccID, indexId, pos, unique);
+			uint64 key = GetValueKey(node, ccID, indexId, pos, IsUniqueItemKey(ccID, indexId));
 			if (m_valueLocalizationMap.find(key) == m_valueLocalizationMap.end())
 			{
 				m_valueLocalizationMap[key] = std::shared_ptr<ValueLocalizationEntry> (new ValueLocalizationEntry(ccID, indexId, pos));
@@ -689,38 +766,22 @@ namespace OpenZWave
 
 		std::string const Localization::GetValueItemHelp(uint8 node, uint8 ccID, uint16 indexId, int32 pos, int32 itemIndex) const
 		{
-			bool unique = false;
-			if ((ccID == Internal::CC::SoundSwitch::StaticGetCommandClassId()) && (indexId == 1 || indexId == 3))
-			{
-				unique = true;
-			}
-			if ((ccID == Internal::CC::CentralScene::StaticGetCommandClassId()) && (indexId < 256))
-			{
-				unique = true;
-			}
-
-			uint64 key = GetValueKey(node, ccID, indexId, pos, unique);
-			if (m_valueLocalizationMap.find(key) == m_valueLocalizationMap.end())
+			ValueLocalizationEntry* entry = GetValueItemEntry(node, ccID, indexId, pos);
+			if (entry == NULL)
 			{
 				Log::Write(LogLevel_Warning, "Localization::GetValueItemHelp: No ValueLocalizationMap for CommandClass %xd, ValueID: %d (%d) ItemIndex %d", ccID, indexId, pos, itemIndex);
 				return "";
 			}
-			return m_valueLocalizationMap[key]->GetItemHelp(m_selectedLang, itemIndex);
+			if (string const* help = entry->FindBoundItemHelp(itemIndex))
+			{
+				return *help;
+			}
+			return entry->GetItemHelp(m_selectedLang, itemIndex);
 		}
 
 		bool Localization::SetValueItemHelp(uint8 node, uint8 ccID, uint16 indexId, int32 pos, int32 itemIndex, string label, string lang)
 		{
-			bool unique = false;
-			if ((ccID == Internal::CC::SoundSwitch::StaticGetCommandClassId()) && (indexId == 1 || indexId == 3))
-			{
-				unique = true;
-			}
-			if ((ccID == Internal::CC::CentralScene::StaticGetCommandClassId()) && (indexId < 256))
-			{
-				unique = true;
-			}
-
-			uint64 key = GetValueKey(node, ccID, indexId, pos, unique);
+			uint64 key = GetValueKey(node, ccID, indexId, pos, IsUniqueItemKey(ccID, indexId));
 			if (m_valueLocalizationMap.find(key) == m_valueLocalizationMap.end())
 			{
 				m_valueLocalizationMap[key] = std::shared_ptr<ValueLocalizationEntry> (new ValueLocalizationEntry(ccID, indexId, pos));
@@ -790,10 +851,11 @@ namespace OpenZWave
 				return m_instance;
 			}
 			m_instance = new Localization();
+			/* Read the Language first, so the entries are bound to it as they are loaded */
+			Options::Get()->GetOptionAsString("Language", &m_selectedLang);
 			if (!ReadXML()) {
 				OZW_ERROR(OZWException::OZWEXCEPTION_CONFIG, "Cannot Create Localization Class! - Missing/Invalid Config File?");
 			}
-			Options::Get()->GetOptionAsString("Language", &m_selectedLang);
 			return m_instance;
 		}
 	} // namespace Internal
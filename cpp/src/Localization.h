@@ -31,6 +31,8 @@
 #include <cstdio>
 #include <string>
 #include <map>
+#include <mutex>
+#include <set>
 #include "Defs.h"
 #include "Driver.h"
 #include "command_classes/CommandClass.h"
@@ -81,7 +83,30 @@ namespace OpenZWave
 				string GetItemHelp(string lang, int32 itemIndex);
 				bool HasItemHelp(int32 itemIndex, string lang);
 
+				/**
+				 * Resolve the texts for a language once, so that the GetBound* and FindBound* methods
+				 * need no lookup by language.  The entry stays bound to the language as texts are added.
+				 */
+				void Bind(string const& lang);
+				/** The label in the language the entry is bound to */
+				string const& GetBoundLabel() const
+				{
+					return *m_boundLabel;
+				}
+				/** The help in the language the entry is bound to */
+				string const& GetBoundHelp() const
+				{
+					return *m_boundHelp;
+				}
+				/** An item's label in the language the entry is bound to, or NULL if the item has none */
+				string const* FindBoundItemLabel(int32 itemIndex) const;
+				/** An item's help in the language the entry is bound to, or NULL if the item has none */
+				string const* FindBoundItemHelp(int32 itemIndex) const;
+
 			private:
+				void BindItemLabel(int32 itemIndex);
+				void BindItemHelp(int32 itemIndex);
+
 				uint8 m_commandClass;
 				uint16 m_index;
 				uint32 m_pos;
@@ -93,6 +118,11 @@ namespace OpenZWave
 				string m_DefaultLabelText;
 				map<int32, string> m_DefaultItemLabelText;
 				map<int32, string> m_DefaultItemHelpText;
+				string m_boundLang;
+				string const* m_boundLabel;					// Interned by Localization
+				string const* m_boundHelp;
+				map<int32, string const*> m_boundItemLabel;
+				map<int32, string const*> m_boundItemHelp;
 		};
 
 		class Localization
@@ -110,6 +140,7 @@ namespace OpenZWave
 				static void ReadXMLVIDItemLabel(uint8 node, uint8 ccID, uint16 indexId, uint32 pos, const TiXmlElement *labelElement);
 				static void ReadGlobalXMLLabel(const TiXmlElement *labelElement);
 				static uint64 GetValueKey(uint8 _node, uint8 _commandClass, uint16 _index, uint32 _pos, bool unique = false);
+				static bool IsUniqueItemKey(uint8 _commandClass, uint16 _index);
 			public:
 				static Localization* Get();
 				void SetupCommandClass(Internal::CC::CommandClass *cc);
@@ -118,6 +149,28 @@ namespace OpenZWave
 					return Localization::m_selectedLang;
 				}
 				;
+				/**
+				 * Switch the language of the value texts.  Every entry is bound to the new language
+				 * in one pass, so the values holding them pick it up without any lookups of their own.
+				 * Command class labels keep the language they were set up with.
+				 */
+				void SetSelectedLang(string const& lang);
+				/**
+				 * Keep a copy of a text in the string table.
+				 * \return the copy, which lives as long as the program.  Equal texts share one copy.
+				 * May be called from any thread.
+				 */
+				static string const* Intern(string const& text);
+				/**
+				 * The entry holding a value's label and help.
+				 * \return the entry, which lives as long as the program, or NULL if the value has no texts yet.
+				 */
+				ValueLocalizationEntry* GetValueEntry(uint8 node, uint8 ccID, uint16 indexId, int32 pos) const;
+				/**
+				 * The entry holding the labels and help of a value's items.
+				 * \return the entry, which lives as long as the program, or NULL if the value has no texts yet.
+				 */
+				ValueLocalizationEntry* GetValueItemEntry(uint8 node, uint8 ccID, uint16 indexId, int32 pos) const;
 				bool SetValueHelp(uint8 node, uint8 ccID, uint16 indexID, uint32 pos, string help, string lang = "");
 				string const GetValueHelp(uint8 node, uint8 ccID, uint16 indexId, uint32 pos);
 				bool SetValueLabel(uint8 node, uint8 ccID, uint16 indexID, uint32 pos, string label, string lang = "");
@@ -140,6 +193,8 @@ namespace OpenZWave
 				static map<uint8, std::shared_ptr<LabelLocalizationEntry> > m_commandClassLocalizationMap;
 				static map<string, std::shared_ptr<LabelLocalizationEntry> > m_globalLabelLocalizationMap;
 				static string m_selectedLang;
+				static set<string> m_strings;				// Interned texts
+				static std::mutex m_stringsMutex;			// Guards m_strings, as values are bound from the driver threads
 				static uint32 m_revision;
 
 		};
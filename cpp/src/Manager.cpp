@@ -29,6 +29,7 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
 
 #include "Defs.h"
 #include "CompatOptionManager.h"
@@ -184,8 +185,11 @@ Manager::Manager() :
 	int nDumpTrigger = (int) LogLevel_Warning;
 	Options::Get()->GetOptionAsInt("DumpTriggerLevel", &nDumpTrigger);
 
+	bool bAsync = false;
+	Options::Get()->GetOptionAsBool("AsyncLogging", &bAsync);
+
 	string logFilename = userPath + logFileNameBase;
-	Log::Create(logFilename, bAppend, bConsoleOutput, (LogLevel) nSaveLogLevel, (LogLevel) nQueueLogLevel, (LogLevel) nDumpTrigger);
+	Log::Create(logFilename, bAppend, bConsoleOutput, (LogLevel) nSaveLogLevel, (LogLevel) nQueueLogLevel, (LogLevel) nDumpTrigger, bAsync);
 	Log::SetLoggingState(logging);
 
 	Internal::CC::CommandClasses::RegisterCommandClasses();
@@ -750,6 +754,44 @@ uint8 Manager::GetPollIntensity(ValueID const &_valueId)
 	return intensity;
 }
 
+//-----------------------------------------------------------------------------
+// <Manager::SetPollInterval>
+// Set the interval at which this value is polled
+//-----------------------------------------------------------------------------
+void Manager::SetPollInterval(ValueID const &_valueId, int32 const _milliseconds)
+{
+	if (Driver* driver = GetDriver(_valueId.GetHomeId()))
+	{
+		return (driver->SetPollInterval(_valueId, _milliseconds));
+	}
+
+	Log::Write(LogLevel_Error, "mgr,     SetPollInterval failed - Driver with Home ID 0x%.8x is not available", _valueId.GetHomeId());
+}
+
+//-----------------------------------------------------------------------------
+// <Manager::GetPollInterval>
+// Get the interval at which this value is polled
+//-----------------------------------------------------------------------------
+int32 Manager::GetPollInterval(ValueID const &_valueId)
+{
+	int32 interval = 0;
+	if (Driver* driver = GetDriver(_valueId.GetHomeId()))
+	{
+		Internal::LockGuard LG(driver->m_nodeMutex);
+		if (Internal::VC::Value* value = driver->GetValue(_valueId))
+		{
+			interval = value->GetPollInterval();
+			value->Release();
+		}
+		else
+		{
+			OZW_ERROR(OZWException::OZWEXCEPTION_INVALID_VALUEID, "Invalid ValueID passed to GetPollInterval");
+		}
+	}
+
+	return interval;
+}
+
 //-----------------------------------------------------------------------------
 //	Retrieving Node information
 //-----------------------------------------------------------------------------
@@ -1353,7 +1395,7 @@ bool Manager::IsNodeInfoReceived(uint32 const _homeId, uint8 const _nodeId)
 		Node *node;
 
 		// Need to lock and unlock nodes to check this information
-		Internal::LockGuard LG(driver->m_nodeMutex);
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
 
 		if ((node = driver->GetNode(_nodeId)) != NULL)
 		{
@@ -1424,7 +1466,7 @@ bool Manager::IsNodeAwake(uint32 const _homeId, uint8 const _nodeId)
 	if (Driver* driver = GetDriver(_homeId))
 	{
 		// Need to lock and unlock nodes to check this information
-		Internal::LockGuard LG(driver->m_nodeMutex);
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
 
 		if (Node* node = driver->GetNode(_nodeId))
 		{
@@ -1446,7 +1488,7 @@ bool Manager::IsNodeFailed(uint32 const _homeId, uint8 const _nodeId)
 	bool result = false;
 	if (Driver* driver = GetDriver(_homeId))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
 		if (Node* node = driver->GetNode(_nodeId))
 		{
 			result = !node->IsNodeAlive();
@@ -1464,7 +1506,7 @@ string Manager::GetNodeQueryStage(uint32 const _homeId, uint8 const _nodeId)
 	string result = "Unknown";
 	if (Driver* driver = GetDriver(_homeId))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
 		if (Node* node = driver->GetNode(_nodeId))
 		{
 			result = node->GetQueryStageName(node->GetCurrentQueryStage());
@@ -1473,6 +1515,31 @@ string Manager::GetNodeQueryStage(uint32 const _homeId, uint8 const _nodeId)
 	return result;
 }
 
+//-----------------------------------------------------------------------------
+// <Manager::SetNodeImportant>
+// Helper method to put a node's queries ahead of the other nodes'
+//-----------------------------------------------------------------------------
+void Manager::SetNodeImportant(uint32 const _homeId, uint8 const _nodeId, bool const _important)
+{
+	if (Driver* driver = GetDriver(_homeId))
+	{
+		driver->SetNodeImportant(_nodeId, _important);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// <Manager::IsNodeImportant>
+// Helper method to return whether a node's queries go ahead of the other nodes'
+//-----------------------------------------------------------------------------
+bool Manager::IsNodeImportant(uint32 const _homeId, uint8 const _nodeId)
+{
+	if (Driver* driver = GetDriver(_homeId))
+	{
+		return driver->IsNodeImportant(_nodeId);
+	}
+	return false;
+}
+
 //-----------------------------------------------------------------------------
 // <Manager::SetNodeLevel>
 // Helper method to set the basic level of a node
@@ -1549,10 +1616,8 @@ string Manager::GetValueLabel(ValueID const& _id, int32 _pos)
 		}
 		else
 		{
-			bool useinstancelabels = true;
-			Options::Get()->GetOptionAsBool("IncludeInstanceLabel", &useinstancelabels);
 			Node* node = driver->GetNode(_id.GetNodeId());
-			if ((useinstancelabels) && (node))
+			if ((Options::Get()->GetSnapshot().m_includeInstanceLabel) && (node))
 			{
 				if (node->GetNumInstances(_id.GetCommandClassId()) > 1)
 				{
@@ -1721,6 +1786,24 @@ void Manager::SetValueHelp(ValueID const& _id, string const& _value, int32 _pos)
 	OZW_ERROR(OZWException::OZWEXCEPTION_INVALID_VALUEID, "Invalid ValueID passed to SetValueHelp");
 }
 
+//-----------------------------------------------------------------------------
+// <Manager::SetLanguage>
+// Switches the language of the value labels and help texts
+//-----------------------------------------------------------------------------
+void Manager::SetLanguage(string const& _lang)
+{
+	// The values read their texts with the node mutex held, so hold them all while the texts are rebound
+	for (map<uint32, Driver*>::iterator it = m_readyDrivers.begin(); it != m_readyDrivers.end(); ++it)
+	{
+		it->second->m_nodeMutex->Lock();
+	}
+	Internal::Localization::Get()->SetSelectedLang(_lang);
+	for (map<uint32, Driver*>::iterator it = m_readyDrivers.begin(); it != m_readyDrivers.end(); ++it)
+	{
+		it->second->m_nodeMutex->Unlock();
+	}
+}
+
 //-----------------------------------------------------------------------------
 // <Manager::GetValueMin>
 // Gets the minimum for a value
@@ -1730,11 +1813,10 @@ int32 Manager::GetValueMin(ValueID const& _id)
 	int32 limit = 0;
 	if (Driver* driver = GetDriver(_id.GetHomeId()))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
-		if (Internal::VC::Value* value = driver->GetValue(_id))
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
+		if (Internal::VC::Value* value = driver->BorrowValue(_id))
 		{
 			limit = value->GetMin();
-			value->Release();
 		}
 		else
 		{
@@ -1754,11 +1836,10 @@ int32 Manager::GetValueMax(ValueID const& _id)
 	int32 limit = 0;
 	if (Driver* driver = GetDriver(_id.GetHomeId()))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
-		if (Internal::VC::Value* value = driver->GetValue(_id))
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
+		if (Internal::VC::Value* value = driver->BorrowValue(_id))
 		{
 			limit = value->GetMax();
-			value->Release();
 		}
 		else
 		{
@@ -1778,11 +1859,10 @@ bool Manager::IsValueReadOnly(ValueID const& _id)
 	bool res = false;
 	if (Driver* driver = GetDriver(_id.GetHomeId()))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
-		if (Internal::VC::Value* value = driver->GetValue(_id))
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
+		if (Internal::VC::Value* value = driver->BorrowValue(_id))
 		{
 			res = value->IsReadOnly();
-			value->Release();
 		}
 		else
 		{
@@ -1802,11 +1882,10 @@ bool Manager::IsValueWriteOnly(ValueID const& _id)
 	bool res = false;
 	if (Driver* driver = GetDriver(_id.GetHomeId()))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
-		if (Internal::VC::Value* value = driver->GetValue(_id))
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
+		if (Internal::VC::Value* value = driver->BorrowValue(_id))
 		{
 			res = value->IsWriteOnly();
-			value->Release();
 		}
 		else
 		{
@@ -1826,11 +1905,10 @@ bool Manager::IsValueSet(ValueID const& _id)
 	bool res = false;
 	if (Driver* driver = GetDriver(_id.GetHomeId()))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
-		if (Internal::VC::Value* value = driver->GetValue(_id))
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
+		if (Internal::VC::Value* value = driver->BorrowValue(_id))
 		{
 			res = value->IsSet();
-			value->Release();
 		}
 		else
 		{
@@ -1850,11 +1928,10 @@ bool Manager::IsValuePolled(ValueID const& _id)
 	bool res = false;
 	if (Driver* driver = GetDriver(_id.GetHomeId()))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
-		if (Internal::VC::Value* value = driver->GetValue(_id))
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
+		if (Internal::VC::Value* value = driver->BorrowValue(_id))
 		{
 			res = value->IsPolled();
-			value->Release();
 		}
 		else
 		{
@@ -1873,10 +1950,9 @@ bool Manager::IsValueValid(ValueID const& _id)
 {
 	if (Driver* driver = GetDriver(_id.GetHomeId()))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
-		if (Internal::VC::Value* value = driver->GetValue(_id))
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
+		if (driver->BorrowValue(_id))
 		{
-			value->Release();
 			return true;
 		}
 	}
@@ -1897,11 +1973,10 @@ bool Manager::GetValueAsBitSet(ValueID const& _id, uint8 _pos, bool* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->BorrowValue(_id)))
 				{
 					*o_value = value->GetBit(_pos);
-					value->Release();
 					return true;
 				}
 				else
@@ -1932,11 +2007,10 @@ bool Manager::GetValueAsBool(ValueID const& _id, bool* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueBool* value = static_cast<Internal::VC::ValueBool*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueBool* value = static_cast<Internal::VC::ValueBool*>(driver->BorrowValue(_id)))
 				{
 					*o_value = value->GetValue();
-					value->Release();
 					res = true;
 				}
 				else
@@ -1949,11 +2023,10 @@ bool Manager::GetValueAsBool(ValueID const& _id, bool* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueButton* value = static_cast<Internal::VC::ValueButton*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueButton* value = static_cast<Internal::VC::ValueButton*>(driver->BorrowValue(_id)))
 				{
 					*o_value = value->IsPressed();
-					value->Release();
 					res = true;
 				}
 				else
@@ -1985,11 +2058,10 @@ bool Manager::GetValueAsByte(ValueID const& _id, uint8* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueByte* value = static_cast<Internal::VC::ValueByte*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueByte* value = static_cast<Internal::VC::ValueByte*>(driver->BorrowValue(_id)))
 				{
 					*o_value = value->GetValue();
-					value->Release();
 					res = true;
 				}
 				else
@@ -2021,12 +2093,11 @@ bool Manager::GetValueAsFloat(ValueID const& _id, float* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueDecimal* value = static_cast<Internal::VC::ValueDecimal*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueDecimal* value = static_cast<Internal::VC::ValueDecimal*>(driver->BorrowValue(_id)))
 				{
-					string str = value->GetValue();
-					*o_value = (float) atof(str.c_str());
-					value->Release();
+					Internal::VC::Decimal const& decimal = value->GetDecimal();
+					*o_value = (float) (decimal.m_value / pow(10.0, decimal.m_precision));
 					res = true;
 				}
 				else
@@ -2056,14 +2127,13 @@ bool Manager::GetValueAsInt(ValueID const& _id, int32* o_value)
 	{
 		if (Driver* driver = GetDriver(_id.GetHomeId()))
 		{
-			Internal::LockGuard LG(driver->m_nodeMutex);
+			Internal::SharedLockGuard LG(driver->m_nodeMutex);
 
 			if (ValueID::ValueType_Int == _id.GetType())
 			{
-				if (Internal::VC::ValueInt* value = static_cast<Internal::VC::ValueInt*>(driver->GetValue(_id)))
+				if (Internal::VC::ValueInt* value = static_cast<Internal::VC::ValueInt*>(driver->BorrowValue(_id)))
 				{
 					*o_value = value->GetValue();
-					value->Release();
 					res = true;
 				}
 				else
@@ -2073,10 +2143,9 @@ bool Manager::GetValueAsInt(ValueID const& _id, int32* o_value)
 			}
 			else if (ValueID::ValueType_BitSet == _id.GetType())
 			{
-				if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->GetValue(_id)))
+				if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->BorrowValue(_id)))
 				{
 					*o_value = value->GetValue();
-					value->Release();
 					res = true;
 				}
 				else
@@ -2108,13 +2177,12 @@ bool Manager::GetValueAsRaw(ValueID const& _id, uint8** o_value, uint8* o_length
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueRaw* value = static_cast<Internal::VC::ValueRaw*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueRaw* value = static_cast<Internal::VC::ValueRaw*>(driver->BorrowValue(_id)))
 				{
 					*o_length = value->GetLength();
 					*o_value = new uint8[*o_length];
 					memcpy(*o_value, value->GetValue(), *o_length);
-					value->Release();
 					res = true;
 				}
 				else
@@ -2146,11 +2214,10 @@ bool Manager::GetValueAsShort(ValueID const& _id, int16* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueShort* value = static_cast<Internal::VC::ValueShort*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueShort* value = static_cast<Internal::VC::ValueShort*>(driver->BorrowValue(_id)))
 				{
 					*o_value = value->GetValue();
-					value->Release();
 					res = true;
 				}
 				else
@@ -2182,16 +2249,15 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 	{
 		if (Driver* driver = GetDriver(_id.GetHomeId()))
 		{
-			Internal::LockGuard LG(driver->m_nodeMutex);
+			Internal::SharedLockGuard LG(driver->m_nodeMutex);
 
 			switch (_id.GetType())
 			{
 				case ValueID::ValueType_BitSet:
 				{
-					if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->BorrowValue(_id)))
 					{
 						*o_value = value->GetAsString();
-						value->Release();
 						res = true;
 					}
 					else
@@ -2202,10 +2268,9 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_Bool:
 				{
-					if (Internal::VC::ValueBool* value = static_cast<Internal::VC::ValueBool*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueBool* value = static_cast<Internal::VC::ValueBool*>(driver->BorrowValue(_id)))
 					{
 						*o_value = value->GetValue() ? "True" : "False";
-						value->Release();
 						res = true;
 					}
 					else
@@ -2216,11 +2281,10 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_Byte:
 				{
-					if (Internal::VC::ValueByte* value = static_cast<Internal::VC::ValueByte*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueByte* value = static_cast<Internal::VC::ValueByte*>(driver->BorrowValue(_id)))
 					{
 						snprintf(str, sizeof(str), "%u", value->GetValue());
 						*o_value = str;
-						value->Release();
 						res = true;
 					}
 					else
@@ -2231,10 +2295,9 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_Decimal:
 				{
-					if (Internal::VC::ValueDecimal* value = static_cast<Internal::VC::ValueDecimal*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueDecimal* value = static_cast<Internal::VC::ValueDecimal*>(driver->BorrowValue(_id)))
 					{
 						*o_value = value->GetValue();
-						value->Release();
 						res = true;
 					}
 					else
@@ -2245,11 +2308,10 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_Int:
 				{
-					if (Internal::VC::ValueInt* value = static_cast<Internal::VC::ValueInt*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueInt* value = static_cast<Internal::VC::ValueInt*>(driver->BorrowValue(_id)))
 					{
 						snprintf(str, sizeof(str), "%d", value->GetValue());
 						*o_value = str;
-						value->Release();
 						res = true;
 					}
 					else
@@ -2260,7 +2322,7 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_List:
 				{
-					if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->BorrowValue(_id)))
 					{
 						Internal::VC::ValueList::Item const *item = value->GetItem();
 						if (item == NULL)
@@ -2273,7 +2335,6 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 							*o_value = item->m_label;
 							res = true;
 						}
-						value->Release();
 
 					}
 					else
@@ -2284,10 +2345,9 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_Raw:
 				{
-					if (Internal::VC::ValueRaw* value = static_cast<Internal::VC::ValueRaw*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueRaw* value = static_cast<Internal::VC::ValueRaw*>(driver->BorrowValue(_id)))
 					{
 						*o_value = value->GetAsString();
-						value->Release();
 						res = true;
 					}
 					else
@@ -2298,11 +2358,10 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_Short:
 				{
-					if (Internal::VC::ValueShort* value = static_cast<Internal::VC::ValueShort*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueShort* value = static_cast<Internal::VC::ValueShort*>(driver->BorrowValue(_id)))
 					{
 						snprintf(str, sizeof(str), "%d", value->GetValue());
 						*o_value = str;
-						value->Release();
 						res = true;
 					}
 					else
@@ -2313,10 +2372,9 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_String:
 				{
-					if (Internal::VC::ValueString* value = static_cast<Internal::VC::ValueString*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueString* value = static_cast<Internal::VC::ValueString*>(driver->BorrowValue(_id)))
 					{
 						*o_value = value->GetValue();
-						value->Release();
 						res = true;
 					}
 					else
@@ -2327,10 +2385,9 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_Button:
 				{
-					if (Internal::VC::ValueButton* value = static_cast<Internal::VC::ValueButton*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueButton* value = static_cast<Internal::VC::ValueButton*>(driver->BorrowValue(_id)))
 					{
 						*o_value = value->IsPressed() ? "True" : "False";
-						value->Release();
 						res = true;
 					}
 					else
@@ -2341,10 +2398,9 @@ bool Manager::GetValueAsString(ValueID const& _id, string* o_value)
 				}
 				case ValueID::ValueType_Schedule:
 				{
-					if (Internal::VC::ValueSchedule* value = static_cast<Internal::VC::ValueSchedule*>(driver->GetValue(_id)))
+					if (Internal::VC::ValueSchedule* value = static_cast<Internal::VC::ValueSchedule*>(driver->BorrowValue(_id)))
 					{
 						*o_value = value->GetAsString();
-						value->Release();
 						res = true;
 					}
 					else
@@ -2375,8 +2431,8 @@ bool Manager::GetValueListSelection(ValueID const& _id, string* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->BorrowValue(_id)))
 				{
 					Internal::VC::ValueList::Item const *item = value->GetItem();
 					if (item != NULL && item->m_label.length() > 0)
@@ -2389,7 +2445,6 @@ bool Manager::GetValueListSelection(ValueID const& _id, string* o_value)
 						o_value = NULL;
 						Log::Write(LogLevel_Warning, "ValueList returned a NULL value for GetValueListSelection: %s", value->GetLabel().c_str());
 					}
-					value->Release();
 				}
 				else
 				{
@@ -2420,8 +2475,8 @@ bool Manager::GetValueListSelection(ValueID const& _id, int32* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->BorrowValue(_id)))
 				{
 					Internal::VC::ValueList::Item const *item = value->GetItem();
 					if (item == NULL)
@@ -2433,7 +2488,6 @@ bool Manager::GetValueListSelection(ValueID const& _id, int32* o_value)
 						*o_value = item->m_value;
 						res = true;
 					}
-					value->Release();
 
 				}
 				else
@@ -2465,12 +2519,11 @@ bool Manager::GetValueListItems(ValueID const& _id, vector<string>* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->BorrowValue(_id)))
 				{
 					o_value->clear();
 					res = value->GetItemLabels(o_value);
-					value->Release();
 				}
 				else
 				{
@@ -2501,12 +2554,11 @@ bool Manager::GetValueListValues(ValueID const& _id, vector<int32>* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueList* value = static_cast<Internal::VC::ValueList*>(driver->BorrowValue(_id)))
 				{
 					o_value->clear();
 					res = value->GetItemValues(o_value);
-					value->Release();
 				}
 				else
 				{
@@ -2523,6 +2575,50 @@ bool Manager::GetValueListValues(ValueID const& _id, vector<int32>* o_value)
 	return res;
 }
 
+//-----------------------------------------------------------------------------
+// <Manager::GetValueAsDecimal>
+// Gets a decimal value as the integer the node reported, its precision and scale
+//-----------------------------------------------------------------------------
+bool Manager::GetValueAsDecimal(ValueID const& _id, int32* o_value, uint8* o_precision, uint8* o_scale)
+{
+	bool res = false;
+
+	if (o_value)
+	{
+		if (ValueID::ValueType_Decimal == _id.GetType())
+		{
+			if (Driver* driver = GetDriver(_id.GetHomeId()))
+			{
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueDecimal* value = static_cast<Internal::VC::ValueDecimal*>(driver->BorrowValue(_id)))
+				{
+					Internal::VC::Decimal const& decimal = value->GetDecimal();
+					*o_value = decimal.m_value;
+					if (o_precision)
+					{
+						*o_precision = decimal.m_precision;
+					}
+					if (o_scale)
+					{
+						*o_scale = decimal.m_scale;
+					}
+					res = true;
+				}
+				else
+				{
+					OZW_ERROR(OZWException::OZWEXCEPTION_INVALID_VALUEID, "Invalid ValueID passed to GetValueAsDecimal");
+				}
+			}
+		}
+		else
+		{
+			OZW_ERROR(OZWException::OZWEXCEPTION_CANNOT_CONVERT_VALUEID, "ValueID passed to GetValueAsDecimal is not a Decimal Value");
+		}
+	}
+
+	return res;
+}
+
 //-----------------------------------------------------------------------------
 // <Manager::GetValueFloatPrecision>
 // Gets a value's scale as a uint8
@@ -2537,11 +2633,10 @@ bool Manager::GetValueFloatPrecision(ValueID const& _id, uint8* o_value)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueDecimal* value = static_cast<Internal::VC::ValueDecimal*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueDecimal* value = static_cast<Internal::VC::ValueDecimal*>(driver->BorrowValue(_id)))
 				{
 					*o_value = value->GetPrecision();
-					value->Release();
 					res = true;
 				}
 				else
@@ -3169,11 +3264,10 @@ bool Manager::GetChangeVerified(ValueID const& _id)
 	bool res = false;
 	if (Driver* driver = GetDriver(_id.GetHomeId()))
 	{
-		Internal::LockGuard LG(driver->m_nodeMutex);
-		if (Internal::VC::Value* value = driver->GetValue(_id))
+		Internal::SharedLockGuard LG(driver->m_nodeMutex);
+		if (Internal::VC::Value* value = driver->BorrowValue(_id))
 		{
 			res = value->GetChangeVerified();
-			value->Release();
 		}
 		else
 		{
@@ -3294,11 +3388,10 @@ bool Manager::GetBitMask(ValueID const& _id, int32* o_mask)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->BorrowValue(_id)))
 				{
 					*o_mask = value->GetBitMask();
-					value->Release();
 					res = true;
 				}
 				else
@@ -3330,11 +3423,10 @@ bool Manager::GetBitSetSize(ValueID const& _id, uint8* o_size)
 		{
 			if (Driver* driver = GetDriver(_id.GetHomeId()))
 			{
-				Internal::LockGuard LG(driver->m_nodeMutex);
-				if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->GetValue(_id)))
+				Internal::SharedLockGuard LG(driver->m_nodeMutex);
+				if (Internal::VC::ValueBitSet* value = static_cast<Internal::VC::ValueBitSet*>(driver->BorrowValue(_id)))
 				{
 					*o_size = value->GetSize();
-					value->Release();
 					res = true;
 				}
 				else
@@ -3369,11 +3461,10 @@ uint8 Manager::GetNumSwitchPoints(ValueID const& _id)
 	{
 		if (Driver* driver = GetDriver(_id.GetHomeId()))
 		{
-			Internal::LockGuard LG(driver->m_nodeMutex);
-			if (Internal::VC::ValueSchedule* value = static_cast<Internal::VC::ValueSchedule*>(driver->GetValue(_id)))
+			Internal::SharedLockGuard LG(driver->m_nodeMutex);
+			if (Internal::VC::ValueSchedule* value = static_cast<Internal::VC::ValueSchedule*>(driver->BorrowValue(_id)))
 			{
 				numSwitchPoints = value->GetNumSwitchPoints();
-				value->Release();
 			}
 			else
 			{
@@ -3499,11 +3590,10 @@ bool Manager::GetSwitchPoint(ValueID const& _id, uint8 const _idx, uint8* o_hour
 	{
 		if (Driver* driver = GetDriver(_id.GetHomeId()))
 		{
-			Internal::LockGuard LG(driver->m_nodeMutex);
-			if (Internal::VC::ValueSchedule* value = static_cast<Internal::VC::ValueSchedule*>(driver->GetValue(_id)))
+			Internal::SharedLockGuard LG(driver->m_nodeMutex);
+			if (Internal::VC::ValueSchedule* value = static_cast<Internal::VC::ValueSchedule*>(driver->BorrowValue(_id)))
 			{
 				res = value->GetSwitchPoint(_idx, o_hours, o_minutes, o_setback);
-				value->Release();
 			}
 			else
 			{
@@ -3716,6 +3806,15 @@ void Manager::RemoveAssociation(uint32 const _homeId, uint8 const _nodeId, uint8
 // Add a watcher to the list
 //-----------------------------------------------------------------------------
 bool Manager::AddWatcher(pfnOnNotification_t _watcher, void* _context)
+{
+	return AddWatcher(_watcher, _context, ~0ULL, 0);
+}
+
+//-----------------------------------------------------------------------------
+// <Manager::AddWatcher>
+// Add a watcher for some notification types, or for a single node, to the list
+//-----------------------------------------------------------------------------
+bool Manager::AddWatcher(pfnOnNotification_t _watcher, void* _context, uint64 const _typeMask, uint8 const _nodeId)
 {
 	// Ensure this watcher is not already on the list
 	m_notificationMutex->Lock();
@@ -3729,7 +3828,7 @@ bool Manager::AddWatcher(pfnOnNotification_t _watcher, void* _context)
 		}
 	}
 
-	m_watchers.push_back(new Watcher(_watcher, _context));
+	m_watchers.push_back(new Watcher(_watcher, _context, _typeMask, _nodeId));
 	m_notificationMutex->Unlock();
 	return true;
 }
@@ -3774,9 +3873,15 @@ void Manager::NotifyWatchers(Notification* _notification)
 	m_notificationMutex->Lock();
 	list<Watcher*>::iterator it = m_watchers.begin();
 	m_watcherIterators.push_back(&it);
+	uint64 typeBit = 1ULL << _notification->GetType();
+	uint8 nodeId = _notification->GetNodeId();
 	while (it != m_watchers.end())
 	{
 		Watcher* pWatcher = *(it++);
+		if (!(pWatcher->m_typeMask & typeBit) || (pWatcher->m_nodeId && (pWatcher->m_nodeId != nodeId)))
+		{
+			continue;
+		}
 		pWatcher->m_callback(_notification, pWatcher->m_context);
 	}
 	m_watcherIterators.pop_back();
@@ -4765,6 +4870,45 @@ if (Driver* driver = GetDriver(_homeId))
 
 }
 
+//-----------------------------------------------------------------------------
+// <Manager::GetDriverLatency>
+// Retrieve the driver's latency histograms.
+//-----------------------------------------------------------------------------
+void Manager::GetDriverLatency(uint32 const _homeId, Driver::LatencyData* _data)
+{
+if (Driver* driver = GetDriver(_homeId))
+{
+	driver->GetLatencyData(_data);
+}
+
+}
+
+//-----------------------------------------------------------------------------
+// <Manager::GetNodeReportLatency>
+// Retrieve the time a node takes to answer requests.
+//-----------------------------------------------------------------------------
+bool Manager::GetNodeReportLatency(uint32 const _homeId, uint8 const _nodeId, LatencyHistogramData* _data)
+{
+if (Driver* driver = GetDriver(_homeId))
+{
+	return driver->GetNodeReportLatency(_nodeId, _data);
+}
+return false;
+}
+
+//-----------------------------------------------------------------------------
+// <Manager::GetCommandClassReportLatency>
+// Retrieve the time the nodes take to answer a command class's requests.
+//-----------------------------------------------------------------------------
+bool Manager::GetCommandClassReportLatency(uint32 const _homeId, uint8 const _commandClassId, LatencyHistogramData* _data)
+{
+if (Driver* driver = GetDriver(_homeId))
+{
+	return driver->GetCommandClassReportLatency(_commandClassId, _data);
+}
+return false;
+}
+
 //-----------------------------------------------------------------------------
 // <Manager::GetNodeRouteScheme>
 // Convert the RouteScheme to a String
@@ -54,6 +54,7 @@ namespace OpenZWave
 			class ValueStore;
 		}
 		class Msg;
+		class NotificationDispatcher;
 	}
 	class Options;
 	class Node;
@@ -114,6 +115,7 @@ namespace OpenZWave
 			friend class Internal::VC::Value;
 			friend class Internal::VC::ValueStore;
 			friend class Internal::Msg;
+			friend class Internal::NotificationDispatcher;
 
 		public:
 			typedef void (*pfnOnNotification_t)(Notification const* _pNotification, void* _context);
@@ -434,6 +436,25 @@ namespace OpenZWave
 			 */
 			uint8 GetPollIntensity(ValueID const &_valueId);
 
+			/**
+			 * \brief Set the time period between polls of a value.
+			 * A value with no period of its own is polled at the interval set with SetPollInterval, times its
+			 * poll intensity.  Either way, the period grows while the value is found unchanged, and a poll is
+			 * put off while the device reports the value by itself.
+			 * \param _valueId The ID of the value whose polling period should be set
+			 * \param _milliseconds The period in milliseconds, or 0 to use the interval set with SetPollInterval.
+			 */
+			void SetPollInterval(ValueID const &_valueId, int32 const _milliseconds);
+
+			/**
+			 * \brief Get the time period between polls of a value.
+			 * \param _valueId The ID of the value to check.
+			 * \return The period in milliseconds, or 0 if the value is polled at the interval set with SetPollInterval.
+			 * \throws OZWException with Type OZWException::OZWEXCEPTION_INVALID_VALUEID if the ValueID is invalid
+			 * \throws OZWException with Type OZWException::OZWEXCEPTION_INVALID_HOMEID if the Driver cannot be found
+			 */
+			int32 GetPollInterval(ValueID const &_valueId);
+
 			/*@}*/
 
 			//-----------------------------------------------------------------------------
@@ -888,6 +909,25 @@ namespace OpenZWave
 			 */
 			string GetNodeQueryStage(uint32 const _homeId, uint8 const _nodeId);
 
+			/**
+			 * \brief Mark a node as important, so that its queries go ahead of the other nodes'.
+			 * Set this once the driver is ready, and the node is interviewed first.
+			 * \param _homeId The Home ID of the Z-Wave controller that manages the node.
+			 * \param _nodeId The ID of the node.
+			 * \param _important Whether the node is important.
+			 * \see IsNodeImportant
+			 */
+			void SetNodeImportant(uint32 const _homeId, uint8 const _nodeId, bool const _important);
+
+			/**
+			 * \brief Get whether a node's queries go ahead of the other nodes'
+			 * \param _homeId The Home ID of the Z-Wave controller that manages the node.
+			 * \param _nodeId The ID of the node to query.
+			 * \return True if the node has been marked as important
+			 * \see SetNodeImportant
+			 */
+			bool IsNodeImportant(uint32 const _homeId, uint8 const _nodeId);
+
 			/**
 			 * \brief Get the node device type as reported in the Z-Wave+ Info report.
 			 * \param _homeId The Home ID of the Z-Wave controller that manages the node.
@@ -1044,6 +1084,14 @@ namespace OpenZWave
 			 */
 			void SetValueHelp(ValueID const& _id, string const& _value, int32 _pos = -1);
 
+			/**
+			 * \brief Switches the language of the value labels and help texts.
+			 * Values with no text in the language fall back to the default text.  Command class labels
+			 * keep the language set by the Language option.
+			 * \param _lang The language, as named in the Localization config file, or empty for the default texts.
+			 */
+			void SetLanguage(string const& _lang);
+
 			/**
 			 * \brief Gets the minimum that this value may contain.
 			 * \param _id The unique identifier of the value.
@@ -1272,6 +1320,21 @@ namespace OpenZWave
 			 */
 			bool GetValueFloatPrecision(ValueID const& _id, uint8* o_value);
 
+			/**
+			 * \brief Gets a decimal value exactly as the node reported it.
+			 * The value is *o_value / 10^*o_precision, in the units the command class gives scale *o_scale.
+			 * \param _id The unique identifier of the value.
+			 * \param o_value Pointer to an int32 that will be filled with the value times 10 to the power of its precision.
+			 * \param o_precision Pointer to a uint8 that will be filled with the number of digits after the decimal point, or NULL.
+			 * \param o_scale Pointer to a uint8 that will be filled with the scale the value was reported in, or NULL.
+			 * \return true if the value was obtained.  Returns false if the value is not a ValueID::ValueType_Decimal. The type can be tested with a call to ValueID::GetType
+			 * \throws OZWException with Type OZWException::OZWEXCEPTION_INVALID_VALUEID if the ValueID is invalid
+			 * \throws OZWException with Type OZWException::OZWEXCEPTION_CANNOT_CONVERT_VALUEID if the Actual Value is off a different type
+			 * \throws OZWException with Type OZWException::OZWEXCEPTION_INVALID_HOMEID if the Driver cannot be found
+			 * \see ValueID::GetType, GetValueAsFloat, GetValueFloatPrecision, GetValueAsString
+			 */
+			bool GetValueAsDecimal(ValueID const& _id, int32* o_value, uint8* o_precision, uint8* o_scale);
+
 			/**
 			 * \brief Sets the state of a bit in a BitSet ValueID.
 			 * Due to the possibility of a device being asleep, the command is assumed to succeed, and the value
@@ -1804,6 +1867,18 @@ namespace OpenZWave
 			 */
 			bool AddWatcher(pfnOnNotification_t _watcher, void* _context);
 
+			/**
+			 * \brief Add a notification watcher that is only called for some notifications.
+			 * \param _watcher pointer to a function that will be called by the notification system.
+			 * \param _context pointer to user defined data that will be passed to the watcher function with each notification.
+			 * \param _typeMask the notification types to report, one bit per Notification::NotificationType,
+			 * for example (1ULL << Notification::Type_ValueChanged) | (1ULL << Notification::Type_ValueRefreshed).
+			 * \param _nodeId only report notifications about this node.  Zero reports notifications about any node.
+			 * \return true if the watcher was successfully added.
+			 * \see RemoveWatcher, Notification
+			 */
+			bool AddWatcher(pfnOnNotification_t _watcher, void* _context, uint64 const _typeMask, uint8 const _nodeId = 0);
+
 			/**
 			 * \brief Remove a notification watcher.
 			 * \param _watcher pointer to a function that must match that passed to a previous call to AddWatcher
@@ -1821,9 +1896,11 @@ namespace OpenZWave
 			{
 					pfnOnNotification_t m_callback;
 					void* m_context;
+					uint64 m_typeMask;				// One bit per Notification::NotificationType to report
+					uint8 m_nodeId;					// Only report this node, or any node if zero
 
-					Watcher(pfnOnNotification_t _callback, void* _context) :
-							m_callback(_callback), m_context(_context)
+					Watcher(pfnOnNotification_t _callback, void* _context, uint64 const _typeMask, uint8 const _nodeId) :
+							m_callback(_callback), m_context(_context), m_typeMask(_typeMask), m_nodeId(_nodeId)
 					{
 					}
 			};
@@ -2613,6 +2690,33 @@ namespace OpenZWave
 			 */
 			void GetNodeStatistics(uint32 const _homeId, uint8 const _nodeId, Node::NodeData* _data);
 
+			/**
+			 * \brief Retrieve the latency histograms of a driver.
+			 * The histograms are copied as they stand, without formatting, so this is cheap enough to call often.
+			 * \param _homeId The Home ID of the driver
+			 * \param _data Pointer to structure LatencyData to return the histograms
+			 * \see GetNodeReportLatency, GetCommandClassReportLatency
+			 */
+			void GetDriverLatency(uint32 const _homeId, Driver::LatencyData* _data);
+
+			/**
+			 * \brief Retrieve the histogram of the time a node takes to answer a request with its report
+			 * \param _homeId The Home ID of the driver for the node
+			 * \param _nodeId The node number
+			 * \param _data Pointer to structure LatencyHistogramData to return the histogram
+			 * \return false if the node does not exist
+			 */
+			bool GetNodeReportLatency(uint32 const _homeId, uint8 const _nodeId, LatencyHistogramData* _data);
+
+			/**
+			 * \brief Retrieve the histogram of the time the nodes take to answer the requests of a command class with its report
+			 * \param _homeId The Home ID of the driver
+			 * \param _commandClassId The command class of the reports
+			 * \param _data Pointer to structure LatencyHistogramData to return the histogram
+			 * \return false if no report of that command class has answered a request yet
+			 */
+			bool GetCommandClassReportLatency(uint32 const _homeId, uint8 const _commandClassId, LatencyHistogramData* _data);
+
 			/**
 			 * \brief Get a Human Readable String for the RouteScheme in the Extended TX Status Frame
 			 * \param _data Pointer to the structure Node::NodeData return from GetNodeStatistics
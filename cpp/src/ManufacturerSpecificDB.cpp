@@ -26,6 +26,7 @@
 //-----------------------------------------------------------------------------
 
 #include "ManufacturerSpecificDB.h"
+#include "DeviceDatabase.h"
 #include "tinyxml.h"
 
 #include "Options.h"
@@ -64,7 +65,7 @@ namespace OpenZWave
 		}
 
 		ManufacturerSpecificDB::ManufacturerSpecificDB() :
-				m_MfsMutex(new Internal::Platform::Mutex()), m_revision(0), m_latestRevision(0), m_initializing(true)
+				m_MfsMutex(new Internal::Platform::Mutex()), m_deviceDB(new DeviceDatabase()), m_revision(0), m_latestRevision(0), m_initializing(true)
 		{
 			// Ensure the singleton instance is set
 			s_instance = this;
@@ -82,6 +83,7 @@ namespace OpenZWave
 
 			if (!s_bXmlLoaded)
 				UnloadProductXML();
+			delete m_deviceDB;
 
 		}
 
@@ -145,6 +147,24 @@ namespace OpenZWave
 			string configPath;
 			Options::Get()->GetOptionAsString("ConfigPath", &configPath);
 
+			// Use the precompiled device database if there is an up to date one
+			bool useDatabase = true;
+			Options::Get()->GetOptionAsBool("DeviceDatabase", &useDatabase);
+			if (useDatabase && m_deviceDB->Open(configPath))
+			{
+				if (m_deviceDB->ReadProducts(s_manufacturerMap, s_productMap))
+				{
+					m_revision = m_deviceDB->GetRevision();
+					Log::Write(LogLevel_Info, "Manufacturer_Specific.xml file Revision is %d (Device Database)", m_revision);
+					s_bXmlLoaded = true;
+					return true;
+				}
+				Log::Write(LogLevel_Warning, "Device Database is invalid - Loading the XML config files instead");
+				m_deviceDB->Close();
+				s_manufacturerMap.clear();
+				s_productMap.clear();
+			}
+
 			string filename = configPath + "manufacturer_specific.xml";
 
 			TiXmlDocument* pDoc = new TiXmlDocument();
@@ -295,6 +315,7 @@ namespace OpenZWave
 
 				s_bXmlLoaded = false;
 			}
+			m_deviceDB->Close();
 		}
 
 		void ManufacturerSpecificDB::checkConfigFiles(Driver *driver)
@@ -343,7 +364,18 @@ namespace OpenZWave
 					}
 					else 
 					{
-						checkConfigFileContents(driver, path);	
+						string pic;
+						if (m_deviceDB->GetProductPic(c->GetKey(), &pic))
+						{
+							if (!pic.empty())
+							{
+								checkProductPic(driver, pic);
+							}
+						}
+						else
+						{
+							checkConfigFileContents(driver, path);
+						}
 					}
 				}
 			}
@@ -357,6 +389,11 @@ namespace OpenZWave
 			if (iter != m_downloading.end())
 			{
 				m_downloading.erase(iter);
+				if (success)
+				{
+					LockGuard LG(m_MfsMutex);
+					m_deviceDB->Discard();
+				}
 				if ((node > 0) && success)
 				{
 					driver->refreshNodeConfig(node);
@@ -397,25 +434,37 @@ namespace OpenZWave
 						str = metaDataItem->GetText();
 						if (str) 
 						{ 
-							string imagefile = configPath + str;
-							if (!Internal::Platform::FileOps::Create()->FileExists(imagefile)) 
-							{ 
-								/* check if we are downloading already */
-								std::list<string>::iterator iter = std::find(m_downloading.begin(), m_downloading.end(), imagefile);
-								/* check if the file exists */
-								if (iter == m_downloading.end())
-								{
-									if (driver->startDownload(imagefile, metaDataItem->GetText())) {
-										Log::Write(LogLevel_Info, "Missing Picture %s - Starting Download", imagefile.c_str());
-										m_downloading.push_back(imagefile);
-									}
-								}
-							}
+							checkProductPic(driver, str);
 						}
 					}
 					metaDataItem = metaDataItem->NextSiblingElement("MetaDataItem");
 				}				
 			}
+			delete pDoc;
+		}
+
+//-----------------------------------------------------------------------------
+// <ManufacturerSpecificDB::checkProductPic>
+// Download a product picture if we don't have it yet
+//-----------------------------------------------------------------------------
+		void ManufacturerSpecificDB::checkProductPic(Driver *driver, string const& pic)
+		{
+			string configPath;
+			Options::Get()->GetOptionAsString("ConfigPath", &configPath);
+			string imagefile = configPath + pic;
+			if (!Internal::Platform::FileOps::Create()->FileExists(imagefile)) 
+			{ 
+				/* check if we are downloading already */
+				std::list<string>::iterator iter = std::find(m_downloading.begin(), m_downloading.end(), imagefile);
+				/* check if the file exists */
+				if (iter == m_downloading.end())
+				{
+					if (driver->startDownload(imagefile, pic)) {
+						Log::Write(LogLevel_Info, "Missing Picture %s - Starting Download", imagefile.c_str());
+						m_downloading.push_back(imagefile);
+					}
+				}
+			}
 		}
 
 		void ManufacturerSpecificDB::fileDownloaded(Driver *, string file, bool success) 
@@ -440,6 +489,10 @@ namespace OpenZWave
 				m_downloading.erase(iter);
 				if (success)
 				{
+					{
+						LockGuard LG(m_MfsMutex);
+						m_deviceDB->Discard();
+					}
 					UnloadProductXML();
 					if (!LoadProductXML()) {
 						OZW_ERROR(OZWException::OZWEXCEPTION_CONFIG, "Cannot Load/Read ManufacturerSpecificDB! - Missing/Invalid Config File?");
@@ -496,6 +549,23 @@ namespace OpenZWave
 			return NULL;
 		}
 
+//-----------------------------------------------------------------------------
+// <ManufacturerSpecificDB::LoadConfigFile>
+// Load a product's device config file
+//-----------------------------------------------------------------------------
+		bool ManufacturerSpecificDB::LoadConfigFile(uint16 _manufacturerId, uint16 _productType, uint16 _productId, string const& _filename, TiXmlDocument* _doc)
+		{
+			{
+				LockGuard LG(m_MfsMutex);
+				if (m_deviceDB->LoadConfigFile(ProductDescriptor::GetKey(_manufacturerId, _productType, _productId), _filename, _doc))
+				{
+					return true;
+				}
+			}
+			_doc->Clear();
+			return _doc->LoadFile(_filename.c_str(), TIXML_ENCODING_UTF8);
+		}
+
 		bool ManufacturerSpecificDB::updateConfigFile(Driver *driver, Node *node)
 		{
 			string configPath;
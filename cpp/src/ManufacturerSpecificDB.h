@@ -36,6 +36,8 @@
 #include "platform/Ref.h"
 #include "Defs.h"
 
+class TiXmlDocument;
+
 namespace OpenZWave
 {
 	class Driver;
@@ -45,6 +47,7 @@ namespace OpenZWave
 		{
 			class Mutex;
 		}
+		class DeviceDatabase;
 
 		class ProductDescriptor 
 		{
@@ -147,14 +150,20 @@ namespace OpenZWave
 				bool updateConfigFile(Driver *, Node *);
 				bool updateMFSConfigFile(Driver *);
 				void checkInitialized();
+				/**
+				 * Load a product's device config file, from the device database if it has an up to date copy, otherwise from the XML file
+				 */
+				bool LoadConfigFile(uint16 _manufacturerId, uint16 _productType, uint16 _productId, string const& _filename, TiXmlDocument* _doc);
 
 			private:
 				void LoadConfigFileRevision(ProductDescriptor *product);
 				ManufacturerSpecificDB();
 				~ManufacturerSpecificDB();
 				void checkConfigFileContents(Driver *driver, string file);
+				void checkProductPic(Driver *driver, string const& pic);
 
 				Internal::Platform::Mutex* m_MfsMutex; /**< Mutex to ensure its accessed by a single thread at a time */
+				DeviceDatabase* m_deviceDB; /**< The precompiled device database, if there is one */
 
 				static ManufacturerSpecificDB *s_instance;
 			public:
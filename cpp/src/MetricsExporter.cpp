@@ -0,0 +1,248 @@
+//-----------------------------------------------------------------------------
+//
+//	MetricsExporter.cpp
+//
+//	Writes driver metrics in the Prometheus text format
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#if !defined(_WIN32) && !defined(WINRT)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+
+#include "MetricsExporter.h"
+#include "LatencyHistogram.h"
+#include "platform/Log.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		// Roughly where the bounds of the exported histograms fall, in microseconds.  Each is
+		// moved up to the top of the histogram bucket it is in, so no bucket straddles it.
+		static uint32 const c_histogramBounds[] =
+		{ 1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, 30000000 };
+
+		// Milliseconds to wait for the agent at the other end of a socket
+		static int32 const c_socketTimeout = 1000;
+
+//-----------------------------------------------------------------------------
+// <MetricsExporter::MetricsExporter>
+// Constructor
+//-----------------------------------------------------------------------------
+		MetricsExporter::MetricsExporter(string const& _target) :
+				m_kind(Target_None), m_failing(false)
+		{
+			if (_target.compare(0, 5, "file:") == 0)
+			{
+				m_kind = Target_File;
+				m_path = _target.substr(5);
+			}
+			else if (_target.compare(0, 5, "unix:") == 0)
+			{
+#if defined(_WIN32) || defined(WINRT)
+				Log::Write(LogLevel_Warning, "MetricsExport to a Unix domain socket is not available on this platform");
+#else
+				m_kind = Target_Unix;
+				m_path = _target.substr(5);
+#endif
+			}
+			else
+			{
+				Log::Write(LogLevel_Warning, "Unknown MetricsExport \"%s\", expected file:<path> or unix:<path>", _target.c_str());
+			}
+
+			if (m_path.empty())
+			{
+				m_kind = Target_None;
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <MetricsExporter::Describe>
+// Start a metric
+//-----------------------------------------------------------------------------
+		void MetricsExporter::Describe(string const& _name, char const* _type, char const* _help)
+		{
+			m_page += "# HELP " + _name + " " + _help + "\n";
+			m_page += "# TYPE " + _name + " " + _type + "\n";
+		}
+
+//-----------------------------------------------------------------------------
+// <MetricsExporter::AddSample>
+// Add a sample of a counter or gauge
+//-----------------------------------------------------------------------------
+		void MetricsExporter::AddSample(string const& _name, string const& _labels, uint64 _value)
+		{
+			char value[24];
+			snprintf(value, sizeof(value), "%llu", (unsigned long long) _value);
+			m_page += _name + "{" + _labels + "} " + value + "\n";
+		}
+
+//-----------------------------------------------------------------------------
+// <MetricsExporter::AddHistogram>
+// Add a latency histogram, with its buckets folded into the exported bounds
+//-----------------------------------------------------------------------------
+		void MetricsExporter::AddHistogram(string const& _name, string const& _labels, LatencyHistogramData const& _data)
+		{
+			char line[64];
+			string bucket = _name + "_bucket{" + _labels + ",le=\"";
+			for (uint32 i = 0; i < sizeof(c_histogramBounds) / sizeof(c_histogramBounds[0]); ++i)
+			{
+				// A bucket edge is a whole number of microseconds, so six places are exact
+				uint32 bound = LatencyHistogramData::GetBucketUpperBound(LatencyHistogramData::GetBucket(c_histogramBounds[i]));
+				snprintf(line, sizeof(line), "%u.%.6u", bound / 1000000, bound % 1000000);
+				string le = line;
+				le.erase(le.find_last_not_of('0') + 1);
+				if (le[le.size() - 1] == '.')
+				{
+					le.erase(le.size() - 1);
+				}
+				snprintf(line, sizeof(line), "\"} %u\n", _data.GetCountAtOrBelow(bound));
+				m_page += bucket + le + line;
+			}
+			snprintf(line, sizeof(line), "+Inf\"} %u\n", _data.m_count);
+			m_page += bucket + line;
+
+			snprintf(line, sizeof(line), "} %.6f\n", _data.m_sum / 1000000.0);
+			m_page += _name + "_sum{" + _labels + line;
+			snprintf(line, sizeof(line), "} %u\n", _data.m_count);
+			m_page += _name + "_count{" + _labels + line;
+		}
+
+//-----------------------------------------------------------------------------
+// <MetricsExporter::Write>
+// Write out the page, and start a new one
+//-----------------------------------------------------------------------------
+		bool MetricsExporter::Write()
+		{
+			bool written = false;
+			if (m_kind == Target_File)
+			{
+				written = WriteFile();
+			}
+			else if (m_kind == Target_Unix)
+			{
+				written = WriteSocket();
+			}
+			m_page.clear();
+
+			// Log a failure once, rather than at every interval until it is put right
+			if (!written && !m_failing)
+			{
+				Log::Write(LogLevel_Warning, "Failed to export metrics to %s", m_path.c_str());
+			}
+			else if (written && m_failing)
+			{
+				Log::Write(LogLevel_Info, "Exporting metrics to %s again", m_path.c_str());
+			}
+			m_failing = !written;
+			return written;
+		}
+
+//-----------------------------------------------------------------------------
+// <MetricsExporter::WriteFile>
+// Replace the file with the page
+//-----------------------------------------------------------------------------
+		bool MetricsExporter::WriteFile()
+		{
+			string temp = m_path + ".tmp";
+			FILE* file = fopen(temp.c_str(), "wb");
+			if (file == NULL)
+			{
+				return false;
+			}
+			bool written = (fwrite(m_page.data(), 1, m_page.size(), file) == m_page.size());
+			written = (fclose(file) == 0) && written;
+			if (!written)
+			{
+				remove(temp.c_str());
+				return false;
+			}
+#if defined(_WIN32) || defined(WINRT)
+			// rename will not replace a file here
+			remove(m_path.c_str());
+#endif
+			return rename(temp.c_str(), m_path.c_str()) == 0;
+		}
+
+//-----------------------------------------------------------------------------
+// <MetricsExporter::WriteSocket>
+// Send the page to the agent listening on the socket
+//-----------------------------------------------------------------------------
+		bool MetricsExporter::WriteSocket()
+		{
+#if defined(_WIN32) || defined(WINRT)
+			return false;
+#else
+			struct sockaddr_un addr;
+			if (m_path.size() >= sizeof(addr.sun_path))
+			{
+				return false;
+			}
+			memset(&addr, 0, sizeof(addr));
+			addr.sun_family = AF_UNIX;
+			memcpy(addr.sun_path, m_path.c_str(), m_path.size());
+
+			int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd < 0)
+			{
+				return false;
+			}
+			// Give up on an agent that stops reading, rather than wait for it.  On Linux this
+			// bounds the connect as well as the sends.
+			struct timeval timeout;
+			timeout.tv_sec = c_socketTimeout / 1000;
+			timeout.tv_usec = (c_socketTimeout % 1000) * 1000;
+			setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+			int on = 1;
+			setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+			bool written = (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) == 0);
+			size_t sent = 0;
+			while (written && (sent < m_page.size()))
+			{
+				// An agent that has gone away must not take the process with it on SIGPIPE
+				ssize_t n = send(fd, m_page.data() + sent, m_page.size() - sent, MSG_NOSIGNAL);
+				if (n <= 0)
+				{
+					written = false;
+				}
+				else
+				{
+					sent += n;
+				}
+			}
+			close(fd);
+			return written;
+#endif
+		}
+	} // namespace Internal
+} // namespace OpenZWave
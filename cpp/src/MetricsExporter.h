@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------
+//
+//	MetricsExporter.h
+//
+//	Writes driver metrics in the Prometheus text format
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _MetricsExporter_H
+#define _MetricsExporter_H
+
+#include <string>
+
+#include "Defs.h"
+
+namespace OpenZWave
+{
+	struct LatencyHistogramData;
+
+	namespace Internal
+	{
+		/** \brief Builds a page of metrics in the Prometheus text format, and writes it out.
+		 *
+		 *  The MetricsExport option names where the page goes:
+		 *  - "file:<path>" replaces the file, by writing the page alongside it and renaming it
+		 *    over the old one, so a reader such as the node_exporter textfile collector never
+		 *    sees half a page.
+		 *  - "unix:<path>" connects to a Unix domain socket that a local agent listens on, and
+		 *    sends the page.  Not available on Windows.
+		 *
+		 *  Add the samples of each metric together, after its Describe.  It does no locking of
+		 *  its own.
+		 */
+		class MetricsExporter
+		{
+			public:
+				/**
+				 * Constructor.
+				 * \param _target "file:<path>" or "unix:<path>".
+				 */
+				MetricsExporter(string const& _target);
+
+				/** Whether the target could be understood */
+				bool IsValid() const
+				{
+					return m_kind != Target_None;
+				}
+
+				/**
+				 * Start a metric.
+				 * \param _type "counter", "gauge" or "histogram".
+				 */
+				void Describe(string const& _name, char const* _type, char const* _help);
+
+				/**
+				 * Add a sample of a counter or gauge.
+				 * \param _labels the labels, without the braces, such as home_id="0x0184d6b2".
+				 */
+				void AddSample(string const& _name, string const& _labels, uint64 _value);
+
+				/**
+				 * Add a latency histogram, in seconds.  Its buckets are folded into a fixed set
+				 * of bounds from about 1ms to 30s, each on the edge of a histogram bucket, so
+				 * every count is exact.  A bound is up to an eighth above the round number it
+				 * stands for, 1.023ms rather than 1ms.
+				 */
+				void AddHistogram(string const& _name, string const& _labels, LatencyHistogramData const& _data);
+
+				/**
+				 * Write out the page built since the last Write, and start a new one.
+				 * \return false if it could not be written.
+				 */
+				bool Write();
+
+			private:
+				MetricsExporter(MetricsExporter const&);					// prevent copy
+				MetricsExporter& operator =(MetricsExporter const&);		// prevent assignment
+
+				bool WriteFile();
+				bool WriteSocket();
+
+				enum Target
+				{
+					Target_None = 0,
+					Target_File,
+					Target_Unix
+				};
+
+				Target m_kind;
+				string m_path;
+				string m_page;
+				bool m_failing;					// The last Write failed, and has been logged
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _MetricsExporter_H
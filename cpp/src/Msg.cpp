@@ -25,6 +25,7 @@
 //
 //-----------------------------------------------------------------------------
 
+#include <mutex>
 #include "Defs.h"
 #include "Msg.h"
 #include "Node.h"
@@ -32,6 +33,7 @@
 #include "Utils.h"
 #include "ZWSecurity.h"
 #include "platform/Log.h"
+#include "command_classes/MultiCmd.h"
 #include "command_classes/MultiInstance.h"
 #include "command_classes/Supervision.h"
 #include "command_classes/Security.h"
@@ -45,15 +47,34 @@ namespace OpenZWave
 		/* Callback for normal messages start at 10. Special Messages using a Callback prior to 10 */
 		uint8 Msg::s_nextCallbackId = 10;
 
+		/* The value being set by this thread, see Msg::ValueScope */
+		static thread_local uint64 s_valueId = 0;
+
 //-----------------------------------------------------------------------------
-// <Msg::Msg>
+// <Msg::ValueScope::ValueScope>
 // Constructor
 //-----------------------------------------------------------------------------
-		Msg::Msg(string const& _logText, uint8 _targetNodeId, uint8 const _msgType, uint8 const _function, bool const _bCallbackRequired, bool const _bReplyRequired,			// = true
-				uint8 const _expectedReply,			// = 0
-				uint8 const _expectedCommandClassId // = 0
-				) :
-				m_logText(_logText), m_bFinal(false), m_bCallbackRequired(_bCallbackRequired), m_callbackId(0), m_expectedReply(0), m_expectedCommandClassId(_expectedCommandClassId), m_length(4), m_targetNodeId(_targetNodeId), m_sendAttempts(0), m_maxSendAttempts( MAX_TRIES), m_instance(1), m_endPoint(0), m_flags(0), m_encrypted(false), m_noncerecvd(false), m_homeId(0), m_resendDuetoCANorNAK(false)
+		Msg::ValueScope::ValueScope(uint64 const _valueId) :
+				m_previous(s_valueId)
+		{
+			s_valueId = _valueId;
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::ValueScope::~ValueScope>
+// Destructor
+//-----------------------------------------------------------------------------
+		Msg::ValueScope::~ValueScope()
+		{
+			s_valueId = m_previous;
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::Msg>
+// Constructor, for a log text that need not be copied
+//-----------------------------------------------------------------------------
+		Msg::Msg(LiteralText _logText, uint8 _targetNodeId, uint8 const _msgType, uint8 const _function, bool const _bCallbackRequired, bool const _bReplyRequired, uint8 const _expectedReply, uint8 const _expectedCommandClassId) :
+				m_logTextLiteral(_logText.m_text), m_bFinal(false), m_bCallbackRequired(_bCallbackRequired), m_callbackId(0), m_expectedReply(0), m_expectedCommandClassId(_expectedCommandClassId), m_length(4), m_buffer(m_inlineBuffer), e_buffer(NULL), m_targetNodeId(_targetNodeId), m_sendAttempts(0), m_maxSendAttempts( MAX_TRIES), m_instance(1), m_endPoint(0), m_flags(0), m_encrypted(false), m_noncerecvd(false), m_homeId(0), m_resendDuetoCANorNAK(false), m_batchCount(0), m_batchReplyCount(0), m_valueId(0), m_valueCommand(0)
 		{
 			if (_bReplyRequired)
 			{
@@ -61,8 +82,7 @@ namespace OpenZWave
 				m_expectedReply = _expectedReply ? _expectedReply : _function;
 			}
 
-			memset(m_buffer, 0x00, 256);
-			memset(e_buffer, 0x00, 256);
+			memset(m_inlineBuffer, 0x00, InlineBufferSize);
 
 			m_buffer[0] = SOF;
 			m_buffer[1] = 0;					// Length of the following data, filled in during Finalize.
@@ -70,6 +90,161 @@ namespace OpenZWave
 			m_buffer[3] = _function;
 		}
 
+//-----------------------------------------------------------------------------
+// <Msg::Msg>
+// Constructor, for a log text that has been built up
+//-----------------------------------------------------------------------------
+		Msg::Msg(string const& _logText, uint8 _targetNodeId, uint8 const _msgType, uint8 const _function, bool const _bCallbackRequired, bool const _bReplyRequired,			// = true
+				uint8 const _expectedReply,			// = 0
+				uint8 const _expectedCommandClassId // = 0
+				) :
+				Msg(LiteralText(NULL), _targetNodeId, _msgType, _function, _bCallbackRequired, _bReplyRequired, _expectedReply, _expectedCommandClassId)
+		{
+			m_logText = _logText;
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::Msg>
+// Copy constructor
+//-----------------------------------------------------------------------------
+		Msg::Msg(Msg const& _other) :
+				m_logTextLiteral(_other.m_logTextLiteral), m_logText(_other.m_logText), m_bFinal(_other.m_bFinal), m_bCallbackRequired(_other.m_bCallbackRequired), m_callbackId(_other.m_callbackId), m_expectedReply(_other.m_expectedReply), m_expectedCommandClassId(_other.m_expectedCommandClassId), m_length(_other.m_length), m_buffer(m_inlineBuffer), e_buffer(NULL), m_targetNodeId(_other.m_targetNodeId), m_sendAttempts(_other.m_sendAttempts), m_maxSendAttempts(_other.m_maxSendAttempts), m_instance(_other.m_instance), m_endPoint(_other.m_endPoint), m_flags(_other.m_flags), m_supervision_session_id(_other.m_supervision_session_id), m_encrypted(false), m_noncerecvd(_other.m_noncerecvd), m_homeId(_other.m_homeId), m_resendDuetoCANorNAK(_other.m_resendDuetoCANorNAK), m_batchCount(_other.m_batchCount), m_batchReplyCount(_other.m_batchReplyCount), m_valueId(_other.m_valueId), m_valueCommand(_other.m_valueCommand)
+		{
+			memcpy(m_inlineBuffer, _other.m_inlineBuffer, InlineBufferSize);
+			if (_other.m_buffer != _other.m_inlineBuffer)
+			{
+				Reserve(MaxBufferSize);
+				memcpy(m_buffer, _other.m_buffer, MaxBufferSize);
+			}
+			if (_other.m_encrypted)
+			{
+				setEncrypted();
+				memcpy(e_buffer, _other.e_buffer, MaxBufferSize);
+			}
+			memcpy(m_nonce, _other.m_nonce, sizeof(m_nonce));
+			memcpy(m_batchReplies, _other.m_batchReplies, sizeof(m_batchReplies));
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::~Msg>
+// Destructor
+//-----------------------------------------------------------------------------
+		Msg::~Msg()
+		{
+			if (m_buffer != m_inlineBuffer)
+			{
+				delete[] m_buffer;
+			}
+			delete[] e_buffer;
+		}
+
+		namespace
+		{
+			// Freed messages kept for reuse.  Only so many are kept, so that the memory of a
+			// large backlog goes back to the heap once it has been sent.
+			struct MsgPool
+			{
+					MsgPool() :
+							m_free(NULL), m_count(0)
+					{
+					}
+
+					std::mutex m_mutex;
+					void* m_free;							// Each block's first word points to the next
+					uint32 m_count;
+			};
+			static uint32 const c_msgPoolSize = 256;
+
+			MsgPool& GetMsgPool()
+			{
+				// Never destroyed, as messages may still be freed while static objects are destroyed
+				static MsgPool* pool = new MsgPool();
+				return *pool;
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::operator new>
+// Take a message from the pool
+//-----------------------------------------------------------------------------
+		void* Msg::operator new(size_t _size)
+		{
+			if (_size == sizeof(Msg))
+			{
+				MsgPool& pool = GetMsgPool();
+				std::lock_guard<std::mutex> lock(pool.m_mutex);
+				if (void* block = pool.m_free)
+				{
+					pool.m_free = *(void**) block;
+					--pool.m_count;
+					return block;
+				}
+			}
+			return ::operator new(_size);
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::operator delete>
+// Return a message to the pool
+//-----------------------------------------------------------------------------
+		void Msg::operator delete(void* _p)
+		{
+			if (!_p)
+			{
+				return;
+			}
+			{
+				MsgPool& pool = GetMsgPool();
+				std::lock_guard<std::mutex> lock(pool.m_mutex);
+				if (pool.m_count < c_msgPoolSize)
+				{
+					*(void**) _p = pool.m_free;
+					pool.m_free = _p;
+					++pool.m_count;
+					return;
+				}
+			}
+			::operator delete(_p);
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::Reserve>
+// Move the frame to the heap if it is going to outgrow the inline buffer
+//-----------------------------------------------------------------------------
+		void Msg::Reserve(uint32 const _size)
+		{
+			if ((_size > InlineBufferSize) && (m_buffer == m_inlineBuffer))
+			{
+				m_buffer = new uint8[MaxBufferSize];
+				memcpy(m_buffer, m_inlineBuffer, InlineBufferSize);
+				memset(&m_buffer[InlineBufferSize], 0x00, MaxBufferSize - InlineBufferSize);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::setEncrypted>
+// Mark the message for encryption, and make room for the encrypted frame
+//-----------------------------------------------------------------------------
+		void Msg::setEncrypted()
+		{
+			m_encrypted = true;
+			if (!e_buffer)
+			{
+				e_buffer = new uint8[MaxBufferSize];
+				memset(e_buffer, 0x00, MaxBufferSize);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::SetLogText>
+// Replace the log text
+//-----------------------------------------------------------------------------
+		void Msg::SetLogText(string const& _logText)
+		{
+			m_logText = _logText;
+			m_logTextLiteral = NULL;
+		}
+
 //-----------------------------------------------------------------------------
 // <Msg::SetInstance>
 // Used to enable wrapping with MultiInstance/MultiChannel during finalize.
@@ -122,6 +297,7 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 		void Msg::Append(uint8 const _data)
 		{
+			Reserve(m_length + 1);
 			m_buffer[m_length++] = _data;
 		}
 
@@ -149,6 +325,17 @@ namespace OpenZWave
 				return;
 			}
 
+			if (s_valueId && (m_buffer[3] == FUNC_ID_ZW_SEND_DATA) && !(m_flags & m_Supervision))
+			{
+				// Taken before any encapsulation hides the command.  A supervised Set is never
+				// replaced, as the Supervision command class waits for its session to end.
+				m_valueId = s_valueId;
+				m_valueCommand = (((uint16) m_buffer[6]) << 8) | m_buffer[7];
+			}
+
+			// Room for both encapsulations, the callback id and the checksum
+			Reserve(m_length + 10);
+
 			// Deal with Supervision encapsulation
 			if ((m_flags & m_Supervision) != 0)
 			{
@@ -225,7 +412,7 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 		std::string Msg::GetAsString()
 		{
-			string str = m_logText;
+			string str = GetLogText();
 
 			char byteStr[16];
 			if (m_targetNodeId != 0xff)
@@ -278,8 +465,8 @@ namespace OpenZWave
 				m_buffer[9] = m_endPoint;
 				m_length += 4;
 
-				snprintf(str, sizeof(str), "MultiChannel Encapsulated (instance=%d): %s", m_instance, m_logText.c_str());
-				m_logText = str;
+				snprintf(str, sizeof(str), "MultiChannel Encapsulated (instance=%d): %s", m_instance, GetLogText().c_str());
+				SetLogText(str);
 			}
 			else
 			{
@@ -295,8 +482,8 @@ namespace OpenZWave
 				m_buffer[8] = m_instance;
 				m_length += 3;
 
-				snprintf(str, sizeof(str), "MultiInstance Encapsulated (instance=%d): %s", m_instance, m_logText.c_str());
-				m_logText = str;
+				snprintf(str, sizeof(str), "MultiInstance Encapsulated (instance=%d): %s", m_instance, GetLogText().c_str());
+				SetLogText(str);
 			}
 		}
 
@@ -323,8 +510,178 @@ namespace OpenZWave
 			m_buffer[5] += 4;
 			m_length += 4;
 
-			snprintf(str, sizeof(str), "Supervisioned (session=%d): %s", m_supervision_session_id, m_logText.c_str());
-			m_logText = str;
+			snprintf(str, sizeof(str), "Supervisioned (session=%d): %s", m_supervision_session_id, GetLogText().c_str());
+			SetLogText(str);
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::GetHash>
+// Hash the bytes that operator == compares
+//-----------------------------------------------------------------------------
+		uint64 Msg::GetHash() const
+		{
+			uint32 length = m_length;
+			if (m_bFinal)
+			{
+				length -= (m_bCallbackRequired ? 2 : 1);
+			}
+
+			// FNV-1a
+			uint64 hash = 0xcbf29ce484222325ULL;
+			for (uint32 i = 0; i < length; ++i)
+			{
+				hash ^= m_buffer[i];
+				hash *= 0x100000001b3ULL;
+			}
+			return hash;
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::CanBatch>
+// Whether the message could share a MultiCmd encapsulation with others
+//-----------------------------------------------------------------------------
+		bool Msg::CanBatch() const
+		{
+			if (!m_bFinal || !m_bCallbackRequired || m_encrypted || (m_flags != 0) || (m_buffer[2] != REQUEST) || (m_buffer[3] != FUNC_ID_ZW_SEND_DATA))
+			{
+				return false;
+			}
+			if (!m_batchCount)
+			{
+				if ((m_buffer[6] == Internal::CC::MultiCmd::StaticGetCommandClassId()) || IsWakeUpNoMoreInformationCommand() || IsNoOperation())
+				{
+					// The node goes back to sleep on the first, and the second is sent to see if it is there at all
+					return false;
+				}
+			}
+
+			// The transaction must end on the callback, or on a report that the Driver can tell apart
+			return (m_expectedReply == 0) || (m_expectedReply == FUNC_ID_ZW_SEND_DATA) || ((m_expectedReply == FUNC_ID_APPLICATION_COMMAND_HANDLER) && (m_expectedCommandClassId != 0));
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::Batch>
+// Add the command of another message to this one's MultiCmd encapsulation
+//-----------------------------------------------------------------------------
+		bool Msg::Batch(Msg const& _msg, uint32 const _maxPayload)
+		{
+			if ((m_batchCount >= MaxBatchCommands) || _msg.m_batchCount || (_msg.m_targetNodeId != m_targetNodeId) || !CanBatch() || !_msg.CanBatch())
+			{
+				return false;
+			}
+
+			// The encapsulation header takes three bytes, and each command one more for its length
+			uint8 length = _msg.m_buffer[5];
+			uint32 payload = (m_batchCount ? m_buffer[5] : (m_buffer[5] + 4)) + 1 + length;
+			if (payload > _maxPayload)
+			{
+				return false;
+			}
+
+			Reserve(6 + payload + 3);
+
+			// The transmit options follow the payload, then the callback id and the checksum
+			uint8 txOptions = m_buffer[6 + m_buffer[5]];
+			if (!m_batchCount)
+			{
+				uint8 ownLength = m_buffer[5];
+				memmove(&m_buffer[10], &m_buffer[6], ownLength);
+				m_buffer[5] = ownLength + 4;
+				m_buffer[6] = Internal::CC::MultiCmd::StaticGetCommandClassId();
+				m_buffer[7] = Internal::CC::MultiCmd::MultiCmdCmd_Encap;
+				m_buffer[8] = 1;
+				m_buffer[9] = ownLength;
+				m_batchCount = 1;
+				if (m_expectedReply == FUNC_ID_APPLICATION_COMMAND_HANDLER)
+				{
+					m_batchReplies[m_batchReplyCount++] = m_expectedCommandClassId;
+				}
+				SetLogText("MultiCmd Encapsulated: " + GetLogText());
+			}
+
+			uint32 offset = 6 + m_buffer[5];
+			m_buffer[offset] = length;
+			memcpy(&m_buffer[offset + 1], &_msg.m_buffer[6], length);
+			m_buffer[5] = (uint8) payload;
+			m_buffer[8] = ++m_batchCount;
+			if (_msg.m_expectedReply == FUNC_ID_APPLICATION_COMMAND_HANDLER)
+			{
+				m_batchReplies[m_batchReplyCount++] = _msg.m_expectedCommandClassId;
+			}
+			SetLogText(GetLogText() + "; " + _msg.GetLogText());
+			m_valueId = 0;
+
+			m_length = (uint8) (6 + payload);
+			m_buffer[m_length++] = txOptions;
+			m_buffer[1] = m_length;
+			m_buffer[m_length++] = m_callbackId;
+			uint8 checksum = 0xff;
+			for (uint32 i = 1; i < m_length; ++i)
+			{
+				checksum ^= m_buffer[i];
+			}
+			m_buffer[m_length++] = checksum;
+
+			if (m_batchReplyCount)
+			{
+				m_expectedReply = FUNC_ID_APPLICATION_COMMAND_HANDLER;
+				m_expectedCommandClassId = m_batchReplies[0];
+			}
+			else if (_msg.m_expectedReply)
+			{
+				m_expectedReply = FUNC_ID_ZW_SEND_DATA;
+			}
+			if (_msg.m_maxSendAttempts > m_maxSendAttempts)
+			{
+				m_maxSendAttempts = _msg.m_maxSendAttempts;
+			}
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::BatchReportReceived>
+// Tick off the reports the batched commands wait for
+//-----------------------------------------------------------------------------
+		bool Msg::BatchReportReceived(uint8 const* _data, uint32 const _length)
+		{
+			if ((_length >= 3) && (_data[0] == Internal::CC::MultiCmd::StaticGetCommandClassId()) && (_data[1] == Internal::CC::MultiCmd::MultiCmdCmd_Encap))
+			{
+				// The node answered with its own encapsulation
+				uint32 base = 3;
+				for (uint8 i = 0; (i < _data[2]) && ((base + 1) < _length); ++i)
+				{
+					BatchReportReceived(_data[base + 1]);
+					base += _data[base] + 1;
+				}
+			}
+			else if (_length)
+			{
+				BatchReportReceived(_data[0]);
+			}
+
+			if (m_batchReplyCount)
+			{
+				m_expectedCommandClassId = m_batchReplies[0];
+				return false;
+			}
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <Msg::BatchReportReceived>
+// Tick off one report
+//-----------------------------------------------------------------------------
+		void Msg::BatchReportReceived(uint8 const _commandClassId)
+		{
+			for (uint8 i = 0; i < m_batchReplyCount; ++i)
+			{
+				if (m_batchReplies[i] == _commandClassId)
+				{
+					memmove(&m_batchReplies[i], &m_batchReplies[i + 1], m_batchReplyCount - i - 1);
+					--m_batchReplyCount;
+					return;
+				}
+			}
 		}
 
 //-----------------------------------------------------------------------------
@@ -57,11 +57,51 @@ namespace OpenZWave
 					m_Supervision = 0x04,		// Indicate Supervision encapsulation
 				};
 
-				Msg(string const& _logtext, uint8 _targetNodeId, uint8 const _msgType, uint8 const _function, bool const _bCallbackRequired, bool const _bReplyRequired = true, uint8 const _expectedReply = 0, uint8 const _expectedCommandClassId = 0);
-				~Msg()
+				enum
+				{
+					MaxBatchCommands = 16,		// Most commands that one MultiCmd encapsulation carries
+					InlineBufferSize = 64,		// Frames up to this size are kept in the Msg itself
+					MaxBufferSize = 256
+				};
+
+				/** \brief While one of these is in scope, the messages the thread finalizes are marked as
+				 *  setting the value, so that a later message setting it can replace them.
+				 */
+				class ValueScope
+				{
+					public:
+						ValueScope(uint64 const _valueId);
+						~ValueScope();
+
+					private:
+						uint64 m_previous;
+				};
+
+				/**
+				 * Constructor, for a log text that is a string literal.  The text is not copied.
+				 */
+				template<size_t N>
+				Msg(char const (&_logtext)[N], uint8 _targetNodeId, uint8 const _msgType, uint8 const _function, bool const _bCallbackRequired, bool const _bReplyRequired = true, uint8 const _expectedReply = 0, uint8 const _expectedCommandClassId = 0) :
+						Msg(LiteralText(_logtext), _targetNodeId, _msgType, _function, _bCallbackRequired, _bReplyRequired, _expectedReply, _expectedCommandClassId)
 				{
 				}
 
+				/**
+				 * A log text built in a buffer would not outlive the message, so it goes through the
+				 * string constructor instead, which copies it.
+				 */
+				template<size_t N, typename ... Args>
+				Msg(char (&_logtext)[N], Args ... _args) = delete;
+
+				/** Constructor, for any other log text.  The text is copied. */
+				Msg(string const& _logtext, uint8 _targetNodeId, uint8 const _msgType, uint8 const _function, bool const _bCallbackRequired, bool const _bReplyRequired = true, uint8 const _expectedReply = 0, uint8 const _expectedCommandClassId = 0);
+				Msg(Msg const& _other);
+				~Msg();
+
+				/** Messages come from a pool, as the queues take and free a great many of them */
+				static void* operator new(size_t _size);
+				static void operator delete(void* _p);
+
 				void SetInstance(OpenZWave::Internal::CC::CommandClass * _cc, uint8 const _instance);	// Used to enable wrapping with MultiInstance/MultiChannel during finalize.
 				void SetSupervision(uint8 _session_id);
 
@@ -133,7 +173,7 @@ namespace OpenZWave
 				 */
 				string GetLogText() const
 				{
-					return m_logText;
+					return m_logTextLiteral ? string(m_logTextLiteral) : m_logText;
 				}
 
 				uint32 GetLength() const
@@ -162,11 +202,11 @@ namespace OpenZWave
 						m_maxSendAttempts = _count;
 				}
 
-				bool IsWakeUpNoMoreInformationCommand()
+				bool IsWakeUpNoMoreInformationCommand() const
 				{
 					return (m_bFinal && (m_length == 11) && (m_buffer[3] == 0x13) && (m_buffer[6] == 0x84) && (m_buffer[7] == 0x08));
 				}
-				bool IsNoOperation()
+				bool IsNoOperation() const
 				{
 					return (m_bFinal && (m_length == 11) && (m_buffer[3] == 0x13) && (m_buffer[6] == 0x00) && (m_buffer[7] == 0x00));
 				}
@@ -194,10 +234,7 @@ namespace OpenZWave
 				{
 					return m_encrypted;
 				}
-				void setEncrypted()
-				{
-					m_encrypted = true;
-				}
+				void setEncrypted();
 				bool isNonceRecieved()
 				{
 					return m_noncerecvd;
@@ -226,14 +263,88 @@ namespace OpenZWave
 					return m_resendDuetoCANorNAK;
 				}
 
+				/**
+				 * \brief A hash of the part of the message that operator == compares.
+				 */
+				uint64 GetHash() const;
+
+				/**
+				 * \brief The ID of the value this message sets, if it was finalized inside a ValueScope.
+				 * \return the value's ValueID::GetId, or 0.
+				 */
+				uint64 GetValueId() const
+				{
+					return m_valueId;
+				}
+
+				/**
+				 * \brief Whether this message and another set the same value with the same command, so that
+				 * the later one makes the earlier unnecessary.
+				 */
+				bool SetsSameValue(Msg const& _other) const
+				{
+					return m_valueId && (m_valueId == _other.m_valueId) && (m_valueCommand == _other.m_valueCommand) && (m_targetNodeId == _other.m_targetNodeId);
+				}
+
+				/**
+				 * \brief Whether this finalized message could share a MultiCmd encapsulation with others.
+				 * Only unencrypted commands sent with FUNC_ID_ZW_SEND_DATA, without any other encapsulation,
+				 * and waiting for no more than their callback or a single report, qualify.
+				 */
+				bool CanBatch() const;
+
+				/**
+				 * \brief Add the command of another message for the same node to this one, putting both in a
+				 * MultiCmd encapsulation.  The other message is left as it is, for the caller to delete.
+				 * \param _msg the message to add.  It must not itself be a batch.
+				 * \param _maxPayload the largest the encapsulation may grow to, in bytes.
+				 * \return true if the command was added.
+				 */
+				bool Batch(Msg const& _msg, uint32 const _maxPayload);
+
+				/**
+				 * \brief The number of commands in this message's MultiCmd encapsulation.
+				 * \return the number of commands, or 0 if the message has not been batched.
+				 */
+				uint8 GetBatchCount() const
+				{
+					return m_batchCount;
+				}
+
+				/**
+				 * \brief Tick off a report that a batched command was waiting for.
+				 * \param _data the command received, starting with its command class.  A MultiCmd encapsulation
+				 * ticks off each of the reports in it.
+				 * \param _length the length of the command.
+				 * \return true once every report the batch waits for has been received.
+				 */
+				bool BatchReportReceived(uint8 const* _data, uint32 const _length);
+
 				/** Returns a pointer to the driver (interface with a Z-Wave controller)
 				 *  associated with this node.
 				 */
 				Driver* GetDriver() const;
 			private:
+				Msg& operator =(Msg const&);			// prevent assignment
+
+				void Reserve(uint32 const _size);		// Make room in m_buffer for a frame of _size bytes
+				void SetLogText(string const& _logText);
+
+				/** A log text that lives as long as the program, and so need not be copied */
+				struct LiteralText
+				{
+						explicit LiteralText(char const* _text) :
+								m_text(_text)
+						{
+						}
+						char const* m_text;
+				};
+				Msg(LiteralText _logText, uint8 _targetNodeId, uint8 const _msgType, uint8 const _function, bool const _bCallbackRequired, bool const _bReplyRequired, uint8 const _expectedReply, uint8 const _expectedCommandClassId);
 
 				void MultiEncap();						// Encapsulate the data inside a MultiInstance/Multicommand message
 				void SupervisionEncap();				// Encapsulate the data inside a Supervision message
+				void BatchReportReceived(uint8 const _commandClassId);
+				char const* m_logTextLiteral;			// The log text, until it is changed and kept in m_logText
 				string m_logText;
 				bool m_bFinal;
 				bool m_bCallbackRequired;
@@ -242,8 +353,9 @@ namespace OpenZWave
 				uint8 m_expectedReply;
 				uint8 m_expectedCommandClassId;
 				uint8 m_length;
-				uint8 m_buffer[256];
-				uint8 e_buffer[256];
+				uint8* m_buffer;						// m_inlineBuffer, or MaxBufferSize bytes on the heap for a longer frame
+				uint8* e_buffer;						// The encrypted frame, allocated by setEncrypted
+				uint8 m_inlineBuffer[InlineBufferSize];
 
 				uint8 m_targetNodeId;
 				uint8 m_sendAttempts;
@@ -261,6 +373,13 @@ namespace OpenZWave
 				static uint8 s_nextCallbackId;		// counter to get a unique callback id
 				/* we are resending this message due to CAN or NAK messages */
 				bool m_resendDuetoCANorNAK;
+
+				uint8 m_batchCount;						// Commands in the MultiCmd encapsulation, or 0 if not batched
+				uint8 m_batchReplyCount;
+				uint8 m_batchReplies[MaxBatchCommands];	// Command classes of the reports the batch still waits for
+
+				uint64 m_valueId;						// Value set by the message, or 0
+				uint16 m_valueCommand;					// Command class and command that set it
 		};
 	} // namespace Internal
 } // namespace OpenZWave
@@ -0,0 +1,177 @@
+//-----------------------------------------------------------------------------
+//
+//	MsgScheduler.cpp
+//
+//	Chooses which of the Driver's message queues to serve next
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include "MsgScheduler.h"
+#include "Driver.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		// Deadlines for the queues other than Send, in milliseconds.  The Command and Controller
+		// queues have none: a controller command takes the network over until it is done.
+		static int32 const c_deadlines[Driver::MsgQueue_Count] =
+		{ 0,			// Command
+				10000,	// NoOp
+				0,		// Controller
+				5000,	// WakeUp
+				0,		// Send, set by the SendDeadline option
+				30000,	// Query
+				60000	// Poll
+				};
+
+//-----------------------------------------------------------------------------
+// <MsgScheduler::MsgScheduler>
+// Constructor
+//-----------------------------------------------------------------------------
+		MsgScheduler::MsgScheduler()
+		{
+		}
+
+//-----------------------------------------------------------------------------
+// <MsgScheduler::~MsgScheduler>
+// Destructor
+//-----------------------------------------------------------------------------
+		MsgScheduler::~MsgScheduler()
+		{
+		}
+
+//-----------------------------------------------------------------------------
+// <MsgScheduler::Select>
+// The highest priority queue that is ready
+//-----------------------------------------------------------------------------
+		uint32 MsgScheduler::Select(QueueHead const* _heads, uint32 _count, Clock::time_point _now)
+		{
+			for (uint32 i = 0; i < _count; ++i)
+			{
+				if (_heads[i].m_ready)
+				{
+					return i;
+				}
+			}
+			return 0;
+		}
+
+//-----------------------------------------------------------------------------
+// <MsgScheduler::GetDeadline>
+// No deadlines
+//-----------------------------------------------------------------------------
+		int32 MsgScheduler::GetDeadline(uint32 _queue) const
+		{
+			return 0;
+		}
+
+//-----------------------------------------------------------------------------
+// <MsgScheduler::IsFairQueue>
+// Every queue is first in, first out
+//-----------------------------------------------------------------------------
+		bool MsgScheduler::IsFairQueue(uint32 _queue) const
+		{
+			return false;
+		}
+
+//-----------------------------------------------------------------------------
+// <FairMsgScheduler::FairMsgScheduler>
+// Constructor
+//-----------------------------------------------------------------------------
+		FairMsgScheduler::FairMsgScheduler(int32 _sendDeadline, int32 _pollShare) :
+				m_sendDeadline(_sendDeadline), m_pollShare(_pollShare), m_pollCredit(0)
+		{
+			if (m_pollShare < 0)
+			{
+				m_pollShare = 0;
+			}
+			else if (m_pollShare > 100)
+			{
+				m_pollShare = 100;
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <FairMsgScheduler::Select>
+// Overdue messages first, then by priority, sharing between Query and Poll
+//-----------------------------------------------------------------------------
+		uint32 FairMsgScheduler::Select(QueueHead const* _heads, uint32 _count, Clock::time_point _now)
+		{
+			if (_heads[Driver::MsgQueue_Command].m_ready)
+			{
+				return Driver::MsgQueue_Command;
+			}
+
+			// The highest priority queue with an overdue message.  Ranking them by priority rather than
+			// by deadline keeps a long backlog of old queries from holding up a newer message.
+			int32 overdue = -1;
+			for (uint32 i = 0; i < _count; ++i)
+			{
+				if (_heads[i].m_ready && GetDeadline(i) && (_heads[i].m_deadline <= _now))
+				{
+					overdue = (int32) i;
+					break;
+				}
+			}
+			// Nothing from a lower queue overtakes a message setting a value, overdue or not
+			bool sendReady = (_count > Driver::MsgQueue_Send) && _heads[Driver::MsgQueue_Send].m_ready;
+			if ((overdue >= 0) && !(sendReady && (overdue > Driver::MsgQueue_Send)))
+			{
+				return (uint32) overdue;
+			}
+
+			uint32 queue = MsgScheduler::Select(_heads, _count, _now);
+			if ((queue == Driver::MsgQueue_Query) && (_count > Driver::MsgQueue_Poll) && _heads[Driver::MsgQueue_Poll].m_ready)
+			{
+				// Both are waiting, so share the turns out
+				m_pollCredit += m_pollShare;
+				if (m_pollCredit >= 100)
+				{
+					m_pollCredit -= 100;
+					queue = Driver::MsgQueue_Poll;
+				}
+			}
+			return queue;
+		}
+
+//-----------------------------------------------------------------------------
+// <FairMsgScheduler::GetDeadline>
+// The deadline for a queue
+//-----------------------------------------------------------------------------
+		int32 FairMsgScheduler::GetDeadline(uint32 _queue) const
+		{
+			if (_queue == Driver::MsgQueue_Send)
+			{
+				return m_sendDeadline;
+			}
+			return (_queue < Driver::MsgQueue_Count) ? c_deadlines[_queue] : 0;
+		}
+
+//-----------------------------------------------------------------------------
+// <FairMsgScheduler::IsFairQueue>
+// The Query and Poll queues are shared between the nodes
+//-----------------------------------------------------------------------------
+		bool FairMsgScheduler::IsFairQueue(uint32 _queue) const
+		{
+			return (_queue == Driver::MsgQueue_Query) || (_queue == Driver::MsgQueue_Poll);
+		}
+	} // namespace Internal
+} // namespace OpenZWave
@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+//
+//	MsgScheduler.h
+//
+//	Chooses which of the Driver's message queues to serve next
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _MsgScheduler_H
+#define _MsgScheduler_H
+
+#include <chrono>
+
+#include "Defs.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		/** \brief Decides which of the Driver's message queues is served when the Driver
+		 *  is free to send.
+		 *
+		 *  The queues are numbered as Driver::MsgQueue, from the highest priority down.  This
+		 *  class serves them in that fixed order, as the Driver always has.  Derive from it for
+		 *  another policy.  Selected with the "MessageScheduler" option.
+		 */
+		class MsgScheduler
+		{
+			public:
+				typedef std::chrono::steady_clock Clock;
+
+				/** The state of one queue, as the scheduler sees it */
+				struct QueueHead
+				{
+						bool m_ready;						// There is an item that can be handled now
+						Clock::time_point m_deadline;		// When the item at the head should have gone, if ready
+				};
+
+				MsgScheduler();
+				virtual ~MsgScheduler();
+
+				/**
+				 * Choose the queue to serve.
+				 * \param _heads the state of each queue.
+				 * \param _count the number of queues that may be served.  Only the first _count entries of _heads are
+				 * used, and at least one of them is ready.
+				 * \param _now the current time.
+				 * \return the index of a ready queue.
+				 */
+				virtual uint32 Select(QueueHead const* _heads, uint32 _count, Clock::time_point _now);
+
+				/**
+				 * How long an item may wait in a queue before it is overdue.
+				 * \return the time in milliseconds, or 0 if items in the queue have no deadline.
+				 */
+				virtual int32 GetDeadline(uint32 _queue) const;
+
+				/**
+				 * Whether the items in a queue are taken from each node in turn, rather than in the
+				 * order they were queued.  The items for any one node always keep their order.
+				 */
+				virtual bool IsFairQueue(uint32 _queue) const;
+
+			private:
+				MsgScheduler(MsgScheduler const&);					// prevent copy
+				MsgScheduler& operator =(MsgScheduler const&);		// prevent assignment
+		};
+
+		/** \brief Serves the message queues in priority order, but with a deadline for each message.
+		 *
+		 *  - A message that has waited past its deadline goes ahead of the higher priority queues.
+		 *    Where several have, the one from the highest priority queue goes first.  A controller
+		 *    command in progress, in the Command queue, is never held up, and nor is a message
+		 *    setting a value, in the Send queue, by one from a lower queue.
+		 *  - While both the Query and the Poll queues are waiting, the Poll queue gets a fixed
+		 *    share of the turns, so that polling goes on while nodes are interviewed.
+		 *  - The Query and Poll queues take each node's messages in turn, so that one node with a
+		 *    long interview or many polled values does not hold up the others.
+		 */
+		class FairMsgScheduler: public MsgScheduler
+		{
+			public:
+				/**
+				 * Constructor.
+				 * \param _sendDeadline the deadline for the Send queue, which holds the messages that
+				 * set values, in milliseconds.
+				 * \param _pollShare the percentage of the turns the Poll queue gets while the Query
+				 * queue is also waiting.
+				 */
+				FairMsgScheduler(int32 _sendDeadline, int32 _pollShare);
+
+				virtual uint32 Select(QueueHead const* _heads, uint32 _count, Clock::time_point _now);
+				virtual int32 GetDeadline(uint32 _queue) const;
+				virtual bool IsFairQueue(uint32 _queue) const;
+
+			private:
+				int32 m_sendDeadline;
+				int32 m_pollShare;
+				int32 m_pollCredit;				// Poll gets a turn each time this reaches 100
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _MsgScheduler_H
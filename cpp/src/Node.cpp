@@ -102,7 +102,7 @@ static char const* c_queryStageNames[] =
 Node::Node(uint32 const _homeId, uint8 const _nodeId) :
 		m_queryStage(QueryStage_None), m_queryPending(false), m_queryConfiguration(false), m_queryRetries(0), m_protocolInfoReceived(false), m_basicprotocolInfoReceived(false), m_nodeInfoReceived(false), m_nodePlusInfoReceived(false), m_manufacturerSpecificClassReceived(false), m_nodeInfoSupported(true), m_refreshonNodeInfoFrame(true), m_nodeAlive(true),	// assome live node
 		m_listening(true),	// assume we start out listening
-		m_frequentListening(false), m_beaming(false), m_routing(false), m_maxBaudRate(0), m_version(0), m_security(false), m_homeId(_homeId), m_nodeId(_nodeId), m_basic(0), m_generic(0), m_specific(0), m_type(""), m_addingNode(false), m_manufacturerName(""), m_productName(""), m_nodeName(""), m_location(""), m_manufacturerId(0), m_productType(0), m_productId(0), m_deviceType(0), m_role(0), m_nodeType(0), m_secured(false), m_nodeCache( NULL), m_Product( NULL), m_fileConfigRevision(0), m_loadedConfigRevision(
+		m_frequentListening(false), m_beaming(false), m_routing(false), m_maxBaudRate(0), m_version(0), m_security(false), m_homeId(_homeId), m_nodeId(_nodeId), m_basic(0), m_generic(0), m_specific(0), m_type(""), m_addingNode(false), m_manufacturerName(""), m_productName(""), m_nodeName(""), m_location(""), m_manufacturerId(0), m_productType(0), m_productId(0), m_deviceType(0), m_role(0), m_nodeType(0), m_secured(false), m_nodeCache( NULL), m_cacheFingerprint(0), m_hasCacheFingerprint(false), m_Product( NULL), m_fileConfigRevision(0), m_loadedConfigRevision(
 				0), m_latestConfigRevision(0), m_values(new Internal::VC::ValueStore()), m_sentCnt(0), m_sentFailed(0), m_retries(0), m_receivedCnt(0), m_receivedDups(0), m_receivedUnsolicited(0), m_lastRequestRTT(0), m_lastResponseRTT(0), m_averageRequestRTT(0), m_averageResponseRTT(0), m_quality(0), m_lastReceivedMessage(), m_errors(0), m_txStatusReportSupported(false), m_txTime(0), m_hops(0), m_ackChannel(0), m_lastTxChannel(0), m_routeScheme((TXSTATUS_ROUTING_SCHEME) 0), m_routeUsed
 		{ }, m_routeSpeed((TXSTATUS_ROUTE_SPEED) 0), m_routeTries(0), m_lastFailedLinkFrom(0), m_lastFailedLinkTo(0), m_lastnonce(0)
 {
@@ -544,7 +544,7 @@ void Node::AdvanceQueries()
 				}
 				else
 				{
-					m_queryStage = QueryStage_Associations;
+					m_queryStage = GetStageAfterCacheLoad();
 					m_queryRetries = 0;
 				}
 				break;
@@ -658,7 +658,7 @@ void Node::AdvanceQueries()
 					cc->SendPending();
 				}
 				// Check whether all nodes are now complete
-				GetDriver()->CheckCompletedNodeQueries();
+				GetDriver()->CheckCompletedNodeQueries(m_nodeId);
 				return;
 			}
 			default:
@@ -697,6 +697,10 @@ void Node::QueryStageComplete(QueryStage const _stage)
 		{
 			m_queryStage = (QueryStage) ((uint32) m_queryStage + 1);
 		}
+		else if (_stage == QueryStage_CacheLoad)
+		{
+			m_queryStage = GetStageAfterCacheLoad();
+		}
 		m_queryRetries = 0;
 	}
 }
@@ -992,6 +996,14 @@ void Node::ReadXML(TiXmlElement const* _node)
 	if (str)
 		m_refreshonNodeInfoFrame = !strcmp(str, "true");
 
+	m_hasCacheFingerprint = false;
+	str = _node->Attribute("fingerprint");
+	if (str)
+	{
+		m_cacheFingerprint = (uint32) strtoul(str, NULL, 16);
+		m_hasCacheFingerprint = true;
+	}
+
 	/* this is the revision of the config file that was present when we created the cache */
 	str = _node->Attribute("configrevision");
 	if (str)
@@ -1302,6 +1314,20 @@ void Node::WriteXML(TiXmlElement* _driverElement)
 
 	nodeElement->SetAttribute("query_stage", c_queryStageNames[m_queryStage]);
 
+	/* Only vouch for the cached session values once they have been queried.  Until then keep
+	 * the fingerprint they were last queried under, so a journal record written part way through
+	 * the queries does not lose it */
+	if (m_queryStage > QueryStage_Session)
+	{
+		m_cacheFingerprint = GetConfigFingerprint();
+		m_hasCacheFingerprint = true;
+	}
+	if (m_hasCacheFingerprint)
+	{
+		snprintf(str, 32, "%.8x", m_cacheFingerprint);
+		nodeElement->SetAttribute("fingerprint", str);
+	}
+
 	TiXmlElement* neighborElement = new TiXmlElement("Neighbors");
 	nodeElement->LinkEndChild(neighborElement);
 	{
@@ -1369,6 +1395,67 @@ void Node::WriteXML(TiXmlElement* _driverElement)
 	}
 }
 
+//-----------------------------------------------------------------------------
+// <Node::GetConfigFingerprint>
+// Hash what the cached state of the node depends on
+//-----------------------------------------------------------------------------
+uint32 Node::GetConfigFingerprint() const
+{
+	uint32 revision = m_Product ? m_Product->GetConfigRevision() : m_loadedConfigRevision;
+	vector<uint8> bytes;
+	bytes.push_back((uint8) (m_manufacturerId >> 8));
+	bytes.push_back((uint8) (m_manufacturerId & 0xff));
+	bytes.push_back((uint8) (m_productType >> 8));
+	bytes.push_back((uint8) (m_productType & 0xff));
+	bytes.push_back((uint8) (m_productId >> 8));
+	bytes.push_back((uint8) (m_productId & 0xff));
+	for (int shift = 24; shift >= 0; shift -= 8)
+	{
+		bytes.push_back((uint8) (revision >> shift));
+	}
+	for (map<uint8, Internal::CC::CommandClass*>::const_iterator it = m_commandClassMap.begin(); it != m_commandClassMap.end(); ++it)
+	{
+		if (it->first == Internal::CC::NoOperation::StaticGetCommandClassId()) // not saved in the cache
+		{
+			continue;
+		}
+		bytes.push_back(it->first);
+		bytes.push_back(it->second->GetVersion());
+	}
+
+	// FNV-1a
+	uint32 hash = 0x811c9dc5;
+	for (vector<uint8>::const_iterator it = bytes.begin(); it != bytes.end(); ++it)
+	{
+		hash ^= *it;
+		hash *= 0x01000193;
+	}
+	return hash;
+}
+
+//-----------------------------------------------------------------------------
+// <Node::GetStageAfterCacheLoad>
+// Decide how much of a node loaded from the cache to query again
+//-----------------------------------------------------------------------------
+Node::QueryStage Node::GetStageAfterCacheLoad() const
+{
+	if (!m_hasCacheFingerprint)
+	{
+		return QueryStage_Associations;
+	}
+
+	uint32 fingerprint = GetConfigFingerprint();
+	if (fingerprint != m_cacheFingerprint)
+	{
+		Log::Write(LogLevel_Info, m_nodeId, "Cache fingerprint %.8x does not match %.8x, refreshing the cached session values", m_cacheFingerprint, fingerprint);
+		return QueryStage_Associations;
+	}
+
+	QueryStage stage = GetDriver()->GetCacheRefreshStage();
+	Log::Write(LogLevel_Info, m_nodeId, "Cache fingerprint %.8x matches, resuming queries at %s", fingerprint, c_queryStageNames[stage]);
+	return stage;
+}
+
 //-----------------------------------------------------------------------------
 // <Node::UpdateProtocolInfo>
 // Handle the FUNC_ID_ZW_GET_NODE_PROTOCOL_INFO response
@@ -1596,7 +1683,7 @@ void Node::SetInstanceLabel(uint8 const _instance, char *label)
 	m_globalInstanceLabel[_instance] = string(label);
 	Driver *driver = GetDriver();
 	if (driver)
-		driver->WriteCache();
+		driver->WriteCache(m_nodeId);
 }
 
 string Node::GetInstanceLabel(uint8 const _ccid, uint8 const _instance)
@@ -1959,7 +2046,7 @@ void Node::SetNodeAlive(bool const _isAlive)
 		if (m_queryStage != Node::QueryStage_Complete)
 		{
 			// Check whether all nodes are now complete
-			GetDriver()->CheckCompletedNodeQueries();
+			GetDriver()->CheckCompletedNodeQueries(m_nodeId);
 		}
 		notification = new Notification(Notification::Type_Notification);
 		notification->SetHomeAndNodeIds(m_homeId, m_nodeId);
@@ -2049,9 +2136,7 @@ void Node::ApplicationCommandHandler(uint8 const* _data, bool encrypted
 		if (pCommandClass->IsSecured() && !encrypted)
 		{
 			Log::Write(LogLevel_Warning, m_nodeId, "Received a Clear Text Message for the CommandClass %s which is Secured", pCommandClass->GetCommandClassName().c_str());
-			bool drop = true;
-			Options::Get()->GetOptionAsBool("EnforceSecureReception", &drop);
-			if (drop)
+			if (Options::Get()->GetSnapshot().m_enforceSecureReception)
 			{
 				Log::Write(LogLevel_Warning, m_nodeId, "   Dropping Message");
 				return;
@@ -2759,8 +2844,21 @@ void Node::ReadValueFromXML(uint8 const _commandClassId, TiXmlElement const* _va
 //-----------------------------------------------------------------------------
 Internal::VC::Value* Node::GetValue(ValueID const& _id)
 {
-	// This increments the value's reference count
-	Internal::VC::Value *value = GetValueStore()->GetValue(_id.GetValueStoreKey());
+	Internal::VC::Value *value = BorrowValue(_id);
+	if (value)
+	{
+		value->AddRef();
+	}
+	return value;
+}
+
+//-----------------------------------------------------------------------------
+// <Node::BorrowValue>
+// Get the value object with the specified ID, without adding a reference
+//-----------------------------------------------------------------------------
+Internal::VC::Value* Node::BorrowValue(ValueID const& _id)
+{
+	Internal::VC::Value *value = GetValueStore()->BorrowValue(_id.GetValueStoreKey());
 	
 	if (!value) {
 		Log::Write(LogLevel_Warning, m_nodeId, "Node::GetValue - Couldn't find ValueID in Store: %s", _id.GetAsString().c_str());
@@ -2771,8 +2869,6 @@ Internal::VC::Value* Node::GetValue(ValueID const& _id)
 	{
 		Log::Write(LogLevel_Error, m_nodeId, "Node::GetValue called with: %s but GetValueStore returned: %s",
 				   _id.GetAsString().c_str(), value->GetID().GetAsString().c_str());
-
-		value->Release();
 		return nullptr;
 	}
 	return value;
@@ -37,6 +37,7 @@
 #include "value_classes/ValueList.h"
 #include "Msg.h"
 #include "platform/TimeStamp.h"
+#include "LatencyHistogram.h"
 #include "Group.h"
 
 class TiXmlElement;
@@ -553,12 +554,26 @@ namespace OpenZWave
 			void ReadDeviceProtocolXML(TiXmlElement const* _ccsElement);
 			void ReadCommandClassesXML(TiXmlElement const* _ccsElement);
 			void WriteXML(TiXmlElement* _nodeElement);
+			/**
+			 * A hash of what the cached state of the node depends on: its manufacturer, product
+			 * type and product ID, the revision of its device config file, and the version of
+			 * each of its command classes.
+			 */
+			uint32 GetConfigFingerprint() const;
+			/**
+			 * The stage to go on to once a node loaded from the cache answers.  If the fingerprint
+			 * saved with it still matches, its cached session values are trusted and the CacheRefresh
+			 * option decides what is queried again.  Otherwise everything from the associations on is.
+			 */
+			QueryStage GetStageAfterCacheLoad() const;
 
 			map<uint8, Internal::CC::CommandClass*> m_commandClassMap; /**< Map of command class ids and pointers to associated command class objects */
 			bool m_secured; /**< Is this Node added Securely */
 			map<uint8, string> m_globalInstanceLabel; /** < The Global Labels for Instances for CC that dont define their own labels */
 
 			TiXmlNode *m_nodeCache;
+			uint32 m_cacheFingerprint; /**< The fingerprint the session values were last queried under, loaded from the cache or taken once they were queried */
+			bool m_hasCacheFingerprint; /**< Whether m_cacheFingerprint is known, which it only is once the session values were queried */
 			//-----------------------------------------------------------------------------
 			// Configuration Revision Related Classes
 			//-----------------------------------------------------------------------------
@@ -644,6 +659,7 @@ namespace OpenZWave
 
 			Internal::VC::Value* GetValue(ValueID const& _id);
 			Internal::VC::Value* GetValue(uint8 const _commandClassId, uint8 const _instance, uint16 const _valueIndex);
+			Internal::VC::Value* BorrowValue(ValueID const& _id);		// GetValue without adding a reference.  Call with the Driver's m_nodeMutex held.
 			bool RemoveValue(uint8 const _commandClassId, uint8 const _instance, uint16 const _valueIndex);
 
 			// Helpers for creating values
@@ -830,6 +846,8 @@ namespace OpenZWave
 			uint32 m_lastResponseRTT;			// Last message response RTT
 			Internal::Platform::TimeStamp m_sentTS;					// Last message sent time
 			Internal::Platform::TimeStamp m_receivedTS;				// Last message received time
+			std::chrono::steady_clock::time_point m_sentTime;		// Last message sent time, to the microsecond
+			Internal::LatencyHistogram m_reportLatency;			// Time from sending a request to the report that answers it
 			uint32 m_averageRequestRTT;			// Average Request round trip time.
 			uint32 m_averageResponseRTT;		// Average Response round trip time.
 			uint8 m_quality;					// Node quality measure
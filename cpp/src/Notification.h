@@ -52,6 +52,7 @@ namespace OpenZWave
 			class ValueStore;
 		}
 		class ManufacturerSpecificDB;
+		class NotificationDispatcher;
 	}
 	/** \brief Provides a container for data sent via the notification callback
 	 *    handler installed by a call to Manager::AddWatcher.
@@ -74,6 +75,7 @@ namespace OpenZWave
 			friend class Internal::CC::WakeUp;
 			friend class Internal::CC::ApplicationStatus;
 			friend class Internal::ManufacturerSpecificDB;
+			friend class Internal::NotificationDispatcher;
 			/* allow us to Stream a Notification */
 			//friend std::ostream &operator<<(std::ostream &os, const Notification &dt);
 
@@ -0,0 +1,306 @@
+//-----------------------------------------------------------------------------
+//
+//	NotificationDispatcher.cpp
+//
+//	Delivers notifications to the watchers on a thread of their own
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include "NotificationDispatcher.h"
+#include "Manager.h"
+#include "Notification.h"
+#include "platform/Event.h"
+#include "platform/Log.h"
+#include "platform/WaitSet.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::NotificationDispatcher>
+// Constructor
+//-----------------------------------------------------------------------------
+		NotificationDispatcher::NotificationDispatcher(uint32 _size, Backpressure _backpressure, Platform::Event* _wakeEvent) :
+				m_mask(0), m_backpressure(_backpressure), m_wakeEvent(_wakeEvent), m_queueEvent(new Platform::Event()), m_spaceEvent(new Platform::Event()), m_heldBack(false), m_pending(0), m_maxDepth(0), m_dropped(0), m_coalesced(0), m_head(0), m_producerWaiting(false), m_tail(0), m_consumerIdle(false)
+		{
+			uint32 size = 1;
+			while (size < _size)
+			{
+				size <<= 1;
+			}
+			m_ring.resize(size, NULL);
+			m_mask = size - 1;
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::~NotificationDispatcher>
+// Destructor
+//-----------------------------------------------------------------------------
+		NotificationDispatcher::~NotificationDispatcher()
+		{
+			for (uint32 tail = m_tail; tail != m_head; ++tail)
+			{
+				delete m_ring[tail & m_mask];
+			}
+			for (list<Notification*>::iterator it = m_overflow.begin(); it != m_overflow.end(); ++it)
+			{
+				delete *it;
+			}
+			m_spaceEvent->Release();
+			m_queueEvent->Release();
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::DispatcherThreadEntryPoint>
+// Main entry point for the dispatcher thread
+//-----------------------------------------------------------------------------
+		void NotificationDispatcher::DispatcherThreadEntryPoint(Platform::Event* _exitEvent, void* _context)
+		{
+			NotificationDispatcher* dispatcher = (NotificationDispatcher*) _context;
+			if (dispatcher)
+			{
+				dispatcher->DispatcherThreadProc(_exitEvent);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::DispatcherThreadProc>
+// Deliver queued notifications until told to exit
+//-----------------------------------------------------------------------------
+		void NotificationDispatcher::DispatcherThreadProc(Platform::Event* _exitEvent)
+		{
+			Log::Write(LogLevel_Info, "Notification: dispatcher thread starting");
+			m_threadId = std::this_thread::get_id();
+
+			Platform::Wait* waitObjects[2];
+			waitObjects[0] = _exitEvent;
+			waitObjects[1] = m_queueEvent;
+			Platform::WaitSet waitSet(waitObjects, 2);
+
+			while (true)
+			{
+				uint32 tail = m_tail.load(std::memory_order_relaxed);
+				if (tail == m_head.load(std::memory_order_acquire))
+				{
+					// Tell the producer to wake us, then make sure nothing slipped in before it could see that
+					m_queueEvent->Reset();
+					m_consumerIdle = true;
+					if (tail == m_head.load())
+					{
+						if (waitSet.Select(2) == 0)
+						{
+							// Exit has been signalled
+							return;
+						}
+					}
+					m_consumerIdle = false;
+					continue;
+				}
+
+				Notification* notification = m_ring[tail & m_mask];
+				m_tail.store(tail + 1, std::memory_order_release);
+				if (m_heldBack.load(std::memory_order_relaxed))
+				{
+					// There is room now for the notifications the producer held back
+					m_wakeEvent->Set();
+				}
+
+				if (Log::IsEnabled(LogLevel_Detail))
+				{
+					Log::Write(LogLevel_Detail, notification->GetNodeId(), "Notification: %s", notification->GetAsString().c_str());
+				}
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				Manager::Get()->NotifyWatchers(notification);
+				m_deliveryTime.RecordSince(start);
+				delete notification;
+
+				--m_pending;
+				if (m_producerWaiting.exchange(false))
+				{
+					m_spaceEvent->Set();
+				}
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::Push>
+// Add a notification to the ring, if there is room for it
+//-----------------------------------------------------------------------------
+		bool NotificationDispatcher::Push(Notification* _notification)
+		{
+			uint32 head = m_head.load(std::memory_order_relaxed);
+			if ((head - m_tail.load(std::memory_order_acquire)) > m_mask)
+			{
+				return false;
+			}
+			m_ring[head & m_mask] = _notification;
+			m_head.store(head + 1, std::memory_order_release);
+			if (m_consumerIdle.exchange(false))
+			{
+				m_queueEvent->Set();
+			}
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::Queued>
+// Record the queue depth once a notification is waiting for delivery
+//-----------------------------------------------------------------------------
+		void NotificationDispatcher::Queued()
+		{
+			uint32 depth = m_pending.load(std::memory_order_relaxed);
+			if (depth > m_maxDepth.load(std::memory_order_relaxed))
+			{
+				m_maxDepth.store(depth, std::memory_order_relaxed);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::Enqueue>
+// Queue a notification for the dispatcher thread
+//-----------------------------------------------------------------------------
+		void NotificationDispatcher::Enqueue(Notification* _notification)
+		{
+			if (!m_overflow.empty())
+			{
+				// Keep the order: nothing overtakes what has been held back
+				Pump();
+				if (!m_overflow.empty())
+				{
+					HoldBack(_notification);
+					return;
+				}
+			}
+
+			// Counted before it is pushed, so the dispatcher thread never sees it uncounted
+			++m_pending;
+			if (Push(_notification))
+			{
+				Queued();
+				return;
+			}
+
+			switch (m_backpressure)
+			{
+				case Backpressure_Block:
+				{
+					while (true)
+					{
+						m_spaceEvent->Reset();
+						m_producerWaiting = true;
+						if (Push(_notification))
+						{
+							break;
+						}
+						Platform::Wait::Single(m_spaceEvent);
+					}
+					m_producerWaiting = false;
+					Queued();
+					break;
+				}
+				case Backpressure_Drop:
+				{
+					--m_pending;
+					++m_dropped;
+					Log::Write(LogLevel_Warning, _notification->GetNodeId(), "Notification queue is full, dropping %s", _notification->GetAsString().c_str());
+					delete _notification;
+					break;
+				}
+				case Backpressure_Coalesce:
+				{
+					--m_pending;
+					HoldBack(_notification);
+					break;
+				}
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::HoldBack>
+// Keep a notification until there is room in the ring.  A value notification
+// does not carry the value, so a repeat of one already held back adds nothing.
+//-----------------------------------------------------------------------------
+		void NotificationDispatcher::HoldBack(Notification* _notification)
+		{
+			Notification::NotificationType type = _notification->GetType();
+			if ((type == Notification::Type_ValueChanged) || (type == Notification::Type_ValueRefreshed))
+			{
+				if (!m_overflowKeys.insert(std::make_pair((uint8) type, _notification->GetValueID().GetId())).second)
+				{
+					++m_coalesced;
+					delete _notification;
+					return;
+				}
+			}
+
+			++m_pending;
+			Queued();
+			m_overflow.push_back(_notification);
+			m_heldBack = true;
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::Pump>
+// Move held back notifications into the ring
+//-----------------------------------------------------------------------------
+		void NotificationDispatcher::Pump()
+		{
+			while (!m_overflow.empty())
+			{
+				Notification* notification = m_overflow.front();
+				if (!Push(notification))
+				{
+					return;
+				}
+				m_overflow.pop_front();
+				m_overflowKeys.erase(std::make_pair((uint8) notification->GetType(), notification->GetValueID().GetId()));
+			}
+			m_heldBack = false;
+		}
+
+//-----------------------------------------------------------------------------
+// <NotificationDispatcher::Flush>
+// Wait for the dispatcher thread to deliver everything queued so far
+//-----------------------------------------------------------------------------
+		void NotificationDispatcher::Flush()
+		{
+			if (std::this_thread::get_id() == m_threadId)
+			{
+				// Called by a watcher.  Waiting for ourselves would never end.
+				return;
+			}
+
+			while (true)
+			{
+				Pump();
+				m_spaceEvent->Reset();
+				m_producerWaiting = true;
+				if (!m_pending)
+				{
+					break;
+				}
+				Platform::Wait::Single(m_spaceEvent);
+			}
+			m_producerWaiting = false;
+		}
+	} // namespace Internal
+} // namespace OpenZWave
@@ -0,0 +1,183 @@
+//-----------------------------------------------------------------------------
+//
+//	NotificationDispatcher.h
+//
+//	Delivers notifications to the watchers on a thread of their own
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _NotificationDispatcher_H
+#define _NotificationDispatcher_H
+
+#include <atomic>
+#include <list>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "Defs.h"
+#include "LatencyHistogram.h"
+
+namespace OpenZWave
+{
+	class Notification;
+	namespace Internal
+	{
+		namespace Platform
+		{
+			class Event;
+		}
+
+		/** \brief Hands a driver's notifications to the watchers from a dedicated thread,
+		 *  so that a slow watcher cannot hold up the driver thread.
+		 *
+		 *  Used when the "AsyncNotifications" option is set.  The driver thread is the only
+		 *  producer, and the dispatcher thread the only consumer, of a bounded ring of
+		 *  "NotificationQueueSize" entries, so the ring needs no lock.  Notifications are
+		 *  delivered in the order they were queued.  What happens when the watchers fall
+		 *  so far behind that the ring fills up is set by the "NotificationBackpressure"
+		 *  option.  See Backpressure.
+		 */
+		class NotificationDispatcher
+		{
+			public:
+				/** What the driver thread does with a notification that finds the ring full. */
+				enum Backpressure
+				{
+					Backpressure_Block = 0, /**< Wait until the dispatcher has made room. Nothing is lost. */
+					Backpressure_Drop, /**< Discard the notification */
+					Backpressure_Coalesce /**< Hold it back until there is room, discarding repeats of a value notification already held back */
+				};
+
+				/**
+				 * Constructor.
+				 * \param _size the number of notifications the ring holds.  It is rounded up to a power of two.
+				 * \param _backpressure what to do when the ring is full.
+				 * \param _wakeEvent event that wakes the producer, so it calls Pump once there is room for
+				 * notifications held back by Backpressure_Coalesce.
+				 */
+				NotificationDispatcher(uint32 _size, Backpressure _backpressure, Platform::Event* _wakeEvent);
+
+				/**
+				 * Destructor.  Any notifications that were not delivered are discarded.
+				 */
+				~NotificationDispatcher();
+
+				/**
+				 * Main entry point for the dispatcher thread. Wrapper around DispatcherThreadProc.
+				 * \param _exitEvent Exit event indicating the thread should exit
+				 * \param _context A NotificationDispatcher object
+				 */
+				static void DispatcherThreadEntryPoint(Platform::Event* _exitEvent, void* _context);
+
+				/**
+				 * Queue a notification for delivery, and take ownership of it.  Producer only.
+				 */
+				void Enqueue(Notification* _notification);
+
+				/**
+				 * Move notifications held back by Backpressure_Coalesce into the ring, as far as
+				 * there is room.  Producer only.
+				 */
+				void Pump();
+
+				/**
+				 * Wait until every notification queued so far has been delivered.  Producer only.
+				 * Does nothing when called from a watcher, on the dispatcher thread itself.
+				 */
+				void Flush();
+
+				/** Notifications queued, or held back, and not yet delivered */
+				uint32 GetDepth() const
+				{
+					return m_pending.load(std::memory_order_relaxed);
+				}
+				/** The largest GetDepth has been */
+				uint32 GetMaxDepth() const
+				{
+					return m_maxDepth.load(std::memory_order_relaxed);
+				}
+				/** Notifications discarded by Backpressure_Drop */
+				uint32 GetDropped() const
+				{
+					return m_dropped.load(std::memory_order_relaxed);
+				}
+				/** Notifications discarded by Backpressure_Coalesce */
+				uint32 GetCoalesced() const
+				{
+					return m_coalesced.load(std::memory_order_relaxed);
+				}
+				/** The time the watchers took over each notification delivered */
+				void GetDeliveryTime(LatencyHistogramData* _data) const
+				{
+					m_deliveryTime.GetData(_data);
+				}
+
+			private:
+				NotificationDispatcher(NotificationDispatcher const&);					// prevent copy
+				NotificationDispatcher& operator =(NotificationDispatcher const&);		// prevent assignment
+
+				/**
+				 * Main class entry point for the dispatcher thread.  Delivers notifications until told to exit.
+				 * \param _exitEvent Exit event indicating the thread should exit
+				 */
+				void DispatcherThreadProc(Platform::Event* _exitEvent);
+
+				bool Push(Notification* _notification);
+				void Queued();
+				void HoldBack(Notification* _notification);
+
+				enum
+				{
+					CacheLineSize = 64
+				};
+
+				std::vector<Notification*> m_ring;
+				uint32 m_mask;
+				Backpressure m_backpressure;
+				Platform::Event* m_wakeEvent;
+				Platform::Event* m_queueEvent;					// Set when the ring goes from empty to not empty
+				Platform::Event* m_spaceEvent;					// Set when a notification is delivered while the producer waits
+				std::thread::id m_threadId;
+
+				// Notifications held back by Backpressure_Coalesce.  Producer only, apart from m_heldBack.
+				list<Notification*> m_overflow;
+				std::set<std::pair<uint8, uint64> > m_overflowKeys;
+				std::atomic<bool> m_heldBack;
+
+				std::atomic<uint32> m_pending;
+				std::atomic<uint32> m_maxDepth;
+				std::atomic<uint32> m_dropped;
+				std::atomic<uint32> m_coalesced;
+				LatencyHistogram m_deliveryTime;
+
+				// The indices run freely and are masked on use, so head - tail is the number queued
+				uint8 m_pad1[CacheLineSize];
+				std::atomic<uint32> m_head;						// Only written by the producer
+				std::atomic<bool> m_producerWaiting;
+				uint8 m_pad2[CacheLineSize];
+				std::atomic<uint32> m_tail;						// Only written by the consumer
+				std::atomic<bool> m_consumerIdle;
+				uint8 m_pad3[CacheLineSize];
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _NotificationDispatcher_H
@@ -105,6 +105,7 @@ Options* Options::Create(string const& _configPath, string const& _userPath, str
 		s_instance->AddOptionInt("SaveLogLevel", LogLevel_Detail);			// Save (to file) log messages equal to or above LogLevel_Detail
 		s_instance->AddOptionInt("QueueLogLevel", LogLevel_Debug);			// Save (in RAM) log messages equal to or above LogLevel_Debug
 		s_instance->AddOptionInt("DumpTriggerLevel", LogLevel_None);			// Default is to never dump RAM-stored log messages
+		s_instance->AddOptionBool("AsyncLogging", false);					// Write log messages from a thread of their own (Unix only). Messages still in flight are lost if the process crashes
 
 		s_instance->AddOptionBool("Associate", true);						// Enable automatic association of the controller with group one of every device.
 		s_instance->AddOptionString("Exclude", string(""), true);		// Remove support for the listed command classes.
@@ -112,11 +113,21 @@ Options* Options::Create(string const& _configPath, string const& _userPath, str
 		s_instance->AddOptionBool("NotifyTransactions", false);					// Notifications when transaction complete is reported.
 		s_instance->AddOptionString("Interface", string(""), true);		// Identify the serial port to be accessed (TODO: change the code so more than one serial port can be specified and HID)
 		s_instance->AddOptionBool("SaveConfiguration", true);						// Save the XML configuration upon driver close.
+		s_instance->AddOptionBool("CacheJournal", true);						// Journal individual node changes rather than rewriting the whole cache each time
+		s_instance->AddOptionInt("CacheJournalCompact", 64);					// Number of journal records after which the cache is rewritten on the timer thread
+		s_instance->AddOptionString("CacheFormat", "xml", false);				// Format of the cache snapshot: "xml" (ozwcache_0x<homeid>.xml) or "binary" (memory mapped ozwcache_0x<homeid>.bin)
+		s_instance->AddOptionString("CacheRefresh", "DYNAMIC", false);			// What a node loaded from the cache queries again while its fingerprint matches: "ALL" (associations, neighbors, session and dynamic values), "DYNAMIC" or "NONE"
 		s_instance->AddOptionInt("DriverMaxAttempts", 0);
 
 		s_instance->AddOptionInt("PollInterval", 30000);						// 30 seconds (can easily poll 30 values in this time; ~120 values is the effective limit for 30 seconds)
 		s_instance->AddOptionBool("IntervalBetweenPolls", false);					// if false, try to execute the entire poll list within the PollInterval time frame
 																					// if true, wait for PollInterval milliseconds between polls
+		s_instance->AddOptionInt("PollBackoff", 1);							// Largest factor by which a value's poll interval grows while polls find it unchanged (1 turns this off)
+		s_instance->AddOptionString("MessageScheduler", "PRIORITY", false);			// Order in which queued messages are sent: "PRIORITY" strictly by queue, or "FAIR" with deadlines and turns shared between Query and Poll
+		s_instance->AddOptionInt("SendDeadline", 500);						// Milliseconds after which a message setting a value goes ahead of the other queues (MessageScheduler FAIR)
+		s_instance->AddOptionInt("PollShare", 20);							// Percentage of the turns the poll queue gets while nodes are being queried (MessageScheduler FAIR)
+		s_instance->AddOptionBool("MultiCmdBatching", false);				// Send queued wake-up and query commands for a node that supports MultiCmd in shared frames
+		s_instance->AddOptionInt("InterviewPipeline", 1);					// Number of listening nodes whose reports to queries may be awaited at once (1 queries one node at a time) (MessageScheduler FAIR)
 		s_instance->AddOptionBool("SuppressValueRefresh", false);					// if true, notifications for refreshed (but unchanged) values will not be sent
 		s_instance->AddOptionBool("PerformReturnRoutes", false);					// if true, return routes will be updated
 		s_instance->AddOptionString("NetworkKey", string(""), false);
@@ -129,9 +140,16 @@ Options* Options::Create(string const& _configPath, string const& _userPath, str
 		s_instance->AddOptionString("CustomSecuredCC", "0x62,0x4c,0x63", false);	// What List of Custom CC should we always encrypt if SecurityStrategy is CUSTOM
 		s_instance->AddOptionBool("EnforceSecureReception", true);						// if we recieve a clear text message for a CC that is Secured, should we drop the message
 		s_instance->AddOptionBool("AutoUpdateConfigFile", true);						// if we should automatically update config files for devices if they are out of date
+		s_instance->AddOptionBool("DeviceDatabase", true);						// Use the precompiled device database (device_database.bin in the config folder) if it is present and up to date
 		s_instance->AddOptionString("ReloadAfterUpdate", "AWAKE", false);			// Should we automatically Reload Nodes after a update
 		s_instance->AddOptionString("Language", "", false);			// Language we should use
 		s_instance->AddOptionBool("IncludeInstanceLabel", true);						// Should we include the Instance Label in Value Labels on MultiInstance Devices
+		s_instance->AddOptionInt("NotificationCoalesceWindow", 0);					// Hold ValueChanged/ValueRefreshed notifications for this many ms, merging repeats for the same value into them (0 = off)
+		s_instance->AddOptionBool("AsyncNotifications", false);						// Deliver notifications to the watchers from a thread of their own, so a slow watcher cannot hold up the driver thread
+		s_instance->AddOptionInt("NotificationQueueSize", 1024);					// Number of notifications that can wait for the notification thread (AsyncNotifications)
+		s_instance->AddOptionString("NotificationBackpressure", "BLOCK", false);		// What to do with a notification when that queue is full: "BLOCK" until there is room, "DROP" it, or "COALESCE" repeated value notifications until there is room
+		s_instance->AddOptionString("MetricsExport", "", false);				// Where to write the statistics and latency histograms in the Prometheus text format: "file:<path>" or "unix:<path>" (empty = off)
+		s_instance->AddOptionInt("MetricsExportInterval", 15000);				// Milliseconds between writes of the metrics (MetricsExport)
 #if defined WINRT
 				s_instance->AddOptionInt( "ThreadTerminateTimeout", -1);						// Since threads cannot be terminated in WinRT, Thread::Terminate will simply wait for them to exit on there own
 #endif
@@ -345,6 +363,14 @@ bool Options::Lock()
 	ParseOptionsString(m_commandLine);
 	m_locked = true;
 
+	// Taken from the registered options, so their defaults are set in one place
+	GetOptionAsBool("EnforceSecureReception", &m_snapshot.m_enforceSecureReception);
+	GetOptionAsBool("SuppressValueRefresh", &m_snapshot.m_suppressValueRefresh);
+	GetOptionAsBool("IncludeInstanceLabel", &m_snapshot.m_includeInstanceLabel);
+	GetOptionAsBool("RefreshAllUserCodes", &m_snapshot.m_refreshAllUserCodes);
+	GetOptionAsInt("RetryTimeout", &m_snapshot.m_retryTimeout);
+	GetOptionAsInt("DriverMaxAttempts", &m_snapshot.m_driverMaxAttempts);
+
 	/* Log our Configured Options */
 	map<string, Option*>::iterator it;
 	Log::Write(LogLevel_Info, "Options:");
@@ -370,6 +396,15 @@ bool Options::Lock()
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// <Options::Snapshot::Snapshot>
+// Constructor.  The values are only known once Lock has read the options.
+//-----------------------------------------------------------------------------
+Options::Snapshot::Snapshot() :
+		m_enforceSecureReception(false), m_suppressValueRefresh(false), m_includeInstanceLabel(false), m_refreshAllUserCodes(false), m_retryTimeout(0), m_driverMaxAttempts(0)
+{
+}
+
 //-----------------------------------------------------------------------------
 // <Options::ParseOptionsString>
 // Parse a string containing program options, such as a command line
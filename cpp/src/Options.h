@@ -206,6 +206,34 @@ namespace OpenZWave
 			 */
 			OptionType GetOptionType(string const& _name);
 
+			/** \brief The options read on hot paths, taken once when the options are locked.
+			 *
+			 *  Reading a field needs no lookup by name.  Options cannot change once they are locked,
+			 *  so neither does the snapshot.  It is filled in from the options by Lock, and until
+			 *  then its fields are all false or 0.
+			 */
+			struct Snapshot
+			{
+					Snapshot();
+
+					bool m_enforceSecureReception;		// EnforceSecureReception
+					bool m_suppressValueRefresh;		// SuppressValueRefresh
+					bool m_includeInstanceLabel;		// IncludeInstanceLabel
+					bool m_refreshAllUserCodes;			// RefreshAllUserCodes
+					int32 m_retryTimeout;				// RetryTimeout
+					int32 m_driverMaxAttempts;			// DriverMaxAttempts
+			};
+
+			/**
+			 * Get the options read on hot paths.
+			 * \return the snapshot taken when the options were locked.
+			 * \see Lock, Snapshot
+			 */
+			Snapshot const& GetSnapshot() const
+			{
+				return m_snapshot;
+			}
+
 			/**
 			 * Test whether the options have been locked.
 			 * \return true if the options have been locked.
@@ -250,6 +278,7 @@ namespace OpenZWave
 			string m_SystemPath;
 			string m_LocalPath;
 			bool m_locked;										// If true, the options are final and AddOption can no longer be called.
+			Snapshot m_snapshot;								// Taken when the options are locked
 			static Options* s_instance;
 	};
 } // namespace OpenZWave
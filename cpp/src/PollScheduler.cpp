@@ -0,0 +1,262 @@
+//-----------------------------------------------------------------------------
+//
+//	PollScheduler.cpp
+//
+//	Decides when each polled value is next polled
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <functional>
+
+#include "PollScheduler.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+//-----------------------------------------------------------------------------
+// <PollScheduler::PollScheduler>
+// Constructor
+//-----------------------------------------------------------------------------
+		PollScheduler::PollScheduler(uint32 _maxBackoff) :
+				m_defaultInterval(0), m_maxBackoff(_maxBackoff ? _maxBackoff : 1), m_generation(0), m_deferred(0), m_backedOff(0)
+		{
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::Add>
+// Start polling a value
+//-----------------------------------------------------------------------------
+		bool PollScheduler::Add(ValueID const& _id, uint8 _intensity, int32 _interval, Clock::time_point _now)
+		{
+			if (Contains(_id))
+			{
+				return false;
+			}
+
+			Entry& entry = m_entries[_id.GetId()];
+			entry.m_id = _id;
+			entry.m_interval = _interval;
+			entry.m_intensity = _intensity;
+			entry.m_polled = false;
+			entry.m_backoff = 1;
+			Schedule(entry, _now + GetInterval(entry));
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::Remove>
+// Stop polling a value.  Its node in the heap goes once it reaches the top.
+//-----------------------------------------------------------------------------
+		bool PollScheduler::Remove(ValueID const& _id)
+		{
+			if (!m_entries.erase(_id.GetId()))
+			{
+				return false;
+			}
+			if (m_entries.empty())
+			{
+				m_heap.clear();
+			}
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::SetIntensity>
+// Change the poll intensity of a value
+//-----------------------------------------------------------------------------
+		void PollScheduler::SetIntensity(ValueID const& _id, uint8 _intensity)
+		{
+			std::map<uint64, Entry>::iterator it = m_entries.find(_id.GetId());
+			if (it != m_entries.end())
+			{
+				it->second.m_intensity = _intensity;
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::SetInterval>
+// Change the interval of a value
+//-----------------------------------------------------------------------------
+		void PollScheduler::SetInterval(ValueID const& _id, int32 _interval)
+		{
+			std::map<uint64, Entry>::iterator it = m_entries.find(_id.GetId());
+			if (it != m_entries.end())
+			{
+				it->second.m_interval = _interval;
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::Next>
+// Take the value that is next due
+//-----------------------------------------------------------------------------
+		bool PollScheduler::Next(Clock::time_point _now, ValueID* _id, int32* _lag)
+		{
+			DropStale();
+			if (m_heap.empty() || (m_heap.front().m_due > _now))
+			{
+				return false;
+			}
+
+			Entry& entry = m_entries[m_heap.front().m_key];
+			std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<HeapNode>());
+			m_heap.pop_back();
+
+			*_id = entry.m_id;
+			*_lag = (int32) std::chrono::duration_cast<std::chrono::milliseconds>(_now - entry.m_due).count();
+
+			// In case there is no answer, poll it again an interval from now
+			entry.m_polled = true;
+			Schedule(entry, _now + GetInterval(entry));
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::GetNextDue>
+// When the next value is due
+//-----------------------------------------------------------------------------
+		bool PollScheduler::GetNextDue(Clock::time_point* _due)
+		{
+			DropStale();
+			if (m_heap.empty())
+			{
+				return false;
+			}
+			*_due = m_heap.front().m_due;
+			return true;
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::Reported>
+// Reschedule a value that its node has reported
+//-----------------------------------------------------------------------------
+		void PollScheduler::Reported(ValueID const& _id, bool _changed, Clock::time_point _now)
+		{
+			std::map<uint64, Entry>::iterator it = m_entries.find(_id.GetId());
+			if (it == m_entries.end())
+			{
+				return;
+			}
+
+			Entry& entry = it->second;
+			if (entry.m_polled)
+			{
+				// The answer to a poll.  Poll again less often while nothing changes.
+				entry.m_polled = false;
+				if (_changed)
+				{
+					entry.m_backoff = 1;
+				}
+				else if (entry.m_backoff < m_maxBackoff)
+				{
+					entry.m_backoff = std::min(entry.m_backoff * 2, m_maxBackoff);
+					++m_backedOff;
+				}
+				Schedule(entry, _now + GetInterval(entry));
+				return;
+			}
+
+			// Reported without a poll, so a poll any sooner than an interval from now would tell us nothing new
+			if (_changed)
+			{
+				entry.m_backoff = 1;
+			}
+			Clock::time_point due = _now + GetInterval(entry);
+			if (due > entry.m_due)
+			{
+				++m_deferred;
+				Schedule(entry, due);
+			}
+			else if (_changed)
+			{
+				Schedule(entry, due);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::GetInterval>
+// The time between polls of a value, including any backoff
+//-----------------------------------------------------------------------------
+		PollScheduler::Clock::duration PollScheduler::GetInterval(Entry const& _entry) const
+		{
+			int64 interval = _entry.m_interval;
+			if (interval <= 0)
+			{
+				interval = (int64) m_defaultInterval * (_entry.m_intensity ? _entry.m_intensity : 1);
+			}
+			return std::chrono::milliseconds(interval * _entry.m_backoff);
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::Schedule>
+// Put a value in the heap at its new due time, leaving its old node stale
+//-----------------------------------------------------------------------------
+		void PollScheduler::Schedule(Entry& _entry, Clock::time_point _due)
+		{
+			_entry.m_due = _due;
+			// Never reused, so a value that is removed and added again does not match its old nodes
+			_entry.m_generation = ++m_generation;
+
+			if (m_heap.size() > (2 * m_entries.size() + 16))
+			{
+				// Too many stale nodes.  Build the heap again from the live ones.
+				m_heap.clear();
+				for (std::map<uint64, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+				{
+					if (&it->second != &_entry)
+					{
+						HeapNode node = { it->second.m_due, it->first, it->second.m_generation };
+						m_heap.push_back(node);
+					}
+				}
+				std::make_heap(m_heap.begin(), m_heap.end(), std::greater<HeapNode>());
+			}
+
+			HeapNode node = { _due, _entry.m_id.GetId(), _entry.m_generation };
+			m_heap.push_back(node);
+			std::push_heap(m_heap.begin(), m_heap.end(), std::greater<HeapNode>());
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::IsLive>
+// Whether a node in the heap is the value's current place
+//-----------------------------------------------------------------------------
+		bool PollScheduler::IsLive(HeapNode const& _node) const
+		{
+			std::map<uint64, Entry>::const_iterator it = m_entries.find(_node.m_key);
+			return (it != m_entries.end()) && (it->second.m_generation == _node.m_generation);
+		}
+
+//-----------------------------------------------------------------------------
+// <PollScheduler::DropStale>
+// Take the stale nodes off the top of the heap
+//-----------------------------------------------------------------------------
+		void PollScheduler::DropStale()
+		{
+			while (!m_heap.empty() && !IsLive(m_heap.front()))
+			{
+				std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<HeapNode>());
+				m_heap.pop_back();
+			}
+		}
+	} // namespace Internal
+} // namespace OpenZWave
@@ -0,0 +1,184 @@
+//-----------------------------------------------------------------------------
+//
+//	PollScheduler.h
+//
+//	Decides when each polled value is next polled
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _PollScheduler_H
+#define _PollScheduler_H
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "Defs.h"
+#include "value_classes/ValueID.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		/** \brief Keeps the polled values in order of when they are next due.
+		 *
+		 *  Each value has an interval of its own.  That is either set for the value, or is the
+		 *  default interval times the value's poll intensity.  The values are kept in a heap on
+		 *  the time they are next due, so the next one is found without walking them all.
+		 *
+		 *  A value's interval is stretched while polling finds nothing new:
+		 *  - When a poll finds the value unchanged, the interval is doubled, up to the largest
+		 *    backoff factor.  A change brings it straight back down.
+		 *  - When the node reports the value without being polled, the next poll is put off
+		 *    until at least an interval after the report.
+		 *
+		 *  It does no locking of its own.
+		 */
+		class PollScheduler
+		{
+			public:
+				typedef std::chrono::steady_clock Clock;
+
+				/**
+				 * Constructor.
+				 * \param _maxBackoff the largest factor by which a value's interval is stretched.
+				 * 1 turns backing off off.
+				 */
+				PollScheduler(uint32 _maxBackoff = 1);
+
+				/**
+				 * Set the interval for the values that have none of their own.  Such a value is
+				 * polled each _milliseconds times its poll intensity.
+				 */
+				void SetDefaultInterval(int32 _milliseconds)
+				{
+					m_defaultInterval = _milliseconds;
+				}
+
+				/**
+				 * Start polling a value.  It is first due an interval from _now.
+				 * \param _intensity the value's poll intensity.
+				 * \param _interval the value's own interval in milliseconds, or 0 to use the default.
+				 * \return false if the value is already polled.
+				 */
+				bool Add(ValueID const& _id, uint8 _intensity, int32 _interval, Clock::time_point _now);
+
+				/**
+				 * Stop polling a value.
+				 * \return false if the value was not polled.
+				 */
+				bool Remove(ValueID const& _id);
+
+				/** Whether a value is polled */
+				bool Contains(ValueID const& _id) const
+				{
+					return m_entries.find(_id.GetId()) != m_entries.end();
+				}
+
+				/** Change the poll intensity of a value, from its next poll on */
+				void SetIntensity(ValueID const& _id, uint8 _intensity);
+
+				/** Change the interval of a value, or set it to 0 to use the default, from its next poll on */
+				void SetInterval(ValueID const& _id, int32 _interval);
+
+				/** The number of values polled */
+				uint32 GetCount() const
+				{
+					return (uint32) m_entries.size();
+				}
+
+				/**
+				 * Take the value that is next due, if it is due by _now.  It is then due again an
+				 * interval later, or sooner once the node answers the poll.
+				 * \param _id set to the value to poll.
+				 * \param _lag set to the milliseconds by which the poll is late.
+				 * \return false if no value is due.
+				 */
+				bool Next(Clock::time_point _now, ValueID* _id, int32* _lag);
+
+				/**
+				 * When the next value is due.
+				 * \return false if no values are polled.
+				 */
+				bool GetNextDue(Clock::time_point* _due);
+
+				/**
+				 * A polled value has been reported by its node, as the answer to a poll or not.
+				 * \param _changed whether the value changed.
+				 */
+				void Reported(ValueID const& _id, bool _changed, Clock::time_point _now);
+
+				/** The number of polls put off because the node had just reported the value */
+				uint32 GetDeferred() const
+				{
+					return m_deferred;
+				}
+
+				/** The number of times a value's interval has been stretched because a poll found it unchanged */
+				uint32 GetBackedOff() const
+				{
+					return m_backedOff;
+				}
+
+			private:
+				PollScheduler(PollScheduler const&);					// prevent copy
+				PollScheduler& operator =(PollScheduler const&);		// prevent assignment
+
+				struct Entry
+				{
+						ValueID m_id;
+						int32 m_interval;					// Milliseconds, or 0 for the default
+						uint8 m_intensity;
+						bool m_polled;						// A poll has been sent and not yet answered
+						uint32 m_backoff;					// Factor by which the interval is stretched
+						uint32 m_generation;				// Matches the value's live node in the heap
+						Clock::time_point m_due;
+				};
+
+				/** A value's place in the heap.  It is stale once the value has been rescheduled. */
+				struct HeapNode
+				{
+						Clock::time_point m_due;
+						uint64 m_key;
+						uint32 m_generation;
+
+						bool operator >(HeapNode const& _other) const
+						{
+							return m_due > _other.m_due;
+						}
+				};
+
+				Clock::duration GetInterval(Entry const& _entry) const;
+				void Schedule(Entry& _entry, Clock::time_point _due);
+				bool IsLive(HeapNode const& _node) const;
+				void DropStale();
+
+				std::map<uint64, Entry> m_entries;			// Keyed by ValueID::GetId()
+				std::vector<HeapNode> m_heap;				// Earliest due first
+				int32 m_defaultInterval;
+				uint32 m_maxBackoff;
+				uint32 m_generation;						// The last generation given to an entry
+				uint32 m_deferred;
+				uint32 m_backedOff;
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _PollScheduler_H
@@ -54,7 +54,7 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 		TimerThread::TimerThread(Driver *_driver) :
 //m_driver( _driver ),
-				m_timerEvent(new Internal::Platform::Event()), m_timerMutex(new Internal::Platform::Mutex()), m_timerTimeout(Internal::Platform::Wait::Timeout_Infinite)
+				m_timerStart(std::chrono::steady_clock::now()), m_freeEntries(NULL), m_timerEvent(new Internal::Platform::Event()), m_timerMutex(new Internal::Platform::Mutex()), m_timerTimeout(Internal::Platform::Wait::Timeout_Infinite)
 		{
 		}
 
@@ -66,7 +66,7 @@ namespace OpenZWave
 		{
 			{
 				LockGuard LG(m_timerMutex);
-				for (list<TimerEventEntry *>::iterator it = m_timerEventList.begin(); it != m_timerEventList.end(); ++it)
+				for (vector<TimerEventEntry *>::iterator it = m_timerEntries.begin(); it != m_timerEntries.end(); ++it)
 				{
 					delete (*it);
 				}
@@ -107,25 +107,21 @@ namespace OpenZWave
 					// Timeout or new entry to timer list.
 					m_timerTimeout = Internal::Platform::Wait::Timeout_Infinite;
 
-					// Go through all waiting actions, and see if any need to be performed.
+					// Perform the actions that have expired.
 					LockGuard LG(m_timerMutex);
-					list<TimerEventEntry *>::iterator it = m_timerEventList.begin();
-					while (it != m_timerEventList.end())
+					uint64 now = Now();
+					while (TimerEventEntry *te = static_cast<TimerEventEntry *>(m_timerWheel.Expire(now)))
 					{
-						int32 tr = (*it)->timestamp.TimeRemaining();
-						if (tr <= 0)
-						{
-							// Expired so perform action and remove from list.
-							Log::Write(LogLevel_Info, "Timer: delayed event");
-							TimerEventEntry *te = *(it++);
-							te->instance->TimerFireEvent(te);
-						}
-						else
-						{
-							// Time remaining.
-							m_timerTimeout = (m_timerTimeout == Internal::Platform::Wait::Timeout_Infinite) ? tr : std::min(m_timerTimeout, tr);
-							++it;
-						}
+						Log::Write(LogLevel_Info, "Timer: delayed event");
+						te->instance->TimerFireEvent(te);
+					}
+
+					// Wait until the wheel next needs to move on.
+					uint64 next = m_timerWheel.GetNextTick();
+					if (next != TimerWheel::Never)
+					{
+						now = Now();
+						m_timerTimeout = (next <= now) ? 0 : (int32) std::min(next - now, (uint64) 0x7fffffff);
 					}
 					m_timerEvent->Reset();
 				}
@@ -138,14 +134,34 @@ namespace OpenZWave
 		TimerThread::TimerEventEntry* TimerThread::TimerSetEvent(int32 _milliseconds, TimerCallback _callback, Timer *_instance, uint32 id)
 		{
 			Log::Write(LogLevel_Info, "Timer: adding event in %d ms", _milliseconds);
-			TimerEventEntry *te = new TimerEventEntry();
-			te->timestamp.SetTime(_milliseconds);
+			// Don't want driver thread and timer thread accessing list at the same time.
+			LockGuard LG(m_timerMutex);
+			TimerEventEntry *te = m_freeEntries;
+			if (te)
+			{
+				m_freeEntries = static_cast<TimerEventEntry *>(te->m_next);
+				te->m_next = NULL;
+			}
+			else
+			{
+				te = new TimerEventEntry();
+				m_timerEntries.push_back(te);
+			}
+			te->m_expiry = Now() + std::max(_milliseconds, 0);
 			te->callback = _callback;
 			te->instance = _instance;
 			te->id = id;
-			// Don't want driver thread and timer thread accessing list at the same time.
-			LockGuard LG(m_timerMutex);
-			m_timerEventList.push_back(te);
+
+			// The newest event goes at the head of its Timer's list
+			te->instancePrev = NULL;
+			te->instanceNext = _instance->m_timerEvents;
+			if (te->instanceNext)
+			{
+				te->instanceNext->instancePrev = te;
+			}
+			_instance->m_timerEvents = te;
+
+			m_timerWheel.Add(te);
 			m_timerEvent->Set();
 			return te;
 		}
@@ -155,14 +171,12 @@ namespace OpenZWave
 // Delete the Specific Timer
 //-----------------------------------------------------------------------------
 
-		void TimerThread::TimerDelEvent(TimerEventEntry *te)
+		void TimerThread::TimerDelEvent(TimerEventEntry *_te, Timer *_instance)
 		{
 			LockGuard LG(m_timerMutex);
-			list<TimerEventEntry *>::iterator it = find(m_timerEventList.begin(), m_timerEventList.end(), te);
-			if (it != m_timerEventList.end())
+			if (_te->instance == _instance)
 			{
-				delete ((*it));
-				m_timerEventList.erase(it);
+				ReleaseEntry(_te);
 			}
 			else
 			{
@@ -170,12 +184,78 @@ namespace OpenZWave
 			}
 		}
 
+//-----------------------------------------------------------------------------
+// <TimerThread::TimerDelEvent>
+// Delete the Timer with an ID
+//-----------------------------------------------------------------------------
+		bool TimerThread::TimerDelEvent(Timer *_instance, uint32 _id)
+		{
+			LockGuard LG(m_timerMutex);
+			for (TimerEventEntry *te = _instance->m_timerEvents; te != NULL; te = te->instanceNext)
+			{
+				if (te->id == _id)
+				{
+					ReleaseEntry(te);
+					return true;
+				}
+			}
+			return false;
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerThread::TimerDelEvents>
+// Delete all the Timers of an instance
+//-----------------------------------------------------------------------------
+		void TimerThread::TimerDelEvents(Timer *_instance)
+		{
+			LockGuard LG(m_timerMutex);
+			while (_instance->m_timerEvents != NULL)
+			{
+				ReleaseEntry(_instance->m_timerEvents);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerThread::ReleaseEntry>
+// Return an entry to the pool.  The caller holds m_timerMutex.
+//-----------------------------------------------------------------------------
+		void TimerThread::ReleaseEntry(TimerEventEntry *_te)
+		{
+			m_timerWheel.Remove(_te);
+			if (_te->instancePrev)
+			{
+				_te->instancePrev->instanceNext = _te->instanceNext;
+			}
+			else
+			{
+				_te->instance->m_timerEvents = _te->instanceNext;
+			}
+			if (_te->instanceNext)
+			{
+				_te->instanceNext->instancePrev = _te->instancePrev;
+			}
+
+			_te->instance = NULL;
+			_te->callback = TimerCallback();
+			_te->m_next = m_freeEntries;
+			m_freeEntries = _te;
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerThread::Now>
+// Milliseconds since the TimerThread was created
+//-----------------------------------------------------------------------------
+		uint64 TimerThread::Now() const
+		{
+			return (uint64) std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_timerStart).count();
+		}
+
 //-----------------------------------------------------------------------------
 // <Timer::Timer>
 // Constuctor for Timer SubClass with Driver passed in
 //-----------------------------------------------------------------------------
 		Timer::Timer(Driver *_driver) :
-				m_driver(_driver)
+				m_driver(_driver), m_timerEvents(NULL)
 		{
 		}
 		;
@@ -185,7 +265,7 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 
 		Timer::Timer() :
-				m_driver(NULL)
+				m_driver(NULL), m_timerEvents(NULL)
 		{
 
 		}
@@ -211,7 +291,6 @@ namespace OpenZWave
 				TimerThread::TimerEventEntry *te = m_driver->GetTimer()->TimerSetEvent(_milliseconds, _callback, this, id);
 				if (te)
 				{
-					m_timerEventList.push_back(te);
 					return te;
 				}
 				Log::Write(LogLevel_Warning, "Could Not Register Timer Callback");
@@ -232,12 +311,7 @@ namespace OpenZWave
 		{
 			if (m_driver)
 			{
-				list<TimerThread::TimerEventEntry *>::iterator it = m_timerEventList.begin();
-				while (it != m_timerEventList.end())
-				{
-					m_driver->GetTimer()->TimerDelEvent((*it));
-					it = m_timerEventList.erase(it);
-				}
+				m_driver->GetTimer()->TimerDelEvents(this);
 			}
 			else
 			{
@@ -261,16 +335,7 @@ namespace OpenZWave
 		{
 			if (m_driver)
 			{
-				list<TimerThread::TimerEventEntry *>::iterator it = find(m_timerEventList.begin(), m_timerEventList.end(), te);
-				if (it != m_timerEventList.end())
-				{
-					m_driver->GetTimer()->TimerDelEvent((*it));
-					m_timerEventList.erase(it);
-				}
-				else
-				{
-					Log::Write(LogLevel_Warning, "Cant Find TimerEvent to Delete in TimerDelEvent");
-				}
+				m_driver->GetTimer()->TimerDelEvent(te, this);
 			}
 			else
 			{
@@ -288,14 +353,9 @@ namespace OpenZWave
 		{
 			if (m_driver)
 			{
-				for (list<TimerThread::TimerEventEntry *>::iterator it = m_timerEventList.begin(); it != m_timerEventList.end(); it++)
+				if (m_driver->GetTimer()->TimerDelEvent(this, id))
 				{
-					if ((*it)->id == id)
-					{
-						m_driver->GetTimer()->TimerDelEvent((*it));
-						m_timerEventList.erase(it);
-						return;
-					}
+					return;
 				}
 				Log::Write(LogLevel_Warning, "Cant Find TimerEvent %d to Delete in TimerDelEvent", id);
 				return;
@@ -314,8 +374,11 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 		void Timer::TimerFireEvent(TimerThread::TimerEventEntry *te)
 		{
-			te->callback(te->id);
+			TimerThread::TimerCallback callback;
+			callback.swap(te->callback);
+			uint32 id = te->id;
 			TimerDelEvent(te);
+			callback(id);
 		}
 	} // namespace Internal
 } // namespace OpenZWave
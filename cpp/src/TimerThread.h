@@ -38,7 +38,11 @@ using std::tr1::bind;
 using std::tr1::function;
 #endif
 
+#include <chrono>
+#include <vector>
+
 #include "Defs.h"
+#include "TimerWheel.h"
 #include "platform/Event.h"
 #include "platform/Mutex.h"
 #include "platform/TimeStamp.h"
@@ -51,6 +55,10 @@ namespace OpenZWave
 		class Timer;
 		/** \brief The TimerThread class makes it possible to schedule events to happen
 		 *  at a certain time in the future.
+		 *
+		 *  The events are kept in a TimerWheel, counting milliseconds on a monotonic clock,
+		 *  so setting or deleting one takes the same time however many there are.  Their
+		 *  entries are pooled, and reused once an event has fired or been deleted.
 		 */
 		class OPENZWAVE_EXPORT TimerThread
 		{
@@ -72,12 +80,13 @@ namespace OpenZWave
 				 */
 				~TimerThread();
 
-				struct TimerEventEntry
+				struct TimerEventEntry: public TimerWheel::Entry
 				{
 						Timer *instance;
-						Internal::Platform::TimeStamp timestamp;
 						TimerCallback callback;
 						uint32 id;
+						TimerEventEntry *instancePrev;			// The other events of the same Timer
+						TimerEventEntry *instanceNext;
 				};
 
 				/**
@@ -100,9 +109,33 @@ namespace OpenZWave
 
 				/**
 				 * Remove a Event
-				 *
+				 * \param _te The event to remove
+				 * \param _instance The Timer SubClass the event should belong to
+				 */
+				void TimerDelEvent(TimerEventEntry *_te, Timer *_instance);
+
+				/**
+				 * Remove the Event with an ID
+				 * \param _instance The Timer SubClass the event belongs to
+				 * \param _id The ID of the event
+				 * \return True if there was an event to remove
+				 */
+				bool TimerDelEvent(Timer *_instance, uint32 _id);
+
+				/**
+				 * Remove all the Events of a Timer SubClass
 				 */
-				void TimerDelEvent(TimerEventEntry *);
+				void TimerDelEvents(Timer *_instance);
+
+				/**
+				 * Unlink an event from its Timer and the wheel, and return its entry to the pool
+				 */
+				void ReleaseEntry(TimerEventEntry *_te);
+
+				/**
+				 * The current time on the wheel's clock, in milliseconds
+				 */
+				uint64 Now() const;
 
 				/**
 				 * Main class entry point for the timer thread. Contains the main timer loop.
@@ -110,8 +143,13 @@ namespace OpenZWave
 				 */
 				void TimerThreadProc(Internal::Platform::Event* _exitEvent);
 
-				/** A list of upcoming timer events */
-				list<TimerEventEntry *> m_timerEventList;
+				/** The upcoming timer events */
+				TimerWheel m_timerWheel;
+				std::chrono::steady_clock::time_point m_timerStart;	// Time zero for the wheel
+
+				/** Every entry ever allocated, and those free for reuse */
+				std::vector<TimerEventEntry *> m_timerEntries;
+				TimerEventEntry* m_freeEntries;
 
 				Internal::Platform::Event* m_timerEvent;   // Event to signal new timed action requested
 				Internal::Platform::Mutex* m_timerMutex;   // Serialize access to class members
@@ -126,6 +164,7 @@ namespace OpenZWave
 
 		class OPENZWAVE_EXPORT Timer
 		{
+				friend class TimerThread;
 			public:
 				/**
 				 * \brief Constructor with the _driver this instance is associated with
@@ -169,13 +208,14 @@ namespace OpenZWave
 				 */
 				void SetDriver(Driver *_driver);
 				/**
-				 * \brief Called From the TimerThread Class to execute a callback
+				 * \brief Called From the TimerThread Class to execute a callback.  The event is
+				 * deleted before the callback runs, so the callback may set new ones.
 				 * \param te The TimerEventEntry structure for the callback to execute
 				 */
 				void TimerFireEvent(TimerThread::TimerEventEntry *te);
 			private:
 				Driver* m_driver;
-				list<TimerThread::TimerEventEntry *> m_timerEventList;
+				TimerThread::TimerEventEntry *m_timerEvents;		// Linked through instanceNext.  Guarded by the TimerThread.
 
 		};
 	} // namespace Internal
@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+//
+//	TimerWheel.cpp
+//
+//	Hierarchical timing wheel for the TimerThread
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <string.h>
+#include "TimerWheel.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		uint64 const TimerWheel::Never;
+
+//-----------------------------------------------------------------------------
+// <TimerWheel::TimerWheel>
+// Constructor
+//-----------------------------------------------------------------------------
+		TimerWheel::TimerWheel(uint64 _now) :
+				m_now(_now), m_count(0), m_added(0)
+		{
+			memset(m_occupied, 0, sizeof(m_occupied));
+			memset(m_slots, 0, sizeof(m_slots));
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerWheel::Add>
+// Add a timer to the wheel
+//-----------------------------------------------------------------------------
+		void TimerWheel::Add(Entry* _entry)
+		{
+			if (_entry->m_level != NotQueued)
+			{
+				Unlink(_entry);
+			}
+			_entry->m_order = m_added++;
+			Insert(_entry);
+			++m_count;
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerWheel::Remove>
+// Take a timer out of the wheel
+//-----------------------------------------------------------------------------
+		void TimerWheel::Remove(Entry* _entry)
+		{
+			if (_entry->m_level != NotQueued)
+			{
+				Unlink(_entry);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerWheel::Expire>
+// Take out the next timer due by _now
+//-----------------------------------------------------------------------------
+		TimerWheel::Entry* TimerWheel::Expire(uint64 _now)
+		{
+			while (true)
+			{
+				if (Entry* entry = m_slots[0][m_now & SlotMask].m_head)
+				{
+					Unlink(entry);
+					return entry;
+				}
+				if (m_now >= _now)
+				{
+					return NULL;
+				}
+
+				// Nothing happens in the ticks before the next one, so skip them
+				uint64 next = GetNextTick();
+				Advance((next < _now) ? next : _now);
+			}
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerWheel::GetNextTick>
+// The tick by which Expire needs calling again
+//-----------------------------------------------------------------------------
+		uint64 TimerWheel::GetNextTick() const
+		{
+			uint64 next = Never;
+			for (uint32 level = 0; level < Levels; ++level)
+			{
+				if (!m_occupied[level])
+				{
+					continue;
+				}
+
+				// Look for the first slot in use, starting with the current one on the first level.
+				// On the higher levels the current slot has already been spread out, and is next
+				// due a whole turn of the wheel later.
+				uint32 shift = level * SlotBits;
+				uint64 block = m_now >> shift;
+				for (uint32 distance = (level ? 1 : 0); distance <= Slots; ++distance)
+				{
+					if (m_occupied[level] & (((uint64) 1) << ((block + distance) & SlotMask)))
+					{
+						uint64 tick = (block + distance) << shift;
+						if (tick < next)
+						{
+							next = tick;
+						}
+						break;
+					}
+				}
+			}
+			return next;
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerWheel::Insert>
+// Link a timer into the slot for its expiry
+//-----------------------------------------------------------------------------
+		void TimerWheel::Insert(Entry* _entry)
+		{
+			uint64 expiry = (_entry->m_expiry > m_now) ? _entry->m_expiry : m_now;
+			uint64 delta = expiry - m_now;
+			uint32 level = 0;
+			while ((level < (Levels - 1)) && (delta >= (((uint64) 1) << ((level + 1) * SlotBits))))
+			{
+				++level;
+			}
+			if (delta >= (((uint64) 1) << (Levels * SlotBits)))
+			{
+				// Beyond the top level.  Wait as long as it can, then be placed again.
+				expiry = m_now + (((uint64) 1) << (Levels * SlotBits)) - 1;
+			}
+
+			uint32 slot = (uint32) ((expiry >> (level * SlotBits)) & SlotMask);
+			Slot& s = m_slots[level][slot];
+
+			// Keep the slot in the order the timers were added.  A new timer goes on the end, but one
+			// spread down from a higher level may have been added before some already in the slot.
+			Entry* prev = s.m_tail;
+			while (prev && ((int32) (prev->m_order - _entry->m_order) > 0))
+			{
+				prev = prev->m_prev;
+			}
+			Entry* next = prev ? prev->m_next : s.m_head;
+
+			_entry->m_prev = prev;
+			_entry->m_next = next;
+			if (prev)
+			{
+				prev->m_next = _entry;
+			}
+			else
+			{
+				s.m_head = _entry;
+				m_occupied[level] |= ((uint64) 1) << slot;
+			}
+			if (next)
+			{
+				next->m_prev = _entry;
+			}
+			else
+			{
+				s.m_tail = _entry;
+			}
+			_entry->m_level = (uint8) level;
+			_entry->m_slot = (uint8) slot;
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerWheel::Unlink>
+// Take a timer out of its slot
+//-----------------------------------------------------------------------------
+		void TimerWheel::Unlink(Entry* _entry)
+		{
+			Slot& s = m_slots[_entry->m_level][_entry->m_slot];
+			if (_entry->m_prev)
+			{
+				_entry->m_prev->m_next = _entry->m_next;
+			}
+			else
+			{
+				s.m_head = _entry->m_next;
+			}
+			if (_entry->m_next)
+			{
+				_entry->m_next->m_prev = _entry->m_prev;
+			}
+			else
+			{
+				s.m_tail = _entry->m_prev;
+			}
+			if (!s.m_head)
+			{
+				m_occupied[_entry->m_level] &= ~(((uint64) 1) << _entry->m_slot);
+			}
+
+			_entry->m_prev = NULL;
+			_entry->m_next = NULL;
+			_entry->m_level = NotQueued;
+			--m_count;
+		}
+
+//-----------------------------------------------------------------------------
+// <TimerWheel::Advance>
+// Move time on to _tick, spreading out the higher level slots that come due
+//-----------------------------------------------------------------------------
+		void TimerWheel::Advance(uint64 _tick)
+		{
+			m_now = _tick;
+			for (uint32 level = 1; level < Levels; ++level)
+			{
+				uint32 shift = level * SlotBits;
+				if (_tick & ((((uint64) 1) << shift) - 1))
+				{
+					// Not at the start of a slot on this level, so nor on any above it
+					break;
+				}
+
+				uint32 slot = (uint32) ((_tick >> shift) & SlotMask);
+				Entry* entry = m_slots[level][slot].m_head;
+				m_slots[level][slot].m_head = NULL;
+				m_slots[level][slot].m_tail = NULL;
+				m_occupied[level] &= ~(((uint64) 1) << slot);
+				while (entry)
+				{
+					Entry* next = entry->m_next;
+					Insert(entry);
+					entry = next;
+				}
+			}
+		}
+	} // namespace Internal
+} // namespace OpenZWave
@@ -0,0 +1,143 @@
+//-----------------------------------------------------------------------------
+//
+//	TimerWheel.h
+//
+//	Hierarchical timing wheel for the TimerThread
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _TimerWheel_H
+#define _TimerWheel_H
+
+#include "Defs.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		/** \brief Keeps timers in order of expiry, with constant time insertion and removal.
+		 *
+		 *  Time is counted in ticks.  The wheel has four levels of 64 slots.  A slot of the
+		 *  first level holds the timers for a single tick, a slot of the next level those for
+		 *  64 ticks, and so on.  As time moves on, the timers in a slot of a higher level are
+		 *  spread over the levels below, until they reach the first.  With millisecond ticks
+		 *  the levels cover 64ms, 4s, 4m22s and 4h39m.  A timer further away than that waits
+		 *  at the top level, and is placed again each time it comes round.
+		 *
+		 *  The entries are linked into the slots, so the wheel allocates nothing.  It does no
+		 *  locking of its own.
+		 */
+		class TimerWheel
+		{
+			public:
+				enum
+				{
+					NotQueued = 0xff
+				};
+
+				/** A timer.  Derive from it to add the data the timer carries. */
+				struct Entry
+				{
+						Entry() :
+								m_expiry(0), m_prev(NULL), m_next(NULL), m_order(0), m_level(NotQueued), m_slot(0)
+						{
+						}
+
+						uint64 m_expiry;						// Tick at which the timer expires
+						Entry* m_prev;
+						Entry* m_next;
+						uint32 m_order;							// When it was added, to keep timers for the same tick in order
+						uint8 m_level;							// NotQueued when not in the wheel
+						uint8 m_slot;
+				};
+
+				/**
+				 * Constructor.
+				 * \param _now the current tick.
+				 */
+				TimerWheel(uint64 _now = 0);
+
+				/**
+				 * Add a timer, which expires at its m_expiry tick.  A tick that has already gone
+				 * by expires it as soon as possible.
+				 */
+				void Add(Entry* _entry);
+
+				/**
+				 * Take a timer out of the wheel.  Does nothing if it is not in it.
+				 */
+				void Remove(Entry* _entry);
+
+				/**
+				 * Move time on, and take out the next timer that has expired.
+				 * Call it until it returns NULL to handle every timer due by _now.  Timers expire
+				 * in order of tick, and those for the same tick in the order they were added.
+				 * \param _now the current tick.  It must not go backwards.
+				 * \return an expired timer, which is no longer in the wheel, or NULL if there are no more.
+				 */
+				Entry* Expire(uint64 _now);
+
+				/**
+				 * The tick by which Expire next needs calling.  This is when the next timer expires,
+				 * or earlier if the timers in a higher level slot need spreading out first.
+				 * \return the tick, or Never if the wheel is empty.
+				 */
+				uint64 GetNextTick() const;
+
+				/** The number of timers in the wheel */
+				uint32 GetCount() const
+				{
+					return m_count;
+				}
+
+				static uint64 const Never = ~((uint64) 0);
+
+			private:
+				TimerWheel(TimerWheel const&);					// prevent copy
+				TimerWheel& operator =(TimerWheel const&);		// prevent assignment
+
+				enum
+				{
+					Levels = 4,
+					SlotBits = 6,
+					Slots = 1 << SlotBits,
+					SlotMask = Slots - 1
+				};
+
+				struct Slot
+				{
+						Entry* m_head;
+						Entry* m_tail;
+				};
+
+				void Insert(Entry* _entry);
+				void Unlink(Entry* _entry);
+				void Advance(uint64 _tick);
+
+				uint64 m_now;									// Expire has handled every tick before this one
+				uint32 m_count;
+				uint32 m_added;									// Counts the calls to Add, for Entry::m_order
+				uint64 m_occupied[Levels];						// A bit for each slot that holds timers
+				Slot m_slots[Levels][Slots];
+		};
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif // _TimerWheel_H
@@ -29,6 +29,7 @@
 #define _Utils_H
 
 #include "platform/Mutex.h"
+#include "platform/SharedMutex.h"
 #include "platform/Log.h"
 
 #include <string>
@@ -120,13 +121,19 @@ namespace OpenZWave
 		struct LockGuard
 		{
 				LockGuard(Internal::Platform::Mutex* mutex) :
-						_ref(mutex)
+						_ref(mutex), _shared(NULL), _held(true)
 				{
 					//std::cout << "Locking" << std::endl;
 					_ref->Lock();
 				}
 				;
 
+				LockGuard(Internal::Platform::SharedMutex* mutex) :
+						_ref(NULL), _shared(mutex), _held(true)
+				{
+					_shared->Lock();
+				}
+
 				~LockGuard()
 				{
 #if 0
@@ -135,19 +142,54 @@ namespace OpenZWave
 					else
 					std::cout << "Unlocking" << std::endl;
 #endif
-					if (!_ref->IsSignalled())
+					if (_shared)
+					{
+						// Other threads may hold a SharedMutex, so only release our own lock
+						if (_held)
+							_shared->Unlock();
+					}
+					else if (!_ref->IsSignalled())
 						_ref->Unlock();
 				}
 				void Unlock()
 				{
 //				std::cout << "Unlocking" << std::endl;
-					_ref->Unlock();
+					if (_shared)
+						_shared->Unlock();
+					else
+						_ref->Unlock();
+					_held = false;
 				}
 			private:
 				LockGuard(const LockGuard&);
 				LockGuard& operator =(LockGuard const&);
 
 				Internal::Platform::Mutex* _ref;
+				Internal::Platform::SharedMutex* _shared;
+				bool _held;
+		};
+
+		/**
+		 * Holds a SharedMutex shared for the life of the guard.  Used by code that only
+		 * reads the data the lock protects, so that readers do not serialise on each other.
+		 */
+		struct SharedLockGuard
+		{
+				SharedLockGuard(Internal::Platform::SharedMutex* mutex) :
+						_ref(mutex)
+				{
+					_ref->LockShared();
+				}
+
+				~SharedLockGuard()
+				{
+					_ref->UnlockShared();
+				}
+			private:
+				SharedLockGuard(const SharedLockGuard&);
+				SharedLockGuard& operator =(SharedLockGuard const&);
+
+				Internal::Platform::SharedMutex* _ref;
 		};
 
 		string ozwdirname(string);
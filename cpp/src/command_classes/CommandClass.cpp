@@ -40,6 +40,7 @@
 #include "Manager.h"
 #include "platform/Log.h"
 #include "value_classes/Value.h"
+#include "value_classes/ValueDecimal.h"
 #include "value_classes/ValueStore.h"
 
 namespace OpenZWave
@@ -472,9 +473,24 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			std::string CommandClass::ExtractValue(uint8 const* _data, uint8* _scale, uint8* _precision, uint8 _valueOffset // = 1
 					) const
+			{
+				uint8 precision;
+				int32 value = ExtractDecimal(_data, _scale, &precision, _valueOffset);
+				if (_precision)
+				{
+					*_precision = precision;
+				}
+				return Internal::VC::ValueDecimal::Format(value, precision);
+			}
+
+//-----------------------------------------------------------------------------
+// <CommandClass::ExtractDecimal>
+// Read a value from a variable length sequence of bytes as an integer
+//-----------------------------------------------------------------------------
+			int32 CommandClass::ExtractDecimal(uint8 const* _data, uint8* _scale, uint8* _precision, uint8 _valueOffset // = 1
+					) const
 			{
 				uint8 const size = _data[0] & c_sizeMask;
-				uint8 const precision = (_data[0] & c_precisionMask) >> c_precisionShift;
 
 				if (_scale)
 				{
@@ -483,7 +499,7 @@ namespace OpenZWave
 
 				if (_precision)
 				{
-					*_precision = precision;
+					*_precision = (_data[0] & c_precisionMask) >> c_precisionShift;
 				}
 
 				uint32 value = 0;
@@ -495,11 +511,8 @@ namespace OpenZWave
 				}
 
 				// Deal with sign extension.  All values are signed
-				std::string res;
 				if (_data[_valueOffset] & 0x80)
 				{
-					res = "-";
-
 					// MSB is signed
 					if (size == 1)
 					{
@@ -511,55 +524,7 @@ namespace OpenZWave
 					}
 				}
 
-				// Convert the integer to a decimal string.  We avoid
-				// using floats to prevent accuracy issues.
-				char numBuf[12] =
-				{ 0 };
-
-				if (precision == 0)
-				{
-					// The precision is zero, so we can just print the number directly into the string.
-					snprintf(numBuf, 12, "%d", (signed int) value);
-					res = numBuf;
-				}
-				else
-				{
-					// We'll need to insert a decimal point and include any necessary leading zeros.
-
-					// Fill the buffer with the value padded with leading zeros.
-					snprintf(numBuf, 12, "%011d", (signed int) value);
-
-					// Calculate the position of the decimal point in the buffer
-					int32 decimal = 10 - precision;
-
-					// Shift the characters to make space for the decimal point.
-					// We don't worry about overwriting any minus sign since that is
-					// already written into the res string. While we're shifting, we
-					// also look for the real starting position of the number so we
-					// can copy it into the res string later.
-					int32 start = -1;
-					for (int32 i = 0; i < decimal; ++i)
-					{
-						numBuf[i] = numBuf[i + 1];
-						if ((start < 0) && (numBuf[i] != '0'))
-						{
-							start = i;
-						}
-					}
-					if (start < 0)
-					{
-						start = decimal - 1;
-					}
-
-					// Insert the decimal point
-					struct lconv const* locale = localeconv();
-					numBuf[decimal] = *(locale->decimal_point);
-
-					// Copy the buffer into res
-					res += &numBuf[start];
-				}
-
-				return res;
+				return (int32) value;
 			}
 
 //-----------------------------------------------------------------------------
@@ -612,6 +577,25 @@ namespace OpenZWave
 				}
 			}
 
+//-----------------------------------------------------------------------------
+// <CommandClass::AppendValue>
+// Add a decimal value to a message as a sequence of bytes
+//-----------------------------------------------------------------------------
+			void CommandClass::AppendValue(Msg* _msg, int32 const _value, uint8 const _precision, uint8 const _scale) const
+			{
+				uint8 precision = _precision;
+				uint8 size;
+				int32 val = AdjustPrecision(_value, &precision, &size);
+
+				_msg->Append((precision << c_precisionShift) | (_scale << c_scaleShift) | size);
+
+				int32 shift = (size - 1) << 3;
+				for (int32 i = size; i > 0; --i, shift -= 8)
+				{
+					_msg->Append((uint8) (val >> shift));
+				}
+			}
+
 //-----------------------------------------------------------------------------
 // <CommandClass::GetAppendValueSize>
 // Get the number of bytes that would be added by a call to AppendValue
@@ -623,6 +607,18 @@ namespace OpenZWave
 				return size;
 			}
 
+//-----------------------------------------------------------------------------
+// <CommandClass::GetAppendValueSize>
+// Get the number of bytes that would be added by a call to AppendValue
+//-----------------------------------------------------------------------------
+			uint8 const CommandClass::GetAppendValueSize(int32 const _value, uint8 const _precision) const
+			{
+				uint8 precision = _precision;
+				uint8 size;
+				AdjustPrecision(_value, &precision, &size);
+				return size;
+			}
+
 //-----------------------------------------------------------------------------
 // <CommandClass::ValueToInteger>
 // Convert a decimal string to an integer and report the precision and
@@ -630,44 +626,35 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			int32 CommandClass::ValueToInteger(std::string const& _value, uint8* o_precision, uint8* o_size) const
 			{
-				int32 val;
-				uint8 precision;
-
-				// Find the decimal point
-				size_t pos = _value.find_first_of(".");
-				if (pos == std::string::npos)
-					pos = _value.find_first_of(",");
+				int32 val = 0;
+				uint8 precision = 0;
+				Internal::VC::ValueDecimal::Parse(_value, &val, &precision);
 
-				if (pos == std::string::npos)
-				{
-					// No decimal point
-					precision = 0;
-
-					// Convert the string to an integer
-					val = atol(_value.c_str());
-				}
-				else
-				{
-					// Remove the decimal point and convert to an integer
-					precision = (uint8) ((_value.size() - pos) - 1);
+				val = AdjustPrecision(val, &precision, o_size);
+				if (o_precision)
+					*o_precision = precision;
 
-					std::string str = _value.substr(0, pos) + _value.substr(pos + 1);
-					val = atol(str.c_str());
-				}
+				return val;
+			}
 
+//-----------------------------------------------------------------------------
+// <CommandClass::AdjustPrecision>
+// Apply the precision override, and report the number of bytes required to
+// store the value.
+//-----------------------------------------------------------------------------
+			int32 CommandClass::AdjustPrecision(int32 _value, uint8* io_precision, uint8* o_size) const
+			{
+				int32 val = _value;
 				uint8_t orp = m_com.GetFlagByte(COMPAT_FLAG_OVERRIDEPRECISION);
 				if (orp > 0)
 				{
-					while (precision < orp)
+					while (*io_precision < orp)
 					{
-						precision++;
+						(*io_precision)++;
 						val *= 10;
 					}
 				}
 
-				if (o_precision)
-					*o_precision = precision;
-
 				if (o_size)
 				{
 					// Work out the size as either 1, 2 or 4 bytes
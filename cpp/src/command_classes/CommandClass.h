@@ -210,6 +210,11 @@ namespace OpenZWave
 
 					// Helper methods
 					string ExtractValue(uint8 const* _data, uint8* _scale, uint8* _precision, uint8 _valueOffset = 1) const;
+					/**
+					 *  Read a value from a variable length sequence of bytes, without turning it into a string.
+					 *  \return the value times 10 to the power of the precision.
+					 */
+					int32 ExtractDecimal(uint8 const* _data, uint8* _scale, uint8* _precision, uint8 _valueOffset = 1) const;
 					uint32 decodeDuration(uint8 data) const;
 					uint8 encodeDuration(uint32 seconds) const;
 					/**
@@ -220,8 +225,15 @@ namespace OpenZWave
 					 *  \see Msg
 					 */
 					void AppendValue(Msg* _msg, string const& _value, uint8 const _scale) const;
+					/**
+					 *  Append a decimal value, _value / 10^_precision, to a message.
+					 *  \see AppendValue
+					 */
+					void AppendValue(Msg* _msg, int32 const _value, uint8 const _precision, uint8 const _scale) const;
 					uint8 const GetAppendValueSize(string const& _value) const;
+					uint8 const GetAppendValueSize(int32 const _value, uint8 const _precision) const;
 					int32 ValueToInteger(string const& _value, uint8* o_precision, uint8* o_size) const;
+					int32 AdjustPrecision(int32 _value, uint8* io_precision, uint8* o_size) const;	// Applies the OverridePrecision compatibility flag and works out the number of bytes the value needs
 
 					void UpdateMappedClass(uint8 const _instance, uint8 const _classId, uint8 const _value);		// Update mapped class's value from BASIC class
 
@@ -274,7 +274,8 @@ namespace OpenZWave
 
 				TiXmlDocument* doc = new TiXmlDocument();
 				Log::Write(LogLevel_Info, GetNodeId(), "  Opening config param file %s", filename.c_str());
-				if (!doc->LoadFile(filename.c_str(), TIXML_ENCODING_UTF8))
+				Node* node = GetNodeUnsafe();
+				if (!GetDriver()->GetManufacturerSpecificDB()->LoadConfigFile(node->GetManufacturerId(), node->GetProductType(), node->GetProductId(), filename, doc))
 				{
 					delete doc;
 					Log::Write(LogLevel_Info, GetNodeId(), "Unable to find or load Config Param file %s", filename.c_str());
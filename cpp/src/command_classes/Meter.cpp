@@ -359,7 +359,7 @@ namespace OpenZWave
 				// Get the value and scale
 				uint8 scale;
 				uint8 precision = 0;
-				string valueStr = ExtractValue(&_data[2], &scale, &precision);
+				int32 reading = ExtractDecimal(&_data[2], &scale, &precision);
 				scale = GetScale(_data, _length);
 				int8 meterType = (MeterType) (_data[1] & 0x1f);
 
@@ -370,7 +370,10 @@ namespace OpenZWave
 					return false;
 				}
 
-				Log::Write(LogLevel_Info, GetNodeId(), "Received Meter Report for %s (%d) with Units %s (%d) on Index %d: %s",MeterTypes.at(index).Label.c_str(), meterType, MeterTypes.at(index).Unit.c_str(), scale, index, valueStr.c_str());
+				if (Log::IsEnabled(LogLevel_Info))
+				{
+					Log::Write(LogLevel_Info, GetNodeId(), "Received Meter Report for %s (%d) with Units %s (%d) on Index %d: %s",MeterTypes.at(index).Label.c_str(), meterType, MeterTypes.at(index).Unit.c_str(), scale, index, Internal::VC::ValueDecimal::Format(reading, precision).c_str());
+				}
 
 				Internal::VC::ValueDecimal* value = static_cast<Internal::VC::ValueDecimal*>(GetValue(_instance, index));
 				if (!value && (GetVersion() == 1))
@@ -385,11 +388,7 @@ namespace OpenZWave
 					Log::Write(LogLevel_Warning, GetNodeId(), "Can't Find a ValueID Index for %s (%d) with Unit %s (%d) - Index %d", MeterTypes.at(index).Label.c_str(), meterType, MeterTypes.at(index).Unit.c_str(), scale, index);
 					return false;
 				}
-				value->OnValueRefreshed(valueStr);
-				if (value->GetPrecision() != precision)
-				{
-					value->SetPrecision(precision);
-				}
+				value->OnValueRefreshed(reading, precision, scale);
 				value->Release();
 				bool exporting = false;
 				if (GetVersion() > 1)
@@ -424,13 +423,9 @@ namespace OpenZWave
 					if (previous)
 					{
 						precision = 0;
-						valueStr = ExtractValue(&_data[2], &scale, &precision, 3 + size);
-						Log::Write(LogLevel_Info, GetNodeId(), "    Previous value was %s%s, received %d seconds ago.", valueStr.c_str(), previous->GetUnits().c_str(), delta);
-						previous->OnValueRefreshed(valueStr);
-						if (previous->GetPrecision() != precision)
-						{
-							previous->SetPrecision(precision);
-						}
+						reading = ExtractDecimal(&_data[2], &scale, &precision, 3 + size);
+						Log::Write(LogLevel_Info, GetNodeId(), "    Previous value was %s%s, received %d seconds ago.", Internal::VC::ValueDecimal::Format(reading, precision).c_str(), previous->GetUnits().c_str(), delta);
+						previous->OnValueRefreshed(reading, precision, scale);
 						previous->Release();
 					}
 
@@ -269,7 +269,7 @@ namespace OpenZWave
 					uint8 scale;
 					uint8 precision = 0;
 					uint8 sensorType = _data[1];
-					string valueStr = ExtractValue(&_data[2], &scale, &precision);
+					int32 reading = ExtractDecimal(&_data[2], &scale, &precision);
 
 					Node* node = GetNodeUnsafe();
 					if (node != NULL)
@@ -282,12 +282,11 @@ namespace OpenZWave
 						}
 						value->SetUnits(SensorMultiLevelCCTypes::Get()->GetSensorUnit(sensorType, scale));
 
-						Log::Write(LogLevel_Info, GetNodeId(), "Received SensorMultiLevel report from node %d, instance %d, %s: value=%s%s", GetNodeId(), _instance, SensorMultiLevelCCTypes::Get()->GetSensorName(sensorType).c_str(), valueStr.c_str(), value->GetUnits().c_str());
-						if (value->GetPrecision() != precision)
+						if (Log::IsEnabled(LogLevel_Info))
 						{
-							value->SetPrecision(precision);
+							Log::Write(LogLevel_Info, GetNodeId(), "Received SensorMultiLevel report from node %d, instance %d, %s: value=%s%s", GetNodeId(), _instance, SensorMultiLevelCCTypes::Get()->GetSensorName(sensorType).c_str(), Internal::VC::ValueDecimal::Format(reading, precision).c_str(), value->GetUnits().c_str());
 						}
-						value->OnValueRefreshed(valueStr);
+						value->OnValueRefreshed(reading, precision, scale);
 						value->Release();
 						return true;
 					}
@@ -153,17 +153,16 @@ namespace OpenZWave
 					{
 						uint8 scale;
 						uint8 precision = 0;
-						string temperature = ExtractValue(&_data[2], &scale, &precision);
+						int32 temperature = ExtractDecimal(&_data[2], &scale, &precision);
 
 						value->SetUnits(scale ? "F" : "C");
-						value->OnValueRefreshed(temperature);
-						if (value->GetPrecision() != precision)
-						{
-							value->SetPrecision(precision);
-						}
+						value->OnValueRefreshed(temperature, precision, scale);
 						value->Release();
 
-						Log::Write(LogLevel_Info, GetNodeId(), "Received thermostat setpoint report: Setpoint %s = %s%s", value->GetLabel().c_str(), value->GetValue().c_str(), value->GetUnits().c_str());
+						if (Log::IsEnabled(LogLevel_Info))
+						{
+							Log::Write(LogLevel_Info, GetNodeId(), "Received thermostat setpoint report: Setpoint %s = %s%s", value->GetLabel().c_str(), value->GetValue().c_str(), value->GetUnits().c_str());
+						}
 					}
 					return true;
 				}
@@ -309,11 +308,12 @@ namespace OpenZWave
 						msg->SetInstance(this, _value.GetID().GetInstance());
 						msg->SetSupervision(supervision_session_id);
 						msg->Append(GetNodeId());
-						msg->Append(4 + GetAppendValueSize(value->GetValue()));
+						Internal::VC::Decimal const& decimal = value->GetDecimal();
+						msg->Append(4 + GetAppendValueSize(decimal.m_value, decimal.m_precision));
 						msg->Append(GetCommandClassId());
 						msg->Append(ThermostatSetpointCmd_Set);
 						msg->Append(index);
-						AppendValue(msg, value->GetValue(), scale);
+						AppendValue(msg, decimal.m_value, decimal.m_precision, scale);
 
 						msg->Append(GetDriver()->GetTransmitOptions());
 						GetDriver()->SendMsg(msg, Driver::MsgQueue_Send);
@@ -247,7 +247,7 @@ namespace OpenZWave
 							{
 								m_queryAll = false;
 								/* we might have reset this as part of the RefreshValues Button Value */
-								Options::Get()->GetOptionAsBool("RefreshAllUserCodes", &m_refreshUserCodes);
+								m_refreshUserCodes = Options::Get()->GetSnapshot().m_refreshAllUserCodes;
 							}
 						}
 						else
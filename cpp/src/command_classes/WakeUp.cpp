@@ -366,37 +366,88 @@ namespace OpenZWave
 				// we delete it.  This is to prevent duplicates building up if the
 				// device does not wake up very often.  Deleting the original and
 				// adding the copy to the end avoids problems with the order of
-				// commands such as on and off.
-				list<Driver::MsgQueueItem>::iterator it = m_pendingQueue.begin();
-				while (it != m_pendingQueue.end())
+				// commands such as on and off.  Each copy is removed as the next is
+				// added, so there is never more than one.
+				uint64 hash = _item.GetHash();
+				std::pair<PendingIndex::iterator, PendingIndex::iterator> range = m_pendingIndex.equal_range(hash);
+				for (PendingIndex::iterator it = range.first; it != range.second; ++it)
 				{
-					Driver::MsgQueueItem const& item = *it;
-					if (item == _item)
+					if (*it->second == _item)
 					{
-						// Duplicate found
-						if (Driver::MsgQueueCmd_SendMsg == item.m_command)
-						{
-							delete item.m_msg;
-						}
-						else if (Driver::MsgQueueCmd_Controller == item.m_command)
-						{
-							delete item.m_cci;
-						}
-						it = m_pendingQueue.erase(it);
+						RemovePending(it->second);
+						break;
 					}
-					else
+				}
+
+				// Likewise a message that sets a value replaces one still waiting to set it
+				uint64 valueId = (Driver::MsgQueueCmd_SendMsg == _item.m_command) ? _item.m_msg->GetValueId() : 0;
+				if (valueId)
+				{
+					range = m_pendingValues.equal_range(valueId);
+					for (PendingIndex::iterator it = range.first; it != range.second; ++it)
 					{
-						++it;
+						if (it->second->m_msg->SetsSameValue(*_item.m_msg))
+						{
+							Log::Write(LogLevel_Detail, GetNodeId(), "Replacing queued %s", it->second->m_msg->GetLogText().c_str());
+							RemovePending(it->second);
+							break;
+						}
 					}
 				}
+
 				/* make sure the SendAttempts is reset to 0 */
 				if (_item.m_command == Driver::MsgQueueCmd_SendMsg)
 					_item.m_msg->SetSendAttempts(0);
 
-				m_pendingQueue.push_back(_item);
+				list<Driver::MsgQueueItem>::iterator pos = m_pendingQueue.insert(m_pendingQueue.end(), _item);
+				m_pendingIndex.insert(std::make_pair(hash, pos));
+				if (valueId)
+				{
+					m_pendingValues.insert(std::make_pair(valueId, pos));
+				}
 				m_mutex->Unlock();
 			}
 
+//-----------------------------------------------------------------------------
+// <WakeUp::RemovePending>
+// Delete a pending item, and take it out of the indexes.  The caller holds m_mutex.
+//-----------------------------------------------------------------------------
+			void WakeUp::RemovePending(list<Driver::MsgQueueItem>::iterator _it)
+			{
+				Driver::MsgQueueItem const& item = *_it;
+				std::pair<PendingIndex::iterator, PendingIndex::iterator> range = m_pendingIndex.equal_range(item.GetHash());
+				for (PendingIndex::iterator it = range.first; it != range.second; ++it)
+				{
+					if (it->second == _it)
+					{
+						m_pendingIndex.erase(it);
+						break;
+					}
+				}
+
+				if (Driver::MsgQueueCmd_SendMsg == item.m_command)
+				{
+					if (uint64 valueId = item.m_msg->GetValueId())
+					{
+						range = m_pendingValues.equal_range(valueId);
+						for (PendingIndex::iterator it = range.first; it != range.second; ++it)
+						{
+							if (it->second == _it)
+							{
+								m_pendingValues.erase(it);
+								break;
+							}
+						}
+					}
+					delete item.m_msg;
+				}
+				else if (Driver::MsgQueueCmd_Controller == item.m_command)
+				{
+					delete item.m_cci;
+				}
+				m_pendingQueue.erase(_it);
+			}
+
 //-----------------------------------------------------------------------------
 // <WakeUp::SendPending>
 // The device is awake, so send all the pending messages
@@ -430,6 +481,8 @@ namespace OpenZWave
 					}
 					it = m_pendingQueue.erase(it);
 				}
+				m_pendingIndex.clear();
+				m_pendingValues.clear();
 				m_mutex->Unlock();
 
 				// Send the device back to sleep, unless we have outstanding queries.
@@ -473,7 +526,7 @@ namespace OpenZWave
 				msg->Append(WakeUpCmd_NoMoreInformation);
 				msg->Append(GetDriver()->GetTransmitOptions());
 				GetDriver()->SendMsg(msg, Driver::MsgQueue_WakeUp);
-				GetDriver()->WriteCache();
+				GetDriver()->WriteCache(GetNodeId());
 			}
 
 //-----------------------------------------------------------------------------
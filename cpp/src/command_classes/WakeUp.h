@@ -29,6 +29,7 @@
 #define _WakeUp_H
 
 #include <list>
+#include <unordered_map>
 #include "command_classes/CommandClass.h"
 #include "Driver.h"
 #include "TimerThread.h"
@@ -113,8 +114,14 @@ namespace OpenZWave
 				private:
 					WakeUp(uint32 const _homeId, uint8 const _nodeId);
 
+					typedef std::unordered_multimap<uint64, list<Driver::MsgQueueItem>::iterator> PendingIndex;
+
+					void RemovePending(list<Driver::MsgQueueItem>::iterator _it);
+
 					Internal::Platform::Mutex* m_mutex;			// Serialize access to the pending queue
 					list<Driver::MsgQueueItem> m_pendingQueue;		// Messages waiting to be sent when the device wakes up
+					PendingIndex m_pendingIndex;					// The pending items by Driver::MsgQueueItem::GetHash
+					PendingIndex m_pendingValues;					// The pending messages that set a value, by Msg::GetValueId
 					bool m_awake;
 					bool m_pollRequired;
 					uint32 m_interval;
@@ -155,6 +155,34 @@ namespace OpenZWave
 				return false;
 			}
 
+			/**
+			 * FileMap. Map a File read-only into memory
+			 * \param string. file name
+			 * \param o_size. Receives the size of the mapping
+			 * \return Pointer to the contents, or NULL on failure.
+			 */
+			uint8 const* FileOps::FileMap(const string &_fileName, size_t* o_size)
+			{
+				if (s_instance != NULL)
+				{
+					return s_instance->m_pImpl->FileMap(_fileName, o_size);
+				}
+				return NULL;
+			}
+
+			/**
+			 * FileUnmap. Release a mapping returned by FileMap
+			 * \param _data. The pointer returned by FileMap
+			 * \param _size. The size returned by FileMap
+			 */
+			void FileOps::FileUnmap(uint8 const* _data, size_t _size)
+			{
+				if (s_instance != NULL)
+				{
+					s_instance->m_pImpl->FileUnmap(_data, _size);
+				}
+			}
+
 //-----------------------------------------------------------------------------
 //	<FileOps::FileOps>
 //	Constructor
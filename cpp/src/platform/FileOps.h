@@ -102,6 +102,21 @@ namespace OpenZWave
 					 */
 					static bool FolderCreate(const string &_folderName);
 
+					/**
+					 * FileMap. Map a File read-only into memory
+					 * \param string. file name
+					 * \param o_size. Receives the size of the mapping
+					 * \return Pointer to the contents, or NULL on failure. Must be released with FileUnmap.
+					 */
+					static uint8 const* FileMap(const string &_fileName, size_t* o_size);
+
+					/**
+					 * FileUnmap. Release a mapping returned by FileMap
+					 * \param _data. The pointer returned by FileMap
+					 * \param _size. The size returned by FileMap
+					 */
+					static void FileUnmap(uint8 const* _data, size_t _size);
+
 				private:
 					FileOps();
 					~FileOps();
@@ -60,23 +60,26 @@ char const *OpenZWave::LogLevelString[] =
 Log* Log::s_instance = NULL;
 std::vector<i_LogImpl*> Log::m_pImpls;
 static bool s_dologging;
+static LogLevel s_maxLevel = LogLevel_Internal;	// Least severe level that is saved or queued
 
 //-----------------------------------------------------------------------------
 //	<Log::Create>
 //	Static creation of the singleton
 //-----------------------------------------------------------------------------
-Log* Log::Create(string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger)
+Log* Log::Create(string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger, bool const _bAsync)
 {
 	if ( NULL == s_instance)
 	{
-		s_instance = new Log(_filename, _bAppend, _bConsoleOutput, _saveLevel, _queueLevel, _dumpTrigger);
+		s_instance = new Log(_filename, _bAppend, _bConsoleOutput, _saveLevel, _queueLevel, _dumpTrigger, _bAsync);
 		s_dologging = true; // default logging to true so no change to what people experience now
+		s_maxLevel = (_saveLevel > _queueLevel) ? _saveLevel : _queueLevel;
 	}
 	else
 	{
 		Log::Destroy();
-		s_instance = new Log(_filename, _bAppend, _bConsoleOutput, _saveLevel, _queueLevel, _dumpTrigger);
+		s_instance = new Log(_filename, _bAppend, _bConsoleOutput, _saveLevel, _queueLevel, _dumpTrigger, _bAsync);
 		s_dologging = true; // default logging to true so no change to what people experience now
+		s_maxLevel = (_saveLevel > _queueLevel) ? _saveLevel : _queueLevel;
 	}
 
 	return s_instance;
@@ -127,6 +130,8 @@ bool Log::SetLoggingClass(i_LogImpl *LogClass, bool Append)
 		}
 	}
 	s_instance->m_pImpls.push_back(LogClass);
+	// We can't tell what an application's logging class filters out
+	s_maxLevel = LogLevel_Internal;
 	return true;
 }
 
@@ -164,6 +169,7 @@ void Log::SetLoggingState(LogLevel _saveLevel, LogLevel _queueLevel, LogLevel _d
 		Log::Write(LogLevel_Warning, "The trigger for dumping queued messages must be a higher-priority message than the level that is queued.");
 
 	bool prevLogging = s_dologging;
+	s_maxLevel = (_saveLevel > _queueLevel) ? _saveLevel : _queueLevel;
 	// s_dologging is true if any messages are to be saved in file or queue
 	if ((_saveLevel > LogLevel_Always) || (_queueLevel > LogLevel_Always))
 	{
@@ -195,12 +201,26 @@ bool Log::GetLoggingState()
 	return s_dologging;
 }
 
+//-----------------------------------------------------------------------------
+//	<Log::IsEnabled>
+//	Return whether messages of a given level will be saved or queued
+//-----------------------------------------------------------------------------
+bool Log::IsEnabled(LogLevel _level)
+{
+	return s_instance && s_dologging && (_level <= s_maxLevel);
+}
+
 //-----------------------------------------------------------------------------
 //	<Log::Write>
 //	Write to the log
 //-----------------------------------------------------------------------------
 void Log::Write(LogLevel _level, char const* _format, ...)
 {
+	// Nothing will be done with it, so don't take the lock or look at the arguments
+	if (!IsEnabled(_level) && (_level != LogLevel_Internal))
+	{
+		return;
+	}
 	if (s_instance && s_dologging && (s_instance->m_pImpls.size() > 0))
 	{
 		s_instance->m_logMutex->Lock(); // double locks if recursive
@@ -219,6 +239,10 @@ void Log::Write(LogLevel _level, char const* _format, ...)
 //-----------------------------------------------------------------------------
 void Log::Write(LogLevel _level, uint8 const _nodeId, char const* _format, ...)
 {
+	if (!IsEnabled(_level) && (_level != LogLevel_Internal))
+	{
+		return;
+	}
 	if (s_instance && s_dologging && (s_instance->m_pImpls.size() > 0))
 	{
 		if (_level != LogLevel_Internal)
@@ -282,12 +306,17 @@ void Log::SetLogFileName(const string &_filename)
 //	<Log::Log>
 //	Constructor
 //-----------------------------------------------------------------------------
-Log::Log(string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger) :
+Log::Log(string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger, bool const _bAsync) :
 		m_logMutex(new Internal::Platform::Mutex())
 {
 	if (m_pImpls.size() == 0)
 	{
+#if defined WIN32 || defined WINRT
+		// These always write on the caller's thread
 		m_pImpls.push_back(new Internal::Platform::LogImpl(_filename, _bAppend, _bConsoleOutput, _saveLevel, _queueLevel, _dumpTrigger));
+#else
+		m_pImpls.push_back(new Internal::Platform::LogImpl(_filename, _bAppend, _bConsoleOutput, _saveLevel, _queueLevel, _dumpTrigger, _bAsync));
+#endif
 	}
 }
 
@@ -100,10 +100,13 @@ namespace OpenZWave
 			 *
 			 * Creates the cross-platform logging singleton.
 			 * Any previous log will be cleared.
+			 * \param _bAsync format and write the messages on a thread of their own, so that callers only
+			 * pay for formatting the message text.  Only supported on Unix, elsewhere messages are always written
+			 * by the caller.
 			 * \return a pointer to the logging object.
 			 * \see Destroy, Write
 			 */
-			static Log* Create(string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger);
+			static Log* Create(string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger, bool const _bAsync = false);
 
 			/** \brief Create a log.
 			 *
@@ -164,6 +167,13 @@ namespace OpenZWave
 			 */
 			static void GetLoggingState(LogLevel* _saveLevel, LogLevel* _queueLevel, LogLevel* _dumpTrigger);
 
+			/**\brief Determine whether messages of a given level are written or queued.
+			 *
+			 * Lets callers skip formatting expensive log arguments that would be thrown away.
+			 * \param _level	LogLevel of the message
+			 */
+			static bool IsEnabled(LogLevel _level);
+
 			/** \brief Change the log file name.
 			 *
 			 * This will start a new log file (or potentially start appending
@@ -204,7 +214,7 @@ namespace OpenZWave
 			static void QueueClear();
 
 		private:
-			Log(string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel _saveLevel, LogLevel _queueLevel, LogLevel _dumpTrigger);
+			Log(string const& _filename, bool const _bAppend, bool const _bConsoleOutput, LogLevel _saveLevel, LogLevel _queueLevel, LogLevel _dumpTrigger, bool const _bAsync);
 			~Log();
 
 			static std::vector<i_LogImpl*> m_pImpls; /**< Pointer to an object that encapsulates the platform-specific logging implementation. */
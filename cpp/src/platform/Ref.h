@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <atomic>
 #include "Defs.h"
 
 namespace OpenZWave
@@ -60,6 +61,14 @@ namespace OpenZWave
 						m_refs = 1;
 					}
 
+					/**
+					 * A copy is a new object, so it starts with a single reference too.
+					 */
+					Ref(Ref const&)
+					{
+						m_refs = 1;
+					}
+
 					/**
 					 * Increases the reference count of the object.
 					 * Every call to AddRef requires a matching call
@@ -79,12 +88,13 @@ namespace OpenZWave
 					 */
 					int32 Release()
 					{
-						if (0 >= (--m_refs))
+						int32 refs = --m_refs;
+						if (0 >= refs)
 						{
 							delete this;
 							return 0;
 						}
-						return m_refs;
+						return refs;
 					}
 
 				protected:
@@ -93,8 +103,9 @@ namespace OpenZWave
 					}
 
 				private:
-					// Reference counting
-					int32 m_refs;
+					// Reference counting.  Atomic, as threads holding a shared lock
+					// add and release references to the same objects.
+					std::atomic<int32> m_refs;
 
 			};
 		// class Ref
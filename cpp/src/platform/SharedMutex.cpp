@@ -0,0 +1,271 @@
+//-----------------------------------------------------------------------------
+//
+//	SharedMutex.cpp
+//
+//	Cross-platform reader/writer lock
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+#include "Defs.h"
+#include "platform/SharedMutex.h"
+#include "platform/Log.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+			thread_local std::vector<SharedMutex::Hold> SharedMutex::s_holds;
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::SharedMutex>
+//	Constructor
+//-----------------------------------------------------------------------------
+			SharedMutex::SharedMutex() :
+					m_state(0), m_locked(false)
+			{
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::~SharedMutex>
+//	Destructor
+//-----------------------------------------------------------------------------
+			SharedMutex::~SharedMutex()
+			{
+				if (m_state != 0)
+				{
+					Log::Write(LogLevel_Error, "SharedMutex::~SharedMutex - Destroying a Locked SharedMutex: 0x%.8x", m_state.load());
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::GetHold>
+//	The calling thread's hold on this lock, or NULL if it has none
+//-----------------------------------------------------------------------------
+			SharedMutex::Hold* SharedMutex::GetHold(bool _create)
+			{
+				Hold* freeHold = NULL;
+				for (std::vector<Hold>::iterator it = s_holds.begin(); it != s_holds.end(); ++it)
+				{
+					if (!it->m_shared && !it->m_exclusive)
+					{
+						freeHold = &*it;
+					}
+					else if (it->m_mutex == this)
+					{
+						return &*it;
+					}
+				}
+
+				if (!_create)
+				{
+					return NULL;
+				}
+				if (!freeHold)
+				{
+					s_holds.push_back(Hold());
+					freeHold = &s_holds.back();
+				}
+				freeHold->m_mutex = this;
+				freeHold->m_shared = 0;
+				freeHold->m_exclusive = 0;
+				return freeHold;
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::Lock>
+//	Take the lock exclusively
+//-----------------------------------------------------------------------------
+			bool SharedMutex::Lock(bool const _bWait)
+			{
+				Hold* hold = GetHold(false);
+				if (hold && hold->m_exclusive)
+				{
+					++hold->m_exclusive;
+					return true;
+				}
+
+				if (hold && hold->m_shared)
+				{
+					// Upgrading would mean letting go of the shared lock while other readers leave, and
+					// anything the caller borrowed under it could be freed by a writer that gets in first
+					Log::Write(LogLevel_Error, "SharedMutex::Lock - Taking an exclusive lock that is already held shared");
+					return false;
+				}
+
+				if (!_bWait)
+				{
+					uint32 state = 0;
+					if (!m_state.compare_exchange_strong(state, c_writer))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					// Wait our turn behind any other writer, then for the readers to leave
+					uint32 state = m_state.load();
+					while (true)
+					{
+						if (state & c_writer)
+						{
+							m_cond.wait(lock);
+							state = m_state.load();
+						}
+						else if (m_state.compare_exchange_weak(state, state | c_writer))
+						{
+							break;
+						}
+					}
+					while (m_state.load() != c_writer)
+					{
+						m_cond.wait(lock);
+					}
+				}
+
+				m_locked = true;
+				GetHold(true)->m_exclusive = 1;
+				return true;
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::Unlock>
+//	Release an exclusive lock
+//-----------------------------------------------------------------------------
+			void SharedMutex::Unlock()
+			{
+				Hold* hold = GetHold(false);
+				if (!hold)
+				{
+					Log::Write(LogLevel_Error, "SharedMutex::Unlock - MisMatched Lock/Release Pair");
+				}
+				else if (!hold->m_exclusive)
+				{
+					Log::Write(LogLevel_Error, "SharedMutex::Unlock - Releasing an exclusive lock that is held shared");
+				}
+				else if (!--hold->m_exclusive)
+				{
+					ReleaseExclusive();
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::LockShared>
+//	Take the lock shared
+//-----------------------------------------------------------------------------
+			void SharedMutex::LockShared()
+			{
+				if (Hold* hold = GetHold(false))
+				{
+					// Either we already read, or we already have it exclusively
+					if (hold->m_exclusive)
+					{
+						++hold->m_exclusive;
+					}
+					else
+					{
+						++hold->m_shared;
+					}
+					return;
+				}
+
+				uint32 state = m_state.load();
+				if ((state & c_writer) || !m_state.compare_exchange_strong(state, state + 1))
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					state = m_state.load();
+					while (true)
+					{
+						if (state & c_writer)
+						{
+							m_cond.wait(lock);
+							state = m_state.load();
+						}
+						else if (m_state.compare_exchange_weak(state, state + 1))
+						{
+							break;
+						}
+					}
+				}
+				GetHold(true)->m_shared = 1;
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::UnlockShared>
+//	Release a shared lock
+//-----------------------------------------------------------------------------
+			void SharedMutex::UnlockShared()
+			{
+				Hold* hold = GetHold(false);
+				if (!hold)
+				{
+					Log::Write(LogLevel_Error, "SharedMutex::UnlockShared - MisMatched Lock/Release Pair");
+				}
+				else if (hold->m_exclusive)
+				{
+					// A shared lock taken while holding the exclusive lock
+					if (!--hold->m_exclusive)
+					{
+						ReleaseExclusive();
+					}
+				}
+				else if (!--hold->m_shared)
+				{
+					ReleaseShared();
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::ReleaseExclusive>
+//	Let the waiting readers and writers in
+//-----------------------------------------------------------------------------
+			void SharedMutex::ReleaseExclusive()
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_locked = false;
+				m_state &= ~c_writer;
+				m_cond.notify_all();
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::ReleaseShared>
+//	Drop our reader count, waking a writer if we were the last reader it waits for
+//-----------------------------------------------------------------------------
+			void SharedMutex::ReleaseShared()
+			{
+				if (--m_state == c_writer)
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_cond.notify_all();
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<SharedMutex::IsSignalled>
+//	Test whether the lock is free
+//-----------------------------------------------------------------------------
+			bool SharedMutex::IsSignalled()
+			{
+				return !m_locked && !(m_state & ~c_writer);
+			}
+		} // namespace Platform
+	} // namespace Internal
+} // namespace OpenZWave
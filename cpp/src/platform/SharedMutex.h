@@ -0,0 +1,134 @@
+//-----------------------------------------------------------------------------
+//
+//	SharedMutex.h
+//
+//	Cross-platform reader/writer lock
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+#ifndef _SharedMutex_H
+#define _SharedMutex_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include "Defs.h"
+#include "platform/Ref.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+			/** \brief A reader/writer lock.  Any number of threads may hold it shared, or one thread exclusively.
+			 *
+			 * The exclusive lock behaves like a recursive Mutex, so a SharedMutex can stand in for one.
+			 * Shared locks may be nested too, and a thread holding the exclusive lock may take shared
+			 * locks.  Taking an uncontended shared lock is a single atomic operation.  A waiting writer
+			 * holds off new readers, so a stream of readers cannot starve it.
+			 * A shared lock cannot be upgraded: asking for the exclusive lock while holding a shared
+			 * one is an error, and Lock returns false.
+			 * \ingroup Platform
+			 */
+			class SharedMutex: public Ref
+			{
+				public:
+					/**
+					 * Constructor.
+					 * Creates a reader/writer lock, initially free.
+					 */
+					SharedMutex();
+
+					/**
+					 * Take the lock exclusively.
+					 * There must be a matching call to Unlock for every call to Lock.
+					 * \param _bWait Defaults to true.  Set this argument to false if the method should return
+					 * immediately, even if the lock is not available.
+					 * \return True if the lock was obtained, or false if it was not available or the
+					 * calling thread holds it shared.
+					 * \see Unlock
+					 */
+					bool Lock(bool const _bWait = true);
+
+					/**
+					 * Releases an exclusive lock.
+					 * \see Lock
+					 */
+					void Unlock();
+
+					/**
+					 * Take the lock shared, alongside any other readers.
+					 * There must be a matching call to UnlockShared for every call to LockShared.
+					 * \see UnlockShared
+					 */
+					void LockShared();
+
+					/**
+					 * Releases a shared lock.
+					 * \see LockShared
+					 */
+					void UnlockShared();
+
+					/**
+					 * Test whether the lock is free, with no readers or writer.
+					 */
+					bool IsSignalled();
+
+				protected:
+					/**
+					 * Destructor.
+					 * Destroys the lock.
+					 */
+					virtual ~SharedMutex();
+
+				private:
+					SharedMutex(SharedMutex const&);					// prevent copy
+					SharedMutex& operator =(SharedMutex const&);		// prevent assignment
+
+					// A lock held by the calling thread.  Nested locks only count here,
+					// so they never queue behind a waiting writer.
+					struct Hold
+					{
+							SharedMutex* m_mutex;
+							int32 m_shared;
+							int32 m_exclusive;
+					};
+					static thread_local std::vector<Hold> s_holds;
+
+					Hold* GetHold(bool _create);
+					void ReleaseExclusive();
+					void ReleaseShared();
+
+					// Readers are counted in m_state.  The writer bit stops new readers from
+					// taking the lock while a writer waits for the current ones to leave.
+					static uint32 const c_writer = 0x40000000;
+
+					std::atomic<uint32> m_state;
+					std::atomic<bool> m_locked;						// held exclusively
+					std::mutex m_mutex;								// for waiting on m_cond
+					std::condition_variable m_cond;
+			};
+		} // namespace Platform
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif //_SharedMutex_H
+
@@ -26,11 +26,9 @@
 //
 //-----------------------------------------------------------------------------
 #include "platform/Stream.h"
-#include "platform/Mutex.h"
 #include "platform/Log.h"
 
 #include <string.h>
-
 #include <cstdio>
 
 namespace OpenZWave
@@ -45,8 +43,13 @@ namespace OpenZWave
 //	Constructor
 //-----------------------------------------------------------------------------
 			Stream::Stream(uint32 _bufferSize) :
-					m_bufferSize(_bufferSize), m_signalSize(1), m_dataSize(0), m_head(0), m_tail(0), m_mutex(new Mutex())
+					m_bufferSize(1), m_signalSize(1), m_head(0), m_tail(0)
 			{
+				while (m_bufferSize < _bufferSize)
+				{
+					m_bufferSize <<= 1;
+				}
+				m_mask = m_bufferSize - 1;
 				m_buffer = new uint8[m_bufferSize];
 				memset(m_buffer, 0x00, m_bufferSize);
 			}
@@ -57,7 +60,6 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			Stream::~Stream()
 			{
-				m_mutex->Release();
 				delete[] m_buffer;
 			}
 
@@ -67,7 +69,7 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			void Stream::SetSignalThreshold(uint32 _size)
 			{
-				m_signalSize = _size;
+				m_signalSize.store(_size, std::memory_order_release);
 				if (IsSignalled())
 				{
 					// We have more data than we are waiting for, so notify the watchers
@@ -81,36 +83,69 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			bool Stream::Get(uint8* _buffer, uint32 _size)
 			{
-				if (m_dataSize < _size)
+				if (GetDataSize() < _size)
 				{
 					// There is not enough data in the buffer to fulfill the request
 					Log::Write(LogLevel_Error, "ERROR: Not enough data in stream buffer");
 					return false;
 				}
+				GetAvailable(_buffer, _size);
+				return true;
+			}
 
-				m_mutex->Lock();
-				if ((m_tail + _size) > m_bufferSize)
+//-----------------------------------------------------------------------------
+//	<Stream::GetAvailable>
+//	Remove up to _maxSize bytes of data from the buffer
+//-----------------------------------------------------------------------------
+			uint32 Stream::GetAvailable(uint8* _buffer, uint32 _maxSize)
+			{
+				// At most two spans, if the data wraps around the end of the buffer
+				uint32 size = 0;
+				while (size < _maxSize)
 				{
-					// We will have to wrap around
-					uint32 block1 = m_bufferSize - m_tail;
-					uint32 block2 = _size - block1;
-
-					memcpy(_buffer, &m_buffer[m_tail], block1);
-					memcpy(&_buffer[block1], m_buffer, block2);
-					m_tail = block2;
+					uint8 const* data;
+					uint32 block = Peek(&data);
+					if (!block)
+					{
+						break;
+					}
+					if (block > (_maxSize - size))
+					{
+						block = _maxSize - size;
+					}
+					memcpy(&_buffer[size], data, block);
+					Consume(block);
+					size += block;
 				}
-				else
+				LogData(_buffer, size, "      Read (buffer->application): ");
+				return size;
+			}
+
+//-----------------------------------------------------------------------------
+//	<Stream::Peek>
+//	Return the contiguous data at the front of the buffer
+//-----------------------------------------------------------------------------
+			uint32 Stream::Peek(uint8 const** o_data)
+			{
+				uint32 tail = m_tail.load(std::memory_order_relaxed);
+				uint32 size = m_head.load(std::memory_order_acquire) - tail;
+				uint32 pos = tail & m_mask;
+				if (size > (m_bufferSize - pos))
 				{
-					// Requested data is in a contiguous block
-					memcpy(_buffer, &m_buffer[m_tail], _size);
-					m_tail += _size;
+					size = m_bufferSize - pos;
 				}
+				*o_data = &m_buffer[pos];
+				return size;
+			}
 
-				LogData(_buffer, _size, "      Read (buffer->application): ");
-
-				m_dataSize -= _size;
-				m_mutex->Unlock();
-				return true;
+//-----------------------------------------------------------------------------
+//	<Stream::Consume>
+//	Remove data returned by Peek from the buffer
+//-----------------------------------------------------------------------------
+			void Stream::Consume(uint32 _size)
+			{
+				// Release, so the producer cannot overwrite the data before we are done with it
+				m_tail.store(m_tail.load(std::memory_order_relaxed) + _size, std::memory_order_release);
 			}
 
 //-----------------------------------------------------------------------------
@@ -119,44 +154,36 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			bool Stream::Put(uint8* _buffer, uint32 _size)
 			{
-				if ((m_bufferSize - m_dataSize) < _size)
+				uint32 head = m_head.load(std::memory_order_relaxed);
+				if ((m_bufferSize - (head - m_tail.load(std::memory_order_acquire))) < _size)
 				{
 					// There is not enough space left in the buffer for the data
 					Log::Write(LogLevel_Error, "ERROR: Not enough space in stream buffer");
 					return false;
 				}
 
-				m_mutex->Lock();
-				if ((m_head + _size) > m_bufferSize)
+				uint32 pos = head & m_mask;
+				uint32 block1 = m_bufferSize - pos;
+				if (_size > block1)
 				{
 					// We will have to wrap around
-					uint32 block1 = m_bufferSize - m_head;
-					uint32 block2 = _size - block1;
-
-					memcpy(&m_buffer[m_head], _buffer, block1);
-					memcpy(m_buffer, &_buffer[block1], block2);
-					uint8 * logpos = m_buffer + m_head;
-					m_head = block2;
-					LogData(logpos, block1, "      Read (controller->buffer):  ");
-					LogData(m_buffer, block2, "      Read (controller->buffer):  ");
+					memcpy(&m_buffer[pos], _buffer, block1);
+					memcpy(m_buffer, &_buffer[block1], _size - block1);
 				}
 				else
 				{
 					// There is enough space before we reach the end of the buffer
-					memcpy(&m_buffer[m_head], _buffer, _size);
-					m_head += _size;
-					LogData(m_buffer + m_head - _size, _size, "      Read (controller->buffer):  ");
+					memcpy(&m_buffer[pos], _buffer, _size);
 				}
+				LogData(_buffer, _size, "      Read (controller->buffer):  ");
 
-				m_dataSize += _size;
-
+				// Publish the data to the consumer
+				m_head.store(head + _size, std::memory_order_release);
 				if (IsSignalled())
 				{
 					// We now have more data than we are waiting for, so notify the watchers
 					Notify();
 				}
-
-				m_mutex->Unlock();
 				return true;
 			}
 
@@ -166,9 +193,7 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			void Stream::Purge()
 			{
-				m_tail = 0;
-				m_head = 0;
-				m_dataSize = 0;
+				m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
 			}
 
 //-----------------------------------------------------------------------------
@@ -177,18 +202,17 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			bool Stream::IsSignalled()
 			{
-				return (m_dataSize >= m_signalSize);
+				return (GetDataSize() >= m_signalSize.load(std::memory_order_acquire));
 			}
 
 //-----------------------------------------------------------------------------
 //	<Stream::LogData>
 //	Format the stream buffer data for log output
 //-----------------------------------------------------------------------------
-			void Stream::LogData(uint8* _buffer, uint32 _length, const string &_function)
+			void Stream::LogData(uint8 const* _buffer, uint32 _length, const string &_function)
 			{
-				if (!_length)
+				if (!_length || !Log::IsEnabled(LogLevel_StreamDetail))
 					return;
-
 				string str = "";
 				for (uint32 i = 0; i < _length; ++i)
 				{
@@ -196,7 +220,6 @@ namespace OpenZWave
 					{
 						str += ", ";
 					}
-
 					char byteStr[8];
 					snprintf(byteStr, sizeof(byteStr), "0x%.2x", _buffer[i]);
 					str += byteStr;
@@ -32,6 +32,7 @@
 #include "platform/Wait.h"
 
 #include <string>
+#include <atomic>
 
 namespace OpenZWave
 {
@@ -39,9 +40,13 @@ namespace OpenZWave
 	{
 		namespace Platform
 		{
-			class Mutex;
-
 			/** \brief Platform-independent definition of a circular buffer.
+			 *
+			 * The buffer has a single producer (the controller's reader thread, which calls Put)
+			 * and a single consumer (the driver thread, which calls everything else).  Under that
+			 * rule it needs no lock: the producer only moves the head index and the consumer only
+			 * moves the tail index.  The two indices are kept on separate cache lines so that the
+			 * threads do not keep stealing the same line from each other.
 			 * \ingroup Platform
 			 */
 			class Stream: public Wait
@@ -52,6 +57,7 @@ namespace OpenZWave
 					/**
 					 * Constructor.
 					 * Creates a cross-platform ring buffer object
+					 * \param _bufferSize minimum size of the buffer.  It is rounded up to a power of two.
 					 */
 					Stream(uint32 _bufferSize);
 
@@ -75,6 +81,33 @@ namespace OpenZWave
 					 */
 					bool Get(uint8* _buffer, uint32 _size);
 
+					/**
+					 * Copies as much data as is available, up to _maxSize bytes, from the stream, removing it from
+					 * the stream as it does so.  Lets a reader take several messages in one call.
+					 * \param _buffer pointer to a block of memory that will be filled with the stream data.
+					 * \param _maxSize the size of the block of memory.
+					 * \return the number of bytes copied, which is zero if the stream is empty.
+					 * \see Get, GetDataSize
+					 */
+					uint32 GetAvailable(uint8* _buffer, uint32 _maxSize);
+
+					/**
+					 * Returns the data at the front of the stream in place, without removing it.  The data
+					 * may wrap around the end of the buffer, in which case only the first part is returned,
+					 * and the rest follows once that part has been consumed.
+					 * \param o_data set to point at the data.  It stays valid until the data is consumed.
+					 * \return the number of contiguous bytes at o_data, which is zero if the stream is empty.
+					 * \see Consume
+					 */
+					uint32 Peek(uint8 const** o_data);
+
+					/**
+					 * Removes data returned by Peek from the stream.
+					 * \param _size the amount of data in bytes to remove.  Must not be more than Peek returned.
+					 * \see Peek
+					 */
+					void Consume(uint32 _size);
+
 					/**
 					 * Copies the requested amount of data from the buffer into the stream.
 					 * If there is insufficient room available in the stream's circular buffer, and no data is transferred.
@@ -93,7 +126,7 @@ namespace OpenZWave
 					 */
 					uint32 GetDataSize() const
 					{
-						return m_dataSize;
+						return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
 					}
 
 					/**
@@ -110,7 +143,7 @@ namespace OpenZWave
 					 * \param _size number of valid bytes currently in the buffer
 					 * \param _function string containing text to display before the data
 					 */
-					void LogData(uint8* _buffer, uint32 _size, const string &_function);
+					void LogData(uint8 const* _buffer, uint32 _size, const string &_function);
 
 					/**
 					 * Used by the Wait class to test whether the buffer contains sufficient data.
@@ -127,13 +160,22 @@ namespace OpenZWave
 					Stream(Stream const&);					// prevent copy
 					Stream& operator =(Stream const&);		// prevent assignment
 
+					enum
+					{
+						CacheLineSize = 64
+					};
+
 					uint8* m_buffer;
-					uint32 m_bufferSize;
-					uint32 m_signalSize;
-					uint32 m_dataSize;
-					uint32 m_head;
-					uint32 m_tail;
-					Mutex* m_mutex;
+					uint32 m_bufferSize;					// always a power of two
+					uint32 m_mask;
+					std::atomic<uint32> m_signalSize;
+
+					// The indices run freely and are masked on use, so head - tail is the amount of data
+					uint8 m_pad1[CacheLineSize];
+					std::atomic<uint32> m_head;				// Only written by the producer
+					uint8 m_pad2[CacheLineSize];
+					std::atomic<uint32> m_tail;				// Only written by the consumer
+					uint8 m_pad3[CacheLineSize];
 			};
 		} // namespace Platform
 	} // namespace Internal
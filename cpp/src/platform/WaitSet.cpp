@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+//
+//	WaitSet.cpp
+//
+//	A fixed set of Wait objects that a single thread waits on repeatedly
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+#include "Defs.h"
+#include "platform/Wait.h"
+#include "platform/WaitSet.h"
+
+#ifdef WIN32
+#include "platform/windows/WaitSetImpl.h"	// Platform-specific implementation of a WaitSet
+#elif defined WINRT
+#include "platform/winRT/WaitSetImpl.h"	// Platform-specific implementation of a WaitSet
+#else
+#include "platform/unix/WaitSetImpl.h"	// Platform-specific implementation of a WaitSet
+#endif
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+
+//-----------------------------------------------------------------------------
+//	<WaitSet::WaitSet>
+//	Constructor
+//-----------------------------------------------------------------------------
+			WaitSet::WaitSet(Wait** _objects, uint32 _numObjects) :
+					m_objects(_objects), m_numObjects(_numObjects), m_pImpl(new WaitSetImpl())
+			{
+				// The watchers stay in place until the set is destroyed.  They may be
+				// called straight away, so the impl has to exist first.
+				for (uint32 i = 0; i < m_numObjects; ++i)
+				{
+					m_objects[i]->AddWatcher(WaitSetCallback, this);
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSet::~WaitSet>
+//	Destructor
+//-----------------------------------------------------------------------------
+			WaitSet::~WaitSet()
+			{
+				for (uint32 i = 0; i < m_numObjects; ++i)
+				{
+					m_objects[i]->RemoveWatcher(WaitSetCallback, this);
+				}
+				delete m_pImpl;
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSet::Select>
+//	Wait for one of the first _numObjects objects to become signalled
+//-----------------------------------------------------------------------------
+			int32 WaitSet::Select(uint32 _numObjects, int32 _timeout // = -1
+					)
+			{
+				if (_numObjects > m_numObjects)
+				{
+					_numObjects = m_numObjects;
+				}
+
+				m_pImpl->Arm(_timeout);
+				while (true)
+				{
+					// Any object signalled after this scan has also woken the impl,
+					// so the wait below returns straight away rather than missing it.
+					for (uint32 i = 0; i < _numObjects; ++i)
+					{
+						if (m_objects[i]->IsSignalled())
+						{
+							return (int32) i;
+						}
+					}
+
+					// Wakeups from objects beyond _numObjects just go round the loop again
+					if (!m_pImpl->Wait())
+					{
+						return -1;
+					}
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSet::WaitSetCallback>
+//	Called by the watched objects when they become signalled
+//-----------------------------------------------------------------------------
+			void WaitSet::WaitSetCallback(void* _context)
+			{
+				WaitSet* waitSet = (WaitSet*) _context;
+				waitSet->m_pImpl->Wake();
+			}
+		} // namespace Platform
+	} // namespace Internal
+} // namespace OpenZWave
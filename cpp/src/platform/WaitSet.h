@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+//
+//	WaitSet.h
+//
+//	A fixed set of Wait objects that a single thread waits on repeatedly
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+#ifndef _WaitSet_H
+#define _WaitSet_H
+
+#include "Defs.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+			class Wait;
+			class WaitSetImpl;
+
+			/** \brief A set of Wait objects that is waited on over and over by one thread.
+			 *
+			 * Wait::Multiple creates an Event and adds and removes a watcher on every object
+			 * each time it is called. A WaitSet registers its watchers once, for the lifetime
+			 * of the set, and the watchers only wake the waiting thread. On Linux the wakeup is
+			 * an eventfd and the timeout a timerfd, both in an epoll set.
+			 * \ingroup Platform
+			 */
+			class OPENZWAVE_EXPORT WaitSet
+			{
+				public:
+					/**
+					 * Constructor.
+					 * \param _objects array of pointers to the objects to wait on. The array must outlive the WaitSet.
+					 * \param _numObjects number of objects in the array.
+					 */
+					WaitSet(Wait** _objects, uint32 _numObjects);
+					~WaitSet();
+
+					/**
+					 * Wait for one of the first _numObjects objects of the set to become signalled.  If more
+					 * than one object is in a signalled state, the lowest array index will be returned.
+					 * \param _numObjects number of objects, from the start of the array, to wait on.
+					 * \param _timeout optional maximum time to wait.  Defaults to -1, which means wait forever.
+					 * \return index into the array of the object that was signalled, -1 if the wait timed out.
+					 * \see Wait::Multiple
+					 */
+					int32 Select(uint32 _numObjects, int32 _timeout = -1);
+
+				private:
+					WaitSet(WaitSet const&);					// prevent copy
+					WaitSet& operator =(WaitSet const&);		// prevent assignment
+
+					static void WaitSetCallback(void* _context);
+
+					Wait** m_objects;
+					uint32 m_numObjects;
+					WaitSetImpl* m_pImpl;						// Pointer to an object that encapsulates the platform-specific implementation of a WaitSet.
+			};
+		} // namespace Platform
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif //_WaitSet_H
+
@@ -30,6 +30,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <libgen.h>
 #include <iostream>
 #include <fstream>
@@ -174,6 +175,46 @@ namespace OpenZWave
 				Log::Write(LogLevel_Warning, "Create Directory Failed: %s - %s", _dirname.c_str(), strerror(errno));
 				return false;
 			}
+
+//-----------------------------------------------------------------------------
+//	<FileOpsImpl::FileMap>
+//	Map a file read-only into memory
+//-----------------------------------------------------------------------------
+			uint8 const* FileOpsImpl::FileMap(const string _filename, size_t* o_size)
+			{
+				int fd = open(_filename.c_str(), O_RDONLY);
+				if (fd < 0)
+				{
+					return NULL;
+				}
+				struct stat st;
+				if (fstat(fd, &st) != 0 || st.st_size == 0)
+				{
+					close(fd);
+					return NULL;
+				}
+				void* data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				close(fd);
+				if (data == MAP_FAILED)
+				{
+					Log::Write(LogLevel_Warning, "mmap of %s failed: %s", _filename.c_str(), strerror(errno));
+					return NULL;
+				}
+				*o_size = (size_t) st.st_size;
+				return (uint8 const*) data;
+			}
+
+//-----------------------------------------------------------------------------
+//	<FileOpsImpl::FileUnmap>
+//	Release a mapping created by FileMap
+//-----------------------------------------------------------------------------
+			void FileOpsImpl::FileUnmap(uint8 const* _data, size_t _size)
+			{
+				if (_data)
+				{
+					munmap((void*) _data, _size);
+				}
+			}
 		} // namespace Platform
 	} // namespace Internal
 } // namespace OpenZWave
@@ -27,6 +27,7 @@
 //-----------------------------------------------------------------------------
 #include <string>
 #include <cstring>
+#include <algorithm>
 #include <pthread.h>
 #include <iostream>
 #include "Defs.h"
@@ -43,14 +44,14 @@ namespace OpenZWave
 //	<LogImpl::LogImpl>
 //	Constructor
 //-----------------------------------------------------------------------------
-			LogImpl::LogImpl(string const& _filename, bool const _bAppendLog, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger) :
+			LogImpl::LogImpl(string const& _filename, bool const _bAppendLog, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger, bool const _bAsync) :
 					m_filename(_filename),					// name of log file
 					m_bConsoleOutput(_bConsoleOutput),		// true to provide a copy of output to console
 					m_bAppendLog(_bAppendLog),				// true to append (and not overwrite) any existing log
 					m_saveLevel(_saveLevel),					// level of messages to log to file
 					m_queueLevel(_queueLevel),				// level of messages to log to queue
 					m_dumpTrigger(_dumpTrigger),				// dump queued messages when this level is seen
-					pFile( NULL)
+					pFile( NULL), m_queueText(new char[QueueTextSize]), m_queueTextPos(0), m_queueFirst(0), m_queueCount(0), m_bAsync(_bAsync), m_ring(NULL), m_head(0), m_tail(0), m_writerIdle(false), m_callerWaiting(false), m_exit(false)
 			{
 				if (!m_filename.empty())
 				{
@@ -72,6 +73,16 @@ namespace OpenZWave
 					}
 				}
 				setlinebuf(stdout);	// To prevent buffering and lock contention issues
+
+				if (m_bAsync)
+				{
+					m_ring = new Record[RingSize];
+					for (uint32 i = 0; i < RingSize; ++i)
+					{
+						m_ring[i].m_seq = i;
+					}
+					m_writerThread = std::thread(&LogImpl::WriterThreadProc, this);
+				}
 			}
 
 //-----------------------------------------------------------------------------
@@ -80,6 +91,18 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			LogImpl::~LogImpl()
 			{
+				if (m_bAsync)
+				{
+					// The writer thread finishes what is in the ring before it exits
+					{
+						std::unique_lock<std::mutex> lock(m_waitMutex);
+						m_exit = true;
+						m_writerCond.notify_one();
+					}
+					m_writerThread.join();
+					delete[] m_ring;
+				}
+				delete[] m_queueText;
 				if (this->pFile)
 					fclose(this->pFile);
 			}
@@ -133,87 +156,251 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			void LogImpl::Write(LogLevel _logLevel, uint8 const _nodeId, char const* _format, va_list _args)
 			{
-				// create a timestamp string
-				string timeStr = GetTimeStampString();
-				string nodeStr = GetNodeString(_nodeId);
-				string loglevelStr = GetLogLevelString(_logLevel);
+				bool internal = (_logLevel == LogLevel_Internal);
+				bool handle = (_logLevel <= m_queueLevel) || internal;	// we're going to do something with this message...
+				bool dump = (_logLevel <= m_dumpTrigger) && !internal && (_logLevel != LogLevel_Always);
+				if (!handle && !dump)
+				{
+					return;
+				}
 
-				// handle this message
-				if ((_logLevel <= m_queueLevel) || (_logLevel == LogLevel_Internal))	// we're going to do something with this message...
+				Record local;
+				Record* record = m_bAsync ? NULL : &local;
+				uint32 pos = 0;
+				if (m_bAsync)
 				{
-					char lineBuf[1024] =
-					{ 0 };
-					//int lineLen = 0;
-					if (_format != NULL && _format[0] != '\0')
-					{
-						va_list saveargs;
-						va_copy(saveargs, _args);
+					record = Claim(&pos);
+				}
 
-						vsnprintf(lineBuf, sizeof(lineBuf), _format, _args);
-						va_end(saveargs);
+				record->m_type = Record_Message;
+				record->m_level = _logLevel;
+				record->m_nodeId = _nodeId;
+				record->m_save = handle && ((_logLevel <= m_saveLevel) || internal);
+				record->m_queue = handle && !internal;
+				record->m_dump = dump;
+				gettimeofday(&record->m_time, NULL);
+				record->m_thread = pthread_self();
+				record->m_text[0] = 0;
+				if (handle && (_format != NULL) && (_format[0] != '\0'))
+				{
+					vsnprintf(record->m_text, sizeof(record->m_text), _format, _args);
+				}
+
+				if (m_bAsync)
+				{
+					Publish(record, pos);
+				}
+				else
+				{
+					Process(record);
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<LogImpl::Claim>
+//	Take the next free record in the ring, waiting for the writer thread to
+//	make room if there is none
+//-----------------------------------------------------------------------------
+			LogImpl::Record* LogImpl::Claim(uint32* _pos)
+			{
+				uint32 pos = m_head.load(std::memory_order_relaxed);
+				while (true)
+				{
+					Record* record = &m_ring[pos & (RingSize - 1)];
+					int32 lap = (int32) (record->m_seq.load(std::memory_order_acquire) - pos);
+					if (lap == 0)
+					{
+						// Free.  Take it, unless another thread got there first.
+						if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						{
+							*_pos = pos;
+							return record;
+						}
+					}
+					else if (lap < 0)
+					{
+						// Still waiting to be written from the last time round
+						std::unique_lock<std::mutex> lock(m_waitMutex);
+						m_callerWaiting = true;
+						if ((int32) (record->m_seq.load() - pos) < 0)
+						{
+							m_spaceCond.wait_for(lock, std::chrono::milliseconds(10));
+						}
+						pos = m_head.load(std::memory_order_relaxed);
+					}
+					else
+					{
+						pos = m_head.load(std::memory_order_relaxed);
 					}
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<LogImpl::Publish>
+//	Hand a filled in record to the writer thread
+//-----------------------------------------------------------------------------
+			void LogImpl::Publish(Record* _record, uint32 _pos)
+			{
+				_record->m_seq.store(_pos + 1);
+				if (m_writerIdle.load())
+				{
+					std::unique_lock<std::mutex> lock(m_waitMutex);
+					m_writerCond.notify_one();
+				}
+			}
 
-					// should this message be saved to file (and possibly written to console?)
-					if ((_logLevel <= m_saveLevel) || (_logLevel == LogLevel_Internal))
+//-----------------------------------------------------------------------------
+//	<LogImpl::WriterThreadProc>
+//	Format and write out the records in the ring, in order
+//-----------------------------------------------------------------------------
+			void LogImpl::WriterThreadProc()
+			{
+				uint32 tail = m_tail.load(std::memory_order_relaxed);
+				while (true)
+				{
+					Record* record = &m_ring[tail & (RingSize - 1)];
+					if (record->m_seq.load(std::memory_order_acquire) == (tail + 1))
 					{
-						std::string outBuf;
+						Process(record);
+						record->m_seq.store(tail + RingSize);
+						m_tail.store(++tail, std::memory_order_relaxed);
+						if (m_callerWaiting.load())
+						{
+							std::unique_lock<std::mutex> lock(m_waitMutex);
+							m_callerWaiting = false;
+							m_spaceCond.notify_all();
+						}
+						continue;
+					}
 
-						if (this->pFile != NULL || m_bConsoleOutput)
+					// Nothing to do.  Callers only wake us once we say we are idle, so look again after that.
+					std::unique_lock<std::mutex> lock(m_waitMutex);
+					m_writerIdle = true;
+					if (record->m_seq.load() != (tail + 1))
+					{
+						if (m_exit)
 						{
-							if (_logLevel != LogLevel_Internal)						// don't add a second timestamp to display of queued messages
-							{
-								outBuf.append(timeStr);
-								outBuf.append(loglevelStr);
-								outBuf.append(nodeStr);
-								outBuf.append(lineBuf);
-								outBuf.append("\n");
-
-							}
-
-							// print message to file (and possibly screen)
-							if (this->pFile != NULL)
-							{
-								fputs(outBuf.c_str(), pFile);
-							}
-							if (m_bConsoleOutput)
-							{
-								fprintf(stdout, "\x1B[%02um", toEscapeCode(_logLevel));
-								fputs(outBuf.c_str(), stdout);
-								fprintf(stdout, "\x1b[39m");
-								/* always return to normal */
-								fprintf(stdout, "\x1B[%02um", toEscapeCode(LogLevel_Info));
-							}
+							return;
 						}
+						m_writerCond.wait_for(lock, std::chrono::milliseconds(100));
 					}
+					m_writerIdle = false;
+				}
+			}
 
-					if (_logLevel != LogLevel_Internal)
+//-----------------------------------------------------------------------------
+//	<LogImpl::Process>
+//	Format a record and write it to the file, the console and the queue
+//-----------------------------------------------------------------------------
+			void LogImpl::Process(Record const* _record)
+			{
+				switch (_record->m_type)
+				{
+					case Record_Dump:
+					{
+						DumpQueue();
+						return;
+					}
+					case Record_Clear:
+					{
+						m_queueCount = 0;
+						m_queueTextPos = 0;
+						return;
+					}
+				}
+
+				char line[LineSize + 64];
+				uint32 prefix = 0;
+				if (_record->m_level != LogLevel_Internal)
+				{
+					prefix = FormatTimeStamp(line, sizeof(line), _record->m_time);
+				}
+
+				// should this message be saved to file (and possibly written to console?)
+				if (_record->m_save && (this->pFile != NULL || m_bConsoleOutput))
+				{
+					// don't add a second timestamp to display of queued messages
+					char nodeBuf[20];
+					if (_record->m_level != LogLevel_Internal)
+					{
+						snprintf(&line[prefix], sizeof(line) - prefix, "%s%s%s\n", GetLogLevelString(_record->m_level), GetNodeString(nodeBuf, sizeof(nodeBuf), _record->m_nodeId), _record->m_text);
+					}
+					else
 					{
-						char queueBuf[1024];
-						string threadStr = GetThreadId();
-						snprintf(queueBuf, sizeof(queueBuf), "%s%s%s", timeStr.c_str(), threadStr.c_str(), lineBuf);
-						Queue(queueBuf);
+						snprintf(line, sizeof(line), "%s\n", _record->m_text);
 					}
+					Output(_record->m_level, line);
+				}
+
+				if (_record->m_queue)
+				{
+					int len = snprintf(&line[prefix], sizeof(line) - prefix, "%08lx %s", (long unsigned int) _record->m_thread, _record->m_text);
+					Queue(line, std::min(prefix + (uint32) std::max(len, 0), (uint32) sizeof(line) - 1));
 				}
 
 				// now check to see if the _dumpTrigger has been hit
-				if ((_logLevel <= m_dumpTrigger) && (_logLevel != LogLevel_Internal) && (_logLevel != LogLevel_Always))
-					QueueDump();
+				if (_record->m_dump)
+				{
+					DumpQueue();
+				}
 			}
 
 //-----------------------------------------------------------------------------
-//	<LogImpl::Queue>
-//	Write to the log queue
+//	<LogImpl::Output>
+//	Write a formatted line to the file, and possibly the console
 //-----------------------------------------------------------------------------
-			void LogImpl::Queue(char const* _buffer)
+			void LogImpl::Output(LogLevel _level, char const* _line)
 			{
-				string bufStr = _buffer;
-				m_logQueue.push_back(bufStr);
+				// print message to file (and possibly screen)
+				if (this->pFile != NULL)
+				{
+					fputs(_line, pFile);
+				}
+				if (m_bConsoleOutput)
+				{
+					fprintf(stdout, "\x1B[%02um", toEscapeCode(_level));
+					fputs(_line, stdout);
+					fprintf(stdout, "\x1b[39m");
+					/* always return to normal */
+					fprintf(stdout, "\x1B[%02um", toEscapeCode(LogLevel_Info));
+				}
+			}
 
-				// rudimentary queue size management
-				if (m_logQueue.size() > 500)
+//-----------------------------------------------------------------------------
+//	<LogImpl::Queue>
+//	Keep a message for QueueDump, forgetting the oldest ones to make room
+//-----------------------------------------------------------------------------
+			void LogImpl::Queue(char const* _line, uint32 _length)
+			{
+				uint32 size = _length + 1;
+				if ((m_queueTextPos + size) > QueueTextSize)
+				{
+					// Wrap round.  What is left beyond here is the oldest text.
+					while (m_queueCount && (m_queueStart[m_queueFirst] >= m_queueTextPos))
+					{
+						m_queueFirst = (m_queueFirst + 1) % QueueEntries;
+						--m_queueCount;
+					}
+					m_queueTextPos = 0;
+				}
+				while (m_queueCount && (m_queueStart[m_queueFirst] < (m_queueTextPos + size)) && ((m_queueStart[m_queueFirst] + m_queueLength[m_queueFirst]) > m_queueTextPos))
 				{
-					m_logQueue.pop_front();
+					m_queueFirst = (m_queueFirst + 1) % QueueEntries;
+					--m_queueCount;
 				}
+				if (m_queueCount == QueueEntries)
+				{
+					m_queueFirst = (m_queueFirst + 1) % QueueEntries;
+					--m_queueCount;
+				}
+
+				uint32 entry = (m_queueFirst + m_queueCount) % QueueEntries;
+				m_queueStart[entry] = m_queueTextPos;
+				m_queueLength[entry] = size;
+				memcpy(&m_queueText[m_queueTextPos], _line, _length);
+				m_queueText[m_queueTextPos + _length] = 0;
+				m_queueTextPos += size;
+				++m_queueCount;
 			}
 
 //-----------------------------------------------------------------------------
@@ -222,20 +409,50 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			void LogImpl::QueueDump()
 			{
-				Log::Write(LogLevel_Always, "");
-				Log::Write(LogLevel_Always, "Dumping queued log messages");
-				Log::Write(LogLevel_Always, "");
-				list<string>::iterator it = m_logQueue.begin();
-				while (it != m_logQueue.end())
+				if (!m_bAsync)
+				{
+					DumpQueue();
+					return;
+				}
+
+				// In order with the messages that are still in the ring
+				uint32 pos;
+				Record* record = Claim(&pos);
+				record->m_type = Record_Dump;
+				Publish(record, pos);
+			}
+
+//-----------------------------------------------------------------------------
+//	<LogImpl::DumpQueue>
+//	Write out the messages kept for QueueDump, and forget them
+//-----------------------------------------------------------------------------
+			void LogImpl::DumpQueue()
+			{
+				char line[128];
+				struct timeval now;
+				gettimeofday(&now, NULL);
+				uint32 prefix = FormatTimeStamp(line, sizeof(line), now);
+
+				snprintf(&line[prefix], sizeof(line) - prefix, "%s\n", GetLogLevelString(LogLevel_Always));
+				Output(LogLevel_Always, line);
+				snprintf(&line[prefix], sizeof(line) - prefix, "%sDumping queued log messages\n", GetLogLevelString(LogLevel_Always));
+				Output(LogLevel_Always, line);
+				snprintf(&line[prefix], sizeof(line) - prefix, "%s\n", GetLogLevelString(LogLevel_Always));
+				Output(LogLevel_Always, line);
+				for (uint32 i = 0; i < m_queueCount; ++i)
 				{
-					string strTemp = *it;
-					Log::Write(LogLevel_Internal, strTemp.c_str());
-					it++;
+					char const* text = &m_queueText[m_queueStart[(m_queueFirst + i) % QueueEntries]];
+					Output(LogLevel_Internal, text);
+					Output(LogLevel_Internal, "\n");
 				}
-				m_logQueue.clear();
-				Log::Write(LogLevel_Always, "");
-				Log::Write(LogLevel_Always, "End of queued log message dump");
-				Log::Write(LogLevel_Always, "");
+				m_queueCount = 0;
+				m_queueTextPos = 0;
+				snprintf(&line[prefix], sizeof(line) - prefix, "%s\n", GetLogLevelString(LogLevel_Always));
+				Output(LogLevel_Always, line);
+				snprintf(&line[prefix], sizeof(line) - prefix, "%sEnd of queued log message dump\n", GetLogLevelString(LogLevel_Always));
+				Output(LogLevel_Always, line);
+				snprintf(&line[prefix], sizeof(line) - prefix, "%s\n", GetLogLevelString(LogLevel_Always));
+				Output(LogLevel_Always, line);
 			}
 
 //-----------------------------------------------------------------------------
@@ -244,7 +461,17 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			void LogImpl::QueueClear()
 			{
-				m_logQueue.clear();
+				if (!m_bAsync)
+				{
+					m_queueCount = 0;
+					m_queueTextPos = 0;
+					return;
+				}
+
+				uint32 pos;
+				Record* record = Claim(&pos);
+				record->m_type = Record_Clear;
+				Publish(record, pos);
 			}
 
 //-----------------------------------------------------------------------------
@@ -259,32 +486,27 @@ namespace OpenZWave
 			}
 
 //-----------------------------------------------------------------------------
-//	<LogImpl::GetTimeStampString>
-//	Generate a string with formatted current time
+//	<LogImpl::FormatTimeStamp>
+//	Format a time into a buffer, returning the length written
 //-----------------------------------------------------------------------------
-			std::string LogImpl::GetTimeStampString()
+			uint32 LogImpl::FormatTimeStamp(char* _buffer, uint32 _size, struct timeval const& _time)
 			{
-				// Get a timestamp
-				struct timeval tv;
-				gettimeofday(&tv, NULL);
 				// use threadsafe verion of localtime. Reported by nihilus, 2019-04
 				// https://www.gnu.org/software/libc/manual/html_node/Broken_002ddown-Time.html#Broken_002ddown-Time
 				struct tm *tm, xtm;
 				memset(&xtm, 0, sizeof(xtm));
-				tm = localtime_r(&tv.tv_sec, &xtm);
+				tm = localtime_r(&_time.tv_sec, &xtm);
 
 				// create a time stamp string for the log message
-				char buf[100];
-				snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%03d ", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int) tv.tv_usec / 1000);
-				string str = buf;
-				return str;
+				int len = snprintf(_buffer, _size, "%04d-%02d-%02d %02d:%02d:%02d.%03d ", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, (int) _time.tv_usec / 1000);
+				return (len < 0) ? 0 : std::min((uint32) len, _size - 1);
 			}
 
 //-----------------------------------------------------------------------------
 //	<LogImpl::GetNodeString>
 //	Generate a string with formatted node id
 //-----------------------------------------------------------------------------
-			std::string LogImpl::GetNodeString(uint8 const _nodeId)
+			char const* LogImpl::GetNodeString(char* _buffer, uint32 _size, uint8 const _nodeId)
 			{
 				if (_nodeId == 0)
 				{
@@ -296,24 +518,11 @@ namespace OpenZWave
 				}
 				else
 				{
-					char buf[20];
-					snprintf(buf, sizeof(buf), "Node%03d, ", _nodeId);
-					return buf;
+					snprintf(_buffer, _size, "Node%03d, ", _nodeId);
+					return _buffer;
 				}
 			}
 
-//-----------------------------------------------------------------------------
-//	<LogImpl::GetThreadId>
-//	Generate a string with formatted thread id
-//-----------------------------------------------------------------------------
-			std::string LogImpl::GetThreadId()
-			{
-				char buf[20];
-				snprintf(buf, sizeof(buf), "%08lx ", (long unsigned int) pthread_self());
-				string str = buf;
-				return str;
-			}
-
 //-----------------------------------------------------------------------------
 //	<LogImpl::SetLogFileName>
 //	Provide a new log file name (applicable to future writes)
@@ -327,13 +536,14 @@ namespace OpenZWave
 //	<LogImpl::GetLogLevelString>
 //	Provide a new log file name (applicable to future writes)
 //-----------------------------------------------------------------------------
-			std::string LogImpl::GetLogLevelString(LogLevel _level)
+			char const* LogImpl::GetLogLevelString(LogLevel _level)
 			{
+				static char const* const c_levelStrings[] =
+				{ "None, ", "Always, ", "Fatal, ", "Error, ", "Warning, ", "Alert, ", "Info, ", "Detail, ", "Debug, ", "StreamDetail, ", "Internal, " };
+
 				if ((_level >= LogLevel_None) && (_level <= LogLevel_Internal))
 				{
-					char buf[20];
-					snprintf(buf, sizeof(buf), "%s, ", LogLevelString[_level]);
-					return buf;
+					return c_levelStrings[_level - LogLevel_None];
 				}
 				else
 					return "Unknown, ";
@@ -32,7 +32,11 @@
 #include <stdarg.h>
 #include <time.h>
 #include <sys/time.h>
-#include <list>
+#include <pthread.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "platform/Log.h"
 
 namespace OpenZWave
@@ -47,34 +51,92 @@ namespace OpenZWave
 				private:
 					friend class OpenZWave::Log;
 
-					LogImpl(string const& _filename, bool const _bAppendLog, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger);
+					LogImpl(string const& _filename, bool const _bAppendLog, bool const _bConsoleOutput, LogLevel const _saveLevel, LogLevel const _queueLevel, LogLevel const _dumpTrigger, bool const _bAsync);
 					~LogImpl();
 
 					void Write(LogLevel _level, uint8 const _nodeId, char const* _format, va_list _args);
-					void Queue(char const* _buffer);
 					void QueueDump();
 					void QueueClear();
 					void SetLoggingState(LogLevel _saveLevel, LogLevel _queueLevel, LogLevel _dumpTrigger);
 					void SetLogFileName(const string &_filename);
 
-					string GetTimeStampString();
-					string GetNodeString(uint8 const _nodeId);
-					string GetThreadId();
-					string GetLogLevelString(LogLevel _level);
+					enum
+					{
+						LineSize = 1024,			// Longest message, as before
+						RingSize = 256,				// Records waiting for the writer thread.  A power of two.
+						QueueEntries = 500,			// Most messages kept for QueueDump
+						QueueTextSize = 128 * 1024	// Space for the text of those messages
+					};
+
+					// A message, or a request to dump or clear the queue, in the order it was made.
+					// Only the message text is formatted by the caller.  The rest is left to Process.
+					struct Record
+					{
+							std::atomic<uint32> m_seq;	// Which lap of the ring the record belongs to
+							uint8 m_type;
+							LogLevel m_level;
+							uint8 m_nodeId;
+							bool m_save;				// Write to the file and console
+							bool m_queue;				// Keep for QueueDump
+							bool m_dump;				// Dump the queue after this message
+							struct timeval m_time;
+							pthread_t m_thread;
+							char m_text[LineSize];
+					};
+					enum
+					{
+						Record_Message = 0,
+						Record_Dump,
+						Record_Clear
+					};
+
+					Record* Claim(uint32* _pos);
+					void Publish(Record* _record, uint32 _pos);
+					void Process(Record const* _record);
+					void WriterThreadProc();
+					void Output(LogLevel _level, char const* _line);
+					void Queue(char const* _line, uint32 _length);
+					void DumpQueue();
+
+					uint32 FormatTimeStamp(char* _buffer, uint32 _size, struct timeval const& _time);
+					char const* GetNodeString(char* _buffer, uint32 _size, uint8 const _nodeId);
+					char const* GetLogLevelString(LogLevel _level);
 					unsigned int toEscapeCode(LogLevel _level);
 
 					string m_filename; /**< filename specified by user (default is ozw_log.txt) */
 					bool m_bConsoleOutput; /**< if true, send log output to console as well as to the file */
 					bool m_bAppendLog; /**< if true, the log file should be appended to any with the same name */
-					list<string> m_logQueue; /**< list of queued log messages */
 					LogLevel m_saveLevel;
 					LogLevel m_queueLevel;
 					LogLevel m_dumpTrigger;
 					FILE* pFile;
+
+					// The messages kept for QueueDump, oldest first.  Their text is laid out in
+					// m_queueText in the same order, wrapping round when it reaches the end.
+					char* m_queueText;
+					uint32 m_queueTextPos;		// Where the next message's text goes
+					uint32 m_queueStart[QueueEntries];
+					uint32 m_queueLength[QueueEntries];
+					uint32 m_queueFirst;
+					uint32 m_queueCount;
+
+					// With _bAsync, Write only fills in a Record, and a writer thread does the rest.
+					// Any thread may add records.  Each claims a slot by moving m_head on, and marks
+					// it ready through the slot's m_seq, so no lock is needed.
+					bool m_bAsync;
+					Record* m_ring;
+					std::atomic<uint32> m_head;
+					std::atomic<uint32> m_tail;	// Only written by the writer thread
+					std::atomic<bool> m_writerIdle;
+					std::atomic<bool> m_callerWaiting;	// A caller is waiting for room in the ring
+					bool m_exit;
+					std::mutex m_waitMutex;
+					std::condition_variable m_writerCond;
+					std::condition_variable m_spaceCond;
+					std::thread m_writerThread;
 			};
 		} // namespace Platform
 	} // namespace Internal
 } // namespace OpenZWave
 
 #endif //_LogImpl_H
-
@@ -0,0 +1,218 @@
+//-----------------------------------------------------------------------------
+//
+//	WaitSetImpl.cpp
+//
+//	POSIX implementation of a WaitSet
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+#include "Defs.h"
+#include "WaitSetImpl.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#else
+#include <poll.h>
+#endif
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::WaitSetImpl>
+//	Constructor
+//-----------------------------------------------------------------------------
+			WaitSetImpl::WaitSetImpl() :
+					m_readFd(-1), m_wakeFd(-1), m_expired(false)
+			{
+#ifdef __linux__
+				m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+				m_readFd = m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+				m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+				if ((m_epollFd < 0) || (m_readFd < 0) || (m_timerFd < 0))
+				{
+					fprintf(stderr, "WaitSetImpl::WaitSetImpl setup error %s\n", strerror(errno));
+					assert(0);
+				}
+
+				struct epoll_event ev;
+				memset(&ev, 0, sizeof(ev));
+				ev.events = EPOLLIN;
+				ev.data.fd = m_readFd;
+				epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_readFd, &ev);
+				ev.data.fd = m_timerFd;
+				epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_timerFd, &ev);
+#else
+				int fds[2];
+				if (pipe(fds) != 0)
+				{
+					fprintf(stderr, "WaitSetImpl::WaitSetImpl pipe error %s\n", strerror(errno));
+					assert(0);
+				}
+				for (int i = 0; i < 2; ++i)
+				{
+					fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+					fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+				}
+				m_readFd = fds[0];
+				m_wakeFd = fds[1];
+				m_infinite = true;
+#endif
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::~WaitSetImpl>
+//	Destructor
+//-----------------------------------------------------------------------------
+			WaitSetImpl::~WaitSetImpl()
+			{
+#ifdef __linux__
+				close(m_timerFd);
+				close(m_epollFd);
+#else
+				close(m_wakeFd);
+#endif
+				close(m_readFd);
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::Arm>
+//	Start the timeout for a Select call
+//-----------------------------------------------------------------------------
+			void WaitSetImpl::Arm(int32 _timeout)
+			{
+				// A zero timeout only scans the objects once
+				m_expired = (_timeout == 0);
+#ifdef __linux__
+				struct itimerspec its;
+				memset(&its, 0, sizeof(its));
+				if (_timeout > 0)
+				{
+					its.it_value.tv_sec = _timeout / 1000;
+					its.it_value.tv_nsec = (_timeout % 1000) * 1000000L;
+				}
+				// An all zero it_value disarms the timer, for an infinite or immediate timeout
+				timerfd_settime(m_timerFd, 0, &its, NULL);
+#else
+				m_infinite = (_timeout < 0);
+				if (_timeout > 0)
+				{
+					m_deadline.SetTime(_timeout);
+				}
+#endif
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::Wait>
+//	Sleep until woken or the timeout expires
+//-----------------------------------------------------------------------------
+			bool WaitSetImpl::Wait()
+			{
+				if (m_expired)
+				{
+					return false;
+				}
+
+				bool woken = false;
+#ifdef __linux__
+				struct epoll_event events[2];
+				int count;
+				do
+				{
+					count = epoll_wait(m_epollFd, events, 2, -1);
+				} while ((count < 0) && (errno == EINTR));
+
+				uint64 value;
+				for (int i = 0; i < count; ++i)
+				{
+					if (events[i].data.fd == m_timerFd)
+					{
+						if (read(m_timerFd, &value, sizeof(value)) == sizeof(value))
+						{
+							m_expired = true;
+						}
+					}
+					else if (read(m_readFd, &value, sizeof(value)) == sizeof(value))
+					{
+						woken = true;
+					}
+				}
+#else
+				int timeout = -1;
+				if (!m_infinite)
+				{
+					timeout = m_deadline.TimeRemaining();
+					if (timeout <= 0)
+					{
+						m_expired = true;
+						return false;
+					}
+				}
+
+				struct pollfd pfd;
+				pfd.fd = m_readFd;
+				pfd.events = POLLIN;
+				int count = poll(&pfd, 1, timeout);
+				if (count > 0)
+				{
+					char buffer[64];
+					while (read(m_readFd, buffer, sizeof(buffer)) > 0)
+					{
+					}
+					woken = true;
+				}
+				else if (count == 0)
+				{
+					m_expired = true;
+				}
+#endif
+				// A wakeup that raced with the timeout still gets its objects scanned
+				return woken || !m_expired;
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::Wake>
+//	Wake the waiting thread
+//-----------------------------------------------------------------------------
+			void WaitSetImpl::Wake()
+			{
+#ifdef __linux__
+				uint64 value = 1;
+				ssize_t res = write(m_wakeFd, &value, sizeof(value));
+#else
+				char value = 1;
+				ssize_t res = write(m_wakeFd, &value, sizeof(value));
+#endif
+				// EAGAIN means a wakeup is already pending, which is all we need
+				(void) res;
+			}
+		} // namespace Platform
+	} // namespace Internal
+} // namespace OpenZWave
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+//
+//	WaitSetImpl.h
+//
+//	POSIX implementation of a WaitSet
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+#ifndef _WaitSetImpl_H
+#define _WaitSetImpl_H
+
+#include "Defs.h"
+#include "platform/TimeStamp.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+			/** \brief POSIX specific implementation of a WaitSet.
+			 *
+			 * On Linux the thread sleeps in epoll_wait on an eventfd, written by the
+			 * watchers, and a timerfd that expires at the Select timeout.  Elsewhere
+			 * a self-pipe and poll() are used.
+			 */
+			class WaitSetImpl
+			{
+				private:
+					friend class WaitSet;
+
+					WaitSetImpl();
+					~WaitSetImpl();
+
+					/** Start the timeout for a Select call */
+					void Arm(int32 _timeout);
+
+					/**
+					 * Sleep until woken or the timeout armed by Arm expires.
+					 * \return true if woken, false once the timeout has expired
+					 */
+					bool Wait();
+
+					/** Wake the waiting thread.  Called from any thread. */
+					void Wake();
+
+					WaitSetImpl(WaitSetImpl const&);				// prevent copy
+					WaitSetImpl& operator =(WaitSetImpl const&);	// prevent assignment
+
+					int m_readFd;						// drained by the waiting thread
+					int m_wakeFd;						// written by Wake (the same eventfd as m_readFd on Linux)
+					bool m_expired;
+#ifdef __linux__
+					int m_epollFd;
+					int m_timerFd;
+#else
+					bool m_infinite;
+					TimeStamp m_deadline;
+#endif
+			};
+		} // namespace Platform
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif //_WaitSetImpl_H
+
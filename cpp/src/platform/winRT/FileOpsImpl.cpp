@@ -27,6 +27,7 @@
 //-----------------------------------------------------------------------------
 
 #include <windows.h>
+#include <fstream>
 #include "FileOpsImpl.h"
 #include "Utils.h"
 
@@ -179,6 +180,42 @@ namespace OpenZWave
 				}
 				return true;
 			}
+
+//-----------------------------------------------------------------------------
+//	<FileOpsImpl::FileMap>
+//	Read a file into memory (callers only need a read-only view)
+//-----------------------------------------------------------------------------
+			uint8 const* FileOpsImpl::FileMap(const string _filename, size_t* o_size)
+			{
+				std::ifstream in(_filename.c_str(), std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+				if (!in.is_open())
+				{
+					return NULL;
+				}
+				std::streamoff size = in.tellg();
+				if (size <= 0)
+				{
+					return NULL;
+				}
+				uint8* data = new uint8[(size_t) size];
+				in.seekg(0, std::ios_base::beg);
+				if (!in.read((char*) data, size))
+				{
+					delete[] data;
+					return NULL;
+				}
+				*o_size = (size_t) size;
+				return data;
+			}
+
+//-----------------------------------------------------------------------------
+//	<FileOpsImpl::FileUnmap>
+//	Release a buffer returned by FileMap
+//-----------------------------------------------------------------------------
+			void FileOpsImpl::FileUnmap(uint8 const* _data, size_t _size)
+			{
+				delete[] _data;
+			}
 		} // namespace Platform
 	} // namespace Internal
 } // namespace OpenZWave
@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+//
+//	WaitSetImpl.cpp
+//
+//	WinRT implementation of a WaitSet
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+#include <windows.h>
+
+#include "Defs.h"
+#include "WaitSetImpl.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::WaitSetImpl>
+//	Constructor
+//-----------------------------------------------------------------------------
+			WaitSetImpl::WaitSetImpl() :
+					m_expired(false), m_infinite(true)
+			{
+				// Create an auto reset event, so each wakeup is consumed by a single wait
+				m_hEvent = ::CreateEventEx( NULL, NULL, 0, SYNCHRONIZE | EVENT_MODIFY_STATE);
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::~WaitSetImpl>
+//	Destructor
+//-----------------------------------------------------------------------------
+			WaitSetImpl::~WaitSetImpl()
+			{
+				::CloseHandle(m_hEvent);
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::Arm>
+//	Start the timeout for a Select call
+//-----------------------------------------------------------------------------
+			void WaitSetImpl::Arm(int32 _timeout)
+			{
+				m_expired = (_timeout == 0);
+				m_infinite = (_timeout < 0);
+				if (_timeout > 0)
+				{
+					m_deadline.SetTime(_timeout);
+				}
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::Wait>
+//	Sleep until woken or the timeout expires
+//-----------------------------------------------------------------------------
+			bool WaitSetImpl::Wait()
+			{
+				if (m_expired)
+				{
+					return false;
+				}
+
+				DWORD timeout = INFINITE;
+				if (!m_infinite)
+				{
+					int32 remaining = m_deadline.TimeRemaining();
+					if (remaining <= 0)
+					{
+						m_expired = true;
+						return false;
+					}
+					timeout = (DWORD) remaining;
+				}
+
+				if (WAIT_TIMEOUT == ::WaitForSingleObjectEx(m_hEvent, timeout, FALSE))
+				{
+					m_expired = true;
+					return false;
+				}
+				return true;
+			}
+
+//-----------------------------------------------------------------------------
+//	<WaitSetImpl::Wake>
+//	Wake the waiting thread
+//-----------------------------------------------------------------------------
+			void WaitSetImpl::Wake()
+			{
+				::SetEvent(m_hEvent);
+			}
+		} // namespace Platform
+	} // namespace Internal
+} // namespace OpenZWave
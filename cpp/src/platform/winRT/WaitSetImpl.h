@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------------
+//
+//	WaitSetImpl.h
+//
+//	WinRT implementation of a WaitSet
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+#ifndef _WaitSetImpl_H
+#define _WaitSetImpl_H
+
+#include <windows.h>
+#include "Defs.h"
+#include "platform/TimeStamp.h"
+
+namespace OpenZWave
+{
+	namespace Internal
+	{
+		namespace Platform
+		{
+			/** \brief WinRT-specific implementation of the WaitSet class.
+			 *
+			 * The watchers set an auto-reset event that the waiting thread sleeps on.
+			 */
+			class WaitSetImpl
+			{
+				private:
+					friend class WaitSet;
+
+					WaitSetImpl();
+					~WaitSetImpl();
+
+					void Arm(int32 _timeout);
+					bool Wait();
+					void Wake();
+
+					WaitSetImpl(WaitSetImpl const&);				// prevent copy
+					WaitSetImpl& operator =(WaitSetImpl const&);	// prevent assignment
+
+					HANDLE m_hEvent;
+					bool m_expired;
+					bool m_infinite;
+					TimeStamp m_deadline;
+			};
+		} // namespace Platform
+	} // namespace Internal
+} // namespace OpenZWave
+
+#endif //_WaitSetImpl_H
+
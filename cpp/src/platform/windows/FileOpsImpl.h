@@ -54,6 +54,8 @@ namespace OpenZWave
 					bool FileRotate(const string _filename);
 					bool FileCopy(const string, const string);
 					bool FolderCreate(const string _dirname);
+					uint8 const* FileMap(const string _filename, size_t* o_size);
+					void FileUnmap(uint8 const* _data, size_t _size);
 
 			};
 		} // namespace Platform
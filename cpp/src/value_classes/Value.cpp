@@ -34,6 +34,7 @@
 #include "Msg.h"
 #include "Bitfield.h"
 #include "value_classes/Value.h"
+#include "value_classes/ValueDecimal.h"
 #include "platform/Log.h"
 #include "command_classes/CommandClass.h"
 #include "command_classes/Supervision.h"
@@ -58,10 +59,10 @@ namespace OpenZWave
 // Constructor
 //-----------------------------------------------------------------------------
 			Value::Value(uint32 const _homeId, uint8 const _nodeId, ValueID::ValueGenre const _genre, uint8 const _commandClassId, uint8 const _instance, uint16 const _index, ValueID::ValueType const _type, string const& _label, string const& _units, bool const _readOnly, bool const _writeOnly, bool const _isSet, uint8 const _pollIntensity) :
-					m_min(0), m_max(0), m_refreshTime(0), m_verifyChanges(false), m_refreshAfterSet(true), m_id(_homeId, _nodeId, _genre, _commandClassId, _instance, _index, _type), m_targetValueSet(false), m_duration(0), m_units(_units), m_readOnly(_readOnly), m_writeOnly(_writeOnly), m_isSet(_isSet), m_affectsLength(0), m_affects(), m_affectsAll(false), m_checkChange(false), m_pollIntensity(_pollIntensity)
+					m_min(0), m_max(0), m_refreshTime(0), m_verifyChanges(false), m_refreshAfterSet(true), m_id(_homeId, _nodeId, _genre, _commandClassId, _instance, _index, _type), m_targetValueSet(false), m_duration(0), m_localization(NULL), m_missingLocalizationLogged(false), m_units(_units), m_readOnly(_readOnly), m_writeOnly(_writeOnly), m_isSet(_isSet), m_affectsLength(0), m_affects(), m_affectsAll(false), m_checkChange(false), m_pollIntensity(_pollIntensity), m_pollInterval(0)
 			{
 				SetLabel(_label);
-				if (Driver* driver = Manager::Get()->GetDriver(m_id.GetHomeId()))
+				if (Driver* driver = Manager::Get() ? Manager::Get()->GetDriver(m_id.GetHomeId()) : NULL)
 				{
 					Timer::SetDriver(driver);
 				}
@@ -72,7 +73,7 @@ namespace OpenZWave
 // Constructor (from XML)
 //-----------------------------------------------------------------------------
 			Value::Value() :
-					m_min(0), m_max(0), m_refreshTime(0), m_verifyChanges(false), m_refreshAfterSet(true), m_targetValueSet(false), m_duration(0), m_readOnly(false), m_writeOnly(false), m_isSet(false), m_affectsLength(0), m_affects(), m_affectsAll(false), m_checkChange(false), m_pollIntensity(0)
+					m_min(0), m_max(0), m_refreshTime(0), m_verifyChanges(false), m_refreshAfterSet(true), m_targetValueSet(false), m_duration(0), m_localization(NULL), m_missingLocalizationLogged(false), m_readOnly(false), m_writeOnly(false), m_isSet(false), m_affectsLength(0), m_affects(), m_affectsAll(false), m_checkChange(false), m_pollIntensity(0), m_pollInterval(0)
 			{
 			}
 
@@ -118,7 +119,7 @@ namespace OpenZWave
 				 * constructor doens't have a m_id set, hence we can't get the HomeID
 				 */
 
-				if (Driver* driver = Manager::Get()->GetDriver(m_id.GetHomeId()))
+				if (Driver* driver = Manager::Get() ? Manager::Get()->GetDriver(m_id.GetHomeId()) : NULL)
 				{
 						Timer::SetDriver(driver);
 				}
@@ -152,6 +153,11 @@ namespace OpenZWave
 					m_pollIntensity = (uint8) intVal;
 				}
 
+				if (TIXML_SUCCESS == _valueElement->QueryIntAttribute("poll_interval", &intVal))
+				{
+					m_pollInterval = intVal;
+				}
+
 				char const* affects = _valueElement->Attribute("affects");
 				if (affects)
 				{
@@ -227,6 +233,7 @@ namespace OpenZWave
 					}
 					helpElement = helpElement->NextSiblingElement();
 				}
+				BindLocalization();
 			}
 
 //-----------------------------------------------------------------------------
@@ -255,6 +262,12 @@ namespace OpenZWave
 				snprintf(str, sizeof(str), "%d", m_pollIntensity);
 				_valueElement->SetAttribute("poll_intensity", str);
 
+				if (m_pollInterval)
+				{
+					snprintf(str, sizeof(str), "%d", m_pollInterval);
+					_valueElement->SetAttribute("poll_interval", str);
+				}
+
 				snprintf(str, sizeof(str), "%d", m_min);
 				_valueElement->SetAttribute("min", str);
 
@@ -307,7 +320,11 @@ namespace OpenZWave
 						{
 							Log::Write(LogLevel_Info, m_id.GetNodeId(), "Value::Set - %s - %s - %d - %d - %s", cc->GetCommandClassName().c_str(), this->GetLabel().c_str(), m_id.GetIndex(), m_id.GetInstance(), this->GetAsString().c_str());
 							// flag value as set and queue a "Set Value" message for transmission to the device
-							res = cc->SetValue(*this);
+							{
+								// Marked, so that while a sleeping node has yet to get it a later Set replaces it
+								Internal::Msg::ValueScope scope(m_id.GetId());
+								res = cc->SetValue(*this);
+							}
 
 							if (res)
 							{
@@ -364,14 +381,15 @@ namespace OpenZWave
 				{
 					m_isSet = true;
 
-					bool bSuppress;
-					Options::Get()->GetOptionAsBool("SuppressValueRefresh", &bSuppress);
-					if (!bSuppress)
+					if (!Options::Get()->GetSnapshot().m_suppressValueRefresh)
 					{
 						// Notify the watchers
-						Notification* notification = new Notification(Notification::Type_ValueRefreshed);
-						notification->SetValueId(m_id);
-						driver->QueueNotification(notification);
+						driver->QueueValueNotification(Notification::Type_ValueRefreshed, m_id);
+					}
+
+					if (IsPolled())
+					{
+						driver->PollValueReported(m_id, false);
 					}
 				}
 			}
@@ -392,9 +410,12 @@ namespace OpenZWave
 					m_isSet = true;
 
 					// Notify the watchers
-					Notification* notification = new Notification(Notification::Type_ValueChanged);
-					notification->SetValueId(m_id);
-					driver->QueueNotification(notification);
+					driver->QueueValueNotification(Notification::Type_ValueChanged, m_id);
+
+					if (IsPolled())
+					{
+						driver->PollValueReported(m_id, true);
+					}
 				}
 				/* Call Back to the Command Class that this Value has changed, so we can search the
 				 * TriggerRefreshValue vector to see if we should request any other values to be
@@ -531,7 +552,21 @@ namespace OpenZWave
 								Log::Write(LogLevel_Detail, m_id.GetNodeId(), "\tTarget Value is Set to %d", *((uint8*) _targetValue));
 							break;
 						}
-						case ValueID::ValueType_Decimal:		// decimal is stored as a string, so treat it as a string here
+						case ValueID::ValueType_Decimal:		// decimal
+						{
+							if (Log::IsEnabled(LogLevel_Detail))
+							{
+								Decimal const* original = (Decimal const*) _originalValue;
+								Decimal const* value = (Decimal const*) _newValue;
+								Log::Write(LogLevel_Detail, m_id.GetNodeId(), "Value Updated: old value=%s, new value=%s, type=%s", ValueDecimal::Format(original->m_value, original->m_precision).c_str(), ValueDecimal::Format(value->m_value, value->m_precision).c_str(), GetTypeNameFromEnum(_type));
+								if (m_targetValueSet)
+								{
+									Decimal const* target = (Decimal const*) _targetValue;
+									Log::Write(LogLevel_Detail, m_id.GetNodeId(), "\tTarget Value is Set to %s", ValueDecimal::Format(target->m_value, target->m_precision).c_str());
+								}
+							}
+							break;
+						}
 						case ValueID::ValueType_String:			// string
 						{
 							Log::Write(LogLevel_Detail, m_id.GetNodeId(), "Value Updated: old value=%s, new value=%s, type=%s", ((string*) _originalValue)->c_str(), ((string*) _newValue)->c_str(), GetTypeNameFromEnum(_type));
@@ -593,7 +628,9 @@ namespace OpenZWave
 				bool bOriginalEqual = false;
 				switch (_type)
 				{
-					case ValueID::ValueType_Decimal:		// Decimal is stored as a string
+					case ValueID::ValueType_Decimal:		// decimal
+						bOriginalEqual = (*((Decimal*) _originalValue) == *((Decimal*) _newValue));
+						break;
 					case ValueID::ValueType_String:			// string
 						bOriginalEqual = (strcmp(((string*) _originalValue)->c_str(), ((string*) _newValue)->c_str()) == 0);
 						break;
@@ -657,7 +694,9 @@ namespace OpenZWave
 					bool bCheckEqual = false;
 					switch (_type)
 					{
-						case ValueID::ValueType_Decimal:		// Decimal is stored as a string
+						case ValueID::ValueType_Decimal:		// decimal
+							bCheckEqual = (*((Decimal*) _checkValue) == *((Decimal*) _newValue));
+							break;
 						case ValueID::ValueType_String:			// string
 							bCheckEqual = (strcmp(((string*) _checkValue)->c_str(), ((string*) _newValue)->c_str()) == 0);
 							break;
@@ -721,22 +760,70 @@ namespace OpenZWave
 				}
 			}
 
-			std::string const Value::GetHelp() const
+//-----------------------------------------------------------------------------
+// <Value::GetHelp>
+// The help in the selected language
+//-----------------------------------------------------------------------------
+			std::string const& Value::GetHelp() const
 			{
-				return Localization::Get()->GetValueHelp(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1);
+				static std::string const c_none;
+				if (m_localization == NULL)
+				{
+					LogMissingLocalization();
+					return c_none;
+				}
+				return m_localization->GetBoundHelp();
 			}
 			void Value::SetHelp(string const& _help, string const lang)
 			{
 				Localization::Get()->SetValueHelp(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1, _help, lang);
+				BindLocalization();
 			}
 
-			std::string const Value::GetLabel() const
+//-----------------------------------------------------------------------------
+// <Value::GetLabel>
+// The label in the selected language
+//-----------------------------------------------------------------------------
+			std::string const& Value::GetLabel() const
 			{
-				return Localization::Get()->GetValueLabel(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1);
+				static std::string const c_none;
+				if (m_localization == NULL)
+				{
+					LogMissingLocalization();
+					return c_none;
+				}
+				return m_localization->GetBoundLabel();
 			}
 			void Value::SetLabel(string const& _label, string const lang)
 			{
 				Localization::Get()->SetValueLabel(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1, _label, lang);
+				BindLocalization();
+			}
+
+//-----------------------------------------------------------------------------
+// <Value::LogMissingLocalization>
+// Warn that the value has no label or help, the first time it is read
+//-----------------------------------------------------------------------------
+			void Value::LogMissingLocalization() const
+			{
+				if (!m_missingLocalizationLogged)
+				{
+					m_missingLocalizationLogged = true;
+					Log::Write(LogLevel_Warning, m_id.GetNodeId(), "No Label or Help for CommandClass %xd, ValueID: %d", m_id.GetCommandClassId(), m_id.GetIndex());
+				}
+			}
+
+//-----------------------------------------------------------------------------
+// <Value::BindLocalization>
+// Hold on to the entry with our texts, so they are read without a lookup.
+// Entries are never removed, so once found it stays ours.
+//-----------------------------------------------------------------------------
+			void Value::BindLocalization()
+			{
+				if (m_localization == NULL)
+				{
+					m_localization = Localization::Get()->GetValueEntry(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1);
+				}
 			}
 
 //-----------------------------------------------------------------------------
@@ -749,7 +836,9 @@ namespace OpenZWave
 				bool bOriginalEqual = false;
 				switch (_type)
 				{
-					case ValueID::ValueType_Decimal:		// Decimal is stored as a string
+					case ValueID::ValueType_Decimal:		// decimal
+						bOriginalEqual = (*((Decimal*) _targetValue) == *((Decimal*) _newValue));
+						break;
 					case ValueID::ValueType_String:			// string
 						bOriginalEqual = (strcmp(((string*) _targetValue)->c_str(), ((string*) _newValue)->c_str()) == 0);
 						break;
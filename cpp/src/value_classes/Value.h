@@ -45,6 +45,8 @@ namespace OpenZWave
 	class Driver;
 	namespace Internal
 	{
+		class ValueLocalizationEntry;
+
 		namespace VC
 		{
 
@@ -84,7 +86,7 @@ namespace OpenZWave
 						return m_pollIntensity != 0;
 					}
 
-					string const GetLabel() const;
+					string const& GetLabel() const;
 					void SetLabel(string const& _label, string const lang = "");
 
 					string const& GetUnits() const
@@ -96,7 +98,7 @@ namespace OpenZWave
 						m_units = _units;
 					}
 
-					string const GetHelp() const;
+					string const& GetHelp() const;
 					void SetHelp(string const& _help, string const lang = "");
 
 					uint8 const& GetPollIntensity() const
@@ -107,6 +109,14 @@ namespace OpenZWave
 					{
 						m_pollIntensity = _intensity;
 					}
+					int32 GetPollInterval() const
+					{
+						return m_pollInterval;
+					}
+					void SetPollInterval(int32 _milliseconds)
+					{
+						m_pollInterval = _milliseconds;
+					}
 
 					int32 GetMin() const
 					{
@@ -197,6 +207,11 @@ namespace OpenZWave
 					uint32 m_duration;			// The Duration, if the CC supports it
 
 				private:
+					void BindLocalization();
+					void LogMissingLocalization() const;
+
+					ValueLocalizationEntry* m_localization;	// Holds the label and help, and is owned by Localization
+					mutable bool m_missingLocalizationLogged;	// The lack of a label and help has been logged, so is not logged at every read
 					string m_units;
 					bool m_readOnly;
 					bool m_writeOnly;
@@ -206,6 +221,7 @@ namespace OpenZWave
 					bool m_affectsAll;
 					bool m_checkChange;
 					uint8 m_pollIntensity;
+					int32 m_pollInterval;		// Milliseconds between polls, or 0 to follow the PollInterval option
 			};
 		} // namespace VC
 	} // namespace Internal
@@ -46,7 +46,7 @@ namespace OpenZWave
 // Constructor
 //-----------------------------------------------------------------------------
 			ValueBitSet::ValueBitSet(uint32 const _homeId, uint8 const _nodeId, ValueID::ValueGenre const _genre, uint8 const _commandClassId, uint8 const _instance, uint16 const _index, string const& _label, string const& _units, bool const _readOnly, bool const _writeOnly, uint32 const _value, uint8 const _pollIntensity) :
-					Value(_homeId, _nodeId, _genre, _commandClassId, _instance, _index, ValueID::ValueType_BitSet, _label, _units, _readOnly, _writeOnly, false, _pollIntensity), m_value(_value), m_valueCheck(false), m_newValue(false), m_BitMask(0xFFFFFFFF), m_size(0), m_targetValue(0)
+					Value(_homeId, _nodeId, _genre, _commandClassId, _instance, _index, ValueID::ValueType_BitSet, _label, _units, _readOnly, _writeOnly, false, _pollIntensity), m_value(_value), m_valueCheck(false), m_newValue(false), m_BitMask(0xFFFFFFFF), m_size(0), m_targetValue(0), m_itemLocalization(NULL)
 			{
 			}
 
@@ -158,6 +158,7 @@ namespace OpenZWave
 					}
 					BitSetElement = BitSetElement->NextSiblingElement("BitSet");
 				}
+				m_itemLocalization = Localization::Get()->GetValueItemEntry(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1);
 			}
 
 //-----------------------------------------------------------------------------
@@ -287,6 +288,13 @@ namespace OpenZWave
 			{
 				if (isValidBit(_idx))
 				{
+					if (m_itemLocalization != NULL)
+					{
+						if (string const* help = m_itemLocalization->FindBoundItemHelp(_idx))
+						{
+							return *help;
+						}
+					}
 					return Localization::Get()->GetValueItemHelp(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1, _idx);
 				}
 				Log::Write(LogLevel_Warning, m_id.GetNodeId(), "SetBitHelp: Bit %d is not valid with BitMask %d", _idx, m_BitMask);
@@ -297,7 +305,9 @@ namespace OpenZWave
 			{
 				if (isValidBit(_idx))
 				{
-					return Localization::Get()->SetValueItemHelp(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1, _idx, help, Localization::Get()->GetSelectedLang());
+					bool ret = Localization::Get()->SetValueItemHelp(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1, _idx, help, Localization::Get()->GetSelectedLang());
+					m_itemLocalization = Localization::Get()->GetValueItemEntry(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1);
+					return ret;
 				}
 				Log::Write(LogLevel_Warning, m_id.GetNodeId(), "SetBitHelp: Bit %d is not valid with BitMask %d", _idx, m_BitMask);
 				return false;
@@ -314,6 +324,13 @@ namespace OpenZWave
 			{
 				if (isValidBit(_idx))
 				{
+					if (m_itemLocalization != NULL)
+					{
+						if (string const* label = m_itemLocalization->FindBoundItemLabel(_idx))
+						{
+							return *label;
+						}
+					}
 					return Localization::Get()->GetValueItemLabel(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1, _idx);
 				}
 				Log::Write(LogLevel_Warning, m_id.GetNodeId(), "GetBitLabel: Bit %d is not valid with BitMask %d", _idx, m_BitMask);
@@ -325,6 +342,7 @@ namespace OpenZWave
 				if (isValidBit(_idx))
 				{
 					Localization::Get()->SetValueItemLabel(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1, _idx, label, Localization::Get()->GetSelectedLang());
+					m_itemLocalization = Localization::Get()->GetValueItemEntry(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1);
 					return true;
 				}
 				Log::Write(LogLevel_Warning, m_id.GetNodeId(), "SetBitLabel: Bit %d is not valid with BitMask %d", _idx, m_BitMask);
@@ -50,7 +50,8 @@ namespace OpenZWave
 			{
 				public:
 					ValueBitSet(uint32 const _homeId, uint8 const _nodeId, ValueID::ValueGenre const _genre, uint8 const _commandClassId, uint8 const _instance, uint16 const _index, string const& _label, string const& _units, bool const _readOnly, bool const _writeOnly, uint32 const _value, uint8 const _pollIntensity);
-					ValueBitSet()
+					ValueBitSet() :
+							m_itemLocalization(NULL)
 					{
 					}
 					virtual ~ValueBitSet()
@@ -95,6 +96,7 @@ namespace OpenZWave
 					uint8 m_size;					// Number of bytes in size
 					vector<int32> m_bits;
 					uint32 m_targetValue; 		// Target Value, if Supported;
+					ValueLocalizationEntry* m_itemLocalization;	// Holds the bit labels and help, and is owned by Localization
 			};
 		} // namespace VC
 	} // namespace Internal
@@ -25,6 +25,10 @@
 //
 //-----------------------------------------------------------------------------
 
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+
 #include "tinyxml.h"
 #include "value_classes/ValueDecimal.h"
 #include "Msg.h"
@@ -38,14 +42,31 @@ namespace OpenZWave
 	{
 		namespace VC
 		{
+			static int64 const c_powersOfTen[] =
+			{ 1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL };
+			// The precision is sent to the device in a 3 bit field
+			static uint8 const c_maxPrecision = 7;
 
 //-----------------------------------------------------------------------------
 // <ValueDecimal::ValueDecimal>
 // Constructor
 //-----------------------------------------------------------------------------
 			ValueDecimal::ValueDecimal(uint32 const _homeId, uint8 const _nodeId, ValueID::ValueGenre const _genre, uint8 const _commandClassId, uint8 const _instance, uint16 const _index, string const& _label, string const& _units, bool const _readOnly, bool const _writeOnly, string const& _value, uint8 const _pollIntensity) :
-					Value(_homeId, _nodeId, _genre, _commandClassId, _instance, _index, ValueID::ValueType_Decimal, _label, _units, _readOnly, _writeOnly, false, _pollIntensity), m_value(_value), m_valueCheck(""), m_newValue(""), m_precision(0), m_targetValue("")
+					Value(_homeId, _nodeId, _genre, _commandClassId, _instance, _index, ValueID::ValueType_Decimal, _label, _units, _readOnly, _writeOnly, false, _pollIntensity)
+			{
+				Decimal const zero = { 0, 0, 0 };
+				m_value = m_valueCheck = m_newValue = m_targetValue = zero;
+				Parse(_value, &m_value.m_value, &m_value.m_precision);
+			}
+
+//-----------------------------------------------------------------------------
+// <ValueDecimal::ValueDecimal>
+// Constructor (from XML)
+//-----------------------------------------------------------------------------
+			ValueDecimal::ValueDecimal()
 			{
+				Decimal const zero = { 0, 0, 0 };
+				m_value = m_valueCheck = m_newValue = m_targetValue = zero;
 			}
 
 //-----------------------------------------------------------------------------
@@ -59,7 +80,12 @@ namespace OpenZWave
 				char const* str = _valueElement->Attribute("value");
 				if (str)
 				{
-					m_value = str;
+					Parse(str, &m_value.m_value, &m_value.m_precision);
+				}
+				int intVal;
+				if (TIXML_SUCCESS == _valueElement->QueryIntAttribute("scale", &intVal))
+				{
+					m_value.m_scale = (uint8) intVal;
 				}
 				else
 				{
@@ -74,7 +100,12 @@ namespace OpenZWave
 			void ValueDecimal::WriteXML(TiXmlElement* _valueElement)
 			{
 				Value::WriteXML(_valueElement);
-				_valueElement->SetAttribute("value", m_value.c_str());
+				_valueElement->SetAttribute("value", GetValue().c_str());
+				if (m_value.m_scale)
+				{
+					// Part of the value's identity, so the first report after a restart is not taken for a change
+					_valueElement->SetAttribute("scale", m_value.m_scale);
+				}
 			}
 
 //-----------------------------------------------------------------------------
@@ -83,12 +114,19 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			bool ValueDecimal::Set(string const& _value)
 			{
+				Decimal value = m_value;
+				if (!Parse(_value, &value.m_value, &value.m_precision))
+				{
+					Log::Write(LogLevel_Warning, GetID().GetNodeId(), "\"%s\" is not a decimal number", _value.c_str());
+					return false;
+				}
+
 				// create a temporary copy of this value to be submitted to the Set() call and set its value to the function param
 				ValueDecimal* tempValue = new ValueDecimal(*this);
-				tempValue->m_value = _value;
+				tempValue->m_value = value;
 
 				// Save the new value to be stored when the device confirms the value was set successfully, 
-				m_newValue = _value;
+				m_newValue = value;
 
 				// Set the value in the device.
 				bool ret = ((Value*) tempValue)->Set();
@@ -106,31 +144,127 @@ namespace OpenZWave
 			void ValueDecimal::SetTargetValue(string const _target, uint32 _duration)
 			{
 				m_targetValueSet = true;
-				m_targetValue = _target;
+				m_targetValue = m_value;
+				Parse(_target, &m_targetValue.m_value, &m_targetValue.m_precision);
 				m_duration = _duration;
 			}
 
-
 //-----------------------------------------------------------------------------
 // <ValueDecimal::OnValueRefreshed>
 // A value in a device has been refreshed
 //-----------------------------------------------------------------------------
 			void ValueDecimal::OnValueRefreshed(string const& _value)
 			{
-				switch (VerifyRefreshedValue((void*) &m_value, (void*) &m_valueCheck, (void*) &_value, (void *) &m_targetValue, ValueID::ValueType_Decimal))
+				Decimal value = m_value;
+				if (Parse(_value, &value.m_value, &value.m_precision))
+				{
+					OnValueRefreshed(value.m_value, value.m_precision, value.m_scale);
+				}
+			}
+
+//-----------------------------------------------------------------------------
+// <ValueDecimal::OnValueRefreshed>
+// A value in a device has been refreshed
+//-----------------------------------------------------------------------------
+			void ValueDecimal::OnValueRefreshed(int32 const _value, uint8 const _precision, uint8 const _scale)
+			{
+				Decimal const value = { _value, _precision, _scale };
+				switch (VerifyRefreshedValue((void*) &m_value, (void*) &m_valueCheck, (void*) &value, (void *) &m_targetValue, ValueID::ValueType_Decimal))
 				{
 					case 0:		// value hasn't changed, nothing to do
 						break;
 					case 1:		// value has changed (not confirmed yet), save _value in m_valueCheck
-						m_valueCheck = _value;
+						m_valueCheck = value;
 						break;
 					case 2:		// value has changed (confirmed), save _value in m_value
-						m_value = _value;
+						m_value = value;
 						break;
 					case 3:		// all three values are different, so wait for next refresh to try again
 						break;
 				}
 			}
+
+//-----------------------------------------------------------------------------
+// <ValueDecimal::Format>
+// Write a decimal number as a string
+//-----------------------------------------------------------------------------
+			string ValueDecimal::Format(int32 const _value, uint8 const _precision)
+			{
+				char str[32];
+				if (_precision == 0)
+				{
+					snprintf(str, sizeof(str), "%d", _value);
+					return str;
+				}
+
+				// Split the digits either side of the decimal point.  We avoid
+				// using floats to prevent accuracy issues.
+				uint8 precision = (_precision > c_maxPrecision) ? c_maxPrecision : _precision;
+				int64 value = _value;
+				bool negative = (value < 0);
+				if (negative)
+				{
+					value = -value;
+				}
+				struct lconv const* locale = localeconv();
+				snprintf(str, sizeof(str), "%s%lld%c%0*lld", negative ? "-" : "", (long long) (value / c_powersOfTen[precision]), *(locale->decimal_point), (int) precision, (long long) (value % c_powersOfTen[precision]));
+				return str;
+			}
+
+//-----------------------------------------------------------------------------
+// <ValueDecimal::Parse>
+// Read a decimal number from a string
+//-----------------------------------------------------------------------------
+			bool ValueDecimal::Parse(string const& _str, int32* o_value, uint8* o_precision)
+			{
+				// Allow for whitespace around the number, as strtoll does before it
+				size_t last = _str.find_last_not_of(" \t\r\n");
+				string str = (last == string::npos) ? string() : _str.substr(0, last + 1);
+
+				// Find the decimal point
+				size_t pos = str.find_first_of(".,");
+				string digits = str;
+				uint8 precision = 0;
+				bool roundUp = false;
+				if (pos != string::npos)
+				{
+					// Remove the decimal point, and round off any digits past those we can hold
+					size_t count = str.size() - pos - 1;
+					if (count > c_maxPrecision)
+					{
+						if (str.find_first_not_of("0123456789", pos + 1 + c_maxPrecision) != string::npos)
+						{
+							return false;
+						}
+						roundUp = (str[pos + 1 + c_maxPrecision] >= '5');
+						count = c_maxPrecision;
+					}
+					precision = (uint8) count;
+					digits = str.substr(0, pos) + str.substr(pos + 1, count);
+				}
+
+				char const* start = digits.c_str();
+				char* end;
+				errno = 0;
+				long long value = strtoll(start, &end, 10);
+				if ((end == start) || (*end != 0) || (errno == ERANGE))
+				{
+					return false;
+				}
+				if (roundUp)
+				{
+					// Away from zero, including for "-0.00000005", which strtoll reads as 0
+					value += (digits.find('-') != string::npos) ? -1 : 1;
+				}
+				if ((value < -2147483647LL - 1) || (value > 2147483647LL))
+				{
+					return false;
+				}
+
+				*o_value = (int32) value;
+				*o_precision = precision;
+				return true;
+			}
 		} // namespace VC
 	} // namespace Internal
 } // namespace OpenZWave
@@ -40,8 +40,28 @@ namespace OpenZWave
 	{
 		namespace VC
 		{
+			/** \brief A decimal number as the Z-Wave reports carry it: an integer and the number of digits after the decimal point. */
+			struct Decimal
+			{
+					int32 m_value;			// The number times 10 to the power of m_precision
+					uint8 m_precision;		// Digits after the decimal point, 0 to 7
+					uint8 m_scale;			// The scale the node reported the number in (its units)
+
+					bool operator ==(Decimal const& _other) const
+					{
+						return (m_value == _other.m_value) && (m_precision == _other.m_precision) && (m_scale == _other.m_scale);
+					}
+					bool operator !=(Decimal const& _other) const
+					{
+						return !(*this == _other);
+					}
+			};
 
 			/** \brief Decimal value sent to/received from a node.
+			 *
+			 *  The value is held as a Decimal, so a report is stored and compared with the
+			 *  last one without going through a string.  It is only turned into a string when
+			 *  asked for one.
 			 * \ingroup ValueID
 			 */
 			class ValueDecimal: public Value
@@ -49,19 +69,18 @@ namespace OpenZWave
 
 				public:
 					ValueDecimal(uint32 const _homeId, uint8 const _nodeId, ValueID::ValueGenre const _genre, uint8 const _commandClassId, uint8 const _instance, uint16 const _index, string const& _label, string const& _units, bool const _readOnly, bool const _writeOnly, string const& _value, uint8 const _pollIntensity);
-					ValueDecimal() :
-							m_precision(0)
-					{
-					}
+					ValueDecimal();
 					virtual ~ValueDecimal()
 					{
 					}
 
 					bool Set(string const& _value);
 					void OnValueRefreshed(string const& _value);
+					/** A node has reported the value as _value / 10^_precision, in _scale */
+					void OnValueRefreshed(int32 const _value, uint8 const _precision, uint8 const _scale);
 					void ConfirmNewValue()
 					{
-						OnValueRefreshed(m_newValue);
+						OnValueRefreshed(m_newValue.m_value, m_newValue.m_precision, m_newValue.m_scale);
 					};
 					void SetTargetValue(string const _target, uint32 _duration = 0);
 
@@ -78,29 +97,40 @@ namespace OpenZWave
 					virtual void WriteXML(TiXmlElement* _valueElement);
 
 					string GetValue() const
+					{
+						return Format(m_value.m_value, m_value.m_precision);
+					}
+					/** The value as an integer, the digits after its decimal point, and its scale */
+					Decimal const& GetDecimal() const
 					{
 						return m_value;
 					}
 					uint8 GetPrecision() const
 					{
-						return m_precision;
+						return m_value.m_precision;
 					}
-					void SetPrecision(uint8 _precision)
+					uint8 GetScale() const
 					{
-						m_precision = _precision;
+						return m_value.m_scale;
 					}
 
-				private:
+					/** Write _value / 10^_precision as a string, with the decimal point of the current locale */
+					static string Format(int32 const _value, uint8 const _precision);
+					/**
+					 * Read a decimal number written with either '.' or ',' as the decimal point.  Digits
+					 * past the seventh after the point are rounded off, as no more can be sent.
+					 * \return false if _str is not a number, or the number does not fit in an int32.
+					 */
+					static bool Parse(string const& _str, int32* o_value, uint8* o_precision);
 
-					string m_value;				// the current value
-					string m_valueCheck;			// the previous value (used for double-checking spurious value reads)
-					string m_newValue;				// a new value to be set on the appropriate device
-					uint8 m_precision;
-					string m_targetValue;			// Target Value if supported. 
+				private:
+					Decimal m_value;				// the current value
+					Decimal m_valueCheck;			// the previous value (used for double-checking spurious value reads)
+					Decimal m_newValue;				// a new value to be set on the appropriate device
+					Decimal m_targetValue;			// Target Value if supported.
 			};
 		} // namespace VC
 	} // namespace Internal
 } // namespace OpenZWave
 
 #endif
-
@@ -46,7 +46,7 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			ValueList::ValueList(uint32 const _homeId, uint8 const _nodeId, ValueID::ValueGenre const _genre, uint8 const _commandClassId, uint8 const _instance, uint16 const _index, string const& _label, string const& _units, bool const _readOnly, bool const _writeOnly, vector<Item> const& _items, int32 const _valueIdx, uint8 const _pollIntensity, uint8 const _size	// = 4
 					) :
-					Value(_homeId, _nodeId, _genre, _commandClassId, _instance, _index, ValueID::ValueType_List, _label, _units, _readOnly, _writeOnly, false, _pollIntensity), m_items(_items), m_valueIdx(_valueIdx), m_valueIdxCheck(0), m_size(_size), m_targetValue(0)
+					Value(_homeId, _nodeId, _genre, _commandClassId, _instance, _index, ValueID::ValueType_List, _label, _units, _readOnly, _writeOnly, false, _pollIntensity), m_items(_items), m_valueIdx(_valueIdx), m_valueIdxCheck(0), m_size(_size), m_targetValue(0), m_itemLocalization(NULL)
 			{
 				for (vector<Item>::iterator it = m_items.begin(); it != m_items.end(); ++it)
 				{
@@ -55,6 +55,7 @@ namespace OpenZWave
 					/* now set to the Localized Value */
 					it->m_label = Localization::Get()->GetValueItemLabel(m_id.GetNodeId(), _commandClassId, _index, -1, it->m_value);
 				}
+				m_itemLocalization = Localization::Get()->GetValueItemEntry(m_id.GetNodeId(), _commandClassId, _index, -1);
 			}
 
 //-----------------------------------------------------------------------------
@@ -62,7 +63,7 @@ namespace OpenZWave
 // Constructor
 //-----------------------------------------------------------------------------
 			ValueList::ValueList() :
-					Value(), m_items(), m_valueIdx(), m_valueIdxCheck(0), m_size(0)
+					Value(), m_items(), m_valueIdx(), m_valueIdxCheck(0), m_size(0), m_targetValue(0), m_itemLocalization(NULL)
 			{
 
 			}
@@ -151,6 +152,7 @@ namespace OpenZWave
 				{
 					it->m_label = Localization::Get()->GetValueItemLabel(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1, it->m_value);
 				}
+				m_itemLocalization = Localization::Get()->GetValueItemEntry(m_id.GetNodeId(), m_id.GetCommandClassId(), m_id.GetIndex(), -1);
 
 				// Set the value
 				bool valSet = false;
@@ -308,7 +310,7 @@ namespace OpenZWave
 			{
 				for (int32 i = 0; i < (int32) m_items.size(); ++i)
 				{
-					if (_label == m_items[i].m_label)
+					if (_label == GetItemLabel(m_items[i]))
 					{
 						return i;
 					}
@@ -344,7 +346,7 @@ namespace OpenZWave
 				{
 					for (vector<Item>::iterator it = m_items.begin(); it != m_items.end(); ++it)
 					{
-						o_items->push_back((*it).m_label);
+						o_items->push_back(GetItemLabel(*it));
 					}
 
 					return true;
@@ -394,6 +396,23 @@ namespace OpenZWave
 					return NULL;
 				}
 			}
+
+//-----------------------------------------------------------------------------
+// <ValueList::GetItemLabel>
+// An item's label in the selected language, or as the item was made if it
+// has no localized label
+//-----------------------------------------------------------------------------
+			string const& ValueList::GetItemLabel(Item const& _item) const
+			{
+				if (m_itemLocalization != NULL)
+				{
+					if (string const* label = m_itemLocalization->FindBoundItemLabel(_item.m_value))
+					{
+						return *label;
+					}
+				}
+				return _item.m_label;
+			}
 		} // namespace VC
 	} // namespace Internal
 } // namespace OpenZWave
@@ -74,7 +74,7 @@ namespace OpenZWave
 					// From Value
 					virtual string const GetAsString() const
 					{
-						return GetItem()->m_label;
+						return GetItemLabel(*GetItem());
 					}
 					virtual bool SetFromString(string const& _value)
 					{
@@ -99,12 +99,15 @@ namespace OpenZWave
 					}
 
 				private:
+					string const& GetItemLabel(Item const& _item) const;
+
 					vector<Item> m_items;
 					int32 m_valueIdx;					// the current index in the m_items vector
 					int32 m_valueIdxCheck;			// the previous index in the m_items vector (used for double-checking spurious value reads)
 					int32 m_newValue;			// a new index to be set on the appropriate device (used by Supervision CC)
 					uint8 m_size;
 					int32 m_targetValue; 		// the Target Value, if the CC support it
+					ValueLocalizationEntry* m_itemLocalization;	// Holds the item labels, and is owned by Localization
 
 			};
 		} // namespace VC
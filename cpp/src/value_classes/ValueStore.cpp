@@ -25,6 +25,7 @@
 //
 //-----------------------------------------------------------------------------
 
+#include <algorithm>
 #include "value_classes/ValueStore.h"
 #include "value_classes/Value.h"
 #include "Manager.h"
@@ -38,6 +39,13 @@ namespace OpenZWave
 	{
 		namespace VC
 		{
+			namespace
+			{
+				bool KeyLess(pair<uint32, Value*> const& _entry, uint32 const _key)
+				{
+					return _entry.first < _key;
+				}
+			}
 
 //-----------------------------------------------------------------------------
 // <ValueStore::ValueStore>
@@ -45,13 +53,99 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			ValueStore::~ValueStore()
 			{
-				map<uint32, Value*>::iterator it = m_values.begin();
 				while (!m_values.empty())
 				{
-					ValueID const& valueId = it->second->GetID();
-					RemoveValue(valueId.GetValueStoreKey());
-					it = m_values.begin();
+					RemoveValue(m_values.front().first);
+				}
+			}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::Find>
+// Look a key up in the hash index
+//-----------------------------------------------------------------------------
+			ValueStore::Iterator ValueStore::Find(uint32 const _key) const
+			{
+				if (m_index.empty())
+				{
+					return m_values.end();
+				}
+
+				size_t mask = m_index.size() - 1;
+				for (size_t slot = (_key * 0x9e3779b1u) >> m_indexShift;; slot = (slot + 1) & mask)
+				{
+					uint32 pos = m_index[slot];
+					if (!pos)
+					{
+						return m_values.end();
+					}
+					if (m_values[pos - 1].first == _key)
+					{
+						return m_values.begin() + (pos - 1);
+					}
+				}
+			}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::Reindex>
+// Rebuild the hash index, keeping it at most half full
+//-----------------------------------------------------------------------------
+			void ValueStore::Reindex()
+			{
+				if (m_values.empty())
+				{
+					m_index.clear();
+					m_indexShift = 32;
+					return;
+				}
+
+				uint32 bits = 3;
+				while (((size_t) 1 << bits) < m_values.size() * 2)
+				{
+					++bits;
+				}
+				m_index.assign((size_t) 1 << bits, 0);
+				m_indexShift = 32 - bits;
+
+				size_t mask = m_index.size() - 1;
+				for (size_t i = 0; i < m_values.size(); ++i)
+				{
+					size_t slot = (m_values[i].first * 0x9e3779b1u) >> m_indexShift;
+					while (m_index[slot])
+					{
+						slot = (slot + 1) & mask;
+					}
+					m_index[slot] = (uint32) (i + 1);
+				}
+			}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::IndexInsert>
+// Add a newly inserted value to the hash index
+//-----------------------------------------------------------------------------
+			void ValueStore::IndexInsert(size_t const _pos)
+			{
+				if (m_index.size() < m_values.size() * 2)
+				{
+					Reindex();
+					return;
+				}
+
+				// Everything after the new value has moved up one place
+				size_t mask = m_index.size() - 1;
+				for (size_t slot = 0; slot <= mask; ++slot)
+				{
+					if (m_index[slot] > _pos)
+					{
+						++m_index[slot];
+					}
+				}
+
+				size_t slot = (m_values[_pos].first * 0x9e3779b1u) >> m_indexShift;
+				while (m_index[slot])
+				{
+					slot = (slot + 1) & mask;
 				}
+				m_index[slot] = (uint32) (_pos + 1);
 			}
 
 //-----------------------------------------------------------------------------
@@ -66,14 +160,14 @@ namespace OpenZWave
 				}
 
 				uint32 key = _value->GetID().GetValueStoreKey();
-				map<uint32, Value*>::iterator it = m_values.find(key);
-				if (it != m_values.end())
+				if (Find(key) != m_values.end())
 				{
 					// There is already a value in the store with this key, so we give up.
 					return false;
 				}
 
-				m_values[key] = _value;
+				vector<pair<uint32, Value*> >::iterator it = m_values.insert(lower_bound(m_values.begin(), m_values.end(), key, KeyLess), make_pair(key, _value));
+				IndexInsert(it - m_values.begin());
 				_value->AddRef();
 
 				// Notify the watchers of the new value and Check our GetChangeVerified Flag
@@ -107,7 +201,7 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			bool ValueStore::RemoveValue(uint32 const& _key)
 			{
-				map<uint32, Value*>::iterator it = m_values.find(_key);
+				Iterator it = Find(_key);
 				if (it != m_values.end())
 				{
 					Value* value = it->second;
@@ -128,6 +222,7 @@ namespace OpenZWave
 					else
 						Log::Write(LogLevel_Debug, "Value Deleted");
 					m_values.erase(it);
+					Reindex();
 
 					return true;
 				}
@@ -151,8 +246,9 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			void ValueStore::RemoveCommandClassValues(uint8 const _commandClassId)
 			{
-				map<uint32, Value*>::iterator it = m_values.begin();
-				while (it != m_values.end())
+				// Compact the values we keep towards the front in one pass
+				vector<pair<uint32, Value*> >::iterator out = m_values.begin();
+				for (vector<pair<uint32, Value*> >::iterator it = m_values.begin(); it != m_values.end(); ++it)
 				{
 					Value* value = it->second;
 					ValueID const& valueId = value->GetID();
@@ -170,13 +266,14 @@ namespace OpenZWave
 
 						// Now release and remove the value from the store
 						value->Release();
-						it = m_values.erase(it);
 					}
 					else
 					{
-						++it;
+						*out++ = *it;
 					}
 				}
+				m_values.erase(out, m_values.end());
+				Reindex();
 			}
 
 //-----------------------------------------------------------------------------
@@ -185,21 +282,30 @@ namespace OpenZWave
 //-----------------------------------------------------------------------------
 			Value* ValueStore::GetValue(uint32 const& _key) const
 			{
-				Value* value = NULL;
+				Value* value = BorrowValue(_key);
+				if (value)
+				{
+					// Add a reference to the value.  The caller must
+					// call Release on the value when they are done with it.
+					value->AddRef();
+				}
 
-				map<uint32, Value*>::const_iterator it = m_values.find(_key);
+				return value;
+			}
+
+//-----------------------------------------------------------------------------
+// <ValueStore::BorrowValue>
+// Get a value from the store without adding a reference
+//-----------------------------------------------------------------------------
+			Value* ValueStore::BorrowValue(uint32 const& _key) const
+			{
+				Iterator it = Find(_key);
 				if (it != m_values.end())
 				{
-					value = it->second;
-					if (value)
-					{
-						// Add a reference to the value.  The caller must
-						// call Release on the value when they are done with it.
-						value->AddRef();
-					}
+					return it->second;
 				}
 
-				return value;
+				return NULL;
 			}
 
 		} // namespace VC
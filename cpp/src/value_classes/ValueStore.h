@@ -28,7 +28,8 @@
 #ifndef _ValueStore_H
 #define _ValueStore_H
 
-#include <map>
+#include <vector>
+#include <utility>
 #include "Defs.h"
 #include "value_classes/ValueID.h"
 
@@ -44,13 +45,17 @@ namespace OpenZWave
 			class Value;
 
 			/** \brief Container that holds all of the values associated with a given node.
+			 *
+			 * The values are kept in a vector sorted by ValueID::GetValueStoreKey, so iteration runs
+			 * in key order, as it did when this was a map.  Lookups go through an open addressed hash
+			 * index into the vector.  Adding or removing a value invalidates any Iterator.
 			 * \ingroup ValueID
 			 */
 			class ValueStore
 			{
 				public:
 
-					typedef map<uint32, Value*>::const_iterator Iterator;
+					typedef vector<pair<uint32, Value*> >::const_iterator Iterator;
 
 					Iterator Begin()
 					{
@@ -61,19 +66,36 @@ namespace OpenZWave
 						return m_values.end();
 					}
 
-					ValueStore()
+					ValueStore() :
+							m_indexShift(32)
 					{
 					}
 					~ValueStore();
 
 					bool AddValue(Value* _value);
 					bool RemoveValue(uint32 const& _key);
+
+					/**
+					 * Get a value from the store, adding a reference to it.  The caller must Release it.
+					 */
 					Value* GetValue(uint32 const& _key) const;
 
+					/**
+					 * Get a value from the store without adding a reference.  Only for callers
+					 * holding the Driver's node lock, which keeps the value in the store.
+					 */
+					Value* BorrowValue(uint32 const& _key) const;
+
 					void RemoveCommandClassValues(uint8 const _commandClassId);		// Remove all the values associated with a command class
 
 				private:
-					map<uint32, Value*> m_values;
+					Iterator Find(uint32 const _key) const;		// the value with _key, or End()
+					void Reindex();									// rebuild m_index after m_values changes
+					void IndexInsert(size_t const _pos);			// update m_index for a value inserted at _pos
+
+					vector<pair<uint32, Value*> > m_values;			// sorted by key
+					vector<uint32> m_index;							// position in m_values + 1 for each hash slot, 0 if empty
+					uint32 m_indexShift;							// turns a hashed key into a slot
 			};
 		} // namespace VC
 	} // namespace Internal
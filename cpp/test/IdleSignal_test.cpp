@@ -0,0 +1,138 @@
+//-----------------------------------------------------------------------------
+//
+//	IdleSignal_test.cpp
+//
+//	Test Framework for the IdleSignal the poll thread waits on
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "IdleSignal.h"
+#include "Utils.h"
+#include "platform/Event.h"
+#include "platform/Mutex.h"
+
+namespace OpenZWave
+{
+
+namespace Testing
+{
+using Internal::IdleSignal;
+using Internal::LockGuard;
+using Internal::Platform::Event;
+using Internal::Platform::Mutex;
+
+// Keeps the work busy for _milliseconds, as the Driver does while messages are queued
+// faster than they are sent, then lets it go idle
+static void SendTraffic(Mutex* _mutex, IdleSignal* _signal, int _milliseconds)
+{
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::milliseconds(_milliseconds);
+	while (std::chrono::steady_clock::now() < end)
+	{
+		{
+			// Queue a message, with the last one still being sent
+			LockGuard LG(_mutex);
+			_signal->Update(false);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	LockGuard LG(_mutex);
+	_signal->Update(true);
+}
+
+TEST(IdleSignal, WakeupsUnderSustainedTraffic)
+{
+	Mutex* mutex = new Mutex();
+	Event* exitEvent = new Event();
+	IdleSignal* signal = new IdleSignal(mutex);
+	{
+		LockGuard LG(mutex);
+		signal->Update(false);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::thread sender(SendTraffic, mutex, signal, 1000);
+	EXPECT_EQ(signal->WaitUntilIdle(exitEvent, -1), 1);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	sender.join();
+
+	// Waiting in 10ms steps would have woken up 100 times a second
+	double perSecond = signal->GetWakeups() / seconds;
+	RecordProperty("WakeupsPerSecond", (int) perSecond);
+	EXPECT_GE(seconds, 0.9);
+	EXPECT_LE(perSecond, 2.0);
+
+	delete signal;
+	exitEvent->Release();
+	mutex->Release();
+}
+
+TEST(IdleSignal, WakesOncePerIdleSpell)
+{
+	Mutex* mutex = new Mutex();
+	Event* exitEvent = new Event();
+	IdleSignal* signal = new IdleSignal(mutex);
+
+	// Bursts of traffic, as each poll waits for the one before to be sent
+	for (int i = 0; i < 20; ++i)
+	{
+		{
+			LockGuard LG(mutex);
+			signal->Update(false);
+		}
+		std::thread sender(SendTraffic, mutex, signal, 20);
+		EXPECT_EQ(signal->WaitUntilIdle(exitEvent, 5000), 1);
+		sender.join();
+	}
+	EXPECT_LE(signal->GetWakeups(), 20u * 2);
+
+	delete signal;
+	exitEvent->Release();
+	mutex->Release();
+}
+
+TEST(IdleSignal, ExitAndTimeout)
+{
+	Mutex* mutex = new Mutex();
+	Event* exitEvent = new Event();
+	IdleSignal* signal = new IdleSignal(mutex);
+
+	// Idle from the start, so there is nothing to wait for
+	EXPECT_TRUE(signal->IsIdle());
+	EXPECT_EQ(signal->WaitUntilIdle(exitEvent, 0), 1);
+	EXPECT_EQ(signal->GetWakeups(), 0u);
+
+	{
+		LockGuard LG(mutex);
+		signal->Update(false);
+	}
+	EXPECT_EQ(signal->WaitUntilIdle(exitEvent, 20), -1);
+	exitEvent->Set();
+	EXPECT_EQ(signal->WaitUntilIdle(exitEvent, -1), 0);
+
+	delete signal;
+	exitEvent->Release();
+	mutex->Release();
+}
+} // namespace Testing
+} // namespace OpenZWave
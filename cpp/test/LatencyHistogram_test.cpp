@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+//
+//	LatencyHistogram_test.cpp
+//
+//	Test Framework for the buckets of the latency histograms
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+#include "LatencyHistogram.h"
+
+namespace OpenZWave
+{
+
+namespace Testing
+{
+using Internal::LatencyHistogram;
+
+TEST(LatencyHistogram, SmallValuesHaveBucketsOfTheirOwn)
+{
+	for (uint32 i = 0; i < 8; ++i)
+	{
+		EXPECT_EQ(LatencyHistogramData::GetBucket(i), i);
+		EXPECT_EQ(LatencyHistogramData::GetBucketLowerBound(i), i);
+		EXPECT_EQ(LatencyHistogramData::GetBucketUpperBound(i), i);
+	}
+	EXPECT_EQ(LatencyHistogramData::GetBucket(8), 8u);
+	EXPECT_EQ(LatencyHistogramData::GetBucket(15), 15u);
+	EXPECT_EQ(LatencyHistogramData::GetBucket(16), 16u);
+	EXPECT_EQ(LatencyHistogramData::GetBucket(17), 16u);
+	EXPECT_EQ(LatencyHistogramData::GetBucket(0xffffffff), (uint32) LatencyHistogramData::BucketCount - 1);
+}
+
+TEST(LatencyHistogram, BucketsMeetWithoutGaps)
+{
+	EXPECT_EQ(LatencyHistogramData::GetBucketLowerBound(0), 0u);
+	for (uint32 i = 0; i + 1 < LatencyHistogramData::BucketCount; ++i)
+	{
+		EXPECT_EQ(LatencyHistogramData::GetBucketUpperBound(i) + 1, LatencyHistogramData::GetBucketLowerBound(i + 1)) << "bucket " << i;
+	}
+	EXPECT_EQ(LatencyHistogramData::GetBucketUpperBound(LatencyHistogramData::BucketCount - 1), 0xffffffffu);
+}
+
+TEST(LatencyHistogram, EachValueFallsInsideItsBucket)
+{
+	uint32 values[] =
+	{ 9, 100, 999, 1000, 1023, 1024, 65535, 65536, 1000000, 30000000, 0x7fffffff, 0x80000000 };
+	for (uint32 i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+	{
+		uint32 bucket = LatencyHistogramData::GetBucket(values[i]);
+		ASSERT_LT(bucket, (uint32) LatencyHistogramData::BucketCount);
+		EXPECT_LE(LatencyHistogramData::GetBucketLowerBound(bucket), values[i]);
+		EXPECT_GE(LatencyHistogramData::GetBucketUpperBound(bucket), values[i]);
+
+		// No bucket is wider than an eighth of the values it holds
+		uint32 width = LatencyHistogramData::GetBucketUpperBound(bucket) - LatencyHistogramData::GetBucketLowerBound(bucket) + 1;
+		EXPECT_LE(width * 8, LatencyHistogramData::GetBucketLowerBound(bucket));
+	}
+}
+
+TEST(LatencyHistogram, Percentiles)
+{
+	LatencyHistogram histogram;
+	LatencyHistogramData data;
+	histogram.GetData(&data);
+	EXPECT_EQ(data.GetPercentile(50), 0u);
+
+	// 1ms to 1s
+	for (uint32 i = 1; i <= 1000; ++i)
+	{
+		histogram.Record(i * 1000);
+	}
+	histogram.GetData(&data);
+	EXPECT_EQ(data.m_count, 1000u);
+	EXPECT_EQ(data.m_max, 1000000u);
+	EXPECT_EQ(data.GetMean(), 500500u);
+
+	// The top of the bucket the percentile falls in, so no more than an eighth above it
+	EXPECT_GE(data.GetPercentile(50), 500000u);
+	EXPECT_LE(data.GetPercentile(50), 500000u + 500000u / 8);
+	EXPECT_GE(data.GetPercentile(90), 900000u);
+	EXPECT_LE(data.GetPercentile(90), 900000u + 900000u / 8);
+	EXPECT_EQ(data.GetPercentile(100), 1000000u);
+	EXPECT_EQ(data.GetPercentile(0), LatencyHistogramData::GetBucketUpperBound(LatencyHistogramData::GetBucket(1000)));
+}
+
+TEST(LatencyHistogram, CountAtOrBelowABucketEdge)
+{
+	LatencyHistogram histogram;
+	histogram.Record(959);
+	histogram.Record(960);
+	histogram.Record(1000);
+	histogram.Record(1023);
+	histogram.Record(1024);
+	LatencyHistogramData data;
+	histogram.GetData(&data);
+
+	// 960 to 1023 share a bucket, and 1024 to 1151
+	EXPECT_EQ(data.GetCountAtOrBelow(959), 1u);
+	EXPECT_EQ(data.GetCountAtOrBelow(1000), 1u);
+	EXPECT_EQ(data.GetCountAtOrBelow(1023), 4u);
+	EXPECT_EQ(data.GetCountAtOrBelow(1024), 4u);
+	EXPECT_EQ(data.GetCountAtOrBelow(1151), 5u);
+}
+} // namespace Testing
+} // namespace OpenZWave
@@ -0,0 +1,130 @@
+//-----------------------------------------------------------------------------
+//
+//	MsgScheduler_test.cpp
+//
+//	Test Framework for the choice of message queue to serve
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+#include "MsgScheduler.h"
+#include "Driver.h"
+
+namespace OpenZWave
+{
+
+namespace Testing
+{
+using Internal::FairMsgScheduler;
+using Internal::MsgScheduler;
+
+class FairMsgSchedulerTest: public ::testing::Test
+{
+	protected:
+		FairMsgSchedulerTest() :
+				m_scheduler(500, 20), m_now(MsgScheduler::Clock::now())
+		{
+			for (uint32 i = 0; i < Driver::MsgQueue_Count; ++i)
+			{
+				m_heads[i].m_ready = false;
+				m_heads[i].m_deadline = m_now;
+			}
+		}
+
+		// Puts an item at the head of a queue, queued _age milliseconds ago
+		void Queue(uint32 _queue, int32 _age)
+		{
+			m_heads[_queue].m_ready = true;
+			m_heads[_queue].m_deadline = m_now - std::chrono::milliseconds(_age) + std::chrono::milliseconds(m_scheduler.GetDeadline(_queue));
+		}
+
+		uint32 Select()
+		{
+			return m_scheduler.Select(m_heads, Driver::MsgQueue_Count, m_now);
+		}
+
+		FairMsgScheduler m_scheduler;
+		MsgScheduler::Clock::time_point m_now;
+		MsgScheduler::QueueHead m_heads[Driver::MsgQueue_Count];
+};
+
+TEST_F(FairMsgSchedulerTest, PriorityOrderWhenNothingIsOverdue)
+{
+	Queue(Driver::MsgQueue_Query, 0);
+	Queue(Driver::MsgQueue_Send, 0);
+	Queue(Driver::MsgQueue_WakeUp, 0);
+	EXPECT_EQ(Select(), (uint32) Driver::MsgQueue_WakeUp);
+}
+
+TEST_F(FairMsgSchedulerTest, OldQueryBacklogDoesNotHoldUpAFreshSend)
+{
+	// A re-interview has kept the head of the Query queue waiting for two minutes
+	Queue(Driver::MsgQueue_Query, 120000);
+	Queue(Driver::MsgQueue_Poll, 120000);
+	Queue(Driver::MsgQueue_Send, 0);
+	EXPECT_EQ(Select(), (uint32) Driver::MsgQueue_Send);
+
+	// And once the Send is overdue too
+	Queue(Driver::MsgQueue_Send, 1000);
+	EXPECT_EQ(Select(), (uint32) Driver::MsgQueue_Send);
+}
+
+TEST_F(FairMsgSchedulerTest, OverdueItemOvertakesHigherQueues)
+{
+	Queue(Driver::MsgQueue_WakeUp, 0);
+	Queue(Driver::MsgQueue_Query, 31000);
+	EXPECT_EQ(Select(), (uint32) Driver::MsgQueue_Query);
+
+	Queue(Driver::MsgQueue_Send, 1000);
+	EXPECT_EQ(Select(), (uint32) Driver::MsgQueue_Send);
+}
+
+TEST_F(FairMsgSchedulerTest, HigherOverdueQueueGoesFirst)
+{
+	// The Poll item has waited past its deadline for longer, but Query ranks above it
+	Queue(Driver::MsgQueue_Query, 31000);
+	Queue(Driver::MsgQueue_Poll, 600000);
+	EXPECT_EQ(Select(), (uint32) Driver::MsgQueue_Query);
+}
+
+TEST_F(FairMsgSchedulerTest, CommandIsNeverHeldUp)
+{
+	Queue(Driver::MsgQueue_Command, 0);
+	Queue(Driver::MsgQueue_Send, 10000);
+	Queue(Driver::MsgQueue_Query, 120000);
+	EXPECT_EQ(Select(), (uint32) Driver::MsgQueue_Command);
+}
+
+TEST_F(FairMsgSchedulerTest, PollGetsItsShareAlongsideQueries)
+{
+	Queue(Driver::MsgQueue_Query, 0);
+	Queue(Driver::MsgQueue_Poll, 0);
+	uint32 polls = 0;
+	for (uint32 i = 0; i < 100; ++i)
+	{
+		if (Select() == Driver::MsgQueue_Poll)
+		{
+			++polls;
+		}
+	}
+	EXPECT_EQ(polls, 20u);
+}
+} // namespace Testing
+} // namespace OpenZWave
@@ -0,0 +1,161 @@
+//-----------------------------------------------------------------------------
+//
+//	Msg_test.cpp
+//
+//	Test Framework for batching messages into MultiCmd encapsulations
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+#include "Defs.h"
+#include "Msg.h"
+
+namespace OpenZWave
+{
+
+namespace Testing
+{
+using Internal::Msg;
+
+// A finalized Get, as a command class sends it, waiting for its report
+static Msg* NewGet(uint8 _nodeId, uint8 _commandClassId, uint8 _command)
+{
+	Msg* msg = new Msg("Get", _nodeId, REQUEST, FUNC_ID_ZW_SEND_DATA, true, true, FUNC_ID_APPLICATION_COMMAND_HANDLER, _commandClassId);
+	msg->Append(_nodeId);
+	msg->Append(2);
+	msg->Append(_commandClassId);
+	msg->Append(_command);
+	msg->Append(TRANSMIT_OPTION_ACK | TRANSMIT_OPTION_AUTO_ROUTE | TRANSMIT_OPTION_EXPLORE);
+	msg->Finalize();
+	return msg;
+}
+
+// A report, as it follows the node id in FUNC_ID_APPLICATION_COMMAND_HANDLER
+static bool Report(Msg* _msg, uint8 _commandClassId)
+{
+	uint8 const data[] =
+	{ _commandClassId, 0x03, 0x00 };
+	return _msg->BatchReportReceived(data, sizeof(data));
+}
+
+static uint8 const c_switchBinary = 0x25;
+static uint8 const c_sensorMultilevel = 0x31;
+static uint8 const c_battery = 0x80;
+static uint8 const c_multiCmd = 0x8f;
+
+class MsgBatchTest: public ::testing::Test
+{
+	protected:
+		MsgBatchTest()
+		{
+			m_batch = NewGet(5, c_switchBinary, 0x02);
+			Msg* sensor = NewGet(5, c_sensorMultilevel, 0x04);
+			Msg* battery = NewGet(5, c_battery, 0x02);
+			m_batched = m_batch->Batch(*sensor, 46) && m_batch->Batch(*battery, 46);
+			delete sensor;
+			delete battery;
+		}
+		virtual ~MsgBatchTest()
+		{
+			delete m_batch;
+		}
+
+		Msg* m_batch;
+		bool m_batched;
+};
+
+TEST_F(MsgBatchTest, EncapsulatesEachCommand)
+{
+	ASSERT_TRUE(m_batched);
+	EXPECT_EQ(m_batch->GetBatchCount(), 3);
+	uint8 const* buffer = m_batch->GetBuffer();
+	EXPECT_EQ(buffer[6], c_multiCmd);
+	EXPECT_EQ(buffer[8], 3);
+	EXPECT_EQ(buffer[9], 2);
+	EXPECT_EQ(buffer[10], c_switchBinary);
+	EXPECT_EQ(buffer[12], 2);
+	EXPECT_EQ(buffer[13], c_sensorMultilevel);
+	EXPECT_EQ(buffer[15], 2);
+	EXPECT_EQ(buffer[16], c_battery);
+
+	// The checksum still covers the frame
+	uint8 checksum = 0xff;
+	for (uint32 i = 1; i < m_batch->GetLength() - 1; ++i)
+	{
+		checksum ^= buffer[i];
+	}
+	EXPECT_EQ(buffer[m_batch->GetLength() - 1], checksum);
+	EXPECT_EQ(m_batch->GetExpectedReply(), FUNC_ID_APPLICATION_COMMAND_HANDLER);
+}
+
+TEST_F(MsgBatchTest, CompleteOnceEveryReportArrives)
+{
+	ASSERT_TRUE(m_batched);
+	EXPECT_FALSE(Report(m_batch, c_battery));
+	EXPECT_FALSE(Report(m_batch, c_switchBinary));
+	EXPECT_TRUE(Report(m_batch, c_sensorMultilevel));
+}
+
+TEST_F(MsgBatchTest, MissingReportKeepsTheBatchWaiting)
+{
+	ASSERT_TRUE(m_batched);
+	EXPECT_FALSE(Report(m_batch, c_switchBinary));
+	EXPECT_FALSE(Report(m_batch, c_battery));
+
+	// Reports the batch did not ask for, or has already had, tick nothing off
+	EXPECT_FALSE(Report(m_batch, c_switchBinary));
+	EXPECT_FALSE(Report(m_batch, 0x20));
+
+	// The transaction waits on the report still missing, and times out if it never comes
+	EXPECT_EQ(m_batch->GetExpectedCommandClassId(), c_sensorMultilevel);
+	EXPECT_EQ(m_batch->GetExpectedReply(), FUNC_ID_APPLICATION_COMMAND_HANDLER);
+}
+
+TEST_F(MsgBatchTest, ReportsInAMultiCmdEncapsulation)
+{
+	ASSERT_TRUE(m_batched);
+	uint8 const data[] =
+	{ c_multiCmd, 0x01, 2, 3, c_battery, 0x03, 0x50, 3, c_switchBinary, 0x03, 0xff };
+	EXPECT_FALSE(m_batch->BatchReportReceived(data, sizeof(data)));
+	EXPECT_EQ(m_batch->GetExpectedCommandClassId(), c_sensorMultilevel);
+	EXPECT_TRUE(Report(m_batch, c_sensorMultilevel));
+}
+
+TEST(MsgBatch, OnlyBatchesFinalizedCommandsForTheSameNode)
+{
+	Msg* first = NewGet(5, c_switchBinary, 0x02);
+	Msg* other = NewGet(6, c_battery, 0x02);
+	EXPECT_FALSE(first->Batch(*other, 46));
+
+	Msg* unfinished = new Msg("Get", 5, REQUEST, FUNC_ID_ZW_SEND_DATA, true, true, FUNC_ID_APPLICATION_COMMAND_HANDLER, c_battery);
+	EXPECT_FALSE(first->Batch(*unfinished, 46));
+
+	// Too big for the payload allowed
+	Msg* battery = NewGet(5, c_battery, 0x02);
+	EXPECT_FALSE(first->Batch(*battery, 8));
+	EXPECT_EQ(first->GetBatchCount(), 0);
+
+	delete first;
+	delete other;
+	delete unfinished;
+	delete battery;
+}
+} // namespace Testing
+} // namespace OpenZWave
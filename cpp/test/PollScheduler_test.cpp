@@ -0,0 +1,199 @@
+//-----------------------------------------------------------------------------
+//
+//	PollScheduler_test.cpp
+//
+//	Test Framework for the order and timing of polls
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+#include "PollScheduler.h"
+
+namespace OpenZWave
+{
+
+namespace Testing
+{
+using Internal::PollScheduler;
+using std::chrono::milliseconds;
+
+class PollSchedulerTest: public ::testing::Test
+{
+	protected:
+		PollSchedulerTest() :
+				m_start(PollScheduler::Clock::now())
+		{
+		}
+
+		static ValueID NewValue(uint8 _nodeId, uint16 _index)
+		{
+			return ValueID(0x01234567, _nodeId, ValueID::ValueGenre_User, 0x31, 1, _index, ValueID::ValueType_Decimal);
+		}
+
+		PollScheduler::Clock::time_point At(int32 _milliseconds) const
+		{
+			return m_start + milliseconds(_milliseconds);
+		}
+
+		// The milliseconds from the start to when the next value is due, or -1 if none are polled
+		static int32 NextDue(PollScheduler& _scheduler, PollScheduler::Clock::time_point _start)
+		{
+			PollScheduler::Clock::time_point due;
+			if (!_scheduler.GetNextDue(&due))
+			{
+				return -1;
+			}
+			return (int32) std::chrono::duration_cast<milliseconds>(due - _start).count();
+		}
+
+		// Takes the value due at _milliseconds, and checks it is _id
+		void ExpectPoll(PollScheduler& _scheduler, int32 _milliseconds, ValueID const& _id)
+		{
+			ValueID id;
+			int32 lag = -1;
+			EXPECT_FALSE(_scheduler.Next(At(_milliseconds - 1), &id, &lag)) << "polled before " << _milliseconds;
+			ASSERT_TRUE(_scheduler.Next(At(_milliseconds), &id, &lag)) << "not polled at " << _milliseconds;
+			EXPECT_EQ(id, _id);
+			EXPECT_EQ(lag, 0);
+		}
+
+		PollScheduler::Clock::time_point m_start;
+};
+
+TEST_F(PollSchedulerTest, IntervalIsTheDefaultTimesTheIntensity)
+{
+	PollScheduler scheduler;
+	scheduler.SetDefaultInterval(1000);
+	ValueID a = NewValue(2, 1);
+	ValueID b = NewValue(3, 1);
+	ValueID c = NewValue(4, 1);
+	ASSERT_TRUE(scheduler.Add(a, 3, 0, At(0)));
+	ASSERT_TRUE(scheduler.Add(b, 1, 0, At(0)));
+	ASSERT_TRUE(scheduler.Add(c, 1, 2500, At(0)));
+	EXPECT_FALSE(scheduler.Add(b, 1, 0, At(0)));
+	EXPECT_EQ(scheduler.GetCount(), 3u);
+
+	ExpectPoll(scheduler, 1000, b);
+	scheduler.Reported(b, true, At(1000));
+	ExpectPoll(scheduler, 2000, b);
+	scheduler.Remove(b);
+	ExpectPoll(scheduler, 2500, c);
+	scheduler.Reported(c, true, At(2500));
+	ExpectPoll(scheduler, 3000, a);
+}
+
+TEST_F(PollSchedulerTest, NoBackoffByDefault)
+{
+	PollScheduler scheduler;
+	scheduler.SetDefaultInterval(1000);
+	ValueID a = NewValue(2, 1);
+	scheduler.Add(a, 1, 0, At(0));
+
+	for (int32 t = 1000; t <= 5000; t += 1000)
+	{
+		ExpectPoll(scheduler, t, a);
+		scheduler.Reported(a, false, At(t));
+	}
+	EXPECT_EQ(scheduler.GetBackedOff(), 0u);
+}
+
+TEST_F(PollSchedulerTest, UnchangedValuesBackOff)
+{
+	PollScheduler scheduler(4);
+	scheduler.SetDefaultInterval(1000);
+	ValueID a = NewValue(2, 1);
+	scheduler.Add(a, 1, 0, At(0));
+
+	// Each poll that finds the value unchanged doubles the interval, up to 4 times
+	ExpectPoll(scheduler, 1000, a);
+	scheduler.Reported(a, false, At(1000));
+	ExpectPoll(scheduler, 3000, a);
+	scheduler.Reported(a, false, At(3000));
+	ExpectPoll(scheduler, 7000, a);
+	scheduler.Reported(a, false, At(7000));
+	ExpectPoll(scheduler, 11000, a);
+	EXPECT_EQ(scheduler.GetBackedOff(), 2u);
+
+	// A change brings it straight back
+	scheduler.Reported(a, true, At(11000));
+	ExpectPoll(scheduler, 12000, a);
+}
+
+TEST_F(PollSchedulerTest, UnansweredPollIsRepeated)
+{
+	PollScheduler scheduler(4);
+	scheduler.SetDefaultInterval(1000);
+	ValueID a = NewValue(2, 1);
+	scheduler.Add(a, 1, 0, At(0));
+
+	ExpectPoll(scheduler, 1000, a);
+	ExpectPoll(scheduler, 2000, a);
+	EXPECT_EQ(scheduler.GetBackedOff(), 0u);
+}
+
+TEST_F(PollSchedulerTest, UnsolicitedReportDefersThePoll)
+{
+	PollScheduler scheduler;
+	scheduler.SetDefaultInterval(1000);
+	ValueID a = NewValue(2, 1);
+	ValueID b = NewValue(3, 1);
+	scheduler.Add(a, 1, 0, At(0));
+	scheduler.Add(b, 1, 0, At(0));
+
+	// The node reported a on its own, so its poll waits an interval from then
+	scheduler.Reported(a, true, At(600));
+	EXPECT_EQ(scheduler.GetDeferred(), 1u);
+	ExpectPoll(scheduler, 1000, b);
+	ExpectPoll(scheduler, 1600, a);
+
+	// A report that would bring the poll forward leaves it where it was
+	scheduler.Reported(a, true, At(1600));
+	scheduler.Reported(b, true, At(1000));
+	EXPECT_EQ(NextDue(scheduler, m_start), 2000);
+	EXPECT_EQ(scheduler.GetDeferred(), 1u);
+}
+
+TEST_F(PollSchedulerTest, RemoveAndAddAgain)
+{
+	PollScheduler scheduler;
+	scheduler.SetDefaultInterval(1000);
+	ValueID a = NewValue(2, 1);
+	ValueID b = NewValue(3, 1);
+	scheduler.Add(a, 1, 0, At(0));
+	scheduler.Add(b, 1, 5000, At(0));
+
+	EXPECT_TRUE(scheduler.Remove(a));
+	EXPECT_FALSE(scheduler.Remove(a));
+	EXPECT_FALSE(scheduler.Contains(a));
+
+	// Added again, it is due an interval from then, not when it was first due
+	ASSERT_TRUE(scheduler.Add(a, 1, 0, At(500)));
+	EXPECT_EQ(NextDue(scheduler, m_start), 1500);
+	ExpectPoll(scheduler, 1500, a);
+	scheduler.Reported(a, true, At(1500));
+	ExpectPoll(scheduler, 2500, a);
+
+	EXPECT_TRUE(scheduler.Remove(a));
+	EXPECT_TRUE(scheduler.Remove(b));
+	EXPECT_EQ(scheduler.GetCount(), 0u);
+	EXPECT_EQ(NextDue(scheduler, m_start), -1);
+}
+} // namespace Testing
+} // namespace OpenZWave
@@ -0,0 +1,221 @@
+//-----------------------------------------------------------------------------
+//
+//	SharedMutex_test.cpp
+//
+//	Test Framework for the reader/writer lock
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "platform/SharedMutex.h"
+
+namespace OpenZWave
+{
+
+namespace Testing
+{
+using Internal::Platform::SharedMutex;
+
+class SharedMutexTest: public ::testing::Test
+{
+	protected:
+		SharedMutexTest() :
+				m_mutex(new SharedMutex())
+		{
+		}
+		virtual ~SharedMutexTest()
+		{
+			m_mutex->Release();
+		}
+
+		// Whether another thread could take the lock exclusively right now
+		bool OtherCanLock()
+		{
+			bool locked = false;
+			std::thread other([this, &locked]()
+			{
+				locked = m_mutex->Lock(false);
+				if (locked)
+				{
+					m_mutex->Unlock();
+				}
+			});
+			other.join();
+			return locked;
+		}
+
+		SharedMutex* m_mutex;
+};
+
+TEST_F(SharedMutexTest, ReadersShareTheLock)
+{
+	m_mutex->LockShared();
+	std::atomic<bool> read(false);
+	std::thread reader([this, &read]()
+	{
+		m_mutex->LockShared();
+		read = true;
+		m_mutex->UnlockShared();
+	});
+	reader.join();
+	EXPECT_TRUE(read);
+	EXPECT_FALSE(OtherCanLock());
+	EXPECT_FALSE(m_mutex->IsSignalled());
+	m_mutex->UnlockShared();
+	EXPECT_TRUE(m_mutex->IsSignalled());
+	EXPECT_TRUE(OtherCanLock());
+}
+
+TEST_F(SharedMutexTest, WriterKeepsReadersOut)
+{
+	ASSERT_TRUE(m_mutex->Lock());
+	EXPECT_FALSE(OtherCanLock());
+
+	std::atomic<bool> read(false);
+	std::thread reader([this, &read]()
+	{
+		m_mutex->LockShared();
+		read = true;
+		m_mutex->UnlockShared();
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_FALSE(read);
+	m_mutex->Unlock();
+	reader.join();
+	EXPECT_TRUE(read);
+	EXPECT_TRUE(m_mutex->IsSignalled());
+}
+
+TEST_F(SharedMutexTest, NestedLocks)
+{
+	ASSERT_TRUE(m_mutex->Lock());
+	ASSERT_TRUE(m_mutex->Lock());
+	m_mutex->LockShared();
+	m_mutex->UnlockShared();
+	m_mutex->Unlock();
+	EXPECT_FALSE(OtherCanLock());
+	m_mutex->Unlock();
+	EXPECT_TRUE(m_mutex->IsSignalled());
+
+	m_mutex->LockShared();
+	m_mutex->LockShared();
+	m_mutex->UnlockShared();
+	EXPECT_FALSE(OtherCanLock());
+	m_mutex->UnlockShared();
+	EXPECT_TRUE(m_mutex->IsSignalled());
+}
+
+TEST_F(SharedMutexTest, SharedLockIsNotUpgraded)
+{
+	m_mutex->LockShared();
+
+	// Refused, whether or not it would wait, and whether or not there are other readers
+	EXPECT_FALSE(m_mutex->Lock(false));
+	EXPECT_FALSE(m_mutex->Lock());
+
+	std::atomic<bool> stop(false);
+	std::thread reader([this, &stop]()
+	{
+		m_mutex->LockShared();
+		while (!stop)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		m_mutex->UnlockShared();
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_FALSE(m_mutex->Lock());
+	stop = true;
+	reader.join();
+
+	// Still held shared
+	EXPECT_FALSE(OtherCanLock());
+	m_mutex->UnlockShared();
+	EXPECT_TRUE(m_mutex->IsSignalled());
+}
+
+TEST_F(SharedMutexTest, WaitingWriterHoldsOffNewReaders)
+{
+	m_mutex->LockShared();
+	std::atomic<bool> written(false);
+	std::thread writer([this, &written]()
+	{
+		m_mutex->Lock();
+		written = true;
+		m_mutex->Unlock();
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_FALSE(written);
+
+	std::atomic<bool> readAfterWrite(false);
+	std::thread reader([this, &written, &readAfterWrite]()
+	{
+		m_mutex->LockShared();
+		readAfterWrite = written.load();
+		m_mutex->UnlockShared();
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	m_mutex->UnlockShared();
+	writer.join();
+	reader.join();
+	EXPECT_TRUE(written);
+	EXPECT_TRUE(readAfterWrite);
+	EXPECT_TRUE(m_mutex->IsSignalled());
+}
+
+TEST_F(SharedMutexTest, WritersExcludeEachOther)
+{
+	uint32 count = 0;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+	{
+		threads.push_back(std::thread([this, &count]()
+		{
+			for (int i = 0; i < 10000; ++i)
+			{
+				if (i % 4)
+				{
+					m_mutex->LockShared();
+					m_mutex->UnlockShared();
+				}
+				else
+				{
+					m_mutex->Lock();
+					uint32 seen = count;
+					count = seen + 1;
+					m_mutex->Unlock();
+				}
+			}
+		}));
+	}
+	for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it)
+	{
+		it->join();
+	}
+	EXPECT_EQ(count, 10000u);
+	EXPECT_TRUE(m_mutex->IsSignalled());
+}
+} // namespace Testing
+} // namespace OpenZWave
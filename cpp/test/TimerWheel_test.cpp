@@ -0,0 +1,254 @@
+//-----------------------------------------------------------------------------
+//
+//	TimerWheel_test.cpp
+//
+//	Test Framework for the order in which timers expire
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "TimerWheel.h"
+
+namespace OpenZWave
+{
+
+namespace Testing
+{
+using Internal::TimerWheel;
+
+// One level of the wheel holds 64 ticks, two 4096, and all four 2^24
+static uint64 const c_horizon = ((uint64) 1) << 24;
+
+struct TestTimer: public TimerWheel::Entry
+{
+		TestTimer(uint32 _id, uint64 _expiry) :
+				m_id(_id)
+		{
+			m_expiry = _expiry;
+		}
+
+		uint32 m_id;
+};
+
+// Expires everything due by _now, checking each timer goes at its own tick
+static std::vector<uint32> ExpireAll(TimerWheel& _wheel, uint64 _now)
+{
+	std::vector<uint32> expired;
+	while (TimerWheel::Entry* entry = _wheel.Expire(_now))
+	{
+		EXPECT_EQ(entry->m_level, TimerWheel::NotQueued);
+		expired.push_back(static_cast<TestTimer*>(entry)->m_id);
+	}
+	return expired;
+}
+
+// Steps time on through every tick that GetNextTick asks for, as TimerThread does, and
+// checks that each timer expires at its tick and not before
+static void ExpectExpiryTicks(TimerWheel& _wheel)
+{
+	uint32 remaining = _wheel.GetCount();
+	while (remaining)
+	{
+		uint64 tick = _wheel.GetNextTick();
+		ASSERT_NE(tick, TimerWheel::Never);
+		while (TimerWheel::Entry* entry = _wheel.Expire(tick))
+		{
+			EXPECT_EQ(entry->m_expiry, tick) << "timer " << static_cast<TestTimer*>(entry)->m_id;
+			--remaining;
+		}
+		EXPECT_EQ(_wheel.GetCount(), remaining);
+	}
+	EXPECT_EQ(_wheel.GetNextTick(), TimerWheel::Never);
+}
+
+TEST(TimerWheel, ExpiresInOrderOfTick)
+{
+	TimerWheel wheel(1000);
+	uint64 const expiries[] =
+	{ 1000 + 5000, 1000 + 3, 1000 + 63, 1000 + 64, 1000 + 65, 1000 + 4095, 1000 + 4096, 1000 + 4097, 1000 + 262143, 1000 + 262144, 1000 + 262145, 999, 1000 };
+	uint32 const count = sizeof(expiries) / sizeof(expiries[0]);
+
+	std::vector<TestTimer> timers;
+	for (uint32 i = 0; i < count; ++i)
+	{
+		timers.push_back(TestTimer(i, expiries[i]));
+	}
+	for (uint32 i = 0; i < count; ++i)
+	{
+		wheel.Add(&timers[i]);
+	}
+	EXPECT_EQ(wheel.GetCount(), count);
+
+	// The timer already past expires at once, in the order it was added
+	std::vector<uint32> expired = ExpireAll(wheel, 1000);
+	ASSERT_EQ(expired.size(), 2u);
+	EXPECT_EQ(expired[0], 11u);
+	EXPECT_EQ(expired[1], 12u);
+	ExpectExpiryTicks(wheel);
+}
+
+TEST(TimerWheel, ExpiresAcrossLevelBoundaries)
+{
+	// Start part way through a slot on every level, so the timers spill over into the next
+	uint64 const start = (((uint64) 5) << 18) + (((uint64) 7) << 12) + (((uint64) 9) << 6) + 11;
+	TimerWheel wheel(start);
+
+	std::vector<TestTimer> timers;
+	uint32 id = 0;
+	for (uint32 level = 0; level < 4; ++level)
+	{
+		uint64 span = ((uint64) 1) << (6 * (level + 1));
+		uint64 const offsets[] =
+		{ 1, span / 2, span - 54, span - 53, span - 1, span, span + 1 };
+		for (uint32 i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i)
+		{
+			timers.push_back(TestTimer(id++, start + offsets[i]));
+		}
+	}
+	for (uint32 i = 0; i < timers.size(); ++i)
+	{
+		wheel.Add(&timers[i]);
+	}
+	ExpectExpiryTicks(wheel);
+}
+
+TEST(TimerWheel, SameTickInTheOrderAdded)
+{
+	TimerWheel wheel(0);
+
+	// The first is added far enough ahead to wait on a higher level, and the others reach
+	// the first level before it is spread down to join them
+	TestTimer first(0, 5000);
+	TestTimer second(1, 5000);
+	TestTimer third(2, 5000);
+	wheel.Add(&first);
+	EXPECT_TRUE(ExpireAll(wheel, 4500).empty());
+	wheel.Add(&second);
+	EXPECT_TRUE(ExpireAll(wheel, 4950).empty());
+	wheel.Add(&third);
+	EXPECT_TRUE(ExpireAll(wheel, 4999).empty());
+
+	std::vector<uint32> expired = ExpireAll(wheel, 5000);
+	ASSERT_EQ(expired.size(), 3u);
+	EXPECT_EQ(expired[0], 0u);
+	EXPECT_EQ(expired[1], 1u);
+	EXPECT_EQ(expired[2], 2u);
+}
+
+TEST(TimerWheel, BeyondTheHorizon)
+{
+	TimerWheel wheel(100);
+
+	// Further away than the top level reaches, so each waits there and is placed again
+	TestTimer near(0, 100 + c_horizon - 1);
+	TestTimer edge(1, 100 + c_horizon);
+	TestTimer far(2, 100 + 3 * c_horizon + 12345);
+	wheel.Add(&far);
+	wheel.Add(&edge);
+	wheel.Add(&near);
+	EXPECT_LE(wheel.GetNextTick(), 100 + c_horizon);
+
+	EXPECT_TRUE(ExpireAll(wheel, 100 + c_horizon - 2).empty());
+	std::vector<uint32> expired = ExpireAll(wheel, 100 + c_horizon);
+	ASSERT_EQ(expired.size(), 2u);
+	EXPECT_EQ(expired[0], 0u);
+	EXPECT_EQ(expired[1], 1u);
+
+	EXPECT_TRUE(ExpireAll(wheel, 100 + 3 * c_horizon + 12344).empty());
+	EXPECT_EQ(wheel.GetCount(), 1u);
+	expired = ExpireAll(wheel, 100 + 3 * c_horizon + 12345);
+	ASSERT_EQ(expired.size(), 1u);
+	EXPECT_EQ(expired[0], 2u);
+	EXPECT_EQ(wheel.GetNextTick(), TimerWheel::Never);
+}
+
+TEST(TimerWheel, BeyondTheHorizonTickByTick)
+{
+	TimerWheel wheel(0);
+	std::vector<TestTimer> timers;
+	timers.push_back(TestTimer(0, 2 * c_horizon + 70));
+	timers.push_back(TestTimer(1, c_horizon + 4100));
+	wheel.Add(&timers[0]);
+	wheel.Add(&timers[1]);
+	ExpectExpiryTicks(wheel);
+}
+
+TEST(TimerWheel, RemoveQueuedTimer)
+{
+	TimerWheel wheel(0);
+	TestTimer a(0, 10);
+	TestTimer b(1, 10);
+	TestTimer c(2, 10);
+	TestTimer later(3, 5000);
+	TestTimer idle(4, 20);
+	wheel.Add(&a);
+	wheel.Add(&b);
+	wheel.Add(&c);
+	wheel.Add(&later);
+	EXPECT_EQ(wheel.GetCount(), 4u);
+
+	// From the middle of a slot, and from a higher level
+	wheel.Remove(&b);
+	EXPECT_EQ(b.m_level, TimerWheel::NotQueued);
+	wheel.Remove(&later);
+	EXPECT_EQ(wheel.GetCount(), 2u);
+
+	// Removing a timer that is not queued does nothing
+	wheel.Remove(&b);
+	wheel.Remove(&idle);
+	EXPECT_EQ(wheel.GetCount(), 2u);
+
+	EXPECT_EQ(wheel.GetNextTick(), 10u);
+	std::vector<uint32> expired = ExpireAll(wheel, 10000);
+	ASSERT_EQ(expired.size(), 2u);
+	EXPECT_EQ(expired[0], 0u);
+	EXPECT_EQ(expired[1], 2u);
+	EXPECT_EQ(wheel.GetCount(), 0u);
+	EXPECT_EQ(wheel.GetNextTick(), TimerWheel::Never);
+
+	// A removed timer can be added again
+	b.m_expiry = 10010;
+	wheel.Add(&b);
+	EXPECT_EQ(wheel.GetNextTick(), 10010u);
+	expired = ExpireAll(wheel, 10010);
+	ASSERT_EQ(expired.size(), 1u);
+	EXPECT_EQ(expired[0], 1u);
+}
+
+TEST(TimerWheel, AddAgainMovesATimer)
+{
+	TimerWheel wheel(0);
+	TestTimer a(0, 3000);
+	TestTimer b(1, 40);
+	wheel.Add(&a);
+	wheel.Add(&b);
+
+	a.m_expiry = 30;
+	wheel.Add(&a);
+	EXPECT_EQ(wheel.GetCount(), 2u);
+	std::vector<uint32> expired = ExpireAll(wheel, 5000);
+	ASSERT_EQ(expired.size(), 2u);
+	EXPECT_EQ(expired[0], 0u);
+	EXPECT_EQ(expired[1], 1u);
+}
+} // namespace Testing
+} // namespace OpenZWave
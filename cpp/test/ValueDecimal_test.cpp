@@ -0,0 +1,212 @@
+//-----------------------------------------------------------------------------
+//
+//	ValueDecimal_test.cpp
+//
+//	Test Framework for reading and writing decimal values
+//
+//	SOFTWARE NOTICE AND LICENSE
+//
+//	This file is part of OpenZWave.
+//
+//	OpenZWave is free software: you can redistribute it and/or modify
+//	it under the terms of the GNU Lesser General Public License as published
+//	by the Free Software Foundation, either version 3 of the License,
+//	or (at your option) any later version.
+//
+//	OpenZWave is distributed in the hope that it will be useful,
+//	but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//	GNU Lesser General Public License for more details.
+//
+//	You should have received a copy of the GNU Lesser General Public License
+//	along with OpenZWave.  If not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+#include "value_classes/ValueDecimal.h"
+#include "Options.h"
+#include "tinyxml.h"
+
+namespace OpenZWave
+{
+
+namespace Testing
+{
+using Internal::VC::ValueDecimal;
+
+// Parses _str, and checks it comes back the same from Format
+static void ExpectRoundTrip(char const* _str, int32 _value, uint8 _precision)
+{
+	int32 value = 0;
+	uint8 precision = 0;
+	ASSERT_TRUE(ValueDecimal::Parse(_str, &value, &precision)) << _str;
+	EXPECT_EQ(value, _value) << _str;
+	EXPECT_EQ(precision, _precision) << _str;
+	EXPECT_EQ(ValueDecimal::Format(value, precision), _str);
+}
+
+// Checks _str is rejected, and the outputs are left alone
+static void ExpectRejected(char const* _str)
+{
+	int32 value = 42;
+	uint8 precision = 3;
+	EXPECT_FALSE(ValueDecimal::Parse(_str, &value, &precision)) << _str;
+	EXPECT_EQ(value, 42) << _str;
+	EXPECT_EQ(precision, 3) << _str;
+}
+
+TEST(ValueDecimal, RoundTrip)
+{
+	// The tests run in the "C" locale, so Format writes a '.'
+	ExpectRoundTrip("0", 0, 0);
+	ExpectRoundTrip("21", 21, 0);
+	ExpectRoundTrip("21.5", 215, 1);
+	ExpectRoundTrip("0.05", 5, 2);
+	ExpectRoundTrip("-12", -12, 0);
+	ExpectRoundTrip("-12.25", -1225, 2);
+	ExpectRoundTrip("-0.5", -5, 1);
+	ExpectRoundTrip("1.0000001", 10000001, 7);
+	ExpectRoundTrip("2147483647", 2147483647, 0);
+	ExpectRoundTrip("-2147483648", -2147483647 - 1, 0);
+	ExpectRoundTrip("-214.7483648", -2147483647 - 1, 7);
+}
+
+TEST(ValueDecimal, CommaSeparator)
+{
+	int32 value = 0;
+	uint8 precision = 0;
+	ASSERT_TRUE(ValueDecimal::Parse("-3,75", &value, &precision));
+	EXPECT_EQ(value, -375);
+	EXPECT_EQ(precision, 2);
+	EXPECT_EQ(ValueDecimal::Format(value, precision), "-3.75");
+}
+
+TEST(ValueDecimal, Whitespace)
+{
+	int32 value = 0;
+	uint8 precision = 0;
+	ASSERT_TRUE(ValueDecimal::Parse(" 1.5 ", &value, &precision));
+	EXPECT_EQ(value, 15);
+	EXPECT_EQ(precision, 1);
+}
+
+TEST(ValueDecimal, Overflow)
+{
+	ExpectRejected("99999999999");
+	ExpectRejected("2147483648");
+	ExpectRejected("-2147483649");
+	ExpectRejected("999.9999999");
+	ExpectRejected("99999999999999999999999");
+}
+
+TEST(ValueDecimal, Garbage)
+{
+	ExpectRejected("");
+	ExpectRejected(" ");
+	ExpectRejected(".");
+	ExpectRejected("-");
+	ExpectRejected("abc");
+	ExpectRejected("12abc");
+	ExpectRejected("1.5x");
+	ExpectRejected("1.2.3");
+	ExpectRejected("1.-5");
+	ExpectRejected("1.23456789x");
+}
+
+TEST(ValueDecimal, LongFractionsAreRounded)
+{
+	int32 value = 0;
+	uint8 precision = 0;
+
+	// Rounded to the 7 digits that fit in the precision field
+	ASSERT_TRUE(ValueDecimal::Parse("3.141592653", &value, &precision));
+	EXPECT_EQ(value, 31415927);
+	EXPECT_EQ(precision, 7);
+
+	ASSERT_TRUE(ValueDecimal::Parse("1.23456784", &value, &precision));
+	EXPECT_EQ(value, 12345678);
+
+	ASSERT_TRUE(ValueDecimal::Parse("-1.23456785", &value, &precision));
+	EXPECT_EQ(value, -12345679);
+
+	ASSERT_TRUE(ValueDecimal::Parse("-0.00000005", &value, &precision));
+	EXPECT_EQ(value, -1);
+	EXPECT_EQ(ValueDecimal::Format(value, precision), "-0.0000001");
+
+	ASSERT_TRUE(ValueDecimal::Parse("0.99999999", &value, &precision));
+	EXPECT_EQ(value, 10000000);
+	EXPECT_EQ(ValueDecimal::Format(value, precision), "1.0000000");
+}
+// The labels of values read from the cache are looked up in the config folder of the source tree
+static void CreateOptions()
+{
+	if (!Options::Get())
+	{
+		Options::Create(OZW_TEST_CONFIG_PATH, "", "");
+		Options::Get()->Lock();
+	}
+}
+
+// A value as the cache has it
+static TiXmlElement NewValueElement(char const* _value, char const* _scale)
+{
+	TiXmlElement element("Value");
+	element.SetAttribute("type", "decimal");
+	element.SetAttribute("genre", "user");
+	element.SetAttribute("instance", 1);
+	element.SetAttribute("index", 1);
+	element.SetAttribute("label", "Air Temperature");
+	element.SetAttribute("units", "F");
+	element.SetAttribute("value", _value);
+	if (_scale)
+	{
+		element.SetAttribute("scale", _scale);
+	}
+	return element;
+}
+
+TEST(ValueDecimal, XMLRoundTrip)
+{
+	CreateOptions();
+
+	ValueDecimal loaded;
+	TiXmlElement element = NewValueElement("71.6", "1");
+	loaded.ReadXML(0x01234567, 5, 0x31, &element);
+	EXPECT_EQ(loaded.GetValue(), "71.6");
+	EXPECT_EQ(loaded.GetPrecision(), 1);
+	EXPECT_EQ(loaded.GetScale(), 1);
+
+	// Written back and read again, it is still the same value, so the
+	// first report after a restart is not taken for a change
+	TiXmlElement written("Value");
+	loaded.WriteXML(&written);
+	EXPECT_STREQ(written.Attribute("value"), "71.6");
+	EXPECT_STREQ(written.Attribute("scale"), "1");
+
+	ValueDecimal reloaded;
+	reloaded.ReadXML(0x01234567, 5, 0x31, &written);
+	EXPECT_EQ(reloaded.GetValue(), "71.6");
+	EXPECT_EQ(reloaded.GetPrecision(), 1);
+	EXPECT_EQ(reloaded.GetScale(), 1);
+}
+
+TEST(ValueDecimal, XMLWithoutScale)
+{
+	CreateOptions();
+
+	// Caches written before the scale was kept, and values in the default scale
+	ValueDecimal loaded;
+	TiXmlElement element = NewValueElement("-3.25", NULL);
+	loaded.ReadXML(0x01234567, 5, 0x31, &element);
+	EXPECT_EQ(loaded.GetValue(), "-3.25");
+	EXPECT_EQ(loaded.GetPrecision(), 2);
+	EXPECT_EQ(loaded.GetScale(), 0);
+
+	TiXmlElement written("Value");
+	loaded.WriteXML(&written);
+	EXPECT_STREQ(written.Attribute("value"), "-3.25");
+	EXPECT_EQ(written.Attribute("scale"), (char const*) NULL);
+}
+} // namespace Testing
+} // namespace OpenZWave
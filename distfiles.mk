@@ -1532,9 +1532,15 @@ DISTFILES =	.gitignore \
 	cpp/build/windows/vs2010/OpenZWave.vcxproj \
 	cpp/build/windows/vs2010/OpenZWave.vcxproj.filters \
 	cpp/build/windows/winversion.tmpl \
+	cpp/examples/CacheTool/CacheTool.cpp \
+	cpp/examples/CacheTool/CacheTool.in \
+	cpp/examples/CacheTool/Makefile \
 	cpp/examples/MinOZW/Main.cpp \
 	cpp/examples/MinOZW/Makefile \
 	cpp/examples/MinOZW/MinOZW.in \
+	cpp/examples/OZWBench/Makefile \
+	cpp/examples/OZWBench/OZWBench.cpp \
+	cpp/examples/OZWBench/OZWBench.in \
 	cpp/examples/windows/MinOZW/Main.cpp \
 	cpp/examples/windows/MinOZW/vs2010/MinOZW.sln \
 	cpp/examples/windows/MinOZW/vs2010/MinOZW.vcxproj \
@@ -1583,13 +1589,19 @@ DISTFILES =	.gitignore \
 	cpp/hidapi/windows/hidapi.sln \
 	cpp/hidapi/windows/hidapi.vcproj \
 	cpp/hidapi/windows/hidtest.vcproj \
+	cpp/src/BinaryCache.cpp \
+	cpp/src/BinaryCache.h \
 	cpp/src/Bitfield.cpp \
 	cpp/src/Bitfield.h \
+	cpp/src/CacheJournal.cpp \
+	cpp/src/CacheJournal.h \
 	cpp/src/CompatOptionManager.cpp \
 	cpp/src/CompatOptionManager.h \
 	cpp/src/DNSThread.cpp \
 	cpp/src/DNSThread.h \
 	cpp/src/Defs.h \
+	cpp/src/DeviceDatabase.cpp \
+	cpp/src/DeviceDatabase.h \
 	cpp/src/DoxygenMain.h \
 	cpp/src/Driver.cpp \
 	cpp/src/Driver.h \
@@ -1597,29 +1609,45 @@ DISTFILES =	.gitignore \
 	cpp/src/Group.h \
 	cpp/src/Http.cpp \
 	cpp/src/Http.h \
+	cpp/src/IdleSignal.cpp \
+	cpp/src/IdleSignal.h \
+	cpp/src/InterviewScheduler.cpp \
+	cpp/src/InterviewScheduler.h \
+	cpp/src/LatencyHistogram.cpp \
+	cpp/src/LatencyHistogram.h \
 	cpp/src/Localization.cpp \
 	cpp/src/Localization.h \
 	cpp/src/Manager.cpp \
 	cpp/src/Manager.h \
 	cpp/src/ManufacturerSpecificDB.cpp \
 	cpp/src/ManufacturerSpecificDB.h \
+	cpp/src/MetricsExporter.cpp \
+	cpp/src/MetricsExporter.h \
 	cpp/src/Msg.cpp \
 	cpp/src/Msg.h \
+	cpp/src/MsgScheduler.cpp \
+	cpp/src/MsgScheduler.h \
 	cpp/src/Node.cpp \
 	cpp/src/Node.h \
 	cpp/src/Notification.cpp \
 	cpp/src/Notification.h \
 	cpp/src/NotificationCCTypes.cpp \
 	cpp/src/NotificationCCTypes.h \
+	cpp/src/NotificationDispatcher.cpp \
+	cpp/src/NotificationDispatcher.h \
 	cpp/src/OZWException.h \
 	cpp/src/Options.cpp \
 	cpp/src/Options.h \
+	cpp/src/PollScheduler.cpp \
+	cpp/src/PollScheduler.h \
 	cpp/src/Scene.cpp \
 	cpp/src/Scene.h \
 	cpp/src/SensorMultiLevelCCTypes.cpp \
 	cpp/src/SensorMultiLevelCCTypes.h \
 	cpp/src/TimerThread.cpp \
 	cpp/src/TimerThread.h \
+	cpp/src/TimerWheel.cpp \
+	cpp/src/TimerWheel.h \
 	cpp/src/Utils.cpp \
 	cpp/src/Utils.h \
 	cpp/src/ValueIDIndexes.h \
@@ -1779,6 +1807,8 @@ DISTFILES =	.gitignore \
 	cpp/src/platform/Ref.h \
 	cpp/src/platform/SerialController.cpp \
 	cpp/src/platform/SerialController.h \
+	cpp/src/platform/SharedMutex.cpp \
+	cpp/src/platform/SharedMutex.h \
 	cpp/src/platform/Stream.cpp \
 	cpp/src/platform/Stream.h \
 	cpp/src/platform/Thread.cpp \
@@ -1787,6 +1817,8 @@ DISTFILES =	.gitignore \
 	cpp/src/platform/TimeStamp.h \
 	cpp/src/platform/Wait.cpp \
 	cpp/src/platform/Wait.h \
+	cpp/src/platform/WaitSet.cpp \
+	cpp/src/platform/WaitSet.h \
 	cpp/src/platform/unix/DNSImpl.cpp \
 	cpp/src/platform/unix/DNSImpl.h \
 	cpp/src/platform/unix/EventImpl.cpp \
@@ -1805,6 +1837,8 @@ DISTFILES =	.gitignore \
 	cpp/src/platform/unix/TimeStampImpl.h \
 	cpp/src/platform/unix/WaitImpl.cpp \
 	cpp/src/platform/unix/WaitImpl.h \
+	cpp/src/platform/unix/WaitSetImpl.cpp \
+	cpp/src/platform/unix/WaitSetImpl.h \
 	cpp/src/platform/unix/android.h \
 	cpp/src/platform/winRT/DNSImpl.cpp \
 	cpp/src/platform/winRT/DNSImpl.h \
@@ -1826,6 +1860,8 @@ DISTFILES =	.gitignore \
 	cpp/src/platform/winRT/TimeStampImpl.h \
 	cpp/src/platform/winRT/WaitImpl.cpp \
 	cpp/src/platform/winRT/WaitImpl.h \
+	cpp/src/platform/winRT/WaitSetImpl.cpp \
+	cpp/src/platform/winRT/WaitSetImpl.h \
 	cpp/src/platform/windows/DNSImpl.cpp \
 	cpp/src/platform/windows/DNSImpl.h \
 	cpp/src/platform/windows/EventImpl.cpp \
@@ -1844,6 +1880,8 @@ DISTFILES =	.gitignore \
 	cpp/src/platform/windows/TimeStampImpl.h \
 	cpp/src/platform/windows/WaitImpl.cpp \
 	cpp/src/platform/windows/WaitImpl.h \
+	cpp/src/platform/windows/WaitSetImpl.cpp \
+	cpp/src/platform/windows/WaitSetImpl.h \
 	cpp/src/value_classes/Value.cpp \
 	cpp/src/value_classes/Value.h \
 	cpp/src/value_classes/ValueBitSet.cpp \
@@ -1872,7 +1910,14 @@ DISTFILES =	.gitignore \
 	cpp/src/value_classes/ValueStore.h \
 	cpp/src/value_classes/ValueString.cpp \
 	cpp/src/value_classes/ValueString.h \
+	cpp/test/LatencyHistogram_test.cpp \
 	cpp/test/Makefile \
+	cpp/test/MsgScheduler_test.cpp \
+	cpp/test/Msg_test.cpp \
+	cpp/test/PollScheduler_test.cpp \
+	cpp/test/SharedMutex_test.cpp \
+	cpp/test/TimerWheel_test.cpp \
+	cpp/test/ValueDecimal_test.cpp \
 	cpp/test/ValueID_test.cpp \
 	cpp/test/include/gtest/gtest-death-test.h \
 	cpp/test/include/gtest/gtest-matchers.h \